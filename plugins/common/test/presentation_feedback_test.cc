@@ -0,0 +1,260 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Checks PresentationFeedback against a running compositor.
+//
+// Maps a small xdg_toplevel with a shm buffer, asks for feedback on that
+// commit and exits non-zero unless a presented or discarded event arrives
+// within kTimeout. Connects to $WAYLAND_DISPLAY; headless Weston is enough:
+//
+//   weston --backend=headless-backend.so --socket=wayland-test &
+//   WAYLAND_DISPLAY=wayland-test ./presentation_feedback_test
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <wayland-client.h>
+#include <plugins/common/wayland/presentation_feedback.h>
+
+#include "xdg-shell-client-protocol.h"
+
+namespace {
+
+constexpr int kWidth = 64;
+constexpr int kHeight = 64;
+constexpr std::chrono::seconds kTimeout{5};
+
+struct Client {
+  wl_compositor* compositor{};
+  wl_shm* shm{};
+  xdg_wm_base* wm_base{};
+  bool configured = false;
+  uint32_t configure_serial = 0;
+};
+
+void OnRegistryGlobal(void* data,
+                      wl_registry* registry,
+                      const uint32_t name,
+                      const char* interface,
+                      uint32_t /* version */) {
+  const auto client = static_cast<Client*>(data);
+  if (strcmp(interface, wl_compositor_interface.name) == 0) {
+    client->compositor = static_cast<wl_compositor*>(
+        wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+  } else if (strcmp(interface, wl_shm_interface.name) == 0) {
+    client->shm = static_cast<wl_shm*>(
+        wl_registry_bind(registry, name, &wl_shm_interface, 1));
+  } else if (strcmp(interface, xdg_wm_base_interface.name) == 0) {
+    client->wm_base = static_cast<xdg_wm_base*>(
+        wl_registry_bind(registry, name, &xdg_wm_base_interface, 1));
+  }
+}
+
+void OnRegistryGlobalRemove(void* /* data */,
+                            wl_registry* /* registry */,
+                            uint32_t /* name */) {}
+
+void OnPing(void* /* data */, xdg_wm_base* wm_base, const uint32_t serial) {
+  xdg_wm_base_pong(wm_base, serial);
+}
+
+void OnSurfaceConfigure(void* data,
+                        xdg_surface* /* surface */,
+                        const uint32_t serial) {
+  const auto client = static_cast<Client*>(data);
+  client->configured = true;
+  client->configure_serial = serial;
+}
+
+void OnToplevelConfigure(void* /* data */,
+                         xdg_toplevel* /* toplevel */,
+                         int32_t /* width */,
+                         int32_t /* height */,
+                         wl_array* /* states */) {}
+
+void OnToplevelClose(void* /* data */, xdg_toplevel* /* toplevel */) {}
+
+wl_buffer* CreateBuffer(wl_shm* shm) {
+  constexpr int stride = kWidth * 4;
+  constexpr int size = stride * kHeight;
+
+  const int fd = memfd_create("presentation_feedback_test", MFD_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  if (ftruncate(fd, size) < 0) {
+    close(fd);
+    return nullptr;
+  }
+  void* pixels =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (pixels == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  memset(pixels, 0x80, size);
+  munmap(pixels, size);
+
+  wl_shm_pool* pool = wl_shm_create_pool(shm, fd, size);
+  wl_buffer* buffer = wl_shm_pool_create_buffer(
+      pool, 0, kWidth, kHeight, stride, WL_SHM_FORMAT_XRGB8888);
+  wl_shm_pool_destroy(pool);
+  close(fd);
+  return buffer;
+}
+
+// Reads and dispatches events until the feedback requested on the last
+// commit is finished or kTimeout passes. Returns the feedback counts.
+plugin_common_wayland::PresentationFeedback::Stats WaitForFeedback(
+    wl_display* display,
+    plugin_common_wayland::PresentationFeedback& feedback) {
+  plugin_common_wayland::PresentationFeedback::Stats total;
+  const auto deadline = std::chrono::steady_clock::now() + kTimeout;
+
+  while (total.presented + total.discarded == 0) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      break;
+    }
+
+    while (wl_display_prepare_read(display) != 0) {
+      wl_display_dispatch_pending(display);
+    }
+    wl_display_flush(display);
+
+    pollfd fd{wl_display_get_fd(display), POLLIN, 0};
+    if (poll(&fd, 1, static_cast<int>(remaining.count())) > 0) {
+      if (wl_display_read_events(display) < 0) {
+        fprintf(stderr, "Lost the connection to the compositor\n");
+        break;
+      }
+    } else {
+      wl_display_cancel_read(display);
+    }
+    wl_display_dispatch_pending(display);
+
+    // The feedback events were read into its own queue above.
+    feedback.Dispatch();
+    const auto stats = feedback.TakeStats();
+    total.presented += stats.presented;
+    total.discarded += stats.discarded;
+    total.latency_max_ms = stats.latency_max_ms;
+  }
+  return total;
+}
+
+}  // namespace
+
+int main() {
+  static const wl_registry_listener registry_listener = {
+      .global = OnRegistryGlobal,
+      .global_remove = OnRegistryGlobalRemove,
+  };
+  static const xdg_wm_base_listener wm_base_listener = {
+      .ping = OnPing,
+  };
+  static const xdg_surface_listener surface_listener = {
+      .configure = OnSurfaceConfigure,
+  };
+  static const xdg_toplevel_listener toplevel_listener = {
+      .configure = OnToplevelConfigure,
+      .close = OnToplevelClose,
+  };
+
+  wl_display* display = wl_display_connect(nullptr);
+  if (display == nullptr) {
+    fprintf(stderr, "Can't connect to a Wayland compositor, is "
+                    "WAYLAND_DISPLAY set?\n");
+    return EXIT_FAILURE;
+  }
+
+  Client client;
+  wl_registry* registry = wl_display_get_registry(display);
+  wl_registry_add_listener(registry, &registry_listener, &client);
+  wl_display_roundtrip(display);
+  if (!client.compositor || !client.shm || !client.wm_base) {
+    fprintf(stderr, "The compositor lacks wl_compositor, wl_shm or "
+                    "xdg_wm_base\n");
+    return EXIT_FAILURE;
+  }
+  xdg_wm_base_add_listener(client.wm_base, &wm_base_listener, &client);
+
+  int result = EXIT_FAILURE;
+  {
+    plugin_common_wayland::PresentationFeedback feedback(display);
+    if (!feedback.IsAvailable()) {
+      fprintf(stderr, "The compositor doesn't support wp_presentation\n");
+      return EXIT_FAILURE;
+    }
+
+    wl_surface* surface = wl_compositor_create_surface(client.compositor);
+    xdg_surface* shell_surface =
+        xdg_wm_base_get_xdg_surface(client.wm_base, surface);
+    xdg_surface_add_listener(shell_surface, &surface_listener, &client);
+    xdg_toplevel* toplevel = xdg_surface_get_toplevel(shell_surface);
+    xdg_toplevel_add_listener(toplevel, &toplevel_listener, &client);
+    xdg_toplevel_set_title(toplevel, "presentation_feedback_test");
+
+    // The first commit carries no buffer; it asks for the configure.
+    wl_surface_commit(surface);
+    wl_display_roundtrip(display);
+    wl_buffer* buffer = client.configured ? CreateBuffer(client.shm) : nullptr;
+
+    if (buffer == nullptr) {
+      fprintf(stderr, client.configured ? "Can't create a shm buffer\n"
+                                        : "The surface wasn't configured\n");
+    } else {
+      xdg_surface_ack_configure(shell_surface, client.configure_serial);
+      wl_surface_attach(surface, buffer, 0, 0);
+      wl_surface_damage(surface, 0, 0, kWidth, kHeight);
+      feedback.Request(surface);
+      wl_surface_commit(surface);
+
+      const auto stats = WaitForFeedback(display, feedback);
+      printf("presented %llu, discarded %llu, latency %.2f ms\n",
+             static_cast<unsigned long long>(stats.presented),
+             static_cast<unsigned long long>(stats.discarded),
+             stats.latency_max_ms);
+      if (stats.presented + stats.discarded > 0) {
+        result = EXIT_SUCCESS;
+      } else {
+        fprintf(stderr, "No feedback within %lld s\n",
+                static_cast<long long>(kTimeout.count()));
+      }
+      wl_buffer_destroy(buffer);
+    }
+
+    xdg_toplevel_destroy(toplevel);
+    xdg_surface_destroy(shell_surface);
+    wl_surface_destroy(surface);
+  }
+
+  xdg_wm_base_destroy(client.wm_base);
+  wl_shm_destroy(client.shm);
+  wl_compositor_destroy(client.compositor);
+  wl_registry_destroy(registry);
+  wl_display_disconnect(display);
+  return result;
+}
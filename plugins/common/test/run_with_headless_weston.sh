@@ -0,0 +1,55 @@
+#!/bin/sh
+#
+# Copyright 2024 Toyota Connected North America
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Runs a Wayland client against a private headless Weston and exits with the
+# client's status.
+#
+# Usage: run_with_headless_weston.sh <weston> <client> [args...]
+
+set -u
+
+weston=$1
+shift
+
+runtime_dir=$(mktemp -d)
+socket=wayland-plugin-test
+export XDG_RUNTIME_DIR="$runtime_dir"
+
+"$weston" --backend=headless-backend.so --socket="$socket" --idle-time=0 \
+    >"$runtime_dir/weston.log" 2>&1 &
+weston_pid=$!
+
+tries=0
+while [ ! -S "$runtime_dir/$socket" ]; do
+    tries=$((tries + 1))
+    if [ "$tries" -gt 50 ] || ! kill -0 "$weston_pid" 2>/dev/null; then
+        echo "Headless Weston didn't start:" >&2
+        cat "$runtime_dir/weston.log" >&2
+        kill "$weston_pid" 2>/dev/null
+        rm -rf "$runtime_dir"
+        exit 1
+    fi
+    sleep 0.1
+done
+
+WAYLAND_DISPLAY="$socket" "$@"
+status=$?
+
+kill "$weston_pid"
+wait "$weston_pid" 2>/dev/null
+rm -rf "$runtime_dir"
+exit "$status"
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "presentation_feedback.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "presentation-time-client-protocol.h"
+
+namespace plugin_common_wayland {
+
+namespace {
+
+double ElapsedMs(const timespec& from, const timespec& to) {
+  return static_cast<double>(to.tv_sec - from.tv_sec) * 1000.0 +
+         static_cast<double>(to.tv_nsec - from.tv_nsec) / 1000000.0;
+}
+
+}  // namespace
+
+PresentationFeedback::PresentationFeedback(wl_display* display)
+    : display_(display) {
+  static const wl_registry_listener registry_listener = {
+      .global = OnRegistryGlobal,
+      .global_remove = OnRegistryGlobalRemove,
+  };
+  static const wp_presentation_listener presentation_listener = {
+      .clock_id = OnClockId,
+  };
+
+  queue_ = wl_display_create_queue(display_);
+
+  // Bound through a wrapper so the registry, and everything created from
+  // it, sends its events to queue_.
+  auto* wrapper = static_cast<wl_display*>(wl_proxy_create_wrapper(display_));
+  wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(wrapper), queue_);
+  wl_registry* registry = wl_display_get_registry(wrapper);
+  wl_proxy_wrapper_destroy(wrapper);
+
+  wl_registry_add_listener(registry, &registry_listener, this);
+  wl_display_roundtrip_queue(display_, queue_);
+  wl_registry_destroy(registry);
+
+  if (presentation_ == nullptr) {
+    return;
+  }
+  wp_presentation_add_listener(presentation_, &presentation_listener, this);
+  // For the clock id.
+  wl_display_roundtrip_queue(display_, queue_);
+}
+
+PresentationFeedback::~PresentationFeedback() {
+  for (auto* pending : pending_) {
+    wp_presentation_feedback_destroy(pending->feedback);
+    delete pending;
+  }
+  if (presentation_) {
+    wp_presentation_destroy(presentation_);
+  }
+  if (queue_) {
+    wl_event_queue_destroy(queue_);
+  }
+}
+
+void PresentationFeedback::Request(wl_surface* surface) {
+  static const wp_presentation_feedback_listener feedback_listener = {
+      .sync_output = OnSyncOutput,
+      .presented = OnPresented,
+      .discarded = OnDiscarded,
+  };
+
+  if (presentation_ == nullptr || surface == nullptr) {
+    return;
+  }
+
+  auto* pending = new Pending{this, nullptr, {}};
+  clock_gettime(clock_id_, &pending->requested);
+  pending->feedback = wp_presentation_feedback(presentation_, surface);
+  wp_presentation_feedback_add_listener(pending->feedback, &feedback_listener,
+                                        pending);
+  pending_.push_back(pending);
+}
+
+void PresentationFeedback::Dispatch() {
+  if (queue_) {
+    wl_display_dispatch_queue_pending(display_, queue_);
+  }
+}
+
+PresentationFeedback::Stats PresentationFeedback::TakeStats() {
+  Stats stats = stats_;
+  if (stats.presented > 0) {
+    stats.latency_avg_ms =
+        latency_total_ms_ / static_cast<double>(stats.presented);
+  }
+
+  stats_ = {};
+  // The refresh rate stays valid until the next presented frame says
+  // otherwise.
+  stats_.refresh_ns = stats.refresh_ns;
+  latency_total_ms_ = 0.0;
+  return stats;
+}
+
+flutter::EncodableMap PresentationFeedback::Encode(const Stats& stats) {
+  return flutter::EncodableMap{
+      {flutter::EncodableValue("presented"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.presented))},
+      {flutter::EncodableValue("discarded"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.discarded))},
+      {flutter::EncodableValue("refreshNs"),
+       flutter::EncodableValue(static_cast<int64_t>(stats.refresh_ns))},
+      {flutter::EncodableValue("latencyAvgMs"),
+       flutter::EncodableValue(stats.latency_avg_ms)},
+      {flutter::EncodableValue("latencyMaxMs"),
+       flutter::EncodableValue(stats.latency_max_ms)},
+  };
+}
+
+void PresentationFeedback::Finish(Pending* pending) {
+  wp_presentation_feedback_destroy(pending->feedback);
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), pending),
+                 pending_.end());
+  delete pending;
+}
+
+void PresentationFeedback::OnRegistryGlobal(void* data,
+                                            wl_registry* registry,
+                                            const uint32_t name,
+                                            const char* interface,
+                                            uint32_t /* version */) {
+  const auto obj = static_cast<PresentationFeedback*>(data);
+  if (strcmp(interface, wp_presentation_interface.name) == 0) {
+    obj->presentation_ = static_cast<wp_presentation*>(
+        wl_registry_bind(registry, name, &wp_presentation_interface, 1));
+  }
+}
+
+void PresentationFeedback::OnRegistryGlobalRemove(void* /* data */,
+                                                  wl_registry* /* registry */,
+                                                  uint32_t /* name */) {}
+
+void PresentationFeedback::OnClockId(void* data,
+                                     wp_presentation* /* presentation */,
+                                     const uint32_t clk_id) {
+  static_cast<PresentationFeedback*>(data)->clock_id_ =
+      static_cast<clockid_t>(clk_id);
+}
+
+void PresentationFeedback::OnSyncOutput(
+    void* /* data */,
+    struct wp_presentation_feedback* /* feedback */,
+    wl_output* /* output */) {}
+
+void PresentationFeedback::OnPresented(
+    void* data,
+    struct wp_presentation_feedback* /* feedback */,
+    const uint32_t tv_sec_hi,
+    const uint32_t tv_sec_lo,
+    const uint32_t tv_nsec,
+    const uint32_t refresh,
+    uint32_t /* seq_hi */,
+    uint32_t /* seq_lo */,
+    uint32_t /* flags */) {
+  const auto pending = static_cast<Pending*>(data);
+  const auto obj = pending->owner;
+
+  timespec presented{};
+  presented.tv_sec = static_cast<time_t>(
+      (static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo);
+  presented.tv_nsec = static_cast<long>(tv_nsec);
+  const double latency_ms = ElapsedMs(pending->requested, presented);
+
+  ++obj->stats_.presented;
+  obj->stats_.refresh_ns = refresh;
+  obj->latency_total_ms_ += latency_ms;
+  obj->stats_.latency_max_ms =
+      std::max(obj->stats_.latency_max_ms, latency_ms);
+
+  obj->Finish(pending);
+}
+
+void PresentationFeedback::OnDiscarded(
+    void* data,
+    struct wp_presentation_feedback* /* feedback */) {
+  const auto pending = static_cast<Pending*>(data);
+  ++pending->owner->stats_.discarded;
+  pending->owner->Finish(pending);
+}
+
+}  // namespace plugin_common_wayland
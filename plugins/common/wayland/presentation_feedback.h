@@ -0,0 +1,120 @@
+/*
+ * Copyright 2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PLUGINS_COMMON_WAYLAND_PRESENTATION_FEEDBACK_H_
+#define PLUGINS_COMMON_WAYLAND_PRESENTATION_FEEDBACK_H_
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#include <flutter/encodable_value.h>
+#include <wayland-client.h>
+
+struct wp_presentation;
+struct wp_presentation_feedback;
+
+namespace plugin_common_wayland {
+
+// Tracks when the commits of a surface reach the display, using the
+// wp_presentation protocol.
+//
+// The protocol objects live on a private event queue, so the host's event
+// loop reads their events without dispatching them; Dispatch() does that.
+// Everything except construction must happen on one thread, normally the
+// one running the surface's frame callbacks. Without wp_presentation on the
+// compositor every call is a no-op.
+class PresentationFeedback {
+ public:
+  struct Stats {
+    uint64_t presented = 0;
+    uint64_t discarded = 0;
+    // Output refresh of the last presented frame, 0 if unknown.
+    uint32_t refresh_ns = 0;
+    // Request to presentation.
+    double latency_avg_ms = 0.0;
+    double latency_max_ms = 0.0;
+  };
+
+  explicit PresentationFeedback(wl_display* display);
+  ~PresentationFeedback();
+
+  // Prevent copying.
+  PresentationFeedback(PresentationFeedback const&) = delete;
+  PresentationFeedback& operator=(PresentationFeedback const&) = delete;
+
+  [[nodiscard]] bool IsAvailable() const { return presentation_ != nullptr; }
+
+  // Asks for feedback on the surface's next commit. Latency is counted from
+  // this call, so make it before rendering the frame.
+  void Request(wl_surface* surface);
+
+  // Delivers the feedback events read so far; never blocks.
+  void Dispatch();
+
+  // Counts since the previous call.
+  Stats TakeStats();
+
+  static flutter::EncodableMap Encode(const Stats& stats);
+
+ private:
+  struct Pending {
+    PresentationFeedback* owner;
+    struct wp_presentation_feedback* feedback;
+    timespec requested;
+  };
+
+  wl_display* display_;
+  wl_event_queue* queue_{};
+  wp_presentation* presentation_{};
+  clockid_t clock_id_ = CLOCK_MONOTONIC;
+
+  std::vector<Pending*> pending_;
+  Stats stats_;
+  double latency_total_ms_ = 0.0;
+
+  void Finish(Pending* pending);
+
+  static void OnRegistryGlobal(void* data,
+                               wl_registry* registry,
+                               uint32_t name,
+                               const char* interface,
+                               uint32_t version);
+  static void OnRegistryGlobalRemove(void* data,
+                                     wl_registry* registry,
+                                     uint32_t name);
+  static void OnClockId(void* data,
+                        wp_presentation* presentation,
+                        uint32_t clk_id);
+  static void OnSyncOutput(void* data,
+                           struct wp_presentation_feedback* feedback,
+                           wl_output* output);
+  static void OnPresented(void* data,
+                          struct wp_presentation_feedback* feedback,
+                          uint32_t tv_sec_hi,
+                          uint32_t tv_sec_lo,
+                          uint32_t tv_nsec,
+                          uint32_t refresh,
+                          uint32_t seq_hi,
+                          uint32_t seq_lo,
+                          uint32_t flags);
+  static void OnDiscarded(void* data,
+                          struct wp_presentation_feedback* feedback);
+};
+
+}  // namespace plugin_common_wayland
+
+#endif  // PLUGINS_COMMON_WAYLAND_PRESENTATION_FEEDBACK_H_
@@ -17,6 +17,7 @@
 
 #include <core/include/literals.h>
 #include <core/utils/deserialize.h>
+#include <core/utils/entitytransforms.h>
 #include <plugins/common/common.h>
 
 namespace plugin_filament_view {
@@ -27,7 +28,8 @@ BaseTransform::BaseTransform(const flutter::EncodableMap& params)
       m_f3CenterPosition(0, 0, 0),
       m_f3ExtentsSize(0, 0, 0),
       m_f3Scale(1, 1, 1),
-      m_quatRotation(0, 0, 0, 1) {
+      m_quatRotation(0, 0, 0, 1),
+      m_mat4World() {
   Deserialize::DecodeParameterWithDefault(kSize, &m_f3ExtentsSize, params,
                                           filament::math::float3(0, 0, 0));
   Deserialize::DecodeParameterWithDefault(kCenterPosition, &m_f3CenterPosition,
@@ -37,6 +39,36 @@ BaseTransform::BaseTransform(const flutter::EncodableMap& params)
                                           filament::math::float3(1, 1, 1));
   Deserialize::DecodeParameterWithDefault(kRotation, &m_quatRotation, params,
                                           filament::math::quatf(0, 0, 0, 1));
+  Deserialize::DecodeParameterWithDefault(kParentGuid, &m_szParentGuid, params,
+                                          std::string());
+}
+
+////////////////////////////////////////////////////////////////////////////
+BaseTransform::BaseTransform(const BinaryScene::View& params)
+    : Component(std::string(__FUNCTION__)),
+      m_f3CenterPosition(0, 0, 0),
+      m_f3ExtentsSize(0, 0, 0),
+      m_f3Scale(1, 1, 1),
+      m_quatRotation(0, 0, 0, 1),
+      m_mat4World() {
+  Deserialize::DecodeParameterWithDefault(kSize, &m_f3ExtentsSize, params,
+                                          filament::math::float3(0, 0, 0));
+  Deserialize::DecodeParameterWithDefault(kCenterPosition, &m_f3CenterPosition,
+                                          params,
+                                          filament::math::float3(0, 0, 0));
+  Deserialize::DecodeParameterWithDefault(kScale, &m_f3Scale, params,
+                                          filament::math::float3(1, 1, 1));
+  Deserialize::DecodeParameterWithDefault(kRotation, &m_quatRotation, params,
+                                          filament::math::quatf(0, 0, 0, 1));
+  Deserialize::DecodeParameterWithDefault(kParentGuid, &m_szParentGuid, params,
+                                          std::string());
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::math::mat4f BaseTransform::oGetLocalTransform() const {
+  return filament::math::mat4f::translation(m_f3CenterPosition) *
+         EntityTransforms::QuaternionToMat4f(m_quatRotation) *
+         filament::math::mat4f::scaling(m_f3Scale);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -50,6 +82,9 @@ void BaseTransform::DebugPrint(const std::string& tabPrefix) const {
                 m_quatRotation.y, m_quatRotation.z, m_quatRotation.w);
   spdlog::debug(tabPrefix + "Extents Size: x={}, y={}, z={}", m_f3ExtentsSize.x,
                 m_f3ExtentsSize.y, m_f3ExtentsSize.z);
+  if (!m_szParentGuid.empty()) {
+    spdlog::debug(tabPrefix + "Parent: {}", m_szParentGuid);
+  }
 }
 
 }  // namespace plugin_filament_view
\ No newline at end of file
@@ -18,7 +18,12 @@
 #include "shell/platform/common/client_wrapper/include/flutter/encodable_value.h"
 
 #include <core/components/base/component.h>
+#include <core/scene/serialization/binary_scene.h>
+#include <filament/math/mat4.h>
 #include <filament/math/quat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -30,8 +35,10 @@ class BaseTransform : public Component {
         m_f3CenterPosition(0, 0, 0),
         m_f3ExtentsSize(0, 0, 0),
         m_f3Scale(1, 1, 1),
-        m_quatRotation(0, 0, 0, 1) {}
+        m_quatRotation(0, 0, 0, 1),
+        m_mat4World() {}
   explicit BaseTransform(const flutter::EncodableMap& params);
+  explicit BaseTransform(const BinaryScene::View& params);
 
   // Getters
   [[nodiscard]] const filament::math::float3& GetCenterPosition() const {
@@ -65,6 +72,50 @@ class BaseTransform : public Component {
     m_quatRotation = rotation;
   }
 
+  // Hierarchy. The center position, rotation and scale above are relative
+  // to the parent; TransformSystem keeps the links and world transforms.
+  [[nodiscard]] const std::string& GetParentGuid() const {
+    return m_szParentGuid;
+  }
+
+  [[nodiscard]] const std::vector<std::string>& GetChildGuids() const {
+    return m_lstChildGuids;
+  }
+
+  void SetParentGuid(const std::string& parentGuid) {
+    m_szParentGuid = parentGuid;
+  }
+
+  void vAddChild(const std::string& childGuid) {
+    if (std::find(m_lstChildGuids.begin(), m_lstChildGuids.end(),
+                  childGuid) == m_lstChildGuids.end()) {
+      m_lstChildGuids.push_back(childGuid);
+    }
+  }
+
+  void vRemoveChild(const std::string& childGuid) {
+    m_lstChildGuids.erase(std::remove(m_lstChildGuids.begin(),
+                                      m_lstChildGuids.end(), childGuid),
+                          m_lstChildGuids.end());
+  }
+
+  // Set when the local transform changed and the world transform of this
+  // subtree hasn't been refreshed yet.
+  [[nodiscard]] bool bIsDirty() const { return m_bDirty; }
+  void vSetDirty(bool dirty) { m_bDirty = dirty; }
+
+  // Cached as of the last TransformSystem update.
+  [[nodiscard]] const filament::math::mat4f& GetWorldTransform() const {
+    return m_mat4World;
+  }
+
+  void SetWorldTransform(const filament::math::mat4f& world) {
+    m_mat4World = world;
+  }
+
+  // translate * rotate * scale, relative to the parent.
+  [[nodiscard]] filament::math::mat4f oGetLocalTransform() const;
+
   void DebugPrint(const std::string& tabPrefix) const override;
 
   static size_t StaticGetTypeID() { return typeid(BaseTransform).hash_code(); }
@@ -80,6 +131,11 @@ class BaseTransform : public Component {
   filament::math::float3 m_f3ExtentsSize;
   filament::math::float3 m_f3Scale;
   filament::math::quatf m_quatRotation;
+
+  std::string m_szParentGuid;
+  std::vector<std::string> m_lstChildGuids;
+  bool m_bDirty = false;
+  filament::math::mat4f m_mat4World;
 };
 
 }  // namespace plugin_filament_view
\ No newline at end of file
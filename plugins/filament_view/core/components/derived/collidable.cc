@@ -91,6 +91,50 @@ Collidable::Collidable(const flutter::EncodableMap& params)
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+Collidable::Collidable(const BinaryScene::View& params)
+    : Component(std::string(__FUNCTION__)),
+      m_f3CenterPosition({0}),
+      m_eShapeType(ShapeType::Cube),
+      m_f3ExtentsSize({1}) {
+  if (const auto collidableSpecificParams = params.oFind(kCollidable);
+      collidableSpecificParams.eGetType() == BinaryScene::Type::Map) {
+    Deserialize::DecodeParameterWithDefaultInt64(
+        kCollidableLayer, &m_nCollisionLayer, collidableSpecificParams, 0);
+    Deserialize::DecodeParameterWithDefaultInt64(
+        kCollidableMask, &m_nCollisionMask, collidableSpecificParams,
+        0xFFFFFFFFu);
+    Deserialize::DecodeParameterWithDefault(
+        kCollidableShouldMatchAttachedObject, &m_bShouldMatchAttachedObject,
+        collidableSpecificParams, false);
+
+    Deserialize::DecodeParameterWithDefault(
+        kCollidableExtents, &m_f3ExtentsSize, params,
+        filament::math::float3(1.0f, 1.0f, 1.0f));
+    Deserialize::DecodeParameterWithDefault(kCollidableIsStatic, &m_bIsStatic,
+                                            params, true);
+
+    if (!m_bShouldMatchAttachedObject) {
+      Deserialize::DecodeEnumParameterWithDefault(
+          kCollidableShapeType, &m_eShapeType, params, ShapeType::Cube);
+    }
+  } else {
+    spdlog::error("Collidable parameter not found or is of incorrect type.");
+  }
+
+  if (m_bIsStatic) {
+    Deserialize::DecodeParameterWithDefault(kCenterPosition,
+                                            &m_f3CenterPosition, params,
+                                            filament::math::float3(0, 0, 0));
+  }
+
+  if (!m_bShouldMatchAttachedObject) {
+    Deserialize::DecodeParameterWithDefault(kCenterPosition, &m_f3ExtentsSize,
+                                            params,
+                                            filament::math::float3(1, 1, 1));
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void Collidable::DebugPrint(const std::string& tabPrefix) const {
   spdlog::debug(tabPrefix + "Collidable Debug Info:");
@@ -20,6 +20,7 @@
 #include <core/components/base/component.h>
 #include <core/include/shapetypes.h>
 #include <core/scene/geometry/ray.h>
+#include <core/scene/serialization/binary_scene.h>
 
 namespace plugin_filament_view {
 
@@ -42,6 +43,7 @@ class Collidable : public Component {
         m_f3ExtentsSize({0.0f, 0.0f, 0.0f}) {}
 
   explicit Collidable(const flutter::EncodableMap& params);
+  explicit Collidable(const BinaryScene::View& params);
 
   // Getters
   [[nodiscard]] bool GetIsStatic() const { return m_bIsStatic; }
@@ -35,6 +35,20 @@ CommonRenderable::CommonRenderable(const flutter::EncodableMap& params)
                                           false);
 }
 
+////////////////////////////////////////////////////////////////////////////
+CommonRenderable::CommonRenderable(const BinaryScene::View& params)
+    : Component(std::string(__FUNCTION__)),
+      m_bCullingOfObjectEnabled(true),
+      m_bReceiveShadows(false),
+      m_bCastShadows(false) {
+  Deserialize::DecodeParameterWithDefault(
+      kCullingEnabled, &m_bCullingOfObjectEnabled, params, true);
+  Deserialize::DecodeParameterWithDefault(kReceiveShadows, &m_bReceiveShadows,
+                                          params, false);
+  Deserialize::DecodeParameterWithDefault(kCastShadows, &m_bCastShadows, params,
+                                          false);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void CommonRenderable::DebugPrint(const std::string& tabPrefix) const {
   spdlog::debug(tabPrefix + "Culling Enabled: {}", m_bCullingOfObjectEnabled);
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <core/components/base/component.h>
+#include <core/scene/serialization/binary_scene.h>
 #include "shell/platform/common/client_wrapper/include/flutter/encodable_value.h"
 
 namespace plugin_filament_view {
@@ -29,6 +30,7 @@ class CommonRenderable : public Component {
         m_bCastShadows(false),
         m_bReceiveShadows(false) {}
   explicit CommonRenderable(const flutter::EncodableMap& params);
+  explicit CommonRenderable(const BinaryScene::View& params);
 
   // Getters
   [[nodiscard]] bool IsCullingOfObjectEnabled() const {
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lod.h"
+
+#include <core/include/literals.h>
+#include <core/utils/deserialize.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////
+Lod::Lod(const flutter::EncodableMap& params)
+    : Component(std::string(__FUNCTION__)), m_fHysteresis(kDefaultHysteresis) {
+  const auto itLodSpecific = params.find(flutter::EncodableValue(kLod));
+  if (itLodSpecific == params.end() ||
+      !std::holds_alternative<flutter::EncodableMap>(itLodSpecific->second)) {
+    spdlog::error("Lod parameter not found or is of incorrect type.");
+    return;
+  }
+
+  const auto& lodSpecificParams =
+      std::get<flutter::EncodableMap>(itLodSpecific->second);
+
+  double dHysteresis;
+  Deserialize::DecodeParameterWithDefault(
+      kLodHysteresis, &dHysteresis, lodSpecificParams,
+      static_cast<double>(kDefaultHysteresis));
+  m_fHysteresis = std::clamp(static_cast<float>(dHysteresis), 0.0f, 0.9f);
+
+  if (const auto itLevels =
+          lodSpecificParams.find(flutter::EncodableValue(kLodLevels));
+      itLevels != lodSpecificParams.end() &&
+      std::holds_alternative<flutter::EncodableList>(itLevels->second)) {
+    for (const auto& level :
+         std::get<flutter::EncodableList>(itLevels->second)) {
+      if (!std::holds_alternative<flutter::EncodableMap>(level)) {
+        spdlog::warn("Skipping lod level that is not a map.");
+        continue;
+      }
+      const auto& levelParams = std::get<flutter::EncodableMap>(level);
+
+      LevelDefinition definition;
+      double dRatio;
+      double dScreenSize;
+      Deserialize::DecodeParameterWithDefault(
+          kLodAssetPath, &definition.szAssetPath, levelParams, std::string());
+      Deserialize::DecodeParameterWithDefault(kLodTriangleRatio, &dRatio,
+                                              levelParams, 0.5);
+      Deserialize::DecodeParameterWithDefault(kLodScreenSize, &dScreenSize,
+                                              levelParams, 0.0);
+      definition.fTriangleRatio =
+          std::clamp(static_cast<float>(dRatio), 0.01f, 1.0f);
+      definition.fScreenSize = static_cast<float>(dScreenSize);
+
+      if (definition.fScreenSize <= 0.0f) {
+        spdlog::warn("Skipping lod level without a positive screen size.");
+        continue;
+      }
+      m_lstLevels.emplace_back(std::move(definition));
+    }
+  }
+
+  // No explicit levels, generate a reasonable chain.
+  if (m_lstLevels.empty()) {
+    m_lstLevels.push_back({"", 0.5f, 0.25f});
+    m_lstLevels.push_back({"", 0.15f, 0.08f});
+  }
+
+  std::sort(m_lstLevels.begin(), m_lstLevels.end(),
+            [](const LevelDefinition& a, const LevelDefinition& b) {
+              return a.fScreenSize > b.fScreenSize;
+            });
+}
+
+////////////////////////////////////////////////////////////////////////////
+Lod::Lod(const BinaryScene::View& params)
+    : Lod(flutter::EncodableMap{
+          {flutter::EncodableValue(kLod), params.oFind(kLod).oToEncodable()}}) {
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Lod::DebugPrint(const std::string& tabPrefix) const {
+  spdlog::debug(tabPrefix + "Hysteresis: {}", m_fHysteresis);
+  for (const auto& level : m_lstLevels) {
+    spdlog::debug(tabPrefix + "Level: asset[{}] ratio[{}] screenSize[{}]",
+                  level.szAssetPath, level.fTriangleRatio, level.fScreenSize);
+  }
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/components/base/component.h>
+#include <core/scene/serialization/binary_scene.h>
+#include "shell/platform/common/client_wrapper/include/flutter/encodable_value.h"
+
+#include <string>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Describes the reduced detail representations of an entity. Level 0 (full
+// detail) is implicit; each listed level is used once the entity's projected
+// size on screen drops below its screen size threshold.
+class Lod : public Component {
+ public:
+  struct LevelDefinition {
+    // Authored variant relative to the asset path; when empty, the level is
+    // generated at load time by simplifying the full detail mesh.
+    std::string szAssetPath;
+    // Fraction of the full detail triangle count to target when generating.
+    float fTriangleRatio;
+    // Projected bounding sphere diameter / viewport height.
+    float fScreenSize;
+  };
+
+  // Constructor
+  Lod()
+      : Component(std::string(__FUNCTION__)),
+        m_fHysteresis(kDefaultHysteresis) {}
+  explicit Lod(const flutter::EncodableMap& params);
+  // Copies out only the lod subtree.
+  explicit Lod(const BinaryScene::View& params);
+
+  // Getters
+  [[nodiscard]] const std::vector<LevelDefinition>& GetLevels() const {
+    return m_lstLevels;
+  }
+
+  [[nodiscard]] float GetHysteresis() const { return m_fHysteresis; }
+
+  void DebugPrint(const std::string& tabPrefix) const override;
+
+  static size_t StaticGetTypeID() { return typeid(Lod).hash_code(); }
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] Component* Clone() const override {
+    return new Lod(*this);  // Copy constructor is called here
+  }
+
+ private:
+  static constexpr float kDefaultHysteresis = 0.15f;
+
+  // Sorted by descending screen size, finest level first.
+  std::vector<LevelDefinition> m_lstLevels;
+  // Fraction a threshold must be crossed by before switching, so objects
+  // sitting at a boundary don't flip levels every frame.
+  float m_fHysteresis;
+};
+
+}  // namespace plugin_filament_view
@@ -66,6 +66,24 @@ void EntityObject::DeserializeNameAndGlobalGuid(
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////
+void EntityObject::DeserializeNameAndGlobalGuid(
+    const BinaryScene::View& params) {
+  if (const auto requestedName = params.oFind(kName).oszGetString();
+      requestedName && !requestedName->empty()) {
+    vOverrideName(std::string(*requestedName));
+    SPDLOG_INFO("OVERRIDING NAME: {}", *requestedName);
+  }
+
+  // Note! There's no clash checking here.
+  if (const auto requestedGlobalGUID =
+          params.oFind(kGlobalGuid).oszGetString();
+      requestedGlobalGUID && !requestedGlobalGUID->empty()) {
+    vOverrideGlobalGuid(std::string(*requestedGlobalGUID));
+    SPDLOG_INFO("OVERRIDING GLOBAL GUID: {}", *requestedGlobalGUID);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 void EntityObject::vDebugPrintComponents() const {
   spdlog::debug("EntityObject Name \'{}\' UUID {} ComponentCount {}", name_,
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include <core/components/base/component.h>
+#include <core/scene/serialization/binary_scene.h>
 
 namespace plugin_filament_view {
 
@@ -27,6 +28,12 @@ using EntityGUID = std::string;
 
 class EntityObject {
   friend class CollisionSystem;
+  friend class LodSystem;
+  friend class ModelSystem;
+  friend class ScenePatchSystem;
+  friend class SceneSnapshotSystem;
+  friend class ShapeSystem;
+  friend class TransformSystem;
 
  public:
   // Overloading the == operator to compare based on global_guid_
@@ -100,6 +107,7 @@ class EntityObject {
                                     EntityObject& other) const;
 
   void DeserializeNameAndGlobalGuid(const flutter::EncodableMap& params);
+  void DeserializeNameAndGlobalGuid(const BinaryScene::View& params);
 
  private:
   EntityGUID global_guid_;
@@ -17,6 +17,7 @@
 #include "model.h"
 
 #include <core/components/derived/collidable.h>
+#include <core/components/derived/lod.h>
 #include <core/include/literals.h>
 #include <core/utils/deserialize.h>
 #include <plugins/common/common.h>
@@ -54,6 +55,42 @@ Model::Model(std::string assetPath,
     auto collidableComp = std::make_shared<Collidable>(params);
     vAddComponent(std::move(collidableComp));
   }
+
+  if (const auto it = params.find(flutter::EncodableValue(kLod));
+      it != params.end() && !it->second.IsNull()) {
+    vAddComponent(std::make_shared<Lod>(params));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+Model::Model(std::string assetPath,
+             std::string url,
+             Model* fallback,
+             Animation* animation,
+             std::shared_ptr<BaseTransform> poTransform,
+             std::shared_ptr<CommonRenderable> poCommonRenderable,
+             const BinaryScene::View& params)
+    : EntityObject(assetPath),
+      assetPath_(std::move(assetPath)),
+      url_(std::move(url)),
+      fallback_(fallback),
+      animation_(animation),
+      m_poAsset(nullptr) {
+  m_poBaseTransform = std::weak_ptr<BaseTransform>(poTransform);
+  m_poCommonRenderable = std::weak_ptr<CommonRenderable>(poCommonRenderable);
+
+  DeserializeNameAndGlobalGuid(params);
+
+  vAddComponent(std::move(poTransform));
+  vAddComponent(std::move(poCommonRenderable));
+
+  if (!params.oFind(kCollidable).bIsNull()) {
+    vAddComponent(std::make_shared<Collidable>(params));
+  }
+
+  if (!params.oFind(kLod).bIsNull()) {
+    vAddComponent(std::make_shared<Lod>(params));
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -72,6 +109,22 @@ GlbModel::GlbModel(std::string assetPath,
             std::move(poCommonRenderable),
             params) {}
 
+////////////////////////////////////////////////////////////////////////////
+GlbModel::GlbModel(std::string assetPath,
+                   std::string url,
+                   Model* fallback,
+                   Animation* animation,
+                   std::shared_ptr<BaseTransform> poTransform,
+                   std::shared_ptr<CommonRenderable> poCommonRenderable,
+                   const BinaryScene::View& params)
+    : Model(std::move(assetPath),
+            std::move(url),
+            fallback,
+            animation,
+            std::move(poTransform),
+            std::move(poCommonRenderable),
+            params) {}
+
 ////////////////////////////////////////////////////////////////////////////
 GltfModel::GltfModel(std::string assetPath,
                      std::string url,
@@ -92,6 +145,26 @@ GltfModel::GltfModel(std::string assetPath,
       pathPrefix_(std::move(pathPrefix)),
       pathPostfix_(std::move(pathPostfix)) {}
 
+////////////////////////////////////////////////////////////////////////////
+GltfModel::GltfModel(std::string assetPath,
+                     std::string url,
+                     std::string pathPrefix,
+                     std::string pathPostfix,
+                     Model* fallback,
+                     Animation* animation,
+                     std::shared_ptr<BaseTransform> poTransform,
+                     std::shared_ptr<CommonRenderable> poCommonRenderable,
+                     const BinaryScene::View& params)
+    : Model(std::move(assetPath),
+            std::move(url),
+            fallback,
+            animation,
+            std::move(poTransform),
+            std::move(poCommonRenderable),
+            params),
+      pathPrefix_(std::move(pathPrefix)),
+      pathPostfix_(std::move(pathPostfix)) {}
+
 ////////////////////////////////////////////////////////////////////////////
 std::unique_ptr<Model> Model::Deserialize(const std::string& flutterAssetsPath,
                                           const flutter::EncodableMap& params) {
@@ -155,6 +228,52 @@ std::unique_ptr<Model> Model::Deserialize(const std::string& flutterAssetsPath,
       params);
 }
 
+////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<Model> Model::Deserialize(const std::string& flutterAssetsPath,
+                                          const BinaryScene::View& params) {
+  SPDLOG_TRACE("++Model::Model");
+  std::unique_ptr<Animation> animation;
+  std::string assetPath;
+  std::string pathPrefix;
+  std::string pathPostfix;
+  std::string url;
+  bool is_glb = false;
+
+  auto oTransform = std::make_shared<BaseTransform>(params);
+  auto oCommonRenderable = std::make_shared<CommonRenderable>(params);
+
+  if (const auto value = params.oFind("animation");
+      value.eGetType() == BinaryScene::Type::Map) {
+    animation = std::make_unique<Animation>(
+        flutterAssetsPath,
+        std::get<flutter::EncodableMap>(value.oToEncodable()));
+  }
+  Deserialize::DecodeParameterWithDefault("assetPath", &assetPath, params,
+                                          std::string());
+  Deserialize::DecodeParameterWithDefault("isGlb", &is_glb, params, false);
+  Deserialize::DecodeParameterWithDefault("url", &url, params, std::string());
+  Deserialize::DecodeParameterWithDefault("pathPrefix", &pathPrefix, params,
+                                          std::string());
+  Deserialize::DecodeParameterWithDefault("pathPostfix", &pathPostfix, params,
+                                          std::string());
+  if (params.oFind("scene").eGetType() == BinaryScene::Type::Map) {
+    spdlog::warn("Scenes are no longer valid off of a model node.");
+  }
+
+  if (is_glb) {
+    return std::make_unique<GlbModel>(
+        std::move(assetPath), std::move(url), nullptr,
+        animation ? animation.release() : nullptr, oTransform,
+        oCommonRenderable, params);
+  }
+
+  return std::make_unique<GltfModel>(
+      std::move(assetPath), std::move(url), std::move(pathPrefix),
+      std::move(pathPostfix), nullptr,
+      animation ? animation.release() : nullptr, oTransform, oCommonRenderable,
+      params);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void Model::DebugPrint() const {
   vDebugPrintComponents();
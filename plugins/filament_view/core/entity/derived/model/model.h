@@ -36,12 +36,23 @@ class Model : public EntityObject {
         std::shared_ptr<BaseTransform> poTransform,
         std::shared_ptr<CommonRenderable> poCommonRenderable,
         const flutter::EncodableMap& params);
+  Model(std::string assetPath,
+        std::string url,
+        Model* fallback,
+        Animation* animation,
+        std::shared_ptr<BaseTransform> poTransform,
+        std::shared_ptr<CommonRenderable> poCommonRenderable,
+        const BinaryScene::View& params);
 
   ~Model() override = default;
 
   static std::unique_ptr<Model> Deserialize(
       const std::string& flutterAssetsPath,
       const flutter::EncodableMap& params);
+  // Reads the entry in place; only an animation is copied out.
+  static std::unique_ptr<Model> Deserialize(
+      const std::string& flutterAssetsPath,
+      const BinaryScene::View& params);
 
   [[nodiscard]] Model* GetFallback() const { return fallback_; }
 
@@ -59,6 +70,11 @@ class Model : public EntityObject {
     return m_poAsset;
   }
 
+  // Set by ModelSystem once the asset has finished loading and its last
+  // renderables were added to the scene.
+  void vSetSceneLoaded() { m_bSceneLoaded = true; }
+  [[nodiscard]] bool bIsSceneLoaded() const { return m_bSceneLoaded; }
+
   [[nodiscard]] std::shared_ptr<BaseTransform> GetBaseTransform() const {
     return m_poBaseTransform.lock();
   }
@@ -76,6 +92,7 @@ class Model : public EntityObject {
   Animation* animation_;
 
   filament::gltfio::FilamentAsset* m_poAsset;
+  bool m_bSceneLoaded = false;
 
   void DebugPrint() const override;
 
@@ -94,6 +111,13 @@ class GlbModel final : public Model {
            std::shared_ptr<BaseTransform> poTransform,
            std::shared_ptr<CommonRenderable> poCommonRenderable,
            const flutter::EncodableMap& params);
+  GlbModel(std::string assetPath,
+           std::string url,
+           Model* fallback,
+           Animation* animation,
+           std::shared_ptr<BaseTransform> poTransform,
+           std::shared_ptr<CommonRenderable> poCommonRenderable,
+           const BinaryScene::View& params);
 
   ~GlbModel() override = default;
 
@@ -112,6 +136,15 @@ class GltfModel final : public Model {
             std::shared_ptr<BaseTransform> poTransform,
             std::shared_ptr<CommonRenderable> poCommonRenderable,
             const flutter::EncodableMap& params);
+  GltfModel(std::string assetPath,
+            std::string url,
+            std::string pathPrefix,
+            std::string pathPostfix,
+            Model* fallback,
+            Animation* animation,
+            std::shared_ptr<BaseTransform> poTransform,
+            std::shared_ptr<CommonRenderable> poCommonRenderable,
+            const BinaryScene::View& params);
 
   ~GltfModel() override = default;
 
@@ -17,11 +17,13 @@
 #include "baseshape.h"
 
 #include <core/components/derived/collidable.h>
+#include <core/components/derived/lod.h>
 #include <core/include/literals.h>
 #include <core/systems/derived/filament_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <core/utils/deserialize.h>
 #include <core/utils/entitytransforms.h>
+#include <core/utils/mesh_simplifier.h>
 #include <filament/RenderableManager.h>
 #include <filament/Scene.h>
 #include <math/norm.h>
@@ -95,6 +97,56 @@ BaseShape::BaseShape(const std::string& flutter_assets_path,
     vAddComponent(std::move(collidableComp));
   }
 
+  if (const auto it = params.find(flutter::EncodableValue(kLod));
+      it != params.end() && !it->second.IsNull()) {
+    vAddComponent(std::make_shared<Lod>(params));
+  }
+
+  SPDLOG_TRACE("--{} {}", __FILE__, __FUNCTION__);
+}
+
+////////////////////////////////////////////////////////////////////////////
+BaseShape::BaseShape(const std::string& flutter_assets_path,
+                     const BinaryScene::View& params)
+    : EntityObject("unset name tbd"),
+      m_poVertexBuffer(nullptr),
+      m_poIndexBuffer(nullptr),
+      type_(ShapeType::Unset),
+      m_f3Normal(0, 0, 0),
+      m_poMaterialInstance(
+          Resource<filament::MaterialInstance*>::Error("Unset")) {
+  SPDLOG_TRACE("++{} {}", __FILE__, __FUNCTION__);
+
+  Deserialize::DecodeParameterWithDefault(kId, &id, params, 0);
+
+  DeserializeNameAndGlobalGuid(params);
+
+  auto oTransform = std::make_shared<BaseTransform>(params);
+  auto oCommonRenderable = std::make_shared<CommonRenderable>(params);
+
+  m_poBaseTransform = std::weak_ptr<BaseTransform>(oTransform);
+  m_poCommonRenderable = std::weak_ptr<CommonRenderable>(oCommonRenderable);
+
+  vAddComponent(std::move(oTransform));
+  vAddComponent(std::move(oCommonRenderable));
+
+  Deserialize::DecodeEnumParameterWithDefault(kShapeType, &type_, params,
+                                              ShapeType::Unset);
+  Deserialize::DecodeParameterWithDefault(kNormal, &m_f3Normal, params,
+                                          float3(0, 0, 0));
+  Deserialize::DecodeParameterWithDefault(kMaterial, m_poMaterialDefinitions,
+                                          params, flutter_assets_path);
+  Deserialize::DecodeParameterWithDefault(kDoubleSided, &m_bDoubleSided, params,
+                                          false);
+
+  if (!params.oFind(kCollidable).bIsNull()) {
+    vAddComponent(std::make_shared<Collidable>(params));
+  }
+
+  if (!params.oFind(kLod).bIsNull()) {
+    vAddComponent(std::make_shared<Lod>(params));
+  }
+
   SPDLOG_TRACE("--{} {}", __FILE__, __FUNCTION__);
 }
 
@@ -113,19 +165,33 @@ void BaseShape::vDestroyBuffers() {
 
   if (m_poMaterialInstance.getStatus() == Status::Success &&
       m_poMaterialInstance.getData() != nullptr) {
-    filamentEngine->destroy(m_poMaterialInstance.getData().value());
+    // Drops our references on the material and its textures.
+    if (const auto materialSystem =
+            ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+                MaterialSystem::StaticGetTypeID(), "vDestroyBuffers")) {
+      materialSystem->vReleaseMaterialInstance(
+          m_poMaterialInstance.getData().value());
+    } else {
+      filamentEngine->destroy(m_poMaterialInstance.getData().value());
+    }
     m_poMaterialInstance =
         Resource<filament::MaterialInstance*>::Error("Unset");
   }
 
-  if (m_poVertexBuffer) {
-    filamentEngine->destroy(m_poVertexBuffer);
-    m_poVertexBuffer = nullptr;
+  // The vertex and index buffers are shared with other shapes.
+  if (m_bHoldsGeometry) {
+    ShapeGeometryCache::vRelease(filamentEngine, m_oGeometryKey);
+    m_bHoldsGeometry = false;
   }
-  if (m_poIndexBuffer) {
-    filamentEngine->destroy(m_poIndexBuffer);
-    m_poIndexBuffer = nullptr;
+  m_poVertexBuffer = nullptr;
+  m_poIndexBuffer = nullptr;
+
+  // [0] is the shared index buffer released above.
+  for (size_t i = 1; i < m_lstLodIndexBuffers.size(); ++i) {
+    filamentEngine->destroy(m_lstLodIndexBuffers[i].first);
   }
+  m_lstLodIndexBuffers.clear();
+  m_lstLodLevels.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -158,6 +224,66 @@ void BaseShape::CloneToOther(BaseShape& other) const {
       std::weak_ptr<CommonRenderable>(commonRenderablePtr);
 }
 
+////////////////////////////////////////////////////////////////////////////
+ShapeGeometryKey BaseShape::oGetGeometryKey() const {
+  ShapeGeometryKey key;
+  key.eType = type_;
+  key.bDoubleSided = m_bDoubleSided;
+  return key;
+}
+
+////////////////////////////////////////////////////////////////////////////
+const ShapeGeometry* BaseShape::poAcquireGeometry(
+    filament::Engine* engine_) const {
+  return ShapeGeometryCache::poAcquire(
+      engine_, oGetGeometryKey(),
+      [this](filament::Engine* engine, ShapeGeometry& geometry) {
+        vBuildGeometry(engine, geometry);
+      });
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BaseShape::bCreateFromSharedGeometry(filament::Engine* engine_) {
+  const auto* geometry = poAcquireGeometry(engine_);
+  if (geometry == nullptr) {
+    m_poVertexBuffer = nullptr;
+    m_poIndexBuffer = nullptr;
+    return false;
+  }
+
+  m_bHoldsGeometry = true;
+  m_oGeometryKey = oGetGeometryKey();
+  m_poVertexBuffer = geometry->poVertexBuffer;
+  m_poIndexBuffer = geometry->poIndexBuffer;
+
+  // Only generated geometry keeps its vertex data around to simplify.
+  if (!geometry->vecIndices.empty()) {
+    vBuildLodLevels(engine_, geometry->vecPositions.data(),
+                    geometry->vecPositions.size(), geometry->vecIndices);
+  }
+
+  vBuildRenderable(engine_);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BaseShape::bCanBeInstanced() const {
+  // Lod swaps index buffers per renderable, so lod shapes keep their own.
+  return !m_bIsWireframe && m_poMaterialDefinitions.has_value() &&
+         GetComponentByStaticTypeID(Lod::StaticGetTypeID()) == nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////
+mat4f BaseShape::oGetLocalTransform() const {
+  const auto transform = m_poBaseTransform.lock();
+  if (transform == nullptr) {
+    return {};
+  }
+  return mat4f::translation(transform->GetCenterPosition()) *
+         EntityTransforms::QuaternionToMat4f(transform->GetRotation()) *
+         mat4f::scaling(transform->GetScale());
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void BaseShape::vBuildRenderable(filament::Engine* engine_) {
   // material_manager can and will be null for now on wireframe creation.
@@ -215,8 +341,95 @@ void BaseShape::vBuildRenderable(filament::Engine* engine_) {
   // to filament for when the building is complete. Further R&D is needed.
 }
 
+////////////////////////////////////////////////////////////////////////////
+void BaseShape::vBuildLodLevels(filament::Engine* engine_,
+                                const float3* positions,
+                                const size_t vertexCount,
+                                const std::vector<unsigned short>& indices) {
+  const auto lod = std::dynamic_pointer_cast<Lod>(
+      GetComponentByStaticTypeID(Lod::StaticGetTypeID()));
+  if (lod == nullptr || m_bIsWireframe || m_poIndexBuffer == nullptr) {
+    return;
+  }
+
+  m_fLodHysteresis = lod->GetHysteresis();
+  m_lstLodLevels.push_back({0.0f, indices.size() / 3, nullptr});
+  m_lstLodIndexBuffers.emplace_back(m_poIndexBuffer, indices.size());
+
+  const std::vector<uint32_t> sourceIndices(indices.begin(), indices.end());
+  for (const auto& level : lod->GetLevels()) {
+    if (!level.szAssetPath.empty()) {
+      spdlog::warn("Shapes only support generated lod levels, ignoring {}",
+                   level.szAssetPath);
+      continue;
+    }
+
+    const auto simplified = MeshSimplifier::vecSimplifyIndices(
+        &positions[0].x, vertexCount, sizeof(float3), sourceIndices.data(),
+        sourceIndices.size(), level.fTriangleRatio);
+    // No point in a level that draws as much as the one before it.
+    if (simplified.size() >= m_lstLodIndexBuffers.back().second) {
+      continue;
+    }
+
+    const size_t indexCount = simplified.size();
+    auto* lodIndices =
+        new std::vector<unsigned short>(simplified.begin(), simplified.end());
+    auto* indexBuffer = IndexBuffer::Builder()
+                            .indexCount(static_cast<uint32_t>(indexCount))
+                            .bufferType(IndexBuffer::IndexType::USHORT)
+                            .build(*engine_);
+    indexBuffer->setBuffer(
+        *engine_,
+        IndexBuffer::BufferDescriptor(
+            lodIndices->data(), indexCount * sizeof(unsigned short),
+            [](void* /*buffer*/, size_t /*size*/, void* user) {
+              delete static_cast<std::vector<unsigned short>*>(user);
+            },
+            lodIndices));
+
+    m_lstLodIndexBuffers.emplace_back(indexBuffer, indexCount);
+    m_lstLodLevels.push_back({level.fScreenSize, indexCount / 3, nullptr});
+  }
+
+  if (m_lstLodLevels.size() < 2) {
+    m_lstLodLevels.clear();
+    m_lstLodIndexBuffers.clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t BaseShape::nGetLodIndexBufferBytes() const {
+  size_t nBytes = 0;
+  for (size_t i = 1; i < m_lstLodIndexBuffers.size(); ++i) {
+    nBytes += m_lstLodIndexBuffers[i].second * sizeof(unsigned short);
+  }
+  return nBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void BaseShape::vSetActiveLodLevel(const size_t nLevel) const {
+  if (nLevel >= m_lstLodIndexBuffers.size() || m_poEntity == nullptr) {
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "BaseShape::vSetActiveLodLevel");
+  auto& rcm = filamentSystem->getFilamentEngine()->getRenderableManager();
+
+  const auto& [indexBuffer, indexCount] = m_lstLodIndexBuffers[nLevel];
+  rcm.setGeometryAt(rcm.getInstance(*m_poEntity), 0,
+                    RenderableManager::PrimitiveType::TRIANGLES,
+                    m_poVertexBuffer, indexBuffer, 0, indexCount);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void BaseShape::vRemoveEntityFromScene() const {
+  // Instanced shapes are toggled through their batch.
+  if (m_bInstanced) {
+    return;
+  }
   if (m_poEntity == nullptr) {
     SPDLOG_WARN("Attempt to remove uninitialized shape from scene {}::{}",
                 __FILE__, __FUNCTION__);
@@ -233,6 +446,9 @@ void BaseShape::vRemoveEntityFromScene() const {
 
 ////////////////////////////////////////////////////////////////////////////
 void BaseShape::vAddEntityToScene() const {
+  if (m_bInstanced) {
+    return;
+  }
   if (m_poEntity == nullptr) {
     SPDLOG_WARN("Attempt to add uninitialized shape to scene {}::{}", __FILE__,
                 __FUNCTION__);
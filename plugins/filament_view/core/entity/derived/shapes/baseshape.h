@@ -21,8 +21,10 @@
 #include <core/components/derived/basetransform.h>
 #include <core/components/derived/commonrenderable.h>
 #include <core/entity/base/entityobject.h>
+#include <core/entity/derived/shapes/shape_geometry_cache.h>
 #include <core/include/shapetypes.h>
 #include <core/scene/geometry/direction.h>
+#include <core/systems/derived/lod_system.h>
 #include <core/systems/derived/material_system.h>
 #include <filament/IndexBuffer.h>
 #include <filament/VertexBuffer.h>
@@ -41,6 +43,8 @@ class BaseShape : public EntityObject {
  public:
   BaseShape(const std::string& flutter_assets_path,
             const flutter::EncodableMap& params);
+  BaseShape(const std::string& flutter_assets_path,
+            const BinaryScene::View& params);
 
   BaseShape();
 
@@ -62,16 +66,78 @@ class BaseShape : public EntityObject {
   void vRemoveEntityFromScene() const;
   void vAddEntityToScene() const;
 
+  // Reduced detail levels, level 0 being the full shape. Empty unless the
+  // shape has a Lod component and geometry that could be simplified.
+  [[nodiscard]] const std::vector<LodSystem::LodLevel>& GetLodLevels() const {
+    return m_lstLodLevels;
+  }
+  [[nodiscard]] float fGetLodHysteresis() const { return m_fLodHysteresis; }
+
+  // Swaps the index buffer the renderable draws with, sharing the vertices.
+  void vSetActiveLodLevel(size_t nLevel) const;
+
+  // Bytes of the index buffers this shape built for its reduced levels;
+  // level 0 belongs to the shared geometry.
+  [[nodiscard]] size_t nGetLodIndexBufferBytes() const;
+
+  [[nodiscard]] virtual ShapeGeometryKey oGetGeometryKey() const;
+
+  // Takes a reference on the shared geometry for this shape's key, for
+  // renderables not owned by the shape. Release with ShapeGeometryCache.
+  const ShapeGeometry* poAcquireGeometry(::filament::Engine* engine_) const;
+
+  // Whether the shape can be drawn as one instance of a batch of shapes
+  // sharing geometry and material, instead of with its own renderable.
+  [[nodiscard]] bool bCanBeInstanced() const;
+
+  // Marks the shape as drawn by a batch; it then never builds a renderable.
+  void vSetInstanced() { m_bInstanced = true; }
+  [[nodiscard]] bool bIsInstanced() const { return m_bInstanced; }
+
+  [[nodiscard]] const MaterialDefinitions* poGetMaterialDefinitions() const {
+    return m_poMaterialDefinitions.has_value()
+               ? m_poMaterialDefinitions.value().get()
+               : nullptr;
+  }
+
+  // translate * rotate * scale from the shape's transform component.
+  [[nodiscard]] filament::math::mat4f oGetLocalTransform() const;
+
+  [[nodiscard]] std::shared_ptr<BaseTransform> GetBaseTransform() const {
+    return m_poBaseTransform.lock();
+  }
+
+  // Null until built, and for instanced shapes.
+  [[nodiscard]] const std::shared_ptr<utils::Entity>& poGetEntity() const {
+    return m_poEntity;
+  }
+
  protected:
   ::filament::VertexBuffer* m_poVertexBuffer;
   ::filament::IndexBuffer* m_poIndexBuffer;
 
   void DebugPrint() const override;
 
+  // Fills geometry with freshly built vertex and index buffers; only called
+  // when the cache has no geometry for oGetGeometryKey() yet.
+  virtual void vBuildGeometry(::filament::Engine* engine_,
+                              ShapeGeometry& geometry) const = 0;
+
+  // Points the shape at the shared geometry, builds lod levels and the
+  // renderable.
+  bool bCreateFromSharedGeometry(::filament::Engine* engine_);
+
   // uses Vertex and Index buffer to create the material and geometry
   // using all the internal variables.
   void vBuildRenderable(::filament::Engine* engine_);
 
+  // Simplifies the given triangle list into one index buffer per generated
+  // level of the Lod component. Call after m_poIndexBuffer is created.
+  void vBuildLodLevels(::filament::Engine* engine_,
+                       const filament::math::float3* positions,
+                       size_t vertexCount,
+                       const std::vector<unsigned short>& indices);
+
   int id{};
   ShapeType type_{};
 
@@ -103,6 +169,17 @@ class BaseShape : public EntityObject {
   // CollisionManager when created debug wireframe models for seeing collidable
   // shapes.
   bool m_bIsWireframe = false;
+
+  // Holds a reference on the cached geometry for m_oGeometryKey.
+  bool m_bHoldsGeometry = false;
+  ShapeGeometryKey m_oGeometryKey;
+
+  bool m_bInstanced = false;
+
+  std::vector<LodSystem::LodLevel> m_lstLodLevels;
+  // Index buffer and index count per lod level, [0] is m_poIndexBuffer.
+  std::vector<std::pair<::filament::IndexBuffer*, size_t>> m_lstLodIndexBuffers;
+  float m_fLodHysteresis = 0.0f;
 };
 
 }  // namespace shapes
@@ -45,20 +45,32 @@ Cube::Cube(const std::string& flutter_assets_path,
   SPDLOG_TRACE("+-{} {}", __FILE__, __FUNCTION__);
 }
 
+////////////////////////////////////////////////////////////////////////////
+Cube::Cube(const std::string& flutter_assets_path,
+           const BinaryScene::View& params)
+    : BaseShape(flutter_assets_path, params) {
+  SPDLOG_TRACE("+-{} {}", __FILE__, __FUNCTION__);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 bool Cube::bInitAndCreateShape(filament::Engine* engine_,
                                std::shared_ptr<Entity> entityObject) {
   m_poEntity = std::move(entityObject);
+  return bCreateFromSharedGeometry(engine_);
+}
 
+////////////////////////////////////////////////////////////////////////////
+void Cube::vBuildGeometry(filament::Engine* engine_,
+                          ShapeGeometry& geometry) const {
   if (m_bDoubleSided)
-    createDoubleSidedCube(engine_);
+    createDoubleSidedCube(engine_, geometry);
   else
-    createSingleSidedCube(engine_);
-  return true;
+    createSingleSidedCube(engine_, geometry);
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void Cube::createDoubleSidedCube(filament::Engine* engine_) {
+void Cube::createDoubleSidedCube(filament::Engine* engine_,
+                                 ShapeGeometry& geometry) {
   // Vertices for a cube (24 vertices for outside, 24 for inside)
   static constexpr float vertices[] = {
       // Outside Front face
@@ -411,30 +423,34 @@ void Cube::createDoubleSidedCube(filament::Engine* engine_) {
           .normalized(VertexAttribute::TANGENTS)
           .build(*engine_);
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 0, VertexBuffer::BufferDescriptor(vertices, sizeof(vertices)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 1, VertexBuffer::BufferDescriptor(normals, sizeof(normals)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 2, VertexBuffer::BufferDescriptor(uvCoords, sizeof(uvCoords)));
 
   constexpr int indexCount =
       72 * 2;  // 24 triangles * 3 vertices (inside + outside)
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine_);
+  geometry.poIndexBuffer = IndexBuffer::Builder()
+                               .indexCount(indexCount)
+                               .bufferType(IndexBuffer::IndexType::USHORT)
+                               .build(*engine_);
 
-  m_poIndexBuffer->setBuffer(
+  geometry.poIndexBuffer->setBuffer(
       *engine_, IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
 
-  vBuildRenderable(engine_);
+  geometry.nIndexCount = indexCount;
+  geometry.oBounds = {float3(-0.5f), float3(0.5f)};
+  geometry.nBufferBytes = sizeof(vertices) + sizeof(normals) +
+                          sizeof(uvCoords) + sizeof(indices);
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void Cube::createSingleSidedCube(filament::Engine* engine_) {
+void Cube::createSingleSidedCube(filament::Engine* engine_,
+                                 ShapeGeometry& geometry) {
   // Vertices for a cube (24 vertices, 4 per face)
   static constexpr float vertices[] = {
       // Front face
@@ -641,37 +657,41 @@ void Cube::createSingleSidedCube(filament::Engine* engine_) {
                                                 float3{0.0f, -1.0f, 0.0f}})
                       .xyzw)};
 
-  m_poVertexBuffer = VertexBuffer::Builder()
-                         .vertexCount(24)  // 4 vertices per face * 6 faces
-                         .bufferCount(3)
-                         .attribute(VertexAttribute::POSITION, 0,
-                                    VertexBuffer::AttributeType::FLOAT3)
-                         .attribute(VertexAttribute::TANGENTS, 1,
-                                    VertexBuffer::AttributeType::SHORT4)
-                         .attribute(VertexAttribute::UV0, 2,
-                                    VertexBuffer::AttributeType::FLOAT2)  // UVs
-                         .normalized(VertexAttribute::TANGENTS)
-                         .build(*engine_);
-
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer =
+      VertexBuffer::Builder()
+          .vertexCount(24)  // 4 vertices per face * 6 faces
+          .bufferCount(3)
+          .attribute(VertexAttribute::POSITION, 0,
+                     VertexBuffer::AttributeType::FLOAT3)
+          .attribute(VertexAttribute::TANGENTS, 1,
+                     VertexBuffer::AttributeType::SHORT4)
+          .attribute(VertexAttribute::UV0, 2,
+                     VertexBuffer::AttributeType::FLOAT2)  // UVs
+          .normalized(VertexAttribute::TANGENTS)
+          .build(*engine_);
+
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 0, VertexBuffer::BufferDescriptor(vertices, sizeof(vertices)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 1, VertexBuffer::BufferDescriptor(normals, sizeof(normals)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 2, VertexBuffer::BufferDescriptor(uvCoords, sizeof(uvCoords)));
 
   constexpr int indexCount = 36;
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine_);
+  geometry.poIndexBuffer = IndexBuffer::Builder()
+                               .indexCount(indexCount)
+                               .bufferType(IndexBuffer::IndexType::USHORT)
+                               .build(*engine_);
 
-  m_poIndexBuffer->setBuffer(
+  geometry.poIndexBuffer->setBuffer(
       *engine_, IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
 
-  vBuildRenderable(engine_);
+  geometry.nIndexCount = indexCount;
+  geometry.oBounds = {float3(-0.5f), float3(0.5f)};
+  geometry.nBufferBytes = sizeof(vertices) + sizeof(normals) +
+                          sizeof(uvCoords) + sizeof(indices);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,8 @@ class Cube : public BaseShape {
  public:
   Cube(const std::string& flutter_assets_path,
        const flutter::EncodableMap& params);
+  Cube(const std::string& flutter_assets_path,
+       const BinaryScene::View& params);
   Cube() = default;
   ~Cube() override = default;
 
@@ -42,10 +44,16 @@ class Cube : public BaseShape {
   bool bInitAndCreateShape(::filament::Engine* engine_,
                            std::shared_ptr<Entity> entityObject) override;
 
+ protected:
+  void vBuildGeometry(::filament::Engine* engine_,
+                      ShapeGeometry& geometry) const override;
+
  private:
-  void createDoubleSidedCube(::filament::Engine* engine_);
+  static void createDoubleSidedCube(::filament::Engine* engine_,
+                                    ShapeGeometry& geometry);
 
-  void createSingleSidedCube(::filament::Engine* engine_);
+  static void createSingleSidedCube(::filament::Engine* engine_,
+                                    ShapeGeometry& geometry);
 };
 
 }  // namespace shapes
@@ -45,21 +45,32 @@ Plane::Plane(const std::string& flutter_assets_path,
   SPDLOG_TRACE("+-{} {}", __FILE__, __FUNCTION__);
 }
 
+////////////////////////////////////////////////////////////////////////////
+Plane::Plane(const std::string& flutter_assets_path,
+             const BinaryScene::View& params)
+    : BaseShape(flutter_assets_path, params) {
+  SPDLOG_TRACE("+-{} {}", __FILE__, __FUNCTION__);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 bool Plane::bInitAndCreateShape(filament::Engine* engine_,
                                 std::shared_ptr<Entity> entityObject) {
   m_poEntity = std::move(entityObject);
+  return bCreateFromSharedGeometry(engine_);
+}
 
+////////////////////////////////////////////////////////////////////////////
+void Plane::vBuildGeometry(filament::Engine* engine_,
+                           ShapeGeometry& geometry) const {
   if (m_bDoubleSided)
-    createDoubleSidedPlane(engine_);
+    createDoubleSidedPlane(engine_, geometry);
   else
-    createSingleSidedPlane(engine_);
-
-  return true;
+    createSingleSidedPlane(engine_, geometry);
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void Plane::createDoubleSidedPlane(filament::Engine* engine_) {
+void Plane::createDoubleSidedPlane(filament::Engine* engine_,
+                                   ShapeGeometry& geometry) {
   // Vertices for a plane (4 vertices for each side, 8 in total)
   static constexpr float vertices[] = {
       // Front face
@@ -133,41 +144,46 @@ void Plane::createDoubleSidedPlane(filament::Engine* engine_) {
                                                 float3{0.0f, 0.0f, -1.0f}})
                       .xyzw)};
 
-  m_poVertexBuffer = VertexBuffer::Builder()
-                         .vertexCount(8)  // 4 vertices for each side
-                         .bufferCount(3)  // Positions, Normals, UVs
-                         .attribute(VertexAttribute::POSITION, 0,
-                                    VertexBuffer::AttributeType::FLOAT3)
-                         .attribute(VertexAttribute::TANGENTS, 1,
-                                    VertexBuffer::AttributeType::SHORT4)
-                         .attribute(VertexAttribute::UV0, 2,
-                                    VertexBuffer::AttributeType::FLOAT2)
-                         .normalized(VertexAttribute::TANGENTS)
-                         .build(*engine_);
-
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer = VertexBuffer::Builder()
+                                .vertexCount(8)  // 4 vertices for each side
+                                .bufferCount(3)  // Positions, Normals, UVs
+                                .attribute(VertexAttribute::POSITION, 0,
+                                           VertexBuffer::AttributeType::FLOAT3)
+                                .attribute(VertexAttribute::TANGENTS, 1,
+                                           VertexBuffer::AttributeType::SHORT4)
+                                .attribute(VertexAttribute::UV0, 2,
+                                           VertexBuffer::AttributeType::FLOAT2)
+                                .normalized(VertexAttribute::TANGENTS)
+                                .build(*engine_);
+
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 0, VertexBuffer::BufferDescriptor(vertices, sizeof(vertices)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 1, VertexBuffer::BufferDescriptor(normals, sizeof(normals)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 2, VertexBuffer::BufferDescriptor(uvCoords, sizeof(uvCoords)));
 
   constexpr int indexCount = 12;
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine_);
+  geometry.poIndexBuffer = IndexBuffer::Builder()
+                               .indexCount(indexCount)
+                               .bufferType(IndexBuffer::IndexType::USHORT)
+                               .build(*engine_);
 
-  m_poIndexBuffer->setBuffer(
+  geometry.poIndexBuffer->setBuffer(
       *engine_, IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
 
-  vBuildRenderable(engine_);
+  geometry.nIndexCount = indexCount;
+  geometry.oBounds = {float3(-0.5f, -0.5f, 0.0f),
+                      float3(0.5f, 0.5f, 0.0f)};
+  geometry.nBufferBytes = sizeof(vertices) + sizeof(normals) +
+                          sizeof(uvCoords) + sizeof(indices);
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void Plane::createSingleSidedPlane(filament::Engine* engine_) {
+void Plane::createSingleSidedPlane(filament::Engine* engine_,
+                                   ShapeGeometry& geometry) {
   // Vertices for a single-sided plane (4 vertices)
   static constexpr float vertices[] = {
       -0.5f, -0.5f, 0.0f,  // Vertex 0
@@ -209,37 +225,41 @@ void Plane::createSingleSidedPlane(filament::Engine* engine_) {
                                                 float3{0.0f, 0.0f, 1.0f}})
                       .xyzw)};
 
-  m_poVertexBuffer = VertexBuffer::Builder()
-                         .vertexCount(4)
-                         .bufferCount(3)  // Positions, Normals, UVs
-                         .attribute(VertexAttribute::POSITION, 0,
-                                    VertexBuffer::AttributeType::FLOAT3)
-                         .attribute(VertexAttribute::TANGENTS, 1,
-                                    VertexBuffer::AttributeType::SHORT4)
-                         .attribute(VertexAttribute::UV0, 2,
-                                    VertexBuffer::AttributeType::FLOAT2)
-                         .normalized(VertexAttribute::TANGENTS)
-                         .build(*engine_);
-
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer = VertexBuffer::Builder()
+                                .vertexCount(4)
+                                .bufferCount(3)  // Positions, Normals, UVs
+                                .attribute(VertexAttribute::POSITION, 0,
+                                           VertexBuffer::AttributeType::FLOAT3)
+                                .attribute(VertexAttribute::TANGENTS, 1,
+                                           VertexBuffer::AttributeType::SHORT4)
+                                .attribute(VertexAttribute::UV0, 2,
+                                           VertexBuffer::AttributeType::FLOAT2)
+                                .normalized(VertexAttribute::TANGENTS)
+                                .build(*engine_);
+
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 0, VertexBuffer::BufferDescriptor(vertices, sizeof(vertices)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 1, VertexBuffer::BufferDescriptor(normals, sizeof(normals)));
 
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 2, VertexBuffer::BufferDescriptor(uvCoords, sizeof(uvCoords)));
 
   constexpr int indexCount = 6;
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine_);
+  geometry.poIndexBuffer = IndexBuffer::Builder()
+                               .indexCount(indexCount)
+                               .bufferType(IndexBuffer::IndexType::USHORT)
+                               .build(*engine_);
 
-  m_poIndexBuffer->setBuffer(
+  geometry.poIndexBuffer->setBuffer(
       *engine_, IndexBuffer::BufferDescriptor(indices, sizeof(indices)));
 
-  vBuildRenderable(engine_);
+  geometry.nIndexCount = indexCount;
+  geometry.oBounds = {float3(-0.5f, -0.5f, 0.0f),
+                      float3(0.5f, 0.5f, 0.0f)};
+  geometry.nBufferBytes = sizeof(vertices) + sizeof(normals) +
+                          sizeof(uvCoords) + sizeof(indices);
 }
 
 ////////////////////////////////////////////////////////////////////////////
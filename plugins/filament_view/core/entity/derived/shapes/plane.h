@@ -29,6 +29,8 @@ class Plane : public BaseShape {
  public:
   Plane(const std::string& flutter_assets_path,
         const flutter::EncodableMap& params);
+  Plane(const std::string& flutter_assets_path,
+        const BinaryScene::View& params);
   Plane() = default;
   ~Plane() override = default;
 
@@ -41,10 +43,16 @@ class Plane : public BaseShape {
   bool bInitAndCreateShape(::filament::Engine* engine_,
                            std::shared_ptr<Entity> entityObject) override;
 
+ protected:
+  void vBuildGeometry(::filament::Engine* engine_,
+                      ShapeGeometry& geometry) const override;
+
  private:
-  void createDoubleSidedPlane(::filament::Engine* engine_);
+  static void createDoubleSidedPlane(::filament::Engine* engine_,
+                                     ShapeGeometry& geometry);
 
-  void createSingleSidedPlane(::filament::Engine* engine_);
+  static void createSingleSidedPlane(::filament::Engine* engine_,
+                                     ShapeGeometry& geometry);
 };
 
 }  // namespace shapes
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shape_geometry_cache.h"
+
+#include <plugins/common/common.h>
+
+namespace plugin_filament_view::shapes {
+
+////////////////////////////////////////////////////////////////////////////
+std::map<ShapeGeometryKey, std::unique_ptr<ShapeGeometry>>&
+ShapeGeometryCache::mapEntries() {
+  static std::map<ShapeGeometryKey, std::unique_ptr<ShapeGeometry>> entries;
+  return entries;
+}
+
+////////////////////////////////////////////////////////////////////////////
+const ShapeGeometry* ShapeGeometryCache::poAcquire(filament::Engine* engine,
+                                                   const ShapeGeometryKey& key,
+                                                   const Builder& builder) {
+  auto& entries = mapEntries();
+  if (const auto it = entries.find(key); it != entries.end()) {
+    ++it->second->nReferences;
+    return it->second.get();
+  }
+
+  auto geometry = std::make_unique<ShapeGeometry>();
+  builder(engine, *geometry);
+  if (geometry->poVertexBuffer == nullptr ||
+      geometry->poIndexBuffer == nullptr) {
+    if (geometry->poVertexBuffer != nullptr) {
+      engine->destroy(geometry->poVertexBuffer);
+    }
+    if (geometry->poIndexBuffer != nullptr) {
+      engine->destroy(geometry->poIndexBuffer);
+    }
+    return nullptr;
+  }
+
+  geometry->nReferences = 1;
+  const auto* result = geometry.get();
+  entries.emplace(key, std::move(geometry));
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ShapeGeometryCache::vRelease(filament::Engine* engine,
+                                  const ShapeGeometryKey& key) {
+  auto& entries = mapEntries();
+  const auto it = entries.find(key);
+  if (it == entries.end()) {
+    spdlog::warn("ShapeGeometryCache: release of unknown geometry");
+    return;
+  }
+
+  if (--it->second->nReferences > 0) {
+    return;
+  }
+
+  engine->destroy(it->second->poVertexBuffer);
+  engine->destroy(it->second->poIndexBuffer);
+  entries.erase(it);
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t ShapeGeometryCache::nGetBufferBytes() {
+  size_t nBytes = 0;
+  for (const auto& [key, geometry] : mapEntries()) {
+    nBytes += geometry->nBufferBytes;
+  }
+  return nBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t ShapeGeometryCache::nGetUnsharedBufferBytes() {
+  size_t nBytes = 0;
+  for (const auto& [key, geometry] : mapEntries()) {
+    nBytes += geometry->nBufferBytes * geometry->nReferences;
+  }
+  return nBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t ShapeGeometryCache::nGetEntryCount() {
+  return mapEntries().size();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ShapeGeometryCache::vForEach(
+    const std::function<void(const ShapeGeometryKey&, const ShapeGeometry&)>&
+        fn) {
+  for (const auto& [key, geometry] : mapEntries()) {
+    fn(key, *geometry);
+  }
+}
+
+}  // namespace plugin_filament_view::shapes
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <core/include/shapetypes.h>
+#include <filament/Box.h>
+#include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/VertexBuffer.h>
+#include <math/vec2.h>
+#include <math/vec3.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace plugin_filament_view::shapes {
+
+// Everything that changes a primitive shape's vertex and index data.
+struct ShapeGeometryKey {
+  ShapeType eType = ShapeType::Unset;
+  bool bDoubleSided = false;
+  // Tessellation, 0 for shapes that have none.
+  int nStacks = 0;
+  int nSlices = 0;
+
+  bool operator<(const ShapeGeometryKey& other) const {
+    return std::tie(eType, bDoubleSided, nStacks, nSlices) <
+           std::tie(other.eType, other.bDoubleSided, other.nStacks,
+                    other.nSlices);
+  }
+};
+
+struct ShapeGeometry {
+  ::filament::VertexBuffer* poVertexBuffer = nullptr;
+  ::filament::IndexBuffer* poIndexBuffer = nullptr;
+  size_t nIndexCount = 0;
+  // Object-space bounds of the vertices.
+  ::filament::Aabb oBounds;
+
+  // Generated vertex data, kept alive as the source of the asynchronous
+  // uploads. Left empty for shapes built from static arrays.
+  std::vector<::filament::math::float3> vecPositions;
+  std::vector<::filament::math::float3> vecNormals;
+  std::vector<::filament::math::float2> vecUVs;
+  std::vector<unsigned short> vecIndices;
+
+  size_t nBufferBytes = 0;
+  size_t nReferences = 0;
+};
+
+// Vertex and index buffers shared by every shape with the same
+// ShapeGeometryKey. Entries are reference counted and destroyed with their
+// last user. Only used from the Filament API thread.
+class ShapeGeometryCache {
+ public:
+  using Builder = std::function<void(::filament::Engine*, ShapeGeometry&)>;
+
+  // Builds the geometry with builder on first use. Returns nullptr if the
+  // builder produced no buffers.
+  static const ShapeGeometry* poAcquire(::filament::Engine* engine,
+                                        const ShapeGeometryKey& key,
+                                        const Builder& builder);
+
+  static void vRelease(::filament::Engine* engine, const ShapeGeometryKey& key);
+
+  // GPU bytes held by the cache, and what they'd be with per-shape buffers.
+  [[nodiscard]] static size_t nGetBufferBytes();
+  [[nodiscard]] static size_t nGetUnsharedBufferBytes();
+  [[nodiscard]] static size_t nGetEntryCount();
+
+  static void vForEach(
+      const std::function<void(const ShapeGeometryKey&, const ShapeGeometry&)>&
+          fn);
+
+ private:
+  static std::map<ShapeGeometryKey, std::unique_ptr<ShapeGeometry>>&
+  mapEntries();
+};
+
+}  // namespace plugin_filament_view::shapes
@@ -56,32 +56,63 @@ Sphere::Sphere(const std::string& flutter_assets_path,
                                           defaultSlices);
 }
 
+////////////////////////////////////////////////////////////////////////////
+Sphere::Sphere(const std::string& flutter_assets_path,
+               const BinaryScene::View& params)
+    : BaseShape(flutter_assets_path, params), stacks_(20), slices_(20) {
+  SPDLOG_TRACE("+-{} {}", __FILE__, __FUNCTION__);
+
+  static constexpr char kStacks[] = "stacks";
+  static constexpr char kSlices[] = "slices";
+
+  constexpr int defaultStacks = 20;
+  constexpr int defaultSlices = 20;
+
+  Deserialize::DecodeParameterWithDefault(kStacks, &stacks_, params,
+                                          defaultStacks);
+  Deserialize::DecodeParameterWithDefault(kSlices, &slices_, params,
+                                          defaultSlices);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 bool Sphere::bInitAndCreateShape(filament::Engine* engine_,
                                  std::shared_ptr<Entity> entityObject) {
   m_poEntity = std::move(entityObject);
+  return bCreateFromSharedGeometry(engine_);
+}
 
-  m_poVertexBuffer = nullptr;
-  m_poIndexBuffer = nullptr;
+////////////////////////////////////////////////////////////////////////////
+ShapeGeometryKey Sphere::oGetGeometryKey() const {
+  auto key = BaseShape::oGetGeometryKey();
+  key.nStacks = stacks_;
+  key.nSlices = slices_;
+  return key;
+}
 
+////////////////////////////////////////////////////////////////////////////
+void Sphere::vBuildGeometry(filament::Engine* engine_,
+                            ShapeGeometry& geometry) const {
   if (m_bDoubleSided) {
     createDoubleSidedSphere(engine_);
   } else {
-    createSingleSidedSphere(engine_);
+    createSingleSidedSphere(engine_, stacks_, slices_, geometry);
   }
-
-  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void Sphere::createSingleSidedSphere(filament::Engine* engine_) {
-  const int sectors = slices_;  // Longitude, or number of vertical slices
-  const int stacks = stacks_;   // Latitude, or number of horizontal slices
-
+void Sphere::createSingleSidedSphere(filament::Engine* engine_,
+                                     const int stacks,
+                                     const int sectors,
+                                     ShapeGeometry& geometry) {
   const float sectorStep =
       2.0f * static_cast<float>(M_PI) / static_cast<float>(sectors);
   const float stackStep = static_cast<float>(M_PI) / static_cast<float>(stacks);
 
+  auto& vertices = geometry.vecPositions;
+  auto& normals = geometry.vecNormals;
+  auto& uvs = geometry.vecUVs;
+  auto& indices = geometry.vecIndices;
+
   // Generate vertices, normals, and UVs for the outer surface
   for (int i = 0; i <= stacks; ++i) {
     const float stackAngle =
@@ -101,16 +132,16 @@ void Sphere::createSingleSidedSphere(filament::Engine* engine_) {
                 static_cast<float>(sectors);  // Longitude, x-axis UV
 
       // Add vertex position
-      vertices_.emplace_back(x, y, z);
+      vertices.emplace_back(x, y, z);
 
       // Add normal
       float length = sqrt(x * x + y * y + z * z);
       if (length == 0)
         length = 0.01f;
-      normals_.emplace_back(x / length, y / length, z / length);
+      normals.emplace_back(x / length, y / length, z / length);
 
       // Add UV coordinates
-      uvs_.emplace_back(u, v);
+      uvs.emplace_back(u, v);
     }
   }
 
@@ -121,20 +152,20 @@ void Sphere::createSingleSidedSphere(filament::Engine* engine_) {
 
     for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
       // Middle area triangles
-      indices_.push_back(static_cast<uint16_t>(k1));
-      indices_.push_back(static_cast<uint16_t>(k2));
-      indices_.push_back(static_cast<uint16_t>(k1 + 1));
+      indices.push_back(static_cast<uint16_t>(k1));
+      indices.push_back(static_cast<uint16_t>(k2));
+      indices.push_back(static_cast<uint16_t>(k1 + 1));
 
-      indices_.push_back(static_cast<uint16_t>(k1 + 1));
-      indices_.push_back(static_cast<uint16_t>(k2));
-      indices_.push_back(static_cast<uint16_t>(k2 + 1));
+      indices.push_back(static_cast<uint16_t>(k1 + 1));
+      indices.push_back(static_cast<uint16_t>(k2));
+      indices.push_back(static_cast<uint16_t>(k2 + 1));
     }
   }
 
   // Create the vertex buffer
-  m_poVertexBuffer =
+  geometry.poVertexBuffer =
       VertexBuffer::Builder()
-          .vertexCount(static_cast<unsigned int>(vertices_.size()))
+          .vertexCount(static_cast<unsigned int>(vertices.size()))
           .bufferCount(3)  // Position, Normals, and UVs
           .attribute(VertexAttribute::POSITION, 0,
                      VertexBuffer::AttributeType::FLOAT3)
@@ -145,31 +176,36 @@ void Sphere::createSingleSidedSphere(filament::Engine* engine_) {
           .build(*engine_);
 
   // Set buffer data
-  m_poVertexBuffer->setBufferAt(
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 0,
-      VertexBuffer::BufferDescriptor(vertices_.data(),
-                                     vertices_.size() * sizeof(float) * 3));
-  m_poVertexBuffer->setBufferAt(
+      VertexBuffer::BufferDescriptor(vertices.data(),
+                                     vertices.size() * sizeof(float) * 3));
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 1,
-      VertexBuffer::BufferDescriptor(normals_.data(),
-                                     normals_.size() * sizeof(float3)));
-  m_poVertexBuffer->setBufferAt(
+      VertexBuffer::BufferDescriptor(normals.data(),
+                                     normals.size() * sizeof(float3)));
+  geometry.poVertexBuffer->setBufferAt(
       *engine_, 2,
-      VertexBuffer::BufferDescriptor(uvs_.data(),
-                                     uvs_.size() * sizeof(float) * 2));
+      VertexBuffer::BufferDescriptor(uvs.data(),
+                                     uvs.size() * sizeof(float) * 2));
 
   // Create the index buffer
-  const auto indexCount = static_cast<unsigned int>(indices_.size());
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine_);
+  const auto indexCount = static_cast<unsigned int>(indices.size());
+  geometry.poIndexBuffer = IndexBuffer::Builder()
+                               .indexCount(indexCount)
+                               .bufferType(IndexBuffer::IndexType::USHORT)
+                               .build(*engine_);
 
-  m_poIndexBuffer->setBuffer(
+  geometry.poIndexBuffer->setBuffer(
       *engine_, IndexBuffer::BufferDescriptor(
-                    indices_.data(), indices_.size() * sizeof(unsigned short)));
-
-  vBuildRenderable(engine_);
+                    indices.data(), indices.size() * sizeof(unsigned short)));
+
+  geometry.nIndexCount = indexCount;
+  geometry.oBounds = {float3(-1.0f), float3(1.0f)};
+  geometry.nBufferBytes = vertices.size() * sizeof(float3) +
+                          normals.size() * sizeof(float3) +
+                          uvs.size() * sizeof(float) * 2 +
+                          indices.size() * sizeof(unsigned short);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -29,6 +29,8 @@ class Sphere : public BaseShape {
  public:
   Sphere(const std::string& flutter_assets_path,
          const flutter::EncodableMap& params);
+  Sphere(const std::string& flutter_assets_path,
+         const BinaryScene::View& params);
   Sphere();
   ~Sphere() override = default;
 
@@ -42,18 +44,22 @@ class Sphere : public BaseShape {
                            std::shared_ptr<Entity> entityObject) override;
   void CloneToOther(BaseShape& other) const override;
 
+  [[nodiscard]] ShapeGeometryKey oGetGeometryKey() const override;
+
+ protected:
+  void vBuildGeometry(::filament::Engine* engine_,
+                      ShapeGeometry& geometry) const override;
+
  private:
   static void createDoubleSidedSphere(::filament::Engine* engine_);
 
-  void createSingleSidedSphere(::filament::Engine* engine_);
+  static void createSingleSidedSphere(::filament::Engine* engine_,
+                                      int stacks,
+                                      int sectors,
+                                      ShapeGeometry& geometry);
 
   int stacks_;
   int slices_;
-
-  std::vector<::filament::math::float3> vertices_;
-  std::vector<::filament::math::float3> normals_;
-  std::vector<unsigned short> indices_;
-  std::vector<::filament::math::float2> uvs_;
 };
 
 }  // namespace shapes
@@ -15,6 +15,7 @@
  */
 
 #include <plugins/common/common.h>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <optional>
@@ -29,6 +30,19 @@ inline std::filesystem::path getAbsolutePath(const std::string& dependent_path,
   return path;
 }
 
+// Per user directory for files derived from assets, safe to delete.
+inline std::filesystem::path getCacheDirectory() {
+  std::filesystem::path path;
+  if (const char* cacheHome = std::getenv("XDG_CACHE_HOME")) {
+    path = cacheHome;
+  } else if (const char* home = std::getenv("HOME")) {
+    path = std::filesystem::path(home) / ".cache";
+  } else {
+    path = std::filesystem::temp_directory_path();
+  }
+  return path / "filament_view";
+}
+
 inline bool isValidFilePath(const std::filesystem::path& path) {
   if (path.empty() || !std::filesystem::exists(path)) {
     spdlog::error("[readAsset] invalid path: {}", path.c_str());
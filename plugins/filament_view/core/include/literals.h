@@ -20,6 +20,23 @@ namespace plugin_filament_view {
 
 // Messages.cc usage from Dart->C++
 static constexpr char kChangeAnimationByIndex[] = "CHANGE_ANIMATION_BY_INDEX";
+static constexpr char kChangeAnimationByIndexValue[] =
+    "CHANGE_ANIMATION_BY_INDEX_VALUE";
+static constexpr char kChangeAnimationByName[] = "CHANGE_ANIMATION_BY_NAME";
+static constexpr char kChangeAnimationByNameValue[] =
+    "CHANGE_ANIMATION_BY_NAME_VALUE";
+static constexpr char kChangeAnimationGuid[] = "CHANGE_ANIMATION_GUID";
+static constexpr char kChangeAnimationLoop[] = "CHANGE_ANIMATION_LOOP";
+static constexpr char kChangeAnimationCrossFadeSeconds[] =
+    "CHANGE_ANIMATION_CROSS_FADE_SECONDS";
+static constexpr char kRequestAnimationInfo[] = "REQUEST_ANIMATION_INFO";
+static constexpr char kApplyScenePatch[] = "APPLY_SCENE_PATCH";
+static constexpr char kApplyScenePatchOperations[] =
+    "APPLY_SCENE_PATCH_OPERATIONS";
+static constexpr char kApplyScenePatchTransformGuids[] =
+    "APPLY_SCENE_PATCH_TRANSFORM_GUIDS";
+static constexpr char kApplyScenePatchTransforms[] =
+    "APPLY_SCENE_PATCH_TRANSFORMS";
 static constexpr char kChangeLightColorByIndex[] =
     "CHANGE_DIRECT_LIGHT_COLOR_BY_INDEX";
 static constexpr char kChangeLightColorByIndexKey[] =
@@ -42,6 +59,27 @@ static constexpr char kChangeCameraRotationValue[] = "ROTATE_CAMERA_VALUE";
 static constexpr char kResetInertiaCameraToDefaultValues[] =
     "RESET_INERTIA_TO_DEFAULTS";
 static constexpr char kChangeQualitySettings[] = "CHANGE_QUALITY_SETTINGS";
+static constexpr char kConfigureQualityGovernor[] =
+    "CONFIGURE_QUALITY_GOVERNOR";
+static constexpr char kConfigureQualityGovernorEnabled[] =
+    "CONFIGURE_QUALITY_GOVERNOR_ENABLED";
+static constexpr char kConfigureQualityGovernorTargetFps[] =
+    "CONFIGURE_QUALITY_GOVERNOR_TARGET_FPS";
+// List of feature names the governor must leave alone: dynamicResolution,
+// bloom, ambientOcclusion, msaa, shadowQuality, shadows.
+static constexpr char kConfigureQualityGovernorPinned[] =
+    "CONFIGURE_QUALITY_GOVERNOR_PINNED";
+// Sends a resource_usage report back; the optional path also gets it as json.
+static constexpr char kRequestResourceUsage[] = "REQUEST_RESOURCE_USAGE";
+static constexpr char kRequestResourceUsageDumpPath[] =
+    "REQUEST_RESOURCE_USAGE_DUMP_PATH";
+// Warns with the top consumers once the accounted total goes over, 0 is off.
+static constexpr char kSetResourceBudget[] = "SET_RESOURCE_BUDGET";
+static constexpr char kSetResourceBudgetMB[] = "SET_RESOURCE_BUDGET_MB";
+// Writes the current scene as a snapshot; without a path, to the one named
+// by the sceneSnapshot creation param.
+static constexpr char kSaveSceneSnapshot[] = "SAVE_SCENE_SNAPSHOT";
+static constexpr char kSaveSceneSnapshotPath[] = "SAVE_SCENE_SNAPSHOT_PATH";
 
 // Collision Requests
 static constexpr char kCollisionRayRequest[] = "COLLISION_RAY_REQUEST";
@@ -60,11 +98,19 @@ static constexpr char kCollisionRayRequestDirectionZ[] =
 static constexpr char kCollisionRayRequestLength[] =
     "COLLISION_RAY_REQUEST_LENGTH";
 static constexpr char kCollisionRayRequestGUID[] = "COLLISION_RAY_REQUEST_GUID";
+// How touches are resolved to entities: kPickingModeCollidables tests the
+// touch ray against collidables, kPickingModeGpu reads back the renderable
+// under the touch point.
+static constexpr char kChangePickingMode[] = "CHANGE_PICKING_MODE";
+static constexpr char kChangePickingModeValue[] = "CHANGE_PICKING_MODE_VALUE";
+static constexpr char kPickingModeCollidables[] = "collidables";
+static constexpr char kPickingModeGpu[] = "gpu";
 
 // Deserialization
 static constexpr char kId[] = "id";
 static constexpr char kName[] = "name";
 static constexpr char kGlobalGuid[] = "global_guid";
+static constexpr char kParentGuid[] = "parentGuid";
 static constexpr char kShapeType[] = "shapeType";
 static constexpr char kSize[] = "size";
 static constexpr char kCenterPosition[] = "centerPosition";
@@ -83,10 +129,51 @@ static constexpr char kModel[] = "model";
 static constexpr char kModels[] = "models";
 static constexpr char kFallback[] = "fallback";
 static constexpr char kScene[] = "scene";
+static constexpr char kSceneBinary[] = "sceneBinary";
+static constexpr char kWriteSceneBinary[] = "writeSceneBinary";
+// Restores from this snapshot when it was taken from the same creation
+// params, and keeps it up to date otherwise. Relative paths are in the user
+// cache directory.
+static constexpr char kSceneSnapshot[] = "sceneSnapshot";
+static constexpr char kSnapshotInfo[] = "snapshotInfo";
+static constexpr char kSnapshotVersion[] = "version";
+static constexpr char kSnapshotSourceHash[] = "sourceHash";
+static constexpr char kSnapshotIblPath[] = "iblPath";
+static constexpr char kSnapshotIblCacheKey[] = "iblCacheKey";
+static constexpr char kSnapshotIblByteSize[] = "iblByteSize";
+static constexpr char kSnapshotIblWriteTime[] = "iblWriteTime";
 static constexpr char kShapes[] = "shapes";
+static constexpr char kShape[] = "shape";
+static constexpr char kPatchOp[] = "op";
+static constexpr char kPatchOpAdd[] = "add";
+static constexpr char kPatchOpRemove[] = "remove";
+static constexpr char kPatchOpUpdate[] = "update";
+static constexpr char kWarmUpMaterials[] = "warmUpMaterials";
+static constexpr char kHoldUntilMaterialsReady[] = "holdUntilMaterialsReady";
+static constexpr char kTextureBudgetMegabytes[] = "textureBudgetMegabytes";
+// Map read before the engine is created, see EngineProfile.
+static constexpr char kEngineProfile[] = "engineProfile";
+static constexpr char kEngineProfileBackend[] = "backend";
+static constexpr char kEngineProfileFeatureLevel[] = "featureLevel";
+static constexpr char kEngineProfileJobSystemThreads[] = "jobSystemThreads";
+static constexpr char kEngineProfileCommandBufferSizeMB[] =
+    "commandBufferSizeMB";
+static constexpr char kEngineProfileMinCommandBufferSizeMB[] =
+    "minCommandBufferSizeMB";
+static constexpr char kEngineProfilePerFrameCommandsSizeMB[] =
+    "perFrameCommandsSizeMB";
+static constexpr char kEngineProfilePerRenderPassArenaSizeMB[] =
+    "perRenderPassArenaSizeMB";
+static constexpr char kEngineProfileDriverHandleArenaSizeMB[] =
+    "driverHandleArenaSizeMB";
+static constexpr char kEngineProfileStereoscopicEyeCount[] =
+    "stereoscopicEyeCount";
+static constexpr char kEngineProfileBenchmark[] = "benchmark";
 static constexpr char kSkybox[] = "skybox";
 static constexpr char kLight[] = "light";
 static constexpr char kIndirectLight[] = "indirectLight";
+static constexpr char kLightColor[] = "color";
+static constexpr char kLightIntensity[] = "intensity";
 static constexpr char kCamera[] = "camera";
 static constexpr char kExposure[] = "exposure";
 static constexpr char kProjection[] = "projection";
@@ -130,6 +217,14 @@ static constexpr char kCollidableMask[] = "collidable_mask";
 static constexpr char kCollidableShouldMatchAttachedObject[] =
     "collidable_shouldMatchAttachedObject";
 
+// specific lod values:
+static constexpr char kLod[] = "lod";
+static constexpr char kLodLevels[] = "lod_levels";
+static constexpr char kLodAssetPath[] = "lod_assetPath";
+static constexpr char kLodTriangleRatio[] = "lod_triangleRatio";
+static constexpr char kLodScreenSize[] = "lod_screenSize";
+static constexpr char kLodHysteresis[] = "lod_hysteresis";
+
 // Custom model viewer for sending frames to dart.
 static constexpr char kUpdateFrame[] = "updateFrame";
 static constexpr char kPreRenderFrame[] = "preRenderFrame";
@@ -139,6 +234,18 @@ static constexpr char kParam_TimeSinceLastRenderedSec[] =
     "timeSinceLastRenderedSec";
 static constexpr char kParam_FPS[] = "fps";
 static constexpr char kParam_ElapsedFrameTime[] = "elapsedFrameTime";
+static constexpr char kQualityGovernorDecision[] = "qualityGovernorDecision";
+static constexpr char kParam_Feature[] = "feature";
+static constexpr char kParam_Degraded[] = "degraded";
+static constexpr char kParam_QualityLevel[] = "level";
+static constexpr char kParam_FrameTimeMs[] = "frameTimeMs";
+static constexpr char kParam_BudgetMs[] = "budgetMs";
+static constexpr char kPresentationStats[] = "presentationStats";
+static constexpr char kParam_Presented[] = "presented";
+static constexpr char kParam_Discarded[] = "discarded";
+static constexpr char kParam_RefreshNs[] = "refreshNs";
+static constexpr char kParam_LatencyAvgMs[] = "latencyAvgMs";
+static constexpr char kParam_LatencyMaxMs[] = "latencyMaxMs";
 
 // Collision Manager and uses, sending messages to dart from native
 static constexpr char kCollisionEvent[] = "collision_event";
@@ -154,6 +261,25 @@ enum CollisionEventType {
   eNativeOnTouchEnd
 };
 
+// Animation System, sending animation state to dart from native
+static constexpr char kAnimationInfo[] = "animation_info";
+static constexpr char kAnimationInfoNames[] = "animation_info_names";
+static constexpr char kAnimationInfoCount[] = "animation_info_count";
+static constexpr char kAnimationInfoCurrentIndex[] =
+    "animation_info_current_index";
+static constexpr char kAnimationInfoIsPlaying[] = "animation_info_is_playing";
+
+// Resource accounting, sending memory usage to dart from native
+static constexpr char kResourceUsage[] = "resource_usage";
+static constexpr char kResourceUsageSystem[] = "system";
+static constexpr char kResourceUsageOwner[] = "owner";
+static constexpr char kResourceUsageKind[] = "kind";
+static constexpr char kResourceUsageGpuBytes[] = "gpu_bytes";
+static constexpr char kResourceUsageCpuBytes[] = "cpu_bytes";
+static constexpr char kResourceUsageSystems[] = "systems";
+static constexpr char kResourceUsageOwners[] = "owners";
+static constexpr char kResourceUsageEntries[] = "entries";
+
 static constexpr char kCamera_Inertia_RotationSpeed[] = "inertia_rotationSpeed";
 static constexpr char kCamera_Inertia_VelocityFactor[] =
     "inertia_velocityFactor";
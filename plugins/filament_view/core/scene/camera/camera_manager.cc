@@ -28,6 +28,8 @@
 #include <filament/math/mat4.h>
 #include <filament/math/vec4.h>
 #include <plugins/common/common.h>
+#include <algorithm>
+#include <cmath>
 
 #define USING_CAM_MANIPULATOR 0
 
@@ -336,6 +338,9 @@ void CameraManager::ChangePrimaryCameraMode(const std::string& szValue) const {
 
 ////////////////////////////////////////////////////////////////////////////
 void CameraManager::updateCamerasFeatures(float fElapsedTime) {
+  // Drained even when gestures are off, so the queue can't grow.
+  vProcessTouchQueue(fElapsedTime);
+
   if (!primaryCamera_ || (primaryCamera_->eCustomCameraMode_ == Camera::Unset &&
                           !primaryCamera_->forceSingleFrameUpdate_)) {
     return;
@@ -375,12 +380,15 @@ void CameraManager::updateCamerasFeatures(float fElapsedTime) {
       return;
     }
 
+    // Frames at the reference rate each step the camera by the velocity.
+    const float fFrameScale = fElapsedTime / kInertiaReferenceFrameSeconds;
+
 #if USING_CAM_MANIPULATOR == 0  // Not using camera manipulator
     auto rotationSpeed =
         static_cast<float>(primaryCamera_->inertia_rotationSpeed_);
 
     // Calculate rotation angles from velocity
-    float angleX = currentVelocity_.x * rotationSpeed;
+    float angleX = currentVelocity_.x * rotationSpeed * fFrameScale;
     // float angleY = currentVelocity_.y * rotationSpeed;
 
     // Update the orbit angle of the camera
@@ -389,7 +397,8 @@ void CameraManager::updateCamerasFeatures(float fElapsedTime) {
     // Calculate the new camera eye position based on the orbit angle
     float zoomSpeed = primaryCamera_->zoomSpeed_.value_or(0.1f);
     float radius =
-        primaryCamera_->current_zoom_radius_ - currentVelocity_.z * zoomSpeed;
+        primaryCamera_->current_zoom_radius_ -
+        currentVelocity_.z * zoomSpeed * fFrameScale;
 
     // Clamp the radius between zoom_minCap_ and zoom_maxCap_
     radius =
@@ -438,7 +447,7 @@ void CameraManager::updateCamerasFeatures(float fElapsedTime) {
     // Apply inertia decay to gradually reduce velocity
     auto inertiaDecayFactor_ =
         static_cast<float>(primaryCamera_->inertia_decayFactor_);
-    currentVelocity_ *= inertiaDecayFactor_;
+    currentVelocity_ *= std::pow(inertiaDecayFactor_, fFrameScale);
 
     primaryCamera_->current_zoom_radius_ = radius;
   }
@@ -537,10 +546,97 @@ CameraManager::aGetRayInformationFromOnTouchPosition(TouchPair touch) const {
 }
 
 ////////////////////////////////////////////////////////////////////////////
-void CameraManager::onAction(int32_t action,
+void CameraManager::onAction(const int32_t action,
                              const int32_t point_count,
                              const size_t point_data_size,
                              const double* point_data) {
+  const auto viewport = m_poOwner->getFilamentView()->getViewport();
+  m_oTouchQueue.vPush(
+      action, point_count,
+      TouchPair(point_count, point_data_size, point_data, viewport.height));
+}
+
+////////////////////////////////////////////////////////////////////////////
+void CameraManager::vProcessTouchQueue(const float fElapsedTime) {
+  m_oTouchQueue.vDrain(m_lstTouchEvents);
+  for (const auto& event : m_lstTouchEvents) {
+    m_nStatsRawTouches += event.nMerged;
+    ++m_nStatsHandledTouches;
+    if (!m_oOldestUnsubmittedTouch.has_value() ||
+        event.oFirstTime < *m_oOldestUnsubmittedTouch) {
+      m_oOldestUnsubmittedTouch = event.oFirstTime;
+    }
+    vHandleTouch(event);
+  }
+
+  m_fStatsElapsed += fElapsedTime;
+  if (m_fStatsElapsed < kStatsIntervalSeconds) {
+    return;
+  }
+
+  m_fInputLatencyMilliseconds =
+      m_nStatsLatencySamples > 0
+          ? m_fStatsLatencyMilliseconds /
+                static_cast<float>(m_nStatsLatencySamples)
+          : 0.0f;
+  if (m_nStatsRawTouches > 0) {
+    spdlog::debug(
+        "CameraManager: {} touch events handled as {}, input to frame "
+        "latency avg {:.1f} ms max {:.1f} ms",
+        m_nStatsRawTouches, m_nStatsHandledTouches,
+        m_fInputLatencyMilliseconds, m_fStatsMaxLatencyMilliseconds);
+  }
+
+  m_fStatsElapsed = 0.0f;
+  m_nStatsRawTouches = 0;
+  m_nStatsHandledTouches = 0;
+  m_nStatsLatencySamples = 0;
+  m_fStatsLatencyMilliseconds = 0.0f;
+  m_fStatsMaxLatencyMilliseconds = 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void CameraManager::vOnFrameSubmitted() {
+  if (!m_oOldestUnsubmittedTouch.has_value()) {
+    return;
+  }
+  const std::chrono::duration<float, std::milli> latency =
+      TouchInputQueue::Clock::now() - *m_oOldestUnsubmittedTouch;
+  m_oOldestUnsubmittedTouch.reset();
+
+  ++m_nStatsLatencySamples;
+  m_fStatsLatencyMilliseconds += latency.count();
+  m_fStatsMaxLatencyMilliseconds =
+      std::max(m_fStatsMaxLatencyMilliseconds, latency.count());
+}
+
+////////////////////////////////////////////////////////////////////////////
+void CameraManager::vApplyReleaseVelocity(
+    const TouchInputQueue::Clock::time_point releaseTime) {
+  if (m_lstVelocitySamples.size() < 2 ||
+      releaseTime - m_lstVelocitySamples.back().oTime >
+          kReleaseVelocityWindow) {
+    currentVelocity_.xy = {0.0f};
+    return;
+  }
+
+  const auto& first = m_lstVelocitySamples.front();
+  const auto& last = m_lstVelocitySamples.back();
+  const std::chrono::duration<float> elapsed = last.oTime - first.oTime;
+  if (elapsed.count() <= 0.0f) {
+    return;
+  }
+
+  // Pixels per reference frame, the unit the drag accumulates velocity in.
+  const auto velocityFactor =
+      static_cast<float>(primaryCamera_->inertia_velocityFactor_);
+  currentVelocity_.xy = (last.f2Position - first.f2Position) /
+                        elapsed.count() * kInertiaReferenceFrameSeconds *
+                        velocityFactor;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void CameraManager::vHandleTouch(const TouchInputQueue::Event& event) {
   // We only care about updating the camera on action if we're set to use those
   // values.
   if (primaryCamera_ == nullptr ||
@@ -550,28 +646,24 @@ void CameraManager::onAction(int32_t action,
   }
 
 #if 0  // Hack testing code - for testing camera controls on PC
-  if ( action == ACTION_DOWN || action == ACTION_MOVE) {
+  if ( event.nAction == ACTION_DOWN || event.nAction == ACTION_MOVE) {
     currentVelocity_.z += 1.0f;
     return;
-  } else if (action == ACTION_UP) {
+  } else if (event.nAction == ACTION_UP) {
     currentVelocity_.z -= 1.0f;
     return;
   }
 #endif
 
-  auto filamentSystem =
-      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "CameraManager::setDefaultCamera");
-
-  const auto viewport = m_poOwner->getFilamentView()->getViewport();
-  auto touch =
-      TouchPair(point_count, point_data_size, point_data, viewport.height);
-  switch (action) {
+  const int32_t point_count = event.nPointCount;
+  auto touch = event.oTouch;
+  switch (event.nAction) {
     case ACTION_DOWN: {
       if (point_count == 1) {
         cameraManipulator_->grabBegin(touch.x(), touch.y(), false);
         initialTouchPosition_ = {touch.x(), touch.y()};
         currentVelocity_ = {0.0f};
+        m_lstVelocitySamples.clear();
       }
     } break;
 
@@ -630,6 +722,16 @@ void CameraManager::onAction(int32_t action,
         // Update velocity based on movement
         currentVelocity_.xy += delta * velocityFactor;
 
+        m_lstVelocitySamples.push_back({currentPosition, event.oTime});
+        const auto windowStart = event.oTime - kReleaseVelocityWindow;
+        m_lstVelocitySamples.erase(
+            m_lstVelocitySamples.begin(),
+            std::find_if(m_lstVelocitySamples.begin(),
+                         m_lstVelocitySamples.end(),
+                         [&windowStart](const VelocitySample& sample) {
+                           return sample.oTime >= windowStart;
+                         }));
+
         // Update touch position for the next move
         initialTouchPosition_ = currentPosition;
 
@@ -668,9 +770,16 @@ void CameraManager::onAction(int32_t action,
         currentGesture_ = Gesture::PAN;
       }
     } break;
-    case ACTION_CANCEL:
     case ACTION_UP:
+      if (currentGesture_ == Gesture::ORBIT) {
+        vApplyReleaseVelocity(event.oTime);
+      }
+      m_lstVelocitySamples.clear();
+      endGesture();
+      break;
+    case ACTION_CANCEL:
     default:
+      m_lstVelocitySamples.clear();
       endGesture();
       break;
   }
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "camera.h"
+#include "touch_input_queue.h"
 #include "touch_pair.h"
 
 #include <camutils/Manipulator.h>
@@ -28,6 +29,9 @@
 #include <core/scene/view_target.h>
 #include <filament/Camera.h>
 #include <utils/EntityManager.h>
+#include <chrono>
+#include <optional>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -52,12 +56,22 @@ class CameraManager {
 
   void destroyCamera() const;
 
-  // Camera control
+  // Camera control. Safe to call from the platform thread; events are
+  // queued and handled once per frame by updateCamerasFeatures.
   void onAction(int32_t action,
                 int32_t point_count,
                 size_t point_data_size,
                 const double* point_data);
 
+  // Call right after the frame is submitted, closes the latency sample for
+  // the touches handled in it.
+  void vOnFrameSubmitted();
+
+  // Touch arrival to frame submission, averaged over the last stats window.
+  [[nodiscard]] float fGetInputLatencyMilliseconds() const {
+    return m_fInputLatencyMilliseconds;
+  }
+
   [[nodiscard]] float calculateAspectRatio() const;
 
   void updateCameraManipulator(const Camera* cameraInfo);
@@ -116,6 +130,14 @@ class CameraManager {
   static constexpr int kZoomConfidenceDistance = 10;
   static constexpr float kZoomSpeed = 1.0f / 10.0f;
 
+  // Inertia settings on Camera were tuned per frame at 60 Hz; velocities and
+  // decay are scaled by elapsed time against this.
+  static constexpr float kInertiaReferenceFrameSeconds = 1.0f / 60.0f;
+  // Release velocity is measured over the moves of this last window, a
+  // finger resting longer than it leaves no fling.
+  static constexpr std::chrono::milliseconds kReleaseVelocityWindow{100};
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
   static constexpr ::filament::math::float3 kDefaultObjectPosition = {
       0.0f, 0.0f, -4.0f};
   static constexpr ::filament::math::float3 kCameraCenter = {0.0f, 0.0f, 0.0f};
@@ -179,6 +201,29 @@ class CameraManager {
 
   ViewTarget* m_poOwner;
 
+  TouchInputQueue m_oTouchQueue;
+  // Reused each frame to avoid reallocating.
+  std::vector<TouchInputQueue::Event> m_lstTouchEvents;
+  // Orbit positions and arrival times inside kReleaseVelocityWindow.
+  struct VelocitySample {
+    filament::math::float2 f2Position;
+    TouchInputQueue::Clock::time_point oTime;
+  };
+  std::vector<VelocitySample> m_lstVelocitySamples;
+  // Oldest touch handled since the last submitted frame.
+  std::optional<TouchInputQueue::Clock::time_point> m_oOldestUnsubmittedTouch;
+
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsRawTouches = 0;
+  size_t m_nStatsHandledTouches = 0;
+  size_t m_nStatsLatencySamples = 0;
+  float m_fStatsLatencyMilliseconds = 0.0f;
+  float m_fStatsMaxLatencyMilliseconds = 0.0f;
+  float m_fInputLatencyMilliseconds = 0.0f;
+
+  void vProcessTouchQueue(float fElapsedTime);
+  void vHandleTouch(const TouchInputQueue::Event& event);
+  void vApplyReleaseVelocity(TouchInputQueue::Clock::time_point releaseTime);
   void endGesture();
   bool isOrbitGesture() const;
   bool isPanGesture() const;
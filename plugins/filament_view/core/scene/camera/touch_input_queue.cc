@@ -0,0 +1,56 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "touch_input_queue.h"
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////
+void TouchInputQueue::vPush(const int32_t action,
+                            const int32_t pointCount,
+                            const TouchPair& touch) {
+  const auto now = Clock::now();
+
+  std::lock_guard lock(m_oMutex);
+  if (action == kActionMove && !m_lstEvents.empty()) {
+    if (auto& last = m_lstEvents.back();
+        last.nAction == kActionMove && last.nPointCount == pointCount) {
+      last.oTouch = touch;
+      last.oTime = now;
+      ++last.nMerged;
+      return;
+    }
+  }
+
+  Event event;
+  event.nAction = action;
+  event.nPointCount = pointCount;
+  event.oTouch = touch;
+  event.oTime = now;
+  event.oFirstTime = now;
+  m_lstEvents.push_back(event);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void TouchInputQueue::vDrain(std::vector<Event>& lstEvents) {
+  lstEvents.clear();
+  std::lock_guard lock(m_oMutex);
+  // Swapping keeps both vectors' capacity, so steady state doesn't
+  // allocate.
+  m_lstEvents.swap(lstEvents);
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "touch_pair.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Touch events handed from the platform thread to the Filament thread.
+//
+// Touch panels report far faster than we render, so a move that follows a
+// move with the same pointer count replaces it; the camera sees at most
+// one move per gesture step each frame. Downs, ups and cancels are kept in
+// order.
+class TouchInputQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    int32_t nAction = 0;
+    int32_t nPointCount = 0;
+    TouchPair oTouch;
+    // Arrival of the newest event merged into this one, used for velocity.
+    Clock::time_point oTime;
+    // Arrival of the oldest, used for latency.
+    Clock::time_point oFirstTime;
+    size_t nMerged = 1;
+  };
+
+  static constexpr int32_t kActionMove = 2;
+
+  TouchInputQueue() = default;
+
+  // Disallow copy and assign.
+  TouchInputQueue(const TouchInputQueue&) = delete;
+  TouchInputQueue& operator=(const TouchInputQueue&) = delete;
+
+  // Any thread.
+  void vPush(int32_t action, int32_t pointCount, const TouchPair& touch);
+
+  // Swaps the queued events into lstEvents, clearing what it held.
+  void vDrain(std::vector<Event>& lstEvents);
+
+ private:
+  std::mutex m_oMutex;
+  std::vector<Event> m_lstEvents;
+};
+
+}  // namespace plugin_filament_view
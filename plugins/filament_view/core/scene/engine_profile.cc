@@ -0,0 +1,167 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "engine_profile.h"
+
+#include "shell/platform/common/client_wrapper/include/flutter/standard_message_codec.h"
+
+#include <core/include/literals.h>
+#include <core/scene/serialization/binary_scene.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <string_view>
+
+namespace plugin_filament_view {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<int64_t> onGetNumber(const flutter::EncodableValue& value) {
+  if (std::holds_alternative<int32_t>(value)) {
+    return std::get<int32_t>(value);
+  }
+  if (std::holds_alternative<int64_t>(value)) {
+    return std::get<int64_t>(value);
+  }
+  if (std::holds_alternative<double>(value)) {
+    return static_cast<int64_t>(std::get<double>(value));
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+EngineProfile EngineProfile::oFromEncodableMap(
+    const flutter::EncodableMap& map) {
+  EngineProfile profile;
+
+  for (const auto& [fst, snd] : map) {
+    if (!std::holds_alternative<std::string>(fst)) {
+      continue;
+    }
+    const auto& key = std::get<std::string>(fst);
+
+    if (key == kEngineProfileBackend &&
+        std::holds_alternative<std::string>(snd)) {
+      if (const auto& name = std::get<std::string>(snd); name == "vulkan") {
+        profile.eBackend = filament::Engine::Backend::VULKAN;
+      } else if (name == "opengl") {
+        profile.eBackend = filament::Engine::Backend::OPENGL;
+      } else {
+        spdlog::warn("EngineProfile: unknown backend {}", name);
+      }
+      continue;
+    }
+    if (key == kEngineProfileBenchmark && std::holds_alternative<bool>(snd)) {
+      profile.bBenchmark = std::get<bool>(snd);
+      continue;
+    }
+
+    const auto number = onGetNumber(snd);
+    if (!number.has_value() || *number < 0) {
+      spdlog::warn("EngineProfile: ignoring {}", key);
+      continue;
+    }
+    const auto value = static_cast<uint32_t>(*number);
+    if (key == kEngineProfileFeatureLevel) {
+      profile.nFeatureLevel = static_cast<uint8_t>(std::min(value, 3u));
+    } else if (key == kEngineProfileJobSystemThreads) {
+      profile.nJobSystemThreads = value;
+    } else if (key == kEngineProfileCommandBufferSizeMB) {
+      profile.nCommandBufferSizeMB = value;
+    } else if (key == kEngineProfileMinCommandBufferSizeMB) {
+      profile.nMinCommandBufferSizeMB = value;
+    } else if (key == kEngineProfilePerFrameCommandsSizeMB) {
+      profile.nPerFrameCommandsSizeMB = value;
+    } else if (key == kEngineProfilePerRenderPassArenaSizeMB) {
+      profile.nPerRenderPassArenaSizeMB = value;
+    } else if (key == kEngineProfileDriverHandleArenaSizeMB) {
+      profile.nDriverHandleArenaSizeMB = value;
+    } else if (key == kEngineProfileStereoscopicEyeCount) {
+      profile.nStereoscopicEyeCount = static_cast<uint8_t>(value);
+    } else {
+      spdlog::warn("EngineProfile: unknown key {}", key);
+    }
+  }
+
+  return profile;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<EngineProfile> EngineProfile::oFromCreationParams(
+    const std::vector<uint8_t>& params) {
+  constexpr std::string_view key(kEngineProfile);
+  if (std::search(params.begin(), params.end(), key.begin(), key.end()) ==
+      params.end()) {
+    return std::nullopt;
+  }
+
+  if (BinaryScene::bHasMagic(params.data(), params.size())) {
+    BinaryScene binaryScene;
+    if (!binaryScene.bBorrowBuffer(params.data(), params.size())) {
+      return std::nullopt;
+    }
+    const auto value = binaryScene.oGetRoot().oFind(key);
+    if (value.eGetType() != BinaryScene::Type::Map) {
+      return std::nullopt;
+    }
+    return oFromEncodableMap(
+        std::get<flutter::EncodableMap>(value.oToEncodable()));
+  }
+
+  auto& codec = flutter::StandardMessageCodec::GetInstance();
+  const auto decoded = codec.DecodeMessage(params.data(), params.size());
+  const auto* creationParams =
+      decoded ? std::get_if<flutter::EncodableMap>(decoded.get()) : nullptr;
+  if (creationParams == nullptr) {
+    return std::nullopt;
+  }
+  const auto it = creationParams->find(flutter::EncodableValue(kEngineProfile));
+  if (it == creationParams->end() ||
+      !std::holds_alternative<flutter::EncodableMap>(it->second)) {
+    return std::nullopt;
+  }
+  return oFromEncodableMap(std::get<flutter::EncodableMap>(it->second));
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::Engine::Config EngineProfile::oGetConfig() const {
+  filament::Engine::Config config;
+  if (nJobSystemThreads > 0) {
+    config.jobSystemThreadCount = nJobSystemThreads;
+  }
+  if (nCommandBufferSizeMB > 0) {
+    config.commandBufferSizeMB = nCommandBufferSizeMB;
+  }
+  if (nMinCommandBufferSizeMB > 0) {
+    config.minCommandBufferSizeMB = nMinCommandBufferSizeMB;
+  }
+  if (nPerFrameCommandsSizeMB > 0) {
+    config.perFrameCommandsSizeMB = nPerFrameCommandsSizeMB;
+  }
+  if (nPerRenderPassArenaSizeMB > 0) {
+    config.perRenderPassArenaSizeMB = nPerRenderPassArenaSizeMB;
+  }
+  if (nDriverHandleArenaSizeMB > 0) {
+    config.driverHandleArenaSizeMB = nDriverHandleArenaSizeMB;
+  }
+  if (nStereoscopicEyeCount > 0) {
+    config.stereoscopicEyeCount = nStereoscopicEyeCount;
+  }
+  return config;
+}
+
+}  // namespace plugin_filament_view
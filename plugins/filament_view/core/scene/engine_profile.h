@@ -0,0 +1,58 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <encodable_value.h>
+#include <filament/Engine.h>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// How the filament engine is created: backend, feature level and the
+// Engine::Config sizes. Zero keeps filament's default for that value.
+//
+// Read from kEngineProfile in the plugin creation params, or set by the
+// embedder with ECSystemManager::setConfigValue(kEngineProfile, profile)
+// before the first view is registered. The engine is created once, so a
+// worker count sweep runs one launch per count with bBenchmark on.
+struct EngineProfile {
+  filament::Engine::Backend eBackend = filament::Engine::Backend::VULKAN;
+  // 0 keeps the highest level the backend supports.
+  uint8_t nFeatureLevel = 0;
+  uint32_t nJobSystemThreads = 0;
+  uint32_t nCommandBufferSizeMB = 0;
+  uint32_t nMinCommandBufferSizeMB = 0;
+  uint32_t nPerFrameCommandsSizeMB = 0;
+  uint32_t nPerRenderPassArenaSizeMB = 0;
+  uint32_t nDriverHandleArenaSizeMB = 0;
+  uint8_t nStereoscopicEyeCount = 0;
+  // Logs GPU frame times with the effective worker count every few seconds.
+  bool bBenchmark = false;
+
+  static EngineProfile oFromEncodableMap(const flutter::EncodableMap& map);
+
+  // Only decodes the params when they mention kEngineProfile, the scene
+  // itself is decoded later alongside engine creation.
+  static std::optional<EngineProfile> oFromCreationParams(
+      const std::vector<uint8_t>& params);
+
+  [[nodiscard]] filament::Engine::Config oGetConfig() const;
+};
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_callback_message.h"
+
+#include <flutter/method_call.h>
+#include <flutter/standard_method_codec.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace plugin_filament_view {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<uint8_t> vecEncode(
+    const std::string& szMethod,
+    const std::vector<std::pair<const char*, flutter::EncodableValue>>& args) {
+  flutter::EncodableMap encodableMap;
+  for (const auto& [fst, snd] : args) {
+    encodableMap.emplace(fst, snd);
+  }
+  const flutter::MethodCall<> methodCall(
+      szMethod,
+      std::make_unique<flutter::EncodableValue>(std::move(encodableMap)));
+  const auto encoded =
+      flutter::StandardMethodCodec::GetInstance().EncodeMethodCall(methodCall);
+  return std::move(*encoded);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// The same type with every byte of its value changed.
+flutter::EncodableValue oFlipBytes(const flutter::EncodableValue& value) {
+  if (const auto* n32 = std::get_if<int32_t>(&value)) {
+    return flutter::EncodableValue(~*n32);
+  }
+  if (const auto* n64 = std::get_if<int64_t>(&value)) {
+    return flutter::EncodableValue(~*n64);
+  }
+  uint64_t bits;
+  std::memcpy(&bits, &std::get<double>(value), sizeof(bits));
+  bits = ~bits;
+  double flipped;
+  std::memcpy(&flipped, &bits, sizeof(flipped));
+  return flutter::EncodableValue(flipped);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+FrameCallbackMessage::FrameCallbackMessage(
+    const std::string& szMethod,
+    std::initializer_list<std::pair<const char*, flutter::EncodableValue>>
+        args) {
+  std::vector<std::pair<const char*, flutter::EncodableValue>> lstArgs(args);
+  m_vecEncoded = vecEncode(szMethod, lstArgs);
+
+  // The keys fix the layout, so the first byte that changes when only one
+  // value changes is where that value is encoded.
+  for (auto& [fst, snd] : lstArgs) {
+    Argument argument{};
+    if (std::holds_alternative<int32_t>(snd)) {
+      argument.eType = ArgumentType::Int32;
+    } else if (std::holds_alternative<int64_t>(snd)) {
+      argument.eType = ArgumentType::Int64;
+    } else {
+      argument.eType = ArgumentType::Double;
+    }
+
+    const auto original = snd;
+    snd = oFlipBytes(original);
+    const auto flipped = vecEncode(szMethod, lstArgs);
+    snd = original;
+
+    argument.nOffset = static_cast<size_t>(
+        std::mismatch(m_vecEncoded.begin(), m_vecEncoded.end(),
+                      flipped.begin())
+            .first -
+        m_vecEncoded.begin());
+    m_lstArguments.push_back(argument);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameCallbackMessage::vSetArgument(const size_t nArg,
+                                        const double value) {
+  const auto& [eType, nOffset] = m_lstArguments[nArg];
+  switch (eType) {
+    case ArgumentType::Int32: {
+      const auto n = static_cast<int32_t>(value);
+      std::memcpy(&m_vecEncoded[nOffset], &n, sizeof(n));
+      break;
+    }
+    case ArgumentType::Int64: {
+      const auto n = static_cast<int64_t>(value);
+      std::memcpy(&m_vecEncoded[nOffset], &n, sizeof(n));
+      break;
+    }
+    case ArgumentType::Double:
+      std::memcpy(&m_vecEncoded[nOffset], &value, sizeof(value));
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameCallbackMessage::vSend(flutter::BinaryMessenger* poMessenger,
+                                 const std::string& szChannel) const {
+  poMessenger->Send(szChannel, m_vecEncoded.data(), m_vecEncoded.size());
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <flutter/binary_messenger.h>
+#include <flutter/encodable_value.h>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// A method call whose arguments are a map of fixed keys to numbers, sent
+// every frame. It is encoded once; each send only overwrites the values in
+// the encoded bytes, so the per-frame callbacks neither build a map nor run
+// the codec.
+class FrameCallbackMessage {
+ public:
+  // The values given here fix each argument's encoded type.
+  FrameCallbackMessage(
+      const std::string& szMethod,
+      std::initializer_list<std::pair<const char*, flutter::EncodableValue>>
+          args);
+
+  // Overwrites the nth argument given to the constructor, converted to the
+  // type it was encoded with.
+  void vSetArgument(size_t nArg, double value);
+
+  void vSend(flutter::BinaryMessenger* poMessenger,
+             const std::string& szChannel) const;
+
+ private:
+  enum class ArgumentType { Int32, Int64, Double };
+
+  struct Argument {
+    ArgumentType eType;
+    size_t nOffset;
+  };
+
+  std::vector<uint8_t> m_vecEncoded;
+  std::vector<Argument> m_lstArguments;
+};
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "frame_coordinator.h"
+
+#include <core/scene/view_target.h>
+#include <core/systems/ecsystems_manager.h>
+#include <plugins/common/common.h>
+#include <asio/post.hpp>
+#include <algorithm>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////
+void FrameCoordinator::vRequestFrame(ViewTarget* poViewTarget,
+                                     const size_t nWhich,
+                                     const uint32_t time) {
+  std::unique_lock lock(m_oPendingMutex);
+
+  const auto iter =
+      std::find_if(m_lstPending.begin(), m_lstPending.end(),
+                   [poViewTarget](const PendingFrame& frame) {
+                     return frame.poViewTarget == poViewTarget;
+                   });
+  if (iter != m_lstPending.end()) {
+    // Keep the first request time, that's what the latency is counted from.
+    iter->nTime = time;
+  } else {
+    m_lstPending.push_back(
+        {poViewTarget, nWhich, time, std::chrono::steady_clock::now()});
+  }
+
+  if (m_bPassPosted) {
+    return;
+  }
+  m_bPassPosted = true;
+  lock.unlock();
+
+  post(*ECSystemManager::GetInstance()->GetStrand(),
+       [this] { vRenderPending(); });
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameCoordinator::vRenderPending() {
+  {
+    std::unique_lock lock(m_oPendingMutex);
+    std::swap(m_lstPending, m_lstRendering);
+    m_bPassPosted = false;
+  }
+
+  // In view order, so the views are drawn in the same sequence every pass.
+  std::sort(m_lstRendering.begin(), m_lstRendering.end(),
+            [](const PendingFrame& a, const PendingFrame& b) {
+              return a.nWhich < b.nWhich;
+            });
+
+  for (const auto& frame : m_lstRendering) {
+    const bool bRendered = frame.poViewTarget->bRenderFrame(frame.nTime);
+
+    if (frame.nWhich >= m_lstStats.size()) {
+      m_lstStats.resize(frame.nWhich + 1);
+    }
+    auto& stats = m_lstStats[frame.nWhich];
+    if (!bRendered) {
+      ++stats.nSkipped;
+      continue;
+    }
+    const std::chrono::duration<float, std::milli> latency =
+        std::chrono::steady_clock::now() - frame.oRequested;
+    ++stats.nFrames;
+    stats.fTotalMilliseconds += latency.count();
+    stats.fMaxMilliseconds = std::max(stats.fMaxMilliseconds, latency.count());
+  }
+  m_lstRendering.clear();
+  ++m_nStatsPasses;
+
+  vLogStats();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameCoordinator::vLogStats() {
+  const auto now = std::chrono::steady_clock::now();
+  if (std::chrono::duration<float>(now - m_oStatsStart).count() <
+      kStatsIntervalSeconds) {
+    return;
+  }
+
+  size_t nFrames = 0;
+  for (const auto& stats : m_lstStats) {
+    nFrames += stats.nFrames;
+  }
+  spdlog::debug("FrameCoordinator: {} passes, {:.2f} views per pass",
+                m_nStatsPasses,
+                m_nStatsPasses == 0 ? 0.0f
+                                    : static_cast<float>(nFrames) /
+                                          static_cast<float>(m_nStatsPasses));
+  for (size_t i = 0; i < m_lstStats.size(); ++i) {
+    const auto& stats = m_lstStats[i];
+    if (stats.nFrames == 0 && stats.nSkipped == 0) {
+      continue;
+    }
+    spdlog::debug(
+        "  view {}: {} frames, {} skipped, latency avg {:.2f} ms max "
+        "{:.2f} ms",
+        i, stats.nFrames, stats.nSkipped,
+        stats.nFrames == 0
+            ? 0.0f
+            : stats.fTotalMilliseconds / static_cast<float>(stats.nFrames),
+        stats.fMaxMilliseconds);
+  }
+
+  std::fill(m_lstStats.begin(), m_lstStats.end(), ViewStats{});
+  m_nStatsPasses = 0;
+  m_oStatsStart = now;
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace plugin_filament_view {
+
+class ViewTarget;
+
+// Gathers the Wayland frame callbacks of all view targets and renders the
+// views that asked for a frame back to back, in one strand task. System
+// updates are strand tasks too, so every view in a pass shows the same
+// scene state, and a view whose callback fires twice before the pass runs
+// is drawn once.
+class FrameCoordinator {
+ public:
+  FrameCoordinator() = default;
+
+  // Disallow copy and assign.
+  FrameCoordinator(const FrameCoordinator&) = delete;
+  FrameCoordinator& operator=(const FrameCoordinator&) = delete;
+
+  // Callable from any thread. The first request after a pass posts the
+  // next one; requests arriving before it runs join it.
+  void vRequestFrame(ViewTarget* poViewTarget, size_t nWhich, uint32_t time);
+
+ private:
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
+  struct PendingFrame {
+    ViewTarget* poViewTarget;
+    size_t nWhich;
+    uint32_t nTime;
+    std::chrono::steady_clock::time_point oRequested;
+  };
+
+  // Request to end of the view's render, per view.
+  struct ViewStats {
+    size_t nFrames = 0;
+    size_t nSkipped = 0;
+    float fTotalMilliseconds = 0.0f;
+    float fMaxMilliseconds = 0.0f;
+  };
+
+  void vRenderPending();
+  void vLogStats();
+
+  std::mutex m_oPendingMutex;
+  std::vector<PendingFrame> m_lstPending;
+  bool m_bPassPosted = false;
+
+  // Only touched on the strand.
+  std::vector<PendingFrame> m_lstRendering;
+  std::vector<ViewStats> m_lstStats;
+  size_t m_nStatsPasses = 0;
+  std::chrono::steady_clock::time_point m_oStatsStart =
+      std::chrono::steady_clock::now();
+};
+
+}  // namespace plugin_filament_view
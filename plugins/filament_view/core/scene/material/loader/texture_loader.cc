@@ -20,15 +20,46 @@
 #include <core/systems/derived/filament_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <imageio/ImageDecoder.h>
+#include <ktxreader/Ktx2Reader.h>
 #include <plugins/common/curl_client/curl_client.h>
 #include <stb_image.h>
+#include <utils/JobSystem.h>
+#include <asio/post.hpp>
+#include <chrono>
+#include <filesystem>
 #include <memory>
 
 namespace plugin_filament_view {
 
+std::map<const filament::Texture*, uint64_t> TextureLoader::m_mapPendingUploads;
+uint64_t TextureLoader::m_nNextUploadToken = 0;
+
 ////////////////////////////////////////////////////////////////////////////
 TextureLoader::TextureLoader() = default;
 
+////////////////////////////////////////////////////////////////////////////
+uint64_t TextureLoader::nBeginUpload(const filament::Texture* texture) {
+  const auto token = ++m_nNextUploadToken;
+  m_mapPendingUploads[texture] = token;
+  return token;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool TextureLoader::bEndUpload(const filament::Texture* texture,
+                               const uint64_t token) {
+  const auto pending = m_mapPendingUploads.find(texture);
+  if (pending == m_mapPendingUploads.end() || pending->second != token) {
+    return false;
+  }
+  m_mapPendingUploads.erase(pending);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void TextureLoader::vCancelPendingUpload(const filament::Texture* texture) {
+  m_mapPendingUploads.erase(texture);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 inline filament::backend::TextureFormat internalFormat(
     const TextureDefinitions::TextureType type) {
@@ -43,23 +74,81 @@ inline filament::backend::TextureFormat internalFormat(
   throw std::runtime_error("Invalid texture type");
 }
 
+////////////////////////////////////////////////////////////////////////////
+size_t TextureLoader::nEstimateTextureBytes(const filament::Texture* texture) {
+  using filament::backend::TextureFormat;
+
+  size_t nBitsPerPixel = 32;
+  switch (texture->getFormat()) {
+    case TextureFormat::ETC2_EAC_RGBA8:
+    case TextureFormat::ETC2_EAC_SRGBA8:
+    case TextureFormat::DXT5_RGBA:
+    case TextureFormat::DXT5_SRGBA:
+    case TextureFormat::RGBA_ASTC_4x4:
+    case TextureFormat::SRGB8_ALPHA8_ASTC_4x4:
+      nBitsPerPixel = 8;
+      break;
+    case TextureFormat::RGB16F:
+    case TextureFormat::RGBA16F:
+      nBitsPerPixel = 64;
+      break;
+    case TextureFormat::RGB32F:
+    case TextureFormat::RGBA32F:
+      nBitsPerPixel = 128;
+      break;
+    default:
+      break;
+  }
+
+  size_t nBytes = 0;
+  for (size_t level = 0; level < texture->getLevels(); ++level) {
+    nBytes += texture->getWidth(level) * texture->getHeight(level) *
+              nBitsPerPixel / 8;
+  }
+  if (texture->getTarget() == filament::Texture::Sampler::SAMPLER_CUBEMAP) {
+    nBytes *= 6;
+  }
+  return nBytes;
+}
+
+////////////////////////////////////////////////////////////////////////////
+static void vLogTextureLoaded(
+    const std::string& file_path,
+    const filament::Texture* texture,
+    const std::chrono::steady_clock::time_point& loadStart) {
+  const std::chrono::duration<float, std::milli> loadTime =
+      std::chrono::steady_clock::now() - loadStart;
+  spdlog::debug(
+      "Texture {} {}x{}, {} levels, format {}, ~{} KiB, loaded in {:.1f} ms",
+      file_path, texture->getWidth(), texture->getHeight(),
+      texture->getLevels(), static_cast<int>(texture->getFormat()),
+      TextureLoader::nEstimateTextureBytes(texture) / 1024, loadTime.count());
+}
+
 ////////////////////////////////////////////////////////////////////////////
 filament::Texture* TextureLoader::createTextureFromImage(
     const std::string& file_path,
     const TextureDefinitions::TextureType type) {
+  // Only the header is read here, the decode happens on a worker.
   int w, h, n;
-  const unsigned char* data = stbi_load(file_path.c_str(), &w, &h, &n, 4);
+  if (!stbi_info(file_path.c_str(), &w, &h, &n)) {
+    spdlog::error("Unable to read image header of {}", file_path);
+    return nullptr;
+  }
 
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
           FilamentSystem::StaticGetTypeID(), "createTextureFromImage");
   const auto engine = filamentSystem->getFilamentEngine();
 
+  // levels(0xff) is clamped to the full chain for this size.
   filament::Texture* texture =
       filament::Texture::Builder()
           .width(static_cast<uint32_t>(w))
           .height(static_cast<uint32_t>(h))
-          .levels(1)  // TODO should be param, backlogged
+          .levels(0xff)
+          .usage(filament::Texture::Usage::DEFAULT |
+                 filament::Texture::Usage::GEN_MIPMAPPABLE)
           .format(internalFormat(type))
           .sampler(filament::Texture::Sampler::SAMPLER_2D)
           .build(*engine);
@@ -69,15 +158,141 @@ filament::Texture* TextureLoader::createTextureFromImage(
     return nullptr;
   }
 
-  filament::Texture::PixelBufferDescriptor pbd(
-      data, static_cast<size_t>(w * h * 4),
-      filament::Texture::PixelBufferDescriptor::PixelDataFormat::RGBA,
-      filament::Texture::PixelBufferDescriptor::PixelDataType::UBYTE,
-      reinterpret_cast<filament::Texture::PixelBufferDescriptor::Callback>(
-          &stbi_image_free));
+  struct DecodeJob {
+    std::string szFilePath;
+    filament::Engine* poEngine;
+    filament::Texture* poTexture;
+    uint64_t nToken;
+    std::chrono::steady_clock::time_point loadStart;
+  };
+  // Owned by the job until the upload ran on the API thread.
+  auto* decode =
+      new DecodeJob{file_path, engine, texture, nBeginUpload(texture),
+                    std::chrono::steady_clock::now()};
+
+  auto& js = engine->getJobSystem();
+  auto* job = js.createJob(nullptr, [decode](utils::JobSystem&,
+                                             utils::JobSystem::Job*) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(decode->szFilePath.c_str(), &width,
+                                    &height, &channels, 4);
+
+    post(*ECSystemManager::GetInstance()->GetStrand(), [decode, data] {
+      const std::unique_ptr<DecodeJob> owned(decode);
+      if (!bEndUpload(owned->poTexture, owned->nToken)) {
+        SPDLOG_DEBUG("Texture {} destroyed before its upload",
+                     owned->szFilePath);
+        stbi_image_free(data);
+        return;
+      }
+      if (data == nullptr) {
+        spdlog::error("Unable to decode image {}", owned->szFilePath);
+        return;
+      }
+
+      const auto* texture = owned->poTexture;
+      filament::Texture::PixelBufferDescriptor pbd(
+          data,
+          static_cast<size_t>(texture->getWidth() * texture->getHeight() * 4),
+          filament::Texture::PixelBufferDescriptor::PixelDataFormat::RGBA,
+          filament::Texture::PixelBufferDescriptor::PixelDataType::UBYTE,
+          reinterpret_cast<filament::Texture::PixelBufferDescriptor::Callback>(
+              &stbi_image_free));
 
-  texture->setImage(*engine, 0, std::move(pbd));
-  texture->generateMipmaps(*engine);
+      owned->poTexture->setImage(*owned->poEngine, 0, std::move(pbd));
+      owned->poTexture->generateMipmaps(*owned->poEngine);
+
+      vLogTextureLoaded(owned->szFilePath, texture, owned->loadStart);
+    });
+  });
+  js.run(job);
+
+  return texture;
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::Texture* TextureLoader::createTextureFromKtx2(
+    const std::string& file_path,
+    const TextureDefinitions::TextureType type) {
+  using filament::Texture;
+  using ktxreader::Ktx2Reader;
+
+  const auto loadStart = std::chrono::steady_clock::now();
+
+  const std::filesystem::path path(file_path);
+  auto buffer = readBinaryFile(path.filename().string(),
+                               path.parent_path().string());
+  if (buffer.empty()) {
+    return nullptr;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "createTextureFromKtx2");
+  const auto engine = filamentSystem->getFilamentEngine();
+
+  // The reader owns the transcoder state, so each load gets its own.
+  auto reader = std::make_unique<Ktx2Reader>(*engine, true);
+
+  // Best first; the reader picks the first one the backend supports.
+  // Embedded GPUs tend to have ASTC or ETC2, desktop ones only BC (DXT).
+  const bool bSrgb = type == TextureDefinitions::TextureType::COLOR;
+  if (bSrgb) {
+    reader->requestFormat(Texture::InternalFormat::SRGB8_ALPHA8_ASTC_4x4);
+    reader->requestFormat(Texture::InternalFormat::ETC2_EAC_SRGBA8);
+    reader->requestFormat(Texture::InternalFormat::DXT5_SRGBA);
+    reader->requestFormat(Texture::InternalFormat::SRGB8_A8);
+  } else {
+    reader->requestFormat(Texture::InternalFormat::RGBA_ASTC_4x4);
+    reader->requestFormat(Texture::InternalFormat::ETC2_EAC_RGBA8);
+    reader->requestFormat(Texture::InternalFormat::DXT5_RGBA);
+    reader->requestFormat(Texture::InternalFormat::RGBA8);
+  }
+
+  auto* async = reader->asyncCreate(
+      buffer.data(), buffer.size(),
+      bSrgb ? Ktx2Reader::TransferFunction::sRGB
+            : Ktx2Reader::TransferFunction::LINEAR);
+  if (async == nullptr) {
+    spdlog::error("Unable to parse KTX2 texture {}", file_path);
+    return nullptr;
+  }
+  auto* texture = async->getTexture();
+
+  struct TranscodeJob {
+    std::string szFilePath;
+    std::vector<uint8_t> buffer;
+    std::unique_ptr<Ktx2Reader> reader;
+    Ktx2Reader::Async* async;
+    filament::Texture* poTexture;
+    uint64_t nToken;
+    std::chrono::steady_clock::time_point loadStart;
+  };
+  auto* transcode = new TranscodeJob{
+      file_path, std::move(buffer),      std::move(reader), async,
+      texture,   nBeginUpload(texture), loadStart};
+
+  auto& js = engine->getJobSystem();
+  auto* job = js.createJob(nullptr, [transcode](utils::JobSystem&,
+                                                utils::JobSystem::Job*) {
+    transcode->async->doTranscoding();
+
+    post(*ECSystemManager::GetInstance()->GetStrand(), [transcode] {
+      const std::unique_ptr<TranscodeJob> owned(transcode);
+      if (!bEndUpload(owned->poTexture, owned->nToken)) {
+        SPDLOG_DEBUG("Texture {} destroyed before its upload",
+                     owned->szFilePath);
+        owned->reader->asyncDestroy(&owned->async);
+        return;
+      }
+      owned->async->uploadImages();
+      owned->reader->asyncDestroy(&owned->async);
+
+      vLogTextureLoaded(owned->szFilePath, owned->poTexture,
+                        owned->loadStart);
+    });
+  });
+  js.run(job);
 
   return texture;
 }
@@ -128,6 +343,9 @@ Resource<filament::Texture*> TextureLoader::loadTexture(
 filament::Texture* TextureLoader::loadTextureFromStream(
     const std::string& file_path,
     const TextureDefinitions::TextureType type) {
+  if (std::filesystem::path(file_path).extension() == ".ktx2") {
+    return createTextureFromKtx2(file_path, type);
+  }
   return createTextureFromImage(file_path, type);
 }
 
@@ -18,7 +18,9 @@
 #include <core/include/resource.h>
 #include <core/scene/material/texture/texture_definitions.h>
 #include <filament/Texture.h>
+#include <cstdint>
 #include <future>
+#include <map>
 
 namespace plugin_filament_view {
 
@@ -32,15 +34,41 @@ class TextureLoader {
   static Resource<::filament::Texture*> loadTexture(
       const TextureDefinitions* texture);
 
+  // Rough GPU footprint including the mip chain.
+  static size_t nEstimateTextureBytes(const ::filament::Texture* texture);
+
+  // Call before destroying a texture; an upload still on its way to it is
+  // skipped instead of touching the freed texture. Strand only.
+  static void vCancelPendingUpload(const ::filament::Texture* texture);
+
   // Disallow copy and assign.
   TextureLoader(const TextureLoader&) = delete;
   TextureLoader& operator=(const TextureLoader&) = delete;
 
  private:
+  // Registers an upload for texture and returns the token its job carries.
+  static uint64_t nBeginUpload(const ::filament::Texture* texture);
+  // False if the upload was cancelled; the texture may be gone then.
+  static bool bEndUpload(const ::filament::Texture* texture, uint64_t token);
+
+  // Textures with an upload in flight. The token guards against a new
+  // texture reusing a destroyed one's address. Only touched on the strand.
+  static std::map<const ::filament::Texture*, uint64_t> m_mapPendingUploads;
+  static uint64_t m_nNextUploadToken;
+
+  // PNG / JPEG. The texture is created right away with a full mip chain;
+  // decoding runs on the JobSystem and the upload is posted back to the
+  // Filament API thread.
   static ::filament::Texture* createTextureFromImage(
       const std::string& file_path,
       const TextureDefinitions::TextureType type);
 
+  // KTX2 / Basis Universal, transcoded off the API thread to the best
+  // compressed format the backend supports. Mips come from the file.
+  static ::filament::Texture* createTextureFromKtx2(
+      const std::string& file_path,
+      const TextureDefinitions::TextureType type);
+
   static ::filament::Texture* loadTextureFromStream(
       const std::string& file_path,
       const TextureDefinitions::TextureType type);
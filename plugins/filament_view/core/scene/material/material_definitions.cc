@@ -20,6 +20,8 @@
 #include <filament/TextureSampler.h>
 #include <plugins/common/common.h>
 #include <filesystem>
+#include <iomanip>
+#include <sstream>
 
 namespace plugin_filament_view {
 
@@ -108,6 +110,37 @@ std::string MaterialDefinitions::szGetMaterialDefinitionLookupName() const {
   return "Unknown";
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+std::string MaterialDefinitions::szGetInstanceKey() const {
+  std::ostringstream key;
+  key << std::setprecision(9) << szGetMaterialDefinitionLookupName();
+
+  // parameters_ is ordered by name, so equal definitions give equal keys.
+  for (const auto& [name, parameter] : parameters_) {
+    if (parameter == nullptr) {
+      continue;
+    }
+    key << '|' << name << ':' << static_cast<int>(parameter->type_) << ':';
+    if (parameter->fValue_.has_value()) {
+      key << parameter->fValue_.value();
+    } else if (parameter->colorValue_.has_value()) {
+      const auto& color = parameter->colorValue_.value();
+      key << color.r << ',' << color.g << ',' << color.b << ',' << color.a;
+    } else if (parameter->textureValue_.has_value()) {
+      key << parameter->getTextureValueAssetPath();
+      if (const auto* sampler = parameter->getTextureSampler()) {
+        key << ',' << static_cast<int>(sampler->getMinFilter()) << ','
+            << static_cast<int>(sampler->getMagFilter()) << ','
+            << static_cast<int>(sampler->getWrapModeS()) << ','
+            << static_cast<int>(sampler->getWrapModeT()) << ','
+            << static_cast<int>(sampler->getWrapModeR()) << ','
+            << sampler->getAnisotropy();
+      }
+    }
+  }
+  return key.str();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 std::vector<MaterialParameter*>
 MaterialDefinitions::vecGetTextureMaterialParameters() const {
@@ -177,7 +210,8 @@ void MaterialDefinitions::vSetMaterialInstancePropertiesFromMyPropertyMap(
           // texturedefinitions->texture_sampler
           const auto textureSampler = iter->second->getTextureSampler();
 
-          filament::TextureSampler sampler(MinFilter::LINEAR,
+          // Loaded textures carry a full mip chain, so use it by default.
+          filament::TextureSampler sampler(MinFilter::LINEAR_MIPMAP_LINEAR,
                                            MagFilter::LINEAR);
 
           if (textureSampler != nullptr) {
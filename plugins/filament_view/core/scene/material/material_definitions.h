@@ -49,6 +49,10 @@ class MaterialDefinitions {
   // looking for which is valid. Used to see if we have this loaded in cache.
   [[nodiscard]] std::string szGetMaterialDefinitionLookupName() const;
 
+  // Material plus every parameter value; definitions with equal keys produce
+  // identical material instances.
+  [[nodiscard]] std::string szGetInstanceKey() const;
+
   // This will go through each of the parameters and return only the
   // texture_(definitions) so the material manager can load what's not already
   // loaded.
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "quality_governor.h"
+
+#include <filament/Renderer.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////
+const char* QualityGovernor::szGetFeatureName(const Feature eFeature) {
+  switch (eFeature) {
+    case Feature::DynamicResolution:
+      return "dynamicResolution";
+    case Feature::Bloom:
+      return "bloom";
+    case Feature::AmbientOcclusion:
+      return "ambientOcclusion";
+    case Feature::Msaa:
+      return "msaa";
+    case Feature::ShadowQuality:
+      return "shadowQuality";
+    case Feature::Shadows:
+      return "shadows";
+    case Feature::Count:
+      break;
+  }
+  return "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<QualityGovernor::Feature> QualityGovernor::oFeatureFromName(
+    const std::string& szName) {
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Feature::Count); ++i) {
+    if (szName == szGetFeatureName(static_cast<Feature>(i))) {
+      return static_cast<Feature>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vConfigure(const Config& config) {
+  vRestoreAll();
+
+  m_oConfig = config;
+  m_oConfig.fTargetFps = std::max(m_oConfig.fTargetFps, 1.0f);
+  m_fFrameMilliseconds = 0.0f;
+  m_nOverBudgetFrames = 0;
+  m_nUnderBudgetFrames = 0;
+
+  spdlog::debug("QualityGovernor: {} at {:.0f} fps, pinned mask {:#x}",
+                m_oConfig.bEnabled ? "enabled" : "disabled",
+                m_oConfig.fTargetFps, m_oConfig.nPinnedMask);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vOnSettingsChanged() {
+  m_lstDegraded.clear();
+  m_nOverBudgetFrames = 0;
+  m_nUnderBudgetFrames = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vOnFrame(const float fCpuMilliseconds,
+                               filament::Renderer* poRenderer) {
+  if (!m_oConfig.bEnabled) {
+    return;
+  }
+
+  // GPU time lags a few frames behind and is missing on backends without
+  // timer queries; CPU time alone is used then.
+  float fFrameMilliseconds = fCpuMilliseconds;
+  if (poRenderer != nullptr) {
+    if (const auto history = poRenderer->getFrameInfoHistory(1);
+        !history.empty() && history[0].denoisedGpuFrameDuration > 0) {
+      fFrameMilliseconds = std::max(
+          fFrameMilliseconds,
+          static_cast<float>(history[0].denoisedGpuFrameDuration) / 1.0e6f);
+    }
+  }
+
+  m_fFrameMilliseconds =
+      m_fFrameMilliseconds == 0.0f
+          ? fFrameMilliseconds
+          : m_fFrameMilliseconds +
+                (fFrameMilliseconds - m_fFrameMilliseconds) * kSmoothing;
+
+  const float fBudget = fBudgetMilliseconds();
+  if (m_fFrameMilliseconds > fBudget * kDegradeRatio) {
+    m_nUnderBudgetFrames = 0;
+    if (++m_nOverBudgetFrames >= kDegradeFrames) {
+      vDegradeNext();
+      m_nOverBudgetFrames = 0;
+    }
+  } else if (m_fFrameMilliseconds < fBudget * kUpgradeRatio) {
+    m_nOverBudgetFrames = 0;
+    if (++m_nUnderBudgetFrames >= kUpgradeFrames) {
+      vRestoreLast();
+      m_nUnderBudgetFrames = 0;
+    }
+  } else {
+    m_nOverBudgetFrames = 0;
+    m_nUnderBudgetFrames = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vDegradeNext() {
+  for (uint8_t i = 0; i < static_cast<uint8_t>(Feature::Count); ++i) {
+    const auto eFeature = static_cast<Feature>(i);
+    if (bIsPinned(eFeature) ||
+        std::find(m_lstDegraded.begin(), m_lstDegraded.end(), eFeature) !=
+            m_lstDegraded.end()) {
+      continue;
+    }
+    vApply(eFeature, true);
+    m_lstDegraded.push_back(eFeature);
+    vReport(eFeature, true);
+    return;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vRestoreLast() {
+  if (m_lstDegraded.empty()) {
+    return;
+  }
+  const auto eFeature = m_lstDegraded.back();
+  m_lstDegraded.pop_back();
+  vApply(eFeature, false);
+  vReport(eFeature, false);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vRestoreAll() {
+  while (!m_lstDegraded.empty()) {
+    vRestoreLast();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vApply(const Feature eFeature, const bool bDegrade) {
+  switch (eFeature) {
+    case Feature::DynamicResolution:
+      if (bDegrade) {
+        m_oSavedDynamicResolution = m_poView->getDynamicResolutionOptions();
+        auto options = m_oSavedDynamicResolution;
+        options.enabled = true;
+        options.minScale = {kMinDynamicResolutionScale};
+        options.quality = filament::View::QualityLevel::LOW;
+        m_poView->setDynamicResolutionOptions(options);
+      } else {
+        m_poView->setDynamicResolutionOptions(m_oSavedDynamicResolution);
+      }
+      break;
+    case Feature::Bloom:
+      if (bDegrade) {
+        m_oSavedBloom = m_poView->getBloomOptions();
+        auto options = m_oSavedBloom;
+        options.enabled = false;
+        m_poView->setBloomOptions(options);
+      } else {
+        m_poView->setBloomOptions(m_oSavedBloom);
+      }
+      break;
+    case Feature::AmbientOcclusion:
+      if (bDegrade) {
+        m_oSavedAmbientOcclusion = m_poView->getAmbientOcclusionOptions();
+        auto options = m_oSavedAmbientOcclusion;
+        options.enabled = false;
+        m_poView->setAmbientOcclusionOptions(options);
+      } else {
+        m_poView->setAmbientOcclusionOptions(m_oSavedAmbientOcclusion);
+      }
+      break;
+    case Feature::Msaa:
+      if (bDegrade) {
+        m_oSavedMsaa = m_poView->getMultiSampleAntiAliasingOptions();
+        auto options = m_oSavedMsaa;
+        options.enabled = false;
+        m_poView->setMultiSampleAntiAliasingOptions(options);
+      } else {
+        m_poView->setMultiSampleAntiAliasingOptions(m_oSavedMsaa);
+      }
+      break;
+    case Feature::ShadowQuality:
+      if (bDegrade) {
+        m_eSavedShadowType = m_poView->getShadowType();
+        m_poView->setShadowType(filament::View::ShadowType::PCF);
+      } else {
+        m_poView->setShadowType(m_eSavedShadowType);
+      }
+      break;
+    case Feature::Shadows:
+      if (bDegrade) {
+        m_bSavedShadowing = m_poView->isShadowingEnabled();
+        m_poView->setShadowingEnabled(false);
+      } else {
+        m_poView->setShadowingEnabled(m_bSavedShadowing);
+      }
+      break;
+    case Feature::Count:
+      break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void QualityGovernor::vReport(const Feature eFeature,
+                              const bool bDegraded) const {
+  spdlog::info("QualityGovernor: {} {} at {:.1f} ms (budget {:.1f} ms)",
+               bDegraded ? "dropped" : "restored", szGetFeatureName(eFeature),
+               m_fFrameMilliseconds, fBudgetMilliseconds());
+  if (m_fnOnDecision) {
+    m_fnOnDecision({eFeature, bDegraded, m_lstDegraded.size(),
+                    m_fFrameMilliseconds, fBudgetMilliseconds()});
+  }
+}
+
+}  // namespace plugin_filament_view
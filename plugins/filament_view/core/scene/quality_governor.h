@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <filament/View.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace filament {
+class Renderer;
+}
+
+namespace plugin_filament_view {
+
+// Trades render quality for frame time when frames run over budget, and
+// gives it back once they are comfortably under. Off until configured.
+//
+// Features are given up one at a time in Feature order, cheapest visual
+// loss first, and restored in reverse. A pinned feature is left as the
+// app set it. Filament's dynamic resolution follows GPU time by itself
+// once it knows the target rate; the first step only lets it scale lower.
+// The target rate is set on the shared renderer by FilamentSystem, the
+// governor only changes its own view.
+class QualityGovernor {
+ public:
+  enum class Feature : uint8_t {
+    DynamicResolution,
+    Bloom,
+    AmbientOcclusion,
+    Msaa,
+    ShadowQuality,
+    Shadows,
+    Count
+  };
+
+  struct Config {
+    bool bEnabled = false;
+    float fTargetFps = 60.0f;
+    // One bit per Feature.
+    uint32_t nPinnedMask = 0;
+  };
+
+  struct Decision {
+    Feature eFeature;
+    // False when the feature was restored.
+    bool bDegraded;
+    // Features given up after this decision.
+    size_t nLevel;
+    float fFrameMilliseconds;
+    float fBudgetMilliseconds;
+  };
+
+  explicit QualityGovernor(filament::View* poView) : m_poView(poView) {}
+
+  // Disallow copy and assign.
+  QualityGovernor(const QualityGovernor&) = delete;
+  QualityGovernor& operator=(const QualityGovernor&) = delete;
+
+  // Restores everything given up so far before taking the new config.
+  void vConfigure(const Config& config);
+
+  // Call after a quality preset was applied; the preset replaced whatever
+  // the governor had changed, so it starts over from there.
+  void vOnSettingsChanged();
+
+  // Once per rendered frame, after endFrame.
+  void vOnFrame(float fCpuMilliseconds, filament::Renderer* poRenderer);
+
+  void vSetDecisionCallback(std::function<void(const Decision&)> callback) {
+    m_fnOnDecision = std::move(callback);
+  }
+
+  static const char* szGetFeatureName(Feature eFeature);
+  static std::optional<Feature> oFeatureFromName(const std::string& szName);
+
+ private:
+  // Over budget by this much for kDegradeFrames frames gives a feature up,
+  // under it by this much for kUpgradeFrames restores one. The gap and
+  // the longer restore wait keep it from flapping.
+  static constexpr float kDegradeRatio = 1.1f;
+  static constexpr float kUpgradeRatio = 0.75f;
+  static constexpr int kDegradeFrames = 30;
+  static constexpr int kUpgradeFrames = 180;
+  // Weight of the newest frame in the running frame time.
+  static constexpr float kSmoothing = 0.1f;
+  static constexpr float kMinDynamicResolutionScale = 0.5f;
+
+  [[nodiscard]] float fBudgetMilliseconds() const {
+    return 1000.0f / m_oConfig.fTargetFps;
+  }
+  [[nodiscard]] bool bIsPinned(Feature eFeature) const {
+    return (m_oConfig.nPinnedMask & (1u << static_cast<uint32_t>(eFeature))) !=
+           0;
+  }
+
+  void vDegradeNext();
+  void vRestoreLast();
+  void vRestoreAll();
+  void vApply(Feature eFeature, bool bDegrade);
+  void vReport(Feature eFeature, bool bDegraded) const;
+
+  filament::View* m_poView;
+  Config m_oConfig;
+  float m_fFrameMilliseconds = 0.0f;
+  int m_nOverBudgetFrames = 0;
+  int m_nUnderBudgetFrames = 0;
+
+  // Given up, in order, and what each was before.
+  std::vector<Feature> m_lstDegraded;
+  filament::View::DynamicResolutionOptions m_oSavedDynamicResolution;
+  filament::View::BloomOptions m_oSavedBloom;
+  filament::View::AmbientOcclusionOptions m_oSavedAmbientOcclusion;
+  filament::View::MultiSampleAntiAliasingOptions m_oSavedMsaa;
+  filament::View::ShadowType m_eSavedShadowType =
+      filament::View::ShadowType::PCF;
+  bool m_bSavedShadowing = true;
+
+  std::function<void(const Decision&)> m_fnOnDecision;
+};
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,637 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "binary_scene.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <utility>
+
+#include <plugins/common/common.h>
+
+namespace plugin_filament_view {
+
+namespace {
+
+constexpr uint32_t kTagTypeMask = 0xff;
+constexpr uint32_t kTagBoolShift = 8;
+
+uint32_t nAlign(const uint32_t offset, const uint32_t alignment) {
+  return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+// Writes children before their parent, so every offset a node stores is
+// already known when the node itself is written.
+class Encoder {
+ public:
+  std::vector<uint8_t> vecFinish(const flutter::EncodableValue& root) {
+    m_vecOut.resize(sizeof(uint32_t) * 4);
+    const uint32_t rootOffset = nWrite(root);
+    if (m_bFailed) {
+      return {};
+    }
+
+    const uint32_t magic = BinaryScene::kMagic;
+    const uint16_t version = BinaryScene::kVersion;
+    const uint16_t flags = 0;
+    const auto size = static_cast<uint32_t>(m_vecOut.size());
+    std::memcpy(m_vecOut.data(), &magic, 4);
+    std::memcpy(m_vecOut.data() + 4, &version, 2);
+    std::memcpy(m_vecOut.data() + 6, &flags, 2);
+    std::memcpy(m_vecOut.data() + 8, &rootOffset, 4);
+    std::memcpy(m_vecOut.data() + 12, &size, 4);
+    return std::move(m_vecOut);
+  }
+
+ private:
+  std::vector<uint8_t> m_vecOut;
+  // Map keys repeat across every entity, each is stored once.
+  std::map<std::string, uint32_t, std::less<>> m_mapStrings;
+  bool m_bFailed = false;
+
+  uint32_t nBegin(BinaryScene::Type type, const uint32_t extra = 0) {
+    m_vecOut.resize(nAlign(static_cast<uint32_t>(m_vecOut.size()), 4));
+    const auto offset = static_cast<uint32_t>(m_vecOut.size());
+    vPut(static_cast<uint32_t>(type) | extra);
+    return offset;
+  }
+
+  template <typename T>
+  void vPut(const T& value) {
+    const size_t at = m_vecOut.size();
+    m_vecOut.resize(at + sizeof(T));
+    std::memcpy(m_vecOut.data() + at, &value, sizeof(T));
+  }
+
+  uint32_t nWriteString(const std::string& value) {
+    if (const auto it = m_mapStrings.find(value); it != m_mapStrings.end()) {
+      return it->second;
+    }
+    const uint32_t offset = nBegin(BinaryScene::Type::String);
+    vPut(static_cast<uint32_t>(value.size()));
+    m_vecOut.insert(m_vecOut.end(), value.begin(), value.end());
+    m_vecOut.push_back(0);
+    m_mapStrings.emplace(value, offset);
+    return offset;
+  }
+
+  template <typename T>
+  uint32_t nWriteVector(BinaryScene::Type type, const std::vector<T>& values) {
+    const uint32_t offset = nBegin(type);
+    vPut(static_cast<uint32_t>(values.size()));
+    m_vecOut.resize(nAlign(static_cast<uint32_t>(m_vecOut.size()), sizeof(T)));
+    const size_t at = m_vecOut.size();
+    m_vecOut.resize(at + values.size() * sizeof(T));
+    if (!values.empty()) {
+      std::memcpy(m_vecOut.data() + at, values.data(),
+                  values.size() * sizeof(T));
+    }
+    return offset;
+  }
+
+  uint32_t nWrite(const flutter::EncodableValue& value) {
+    using Type = BinaryScene::Type;
+
+    if (value.IsNull()) {
+      return nBegin(Type::Null);
+    }
+    if (const auto* v = std::get_if<bool>(&value)) {
+      return nBegin(Type::Bool, (*v ? 1u : 0u) << kTagBoolShift);
+    }
+    if (const auto* v = std::get_if<int32_t>(&value)) {
+      const uint32_t offset = nBegin(Type::Int32);
+      vPut(*v);
+      return offset;
+    }
+    if (const auto* v = std::get_if<int64_t>(&value)) {
+      const uint32_t offset = nBegin(Type::Int64);
+      vPut(*v);
+      return offset;
+    }
+    if (const auto* v = std::get_if<double>(&value)) {
+      const uint32_t offset = nBegin(Type::Double);
+      vPut(*v);
+      return offset;
+    }
+    if (const auto* v = std::get_if<std::string>(&value)) {
+      return nWriteString(*v);
+    }
+    if (const auto* v = std::get_if<std::vector<uint8_t>>(&value)) {
+      return nWriteVector(Type::Uint8List, *v);
+    }
+    if (const auto* v = std::get_if<std::vector<int32_t>>(&value)) {
+      return nWriteVector(Type::Int32List, *v);
+    }
+    if (const auto* v = std::get_if<std::vector<int64_t>>(&value)) {
+      return nWriteVector(Type::Int64List, *v);
+    }
+    if (const auto* v = std::get_if<std::vector<float>>(&value)) {
+      return nWriteVector(Type::Float32List, *v);
+    }
+    if (const auto* v = std::get_if<std::vector<double>>(&value)) {
+      return nWriteVector(Type::Float64List, *v);
+    }
+    if (const auto* v = std::get_if<flutter::EncodableList>(&value)) {
+      std::vector<uint32_t> items;
+      items.reserve(v->size());
+      for (const auto& item : *v) {
+        items.push_back(nWrite(item));
+      }
+      const uint32_t offset = nBegin(Type::List);
+      vPut(static_cast<uint32_t>(items.size()));
+      for (const auto item : items) {
+        vPut(item);
+      }
+      return offset;
+    }
+    if (const auto* v = std::get_if<flutter::EncodableMap>(&value)) {
+      std::vector<std::pair<const std::string*, uint32_t>> entries;
+      entries.reserve(v->size());
+      for (const auto& [key, entry] : *v) {
+        const auto* szKey = std::get_if<std::string>(&key);
+        if (szKey == nullptr) {
+          spdlog::error("BinaryScene: map keys must be strings");
+          m_bFailed = true;
+          return 0;
+        }
+        entries.emplace_back(szKey, nWrite(entry));
+      }
+      std::sort(entries.begin(), entries.end(),
+                [](const auto& a, const auto& b) {
+                  return *a.first < *b.first;
+                });
+
+      std::vector<uint32_t> keys;
+      keys.reserve(entries.size());
+      for (const auto& [szKey, _] : entries) {
+        keys.push_back(nWriteString(*szKey));
+      }
+      const uint32_t offset = nBegin(Type::Map);
+      vPut(static_cast<uint32_t>(entries.size()));
+      for (size_t i = 0; i < entries.size(); ++i) {
+        vPut(keys[i]);
+        vPut(entries[i].second);
+      }
+      return offset;
+    }
+
+    spdlog::error("BinaryScene: custom encodable values can't be converted");
+    m_bFailed = true;
+    return 0;
+  }
+};
+
+size_t nElementSize(const BinaryScene::Type type) {
+  switch (type) {
+    case BinaryScene::Type::Uint8List:
+      return 1;
+    case BinaryScene::Type::Int32List:
+    case BinaryScene::Type::Float32List:
+      return 4;
+    case BinaryScene::Type::Int64List:
+    case BinaryScene::Type::Float64List:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+std::vector<T> vecCopy(const uint8_t* data, const size_t count) {
+  std::vector<T> values(count);
+  if (count != 0) {
+    std::memcpy(values.data(), data, count * sizeof(T));
+  }
+  return values;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::View::bRead(const uint32_t offset,
+                              void* out,
+                              const size_t bytes) const {
+  if (m_pData == nullptr || offset > m_nSize || m_nSize - offset < bytes) {
+    return false;
+  }
+  std::memcpy(out, m_pData + offset, bytes);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+uint32_t BinaryScene::View::nReadU32(const uint32_t offset) const {
+  uint32_t value = 0;
+  return bRead(offset, &value, sizeof(value)) ? value : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::View::oAt(const uint32_t offset) const {
+  // Offsets only ever point at 4 byte aligned values past the header.
+  if (offset < sizeof(Header) || (offset & 3) != 0 || offset >= m_nSize) {
+    return {};
+  }
+  return {m_pData, m_nSize, offset};
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::View::oChild(const uint32_t offset) const {
+  // Children are always written before their parent. Holding a corrupt file
+  // to that keeps a cycle from recursing forever in oToEncodable.
+  if (offset >= m_nOffset) {
+    return {};
+  }
+  return oAt(offset);
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::Type BinaryScene::View::eGetType() const {
+  if (m_pData == nullptr) {
+    return Type::Null;
+  }
+  const uint32_t type = nReadU32(m_nOffset) & kTagTypeMask;
+  if (type > static_cast<uint32_t>(Type::Float64List)) {
+    return Type::Null;
+  }
+  return static_cast<Type>(type);
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<bool> BinaryScene::View::obGetBool() const {
+  if (eGetType() != Type::Bool) {
+    return std::nullopt;
+  }
+  return ((nReadU32(m_nOffset) >> kTagBoolShift) & 1) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<int64_t> BinaryScene::View::onGetInt() const {
+  if (const auto type = eGetType(); type == Type::Int32) {
+    int32_t value = 0;
+    if (bRead(m_nOffset + 4, &value, sizeof(value))) {
+      return value;
+    }
+  } else if (type == Type::Int64) {
+    int64_t value = 0;
+    if (bRead(m_nOffset + 4, &value, sizeof(value))) {
+      return value;
+    }
+  }
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<double> BinaryScene::View::ofGetDouble() const {
+  if (eGetType() == Type::Double) {
+    double value = 0;
+    if (bRead(m_nOffset + 4, &value, sizeof(value))) {
+      return value;
+    }
+    return std::nullopt;
+  }
+  if (const auto value = onGetInt()) {
+    return static_cast<double>(*value);
+  }
+  return std::nullopt;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<std::string_view> BinaryScene::View::oszGetString() const {
+  if (eGetType() != Type::String) {
+    return std::nullopt;
+  }
+  uint32_t length = 0;
+  if (!bRead(m_nOffset + 4, &length, sizeof(length)) ||
+      m_nSize - (m_nOffset + 8) < length) {
+    return std::nullopt;
+  }
+  return std::string_view(reinterpret_cast<const char*>(m_pData) + m_nOffset +
+                              8,
+                          length);
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t BinaryScene::View::nGetSize() const {
+  size_t entrySize = 0;
+  switch (const auto type = eGetType()) {
+    case Type::List:
+      entrySize = sizeof(uint32_t);
+      break;
+    case Type::Map:
+      entrySize = sizeof(uint32_t) * 2;
+      break;
+    default:
+      entrySize = nElementSize(type);
+      break;
+  }
+  if (entrySize == 0) {
+    return 0;
+  }
+
+  // A count that can't fit in the rest of the buffer reads as empty, so a
+  // corrupt file never drives a huge loop or allocation.
+  const size_t count = nReadU32(m_nOffset + 4);
+  const size_t start = m_nOffset + 8;
+  if (start > m_nSize || (m_nSize - start) / entrySize < count) {
+    return 0;
+  }
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::View::oGetListItem(const size_t nIndex) const {
+  if (eGetType() != Type::List || nIndex >= nGetSize()) {
+    return {};
+  }
+  return oChild(nReadU32(m_nOffset + 8 + static_cast<uint32_t>(nIndex) * 4));
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::string_view BinaryScene::View::szGetMapKey(const size_t nIndex) const {
+  if (eGetType() != Type::Map || nIndex >= nGetSize()) {
+    return {};
+  }
+  const auto key =
+      oChild(nReadU32(m_nOffset + 8 + static_cast<uint32_t>(nIndex) * 8));
+  return key.oszGetString().value_or(std::string_view());
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::View::oGetMapValue(const size_t nIndex) const {
+  if (eGetType() != Type::Map || nIndex >= nGetSize()) {
+    return {};
+  }
+  return oChild(nReadU32(m_nOffset + 12 + static_cast<uint32_t>(nIndex) * 8));
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::View::oFind(const std::string_view szKey) const {
+  size_t low = 0;
+  size_t high = nGetSize();
+  while (low < high) {
+    const size_t mid = low + (high - low) / 2;
+    const int compare = szGetMapKey(mid).compare(szKey);
+    if (compare == 0) {
+      return oGetMapValue(mid);
+    }
+    if (compare < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return {};
+}
+
+////////////////////////////////////////////////////////////////////////////
+uint32_t BinaryScene::View::nVectorData(const size_t elementSize) const {
+  const uint32_t data =
+      nAlign(m_nOffset + 8, static_cast<uint32_t>(elementSize));
+  const size_t count = nGetSize();
+  if (data > m_nSize || (m_nSize - data) / elementSize < count) {
+    return 0;
+  }
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////////////
+flutter::EncodableValue BinaryScene::View::oToEncodable() const {
+  switch (const auto type = eGetType()) {
+    case Type::Null:
+      return {};
+    case Type::Bool:
+      return flutter::EncodableValue(obGetBool().value_or(false));
+    case Type::Int32:
+      return flutter::EncodableValue(
+          static_cast<int32_t>(onGetInt().value_or(0)));
+    case Type::Int64:
+      return flutter::EncodableValue(onGetInt().value_or(0));
+    case Type::Double:
+      return flutter::EncodableValue(ofGetDouble().value_or(0.0));
+    case Type::String:
+      return flutter::EncodableValue(
+          std::string(oszGetString().value_or(std::string_view())));
+    case Type::List: {
+      flutter::EncodableList list;
+      const size_t count = nGetSize();
+      list.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        list.emplace_back(oGetListItem(i).oToEncodable());
+      }
+      return flutter::EncodableValue(std::move(list));
+    }
+    case Type::Map: {
+      flutter::EncodableMap map;
+      const size_t count = nGetSize();
+      // Keys are stored sorted, so every insert lands at the end.
+      for (size_t i = 0; i < count; ++i) {
+        map.emplace_hint(map.end(),
+                         flutter::EncodableValue(std::string(szGetMapKey(i))),
+                         oGetMapValue(i).oToEncodable());
+      }
+      return flutter::EncodableValue(std::move(map));
+    }
+    case Type::Uint8List:
+    case Type::Int32List:
+    case Type::Int64List:
+    case Type::Float32List:
+    case Type::Float64List: {
+      const uint32_t data = nVectorData(nElementSize(type));
+      const size_t count = data == 0 ? 0 : nGetSize();
+      const uint8_t* bytes = m_pData + data;
+      if (type == Type::Uint8List) {
+        return flutter::EncodableValue(vecCopy<uint8_t>(bytes, count));
+      }
+      if (type == Type::Int32List) {
+        return flutter::EncodableValue(vecCopy<int32_t>(bytes, count));
+      }
+      if (type == Type::Int64List) {
+        return flutter::EncodableValue(vecCopy<int64_t>(bytes, count));
+      }
+      if (type == Type::Float32List) {
+        return flutter::EncodableValue(vecCopy<float>(bytes, count));
+      }
+      return flutter::EncodableValue(vecCopy<double>(bytes, count));
+    }
+  }
+  return {};
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::~BinaryScene() {
+  vClose();
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::BinaryScene(BinaryScene&& other) noexcept {
+  *this = std::move(other);
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene& BinaryScene::operator=(BinaryScene&& other) noexcept {
+  if (this != &other) {
+    vClose();
+    m_pData = std::exchange(other.m_pData, nullptr);
+    m_nSize = std::exchange(other.m_nSize, 0);
+    m_bMapped = std::exchange(other.m_bMapped, false);
+  }
+  return *this;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void BinaryScene::vClose() {
+  if (m_bMapped && m_pData != nullptr) {
+    munmap(const_cast<uint8_t*>(m_pData), m_nSize);
+  }
+  m_pData = nullptr;
+  m_nSize = 0;
+  m_bMapped = false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::bHasMagic(const uint8_t* data, const size_t size) {
+  uint32_t magic = 0;
+  if (data == nullptr || size < sizeof(Header)) {
+    return false;
+  }
+  std::memcpy(&magic, data, sizeof(magic));
+  return magic == kMagic;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::bValidate(const uint8_t* data, const size_t size) {
+  if (!bHasMagic(data, size)) {
+    spdlog::error("BinaryScene: not a binary scene");
+    return false;
+  }
+
+  Header header{};
+  std::memcpy(&header, data, sizeof(header));
+  if (header.nVersion == 0 || header.nVersion > kVersion) {
+    spdlog::error("BinaryScene: version {} is not supported (max {})",
+                  header.nVersion, kVersion);
+    return false;
+  }
+  if (header.nByteSize != size || header.nRootOffset < sizeof(Header) ||
+      header.nRootOffset >= size || (header.nRootOffset & 3) != 0) {
+    spdlog::error("BinaryScene: truncated or corrupt header");
+    return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::bOpenFile(const std::string& szPath) {
+  vClose();
+
+  const int fd = open(szPath.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st {};
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    spdlog::error("BinaryScene: unable to open {}", szPath);
+    return false;
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    spdlog::error("BinaryScene: unable to map {}", szPath);
+    return false;
+  }
+
+  const auto* data = static_cast<const uint8_t*>(mapped);
+  if (!bValidate(data, size)) {
+    munmap(mapped, size);
+    return false;
+  }
+
+  // Lookups jump around the file, read it all in up front.
+  madvise(mapped, size, MADV_WILLNEED);
+  m_pData = data;
+  m_nSize = size;
+  m_bMapped = true;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::bBorrowBuffer(const uint8_t* data, const size_t size) {
+  vClose();
+  if (!bValidate(data, size)) {
+    return false;
+  }
+  m_pData = data;
+  m_nSize = size;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+BinaryScene::View BinaryScene::oGetRoot() const {
+  if (m_pData == nullptr) {
+    return {};
+  }
+  Header header{};
+  std::memcpy(&header, m_pData, sizeof(header));
+  return View(m_pData, m_nSize, 0).oAt(header.nRootOffset);
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<uint8_t> BinaryScene::vecEncode(
+    const flutter::EncodableValue& value) {
+  return Encoder().vecFinish(value);
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool BinaryScene::bWriteFile(const std::string& szPath,
+                             const flutter::EncodableValue& value) {
+  const auto encoded = vecEncode(value);
+  if (encoded.empty()) {
+    return false;
+  }
+
+  // Written next to the target and renamed, so a reader never maps a
+  // partial file.
+  const std::filesystem::path path(szPath);
+  auto tempPath = path;
+  tempPath += ".tmp";
+  std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(encoded.data()),
+            static_cast<std::streamsize>(encoded.size()));
+  out.close();
+
+  std::error_code error;
+  if (!out) {
+    std::filesystem::remove(tempPath, error);
+    spdlog::error("BinaryScene: unable to write {}", szPath);
+    return false;
+  }
+  std::filesystem::rename(tempPath, path, error);
+  if (error) {
+    spdlog::error("BinaryScene: unable to write {}: {}", szPath,
+                  error.message());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace plugin_filament_view
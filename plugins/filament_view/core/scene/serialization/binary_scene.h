@@ -0,0 +1,157 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <encodable_value.h>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Versioned binary form of the scene creation params, read in place.
+//
+// The file holds the same tree as the StandardMessageCodec map (so anything
+// Dart can put in creation params can be converted), laid out so it can be
+// walked straight out of an mmap without decoding:
+//
+//   header   "FVSB" | u16 version | u16 flags | u32 root offset | u32 size
+//   value    u32 tag (type in the low byte, bool in the next) + payload
+//   string   u32 length | bytes | NUL
+//   list     u32 count | count x u32 value offset
+//   map      u32 count | count x (u32 key offset, u32 value offset), sorted
+//            by key so lookups are a binary search
+//   vectors  u32 count | pad to the element size | elements
+//
+// Every offset is from the start of the buffer and 4 byte aligned, and a
+// child always sits before its parent. The reader bounds checks each
+// access, a malformed file reads as nulls.
+class BinaryScene {
+ public:
+  static constexpr uint32_t kMagic = 0x42535646;  // "FVSB" little endian
+  static constexpr uint16_t kVersion = 1;
+
+  enum class Type : uint8_t {
+    Null = 0,
+    Bool,
+    Int32,
+    Int64,
+    Double,
+    String,
+    List,
+    Map,
+    Uint8List,
+    Int32List,
+    Int64List,
+    Float32List,
+    Float64List,
+  };
+
+  // A non owning handle to one value inside the buffer; cheap to copy.
+  class View {
+   public:
+    View() = default;
+
+    [[nodiscard]] Type eGetType() const;
+    [[nodiscard]] bool bIsNull() const { return eGetType() == Type::Null; }
+
+    [[nodiscard]] std::optional<bool> obGetBool() const;
+    // Int32 and Int64 both widen, like Deserialize does for numbers.
+    [[nodiscard]] std::optional<int64_t> onGetInt() const;
+    [[nodiscard]] std::optional<double> ofGetDouble() const;
+    // Points into the buffer.
+    [[nodiscard]] std::optional<std::string_view> oszGetString() const;
+
+    // Element count for lists, maps and vectors, 0 otherwise.
+    [[nodiscard]] size_t nGetSize() const;
+    [[nodiscard]] View oGetListItem(size_t nIndex) const;
+    [[nodiscard]] std::string_view szGetMapKey(size_t nIndex) const;
+    [[nodiscard]] View oGetMapValue(size_t nIndex) const;
+    // Null view when the key is missing.
+    [[nodiscard]] View oFind(std::string_view szKey) const;
+
+    // Copies this subtree into the codec representation, for code that
+    // still takes flutter::EncodableMap.
+    [[nodiscard]] flutter::EncodableValue oToEncodable() const;
+
+   private:
+    friend class BinaryScene;
+    View(const uint8_t* data, size_t size, uint32_t offset)
+        : m_pData(data), m_nSize(size), m_nOffset(offset) {}
+
+    [[nodiscard]] bool bRead(uint32_t offset, void* out, size_t bytes) const;
+    [[nodiscard]] uint32_t nReadU32(uint32_t offset) const;
+    [[nodiscard]] View oAt(uint32_t offset) const;
+    [[nodiscard]] View oChild(uint32_t offset) const;
+    // Start of the payload of a vector type, after count and padding.
+    [[nodiscard]] uint32_t nVectorData(size_t elementSize) const;
+
+    const uint8_t* m_pData = nullptr;
+    size_t m_nSize = 0;
+    uint32_t m_nOffset = 0;
+  };
+
+  // Owns the mapping the views point into, unless the buffer was borrowed.
+  BinaryScene() = default;
+  ~BinaryScene();
+
+  BinaryScene(const BinaryScene&) = delete;
+  BinaryScene& operator=(const BinaryScene&) = delete;
+  BinaryScene(BinaryScene&& other) noexcept;
+  BinaryScene& operator=(BinaryScene&& other) noexcept;
+
+  // Maps the file read only; returns false if it isn't a scene we can read.
+  bool bOpenFile(const std::string& szPath);
+  // Reads the caller's bytes in place, for scenes that arrive through the
+  // platform channel. They must outlive this and every view taken from it.
+  bool bBorrowBuffer(const uint8_t* data, size_t size);
+
+  [[nodiscard]] bool bIsValid() const { return m_pData != nullptr; }
+  [[nodiscard]] size_t nGetByteSize() const { return m_nSize; }
+  [[nodiscard]] View oGetRoot() const;
+
+  // Cheap sniff, used to tell a binary scene apart from codec bytes.
+  static bool bHasMagic(const uint8_t* data, size_t size);
+
+  // Converter from the creation params map. Returns an empty vector if the
+  // tree holds something with no binary form (custom encodable values).
+  static std::vector<uint8_t> vecEncode(const flutter::EncodableValue& value);
+  static bool bWriteFile(const std::string& szPath,
+                         const flutter::EncodableValue& value);
+
+ private:
+  struct Header {
+    uint32_t nMagic;
+    uint16_t nVersion;
+    uint16_t nFlags;
+    uint32_t nRootOffset;
+    uint32_t nByteSize;
+  };
+  static_assert(sizeof(Header) == 16);
+
+  static bool bValidate(const uint8_t* data, size_t size);
+  void vClose();
+
+  const uint8_t* m_pData = nullptr;
+  size_t m_nSize = 0;
+  // Set when m_pData is an mmap, otherwise the bytes are borrowed.
+  bool m_bMapped = false;
+};
+
+}  // namespace plugin_filament_view
@@ -15,17 +15,21 @@
  */
 #include "scene_text_deserializer.h"
 
+#include <core/include/file_utils.h>
 #include <core/include/literals.h>
 #include <core/systems/derived/collision_system.h>
 #include <core/systems/derived/indirect_light_system.h>
 #include <core/systems/derived/light_system.h>
+#include <core/systems/derived/material_system.h>
 #include <core/systems/derived/model_system.h>
+#include <core/systems/derived/scene_snapshot_system.h>
 #include <core/systems/derived/shape_system.h>
 #include <core/systems/derived/skybox_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <core/utils/deserialize.h>
 #include <plugins/common/common.h>
 #include <asio/post.hpp>
+#include <chrono>
 
 #include "shell/platform/common/client_wrapper/include/flutter/standard_message_codec.h"
 
@@ -38,18 +42,70 @@ SceneTextDeserializer::SceneTextDeserializer(
   const std::string& flutterAssetsPath =
       ecsManager->getConfigValue<std::string>(kAssetPath);
 
+  const auto start = std::chrono::steady_clock::now();
+  const bool bBinary = BinaryScene::bHasMagic(params.data(), params.size());
+
   // kick off process...
-  vDeserializeRootLevel(params, flutterAssetsPath);
+  if (bBinary) {
+    BinaryScene binaryScene;
+    if (binaryScene.bBorrowBuffer(params.data(), params.size())) {
+      vDeserializeBinaryRootLevel(binaryScene.oGetRoot(), flutterAssetsPath);
+    }
+  } else {
+    vDeserializeRootLevel(params, flutterAssetsPath);
+  }
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  spdlog::info(
+      "[SceneTextDeserializer] {} params ({} bytes) deserialized in {:.2f} ms, "
+      "{} models, {} shapes",
+      m_bRestoredSnapshot ? "snapshot"
+      : bBinary           ? "binary"
+                          : "codec",
+      params.size(), elapsed.count(), models_.size(), shapes_.size());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
 void SceneTextDeserializer::vDeserializeRootLevel(
     const std::vector<uint8_t>& params,
     const std::string& flutterAssetsPath) {
+  const auto decodeStart = std::chrono::steady_clock::now();
   auto& codec = flutter::StandardMessageCodec::GetInstance();
   const auto decoded = codec.DecodeMessage(params.data(), params.size());
   const auto& creationParams =
       std::get_if<flutter::EncodableMap>(decoded.get());
+  const std::chrono::duration<float, std::milli> decodeTime =
+      std::chrono::steady_clock::now() - decodeStart;
+
+  if (const auto it =
+          creationParams->find(flutter::EncodableValue(kWriteSceneBinary));
+      it != creationParams->end() &&
+      std::holds_alternative<std::string>(it->second)) {
+    vWriteBinaryScene(*creationParams, std::get<std::string>(it->second),
+                      flutterAssetsPath, params.size(), decodeTime.count());
+  }
+
+  if (const auto it =
+          creationParams->find(flutter::EncodableValue(kSceneSnapshot));
+      it != creationParams->end() &&
+      std::holds_alternative<std::string>(it->second)) {
+    m_szSnapshotPath = std::get<std::string>(it->second);
+    m_nSnapshotSourceHash = SceneSnapshotSystem::nHashParams(params);
+    // A scene read from a binary scene file changes with the file too.
+    if (const auto binaryIt =
+            creationParams->find(flutter::EncodableValue(kSceneBinary));
+        binaryIt != creationParams->end() &&
+        std::holds_alternative<std::string>(binaryIt->second)) {
+      m_nSnapshotSourceHash = SceneSnapshotSystem::nHashFile(
+          m_nSnapshotSourceHash,
+          getAbsolutePath(std::get<std::string>(binaryIt->second),
+                          flutterAssetsPath));
+    }
+    if (bRestoreSnapshot(flutterAssetsPath)) {
+      return;
+    }
+  }
 
   for (const auto& [fst, snd] : *creationParams) {
     auto key = std::get<std::string>(fst);
@@ -59,74 +115,126 @@ void SceneTextDeserializer::vDeserializeRootLevel(
       continue;
     }
 
-    if (key == kModel) {
-      spdlog::warn("Loading Single Model - Deprecated Functionality {}", key);
-
-      auto deserializedModel = Model::Deserialize(
-          flutterAssetsPath, std::get<flutter::EncodableMap>(snd));
-      if (deserializedModel == nullptr) {
-        // load fallback
-        auto fallbackToDeserialize =
-            Deserialize::DeserializeParameter(kFallback, snd);
-        deserializedModel = Model::Deserialize(
-            flutterAssetsPath,
-            std::get<flutter::EncodableMap>(fallbackToDeserialize));
+    vDeserializeRootParameter(key, snd, flutterAssetsPath);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vDeserializeRootParameter(
+    const std::string& key,
+    const flutter::EncodableValue& snd,
+    const std::string& flutterAssetsPath) {
+  if (key == kModel) {
+    spdlog::warn("Loading Single Model - Deprecated Functionality {}", key);
+    vAddModel(flutterAssetsPath, snd);
+  } else if (key == kModels &&
+             std::holds_alternative<flutter::EncodableList>(snd)) {
+    SPDLOG_TRACE("Loading Multiple Models {}", key);
+
+    for (const auto& iter : std::get<flutter::EncodableList>(snd)) {
+      if (iter.IsNull()) {
+        spdlog::warn("CreationParamName unable to cast {}", key.c_str());
+        continue;
       }
-      if (deserializedModel == nullptr) {
-        spdlog::error("Unable to load model and fallback model");
+      vAddModel(flutterAssetsPath, iter);
+    }
+  } else if (key == kScene) {
+    vDeserializeSceneLevel(snd, flutterAssetsPath);
+  } else if (key == kWarmUpMaterials && std::holds_alternative<bool>(snd)) {
+    m_bWarmUpMaterials = std::get<bool>(snd);
+    vRecordRootSetting(key, snd);
+  } else if (key == kHoldUntilMaterialsReady &&
+             std::holds_alternative<bool>(snd)) {
+    m_bHoldUntilMaterialsReady = std::get<bool>(snd);
+    vRecordRootSetting(key, snd);
+  } else if (key == kTextureBudgetMegabytes &&
+             std::holds_alternative<int32_t>(snd)) {
+    m_nTextureBudgetMegabytes = std::get<int32_t>(snd);
+    vRecordRootSetting(key, snd);
+  } else if (key == kShapes &&
+             std::holds_alternative<flutter::EncodableList>(snd)) {
+    for (const auto& iter : std::get<flutter::EncodableList>(snd)) {
+      if (iter.IsNull()) {
+        SPDLOG_DEBUG("CreationParamName unable to cast {}", key.c_str());
         continue;
       }
-      models_.emplace_back(std::move(deserializedModel));
-    } else if (key == kModels &&
-               std::holds_alternative<flutter::EncodableList>(snd)) {
-      SPDLOG_TRACE("Loading Multiple Models {}", key);
-
-      auto list = std::get<flutter::EncodableList>(snd);
-      for (const auto& iter : list) {
-        if (iter.IsNull()) {
-          spdlog::warn("CreationParamName unable to cast {}", key.c_str());
-          continue;
-        }
+      vAddShape(flutterAssetsPath, iter);
+    }
+  } else if (key == kSceneBinary && std::holds_alternative<std::string>(snd)) {
+    bLoadBinaryScene(std::get<std::string>(snd), flutterAssetsPath);
+  } else if (key == kWriteSceneBinary || key == kSceneSnapshot) {
+    // Handled before the walk.
+  } else if (key == kEngineProfile) {
+    // Read before the engine is created, see EngineProfile.
+    vRecordRootSetting(key, snd);
+  } else {
+    spdlog::warn("[SceneTextDeserializer] Unhandled Parameter {}",
+                 key.c_str());
+    plugin_common::Encodable::PrintFlutterEncodableValue(key.c_str(), snd);
+  }
+}
 
-        auto deserializedModel = Model::Deserialize(
-            flutterAssetsPath, std::get<flutter::EncodableMap>(iter));
-        if (deserializedModel == nullptr) {
-          // load fallback
-          auto fallbackToDeserialize =
-              Deserialize::DeserializeParameter(kFallback, iter);
-          deserializedModel = Model::Deserialize(
-              flutterAssetsPath,
-              std::get<flutter::EncodableMap>(fallbackToDeserialize));
-        }
-        if (deserializedModel == nullptr) {
-          spdlog::error("Unable to load model and fallback model");
-          continue;
-        }
-        models_.emplace_back(std::move(deserializedModel));
-      }
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vAddModel(const std::string& flutterAssetsPath,
+                                      const flutter::EncodableValue& params) {
+  auto deserializedModel = Model::Deserialize(
+      flutterAssetsPath, std::get<flutter::EncodableMap>(params));
+  if (deserializedModel == nullptr) {
+    // load fallback
+    auto fallbackToDeserialize =
+        Deserialize::DeserializeParameter(kFallback, params);
+    deserializedModel = Model::Deserialize(
+        flutterAssetsPath,
+        std::get<flutter::EncodableMap>(fallbackToDeserialize));
+  }
+  if (deserializedModel == nullptr) {
+    spdlog::error("Unable to load model and fallback model");
+    return;
+  }
+  vRecordEntity(kModels, params, deserializedModel->GetGlobalGuid());
+  models_.emplace_back(std::move(deserializedModel));
+}
 
-    } else if (key == kScene) {
-      vDeserializeSceneLevel(snd, flutterAssetsPath);
-    } else if (key == kShapes &&
-               std::holds_alternative<flutter::EncodableList>(snd)) {
-      auto list = std::get<flutter::EncodableList>(snd);
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vAddShape(const std::string& flutterAssetsPath,
+                                      const flutter::EncodableValue& params) {
+  auto shape = ShapeSystem::poDeserializeShapeFromData(
+      flutterAssetsPath, std::get<flutter::EncodableMap>(params));
+  if (shape != nullptr) {
+    vRecordEntity(kShapes, params, shape->GetGlobalGuid());
+  }
 
-      for (const auto& iter : list) {
-        if (iter.IsNull()) {
-          SPDLOG_DEBUG("CreationParamName unable to cast {}", key.c_str());
-          continue;
-        }
-        auto shape = ShapeSystem::poDeserializeShapeFromData(
-            flutterAssetsPath, std::get<flutter::EncodableMap>(iter));
+  shapes_.emplace_back(shape.release());
+}
 
-        shapes_.emplace_back(shape.release());
-      }
-    } else {
-      spdlog::warn("[SceneTextDeserializer] Unhandled Parameter {}",
-                   key.c_str());
-      plugin_common::Encodable::PrintFlutterEncodableValue(key.c_str(), snd);
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vAddModel(const std::string& flutterAssetsPath,
+                                      const BinaryScene::View& params) {
+  auto deserializedModel = Model::Deserialize(flutterAssetsPath, params);
+  if (deserializedModel == nullptr) {
+    if (const auto fallback = params.oFind(kFallback);
+        fallback.eGetType() == BinaryScene::Type::Map) {
+      deserializedModel = Model::Deserialize(flutterAssetsPath, fallback);
     }
   }
+  if (deserializedModel == nullptr) {
+    spdlog::error("Unable to load model and fallback model");
+    return;
+  }
+  vRecordEntity(kModels, params, deserializedModel->GetGlobalGuid());
+  models_.emplace_back(std::move(deserializedModel));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vAddShape(const std::string& flutterAssetsPath,
+                                      const BinaryScene::View& params) {
+  auto shape =
+      ShapeSystem::poDeserializeShapeFromData(flutterAssetsPath, params);
+  if (shape != nullptr) {
+    vRecordEntity(kShapes, params, shape->GetGlobalGuid());
+  }
+
+  shapes_.emplace_back(shape.release());
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -134,45 +242,310 @@ void SceneTextDeserializer::vDeserializeSceneLevel(
     const flutter::EncodableValue& params,
     const std::string& /*flutterAssetsPath*/) {
   for (const auto& [fst, snd] : std::get<flutter::EncodableMap>(params)) {
-    auto key = std::get<std::string>(fst);
-    if (snd.IsNull()) {
-      SPDLOG_WARN(
-          "vDeserializeSceneLevel Param ITER is null key:{} file:{} "
-          "function:{}",
-          key, __FILE__, __FUNCTION__);
-      continue;
+    vDeserializeSceneParameter(std::get<std::string>(fst), snd);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vDeserializeSceneParameter(
+    const std::string& key,
+    const flutter::EncodableValue& snd) {
+  if (snd.IsNull()) {
+    SPDLOG_WARN(
+        "vDeserializeSceneLevel Param ITER is null key:{} file:{} "
+        "function:{}",
+        key, __FILE__, __FUNCTION__);
+    return;
+  }
+
+  // everything here looks to make sure its a map, we can return early if
+  // its not.
+  if (!std::holds_alternative<flutter::EncodableMap>(snd)) {
+    return;
+  }
+
+  const auto& encodableMap = std::get<flutter::EncodableMap>(snd);
+
+  if (bIsRecording()) {
+    auto& scene = m_oSnapshotScene[flutter::EncodableValue(kScene)];
+    if (!std::holds_alternative<flutter::EncodableMap>(scene)) {
+      scene = flutter::EncodableMap();
     }
+    std::get<flutter::EncodableMap>(scene)[flutter::EncodableValue(key)] = snd;
+  }
+
+  if (key == kSkybox) {
+    skybox_ = Skybox::Deserialize(encodableMap);
+  } else if (key == kLight) {
+    lights_.emplace_back(std::make_unique<Light>(encodableMap));
+  } else if (key == kIndirectLight) {
+    indirect_light_ = IndirectLight::Deserialize(encodableMap);
+  } else if (key == kCamera) {
+    camera_ = std::make_unique<Camera>(encodableMap);
+  } else if (key == "ground") {
+    spdlog::warn(
+        "Specifying a ground is no longer supporting, a ground is now a "
+        "plane in shapes.");
+  } else {
+    spdlog::debug("[SceneTextDeserializer] Unhandled Parameter {}",
+                  key.c_str());
+    plugin_common::Encodable::PrintFlutterEncodableValue(key.c_str(), snd);
+  }
+}
 
-    // everything in this loop looks to make sure its a map, we can continue
-    // on if its not.
-    if (!std::holds_alternative<flutter::EncodableMap>(snd)) {
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vDeserializeBinaryRootLevel(
+    const BinaryScene::View& root,
+    const std::string& flutterAssetsPath) {
+  if (root.eGetType() != BinaryScene::Type::Map) {
+    spdlog::error("[SceneTextDeserializer] Binary scene root is not a map");
+    return;
+  }
+
+  for (size_t i = 0; i < root.nGetSize(); ++i) {
+    const auto key = root.szGetMapKey(i);
+    const auto value = root.oGetMapValue(i);
+    if (value.bIsNull()) {
       continue;
     }
 
-    auto encodableMap = std::get<flutter::EncodableMap>(snd);
-
-    if (key == kSkybox) {
-      skybox_ = Skybox::Deserialize(encodableMap);
-    } else if (key == kLight) {
-      lights_.emplace_back(std::make_unique<Light>(encodableMap));
-    } else if (key == kIndirectLight) {
-      indirect_light_ = IndirectLight::Deserialize(encodableMap);
-    } else if (key == kCamera) {
-      camera_ = std::make_unique<Camera>(encodableMap);
-    } else if (key == "ground") {
-      spdlog::warn(
-          "Specifying a ground is no longer supporting, a ground is now a "
-          "plane in shapes.");
-    } else if (!snd.IsNull()) {
-      spdlog::debug("[SceneTextDeserializer] Unhandled Parameter {}",
-                    key.c_str());
-      plugin_common::Encodable::PrintFlutterEncodableValue(key.c_str(), snd);
+    if (key == kWarmUpMaterials && value.obGetBool()) {
+      m_bWarmUpMaterials = *value.obGetBool();
+      vRecordRootSetting(std::string(key), flutter::EncodableValue(
+                                               m_bWarmUpMaterials));
+    } else if (key == kHoldUntilMaterialsReady && value.obGetBool()) {
+      m_bHoldUntilMaterialsReady = *value.obGetBool();
+      vRecordRootSetting(std::string(key), flutter::EncodableValue(
+                                               m_bHoldUntilMaterialsReady));
+    } else if (key == kTextureBudgetMegabytes && value.onGetInt()) {
+      m_nTextureBudgetMegabytes = static_cast<int32_t>(*value.onGetInt());
+      vRecordRootSetting(std::string(key), flutter::EncodableValue(
+                                               m_nTextureBudgetMegabytes));
+    } else if ((key == kModels || key == kShapes) &&
+               value.eGetType() == BinaryScene::Type::List) {
+      for (size_t j = 0; j < value.nGetSize(); ++j) {
+        const auto item = value.oGetListItem(j);
+        if (item.eGetType() != BinaryScene::Type::Map) {
+          spdlog::warn("CreationParamName unable to cast {}", key);
+          continue;
+        }
+        if (key == kModels) {
+          vAddModel(flutterAssetsPath, item);
+        } else {
+          vAddShape(flutterAssetsPath, item);
+        }
+      }
+    } else if (key == kScene && value.eGetType() == BinaryScene::Type::Map) {
+      for (size_t j = 0; j < value.nGetSize(); ++j) {
+        vDeserializeSceneParameter(std::string(value.szGetMapKey(j)),
+                                   value.oGetMapValue(j).oToEncodable());
+      }
+    } else if (key == kSnapshotInfo &&
+               value.eGetType() == BinaryScene::Type::Map) {
+      vReadSnapshotInfo(value);
+    } else if (key == kSceneBinary || key == kWriteSceneBinary ||
+               key == kSceneSnapshot) {
+      spdlog::warn("[SceneTextDeserializer] {} ignored inside a binary scene",
+                   key);
+    } else {
+      vDeserializeRootParameter(std::string(key), value.oToEncodable(),
+                                flutterAssetsPath);
     }
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+bool SceneTextDeserializer::bLoadBinaryScene(
+    const std::string& szPath,
+    const std::string& flutterAssetsPath) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto path = getAbsolutePath(szPath, flutterAssetsPath);
+
+  BinaryScene binaryScene;
+  if (!binaryScene.bOpenFile(path.string())) {
+    spdlog::error("[SceneTextDeserializer] Unable to load binary scene {}",
+                  path.c_str());
+    return false;
+  }
+  vDeserializeBinaryRootLevel(binaryScene.oGetRoot(), flutterAssetsPath);
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  spdlog::info("[SceneTextDeserializer] Mapped {} ({} bytes) in {:.2f} ms",
+               path.c_str(), binaryScene.nGetByteSize(), elapsed.count());
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+bool SceneTextDeserializer::bRestoreSnapshot(
+    const std::string& flutterAssetsPath) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto path = SceneSnapshotSystem::oResolvePath(m_szSnapshotPath);
+
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    spdlog::info("[SceneTextDeserializer] No scene snapshot at {} yet",
+                 path.c_str());
+    return false;
+  }
+
+  BinaryScene binaryScene;
+  if (!binaryScene.bOpenFile(path.string())) {
+    spdlog::warn("[SceneTextDeserializer] Unreadable scene snapshot {}",
+                 path.c_str());
+    return false;
+  }
+
+  const auto root = binaryScene.oGetRoot();
+  const auto info = root.oFind(kSnapshotInfo);
+  if (info.oFind(kSnapshotVersion).onGetInt() !=
+          SceneSnapshotSystem::kFormatVersion ||
+      info.oFind(kSnapshotSourceHash).onGetInt() != m_nSnapshotSourceHash) {
+    spdlog::info(
+        "[SceneTextDeserializer] Scene snapshot {} is from other creation "
+        "params, loading them instead",
+        path.c_str());
+    return false;
+  }
+
+  m_bRestoredSnapshot = true;
+  vDeserializeBinaryRootLevel(root, flutterAssetsPath);
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  spdlog::info(
+      "[SceneTextDeserializer] Restored scene snapshot {} ({} bytes) in "
+      "{:.2f} ms",
+      path.c_str(), binaryScene.nGetByteSize(), elapsed.count());
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vReadSnapshotInfo(const BinaryScene::View& info) {
+  const auto szPath = info.oFind(kSnapshotIblPath).oszGetString();
+  const auto szCacheKey = info.oFind(kSnapshotIblCacheKey).oszGetString();
+  const auto nByteSize = info.oFind(kSnapshotIblByteSize).onGetInt();
+  const auto nWriteTime = info.oFind(kSnapshotIblWriteTime).onGetInt();
+  if (!szPath || !szCacheKey || !nByteSize || !nWriteTime) {
+    return;
+  }
+
+  IndirectLightSystem::HdrSource source;
+  source.szPath = std::string(*szPath);
+  source.szCacheKey = std::string(*szCacheKey);
+  source.nByteSize = *nByteSize;
+  source.nWriteTime = *nWriteTime;
+  m_oSnapshotHdrSource = std::move(source);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vRecordEntity(const char* szListKey,
+                                          const flutter::EncodableValue& params,
+                                          const EntityGUID& guid) {
+  if (!bIsRecording()) {
+    return;
+  }
+
+  auto entry = std::get<flutter::EncodableMap>(params);
+  // Entities without a guid in their params get a generated one; it has to
+  // be kept for patches and parent links to find them after a restore.
+  entry[flutter::EncodableValue(kGlobalGuid)] = flutter::EncodableValue(guid);
+
+  auto& list = m_oSnapshotScene[flutter::EncodableValue(szListKey)];
+  if (!std::holds_alternative<flutter::EncodableList>(list)) {
+    list = flutter::EncodableList();
+  }
+  std::get<flutter::EncodableList>(list).emplace_back(std::move(entry));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vRecordEntity(const char* szListKey,
+                                          const BinaryScene::View& params,
+                                          const EntityGUID& guid) {
+  if (!bIsRecording()) {
+    return;
+  }
+  vRecordEntity(szListKey, params.oToEncodable(), guid);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vRecordRootSetting(
+    const std::string& key,
+    const flutter::EncodableValue& value) {
+  if (!bIsRecording()) {
+    return;
+  }
+  m_oSnapshotScene[flutter::EncodableValue(key)] = value;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void SceneTextDeserializer::vWriteBinaryScene(
+    const flutter::EncodableMap& creationParams,
+    const std::string& szPath,
+    const std::string& flutterAssetsPath,
+    const size_t nCodecBytes,
+    const float fCodecDecodeMilliseconds) {
+  // The converter keys only make sense in the map that carries them.
+  auto sceneParams = creationParams;
+  sceneParams.erase(flutter::EncodableValue(kWriteSceneBinary));
+  sceneParams.erase(flutter::EncodableValue(kSceneBinary));
+
+  const auto path = getAbsolutePath(szPath, flutterAssetsPath);
+  if (!BinaryScene::bWriteFile(path.string(),
+                               flutter::EncodableValue(sceneParams))) {
+    spdlog::error("[SceneTextDeserializer] Unable to write binary scene {}",
+                  path.c_str());
+    return;
+  }
+
+  // Load time check on this scene: mapping the file and copying every value
+  // out is the most the binary path ever does, against the codec decode.
+  const auto start = std::chrono::steady_clock::now();
+  BinaryScene binaryScene;
+  if (!binaryScene.bOpenFile(path.string())) {
+    return;
+  }
+  const auto roundTrip = binaryScene.oGetRoot().oToEncodable();
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (roundTrip != flutter::EncodableValue(sceneParams)) {
+    spdlog::error("[SceneTextDeserializer] Binary scene {} doesn't read back",
+                  path.c_str());
+    return;
+  }
+  spdlog::info(
+      "[SceneTextDeserializer] Wrote binary scene {} ({} bytes, codec {} "
+      "bytes). Codec decode {:.3f} ms, binary map and full copy {:.3f} ms",
+      path.c_str(), binaryScene.nGetByteSize(), nCodecBytes,
+      fCodecDecodeMilliseconds, elapsed.count());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 void SceneTextDeserializer::vRunPostSetupLoad() {
+  if (const auto snapshotSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<SceneSnapshotSystem>(
+              SceneSnapshotSystem::StaticGetTypeID(), __FUNCTION__)) {
+    const auto* hdrLight =
+        dynamic_cast<HdrIndirectLight*>(indirect_light_.get());
+    snapshotSystem->vSetScene(
+        std::move(m_oSnapshotScene), m_szSnapshotPath, m_nSnapshotSourceHash,
+        m_bRestoredSnapshot,
+        hdrLight != nullptr && !hdrLight->getAssetPath().empty());
+  }
+
+  // Before anything creates materials, so all of them get warmed up.
+  if (const auto materialSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+              MaterialSystem::StaticGetTypeID(), __FUNCTION__)) {
+    materialSystem->vBeginSceneEntry(m_bWarmUpMaterials,
+                                     m_bHoldUntilMaterialsReady);
+    if (m_nTextureBudgetMegabytes > 0) {
+      materialSystem->vSetTextureBudget(
+          static_cast<size_t>(m_nTextureBudgetMegabytes) * 1024 * 1024);
+    }
+  }
+
   setUpLoadingModels();
   setUpSkybox();
   setUpLight();
@@ -241,32 +614,10 @@ void SceneTextDeserializer::loadModel(Model* model) {
 
     if (modelSystem == nullptr) {
       spdlog::error("Unable to find the model system.");
-      /*return Resource<std::string_view>::Error(
-          "Unable to find the model system.");*/
+      return;
     }
 
-    const auto& loader = modelSystem;
-    if (dynamic_cast<GlbModel*>(model)) {
-      const auto glb_model = dynamic_cast<GlbModel*>(model);
-      if (!glb_model->szGetAssetPath().empty()) {
-        loader->loadGlbFromAsset(model, glb_model->szGetAssetPath(), false);
-      }
-
-      if (!glb_model->szGetURLPath().empty()) {
-        loader->loadGlbFromUrl(model, glb_model->szGetURLPath());
-      }
-    } else if (dynamic_cast<GltfModel*>(model)) {
-      const auto gltf_model = dynamic_cast<GltfModel*>(model);
-      if (!gltf_model->szGetAssetPath().empty()) {
-        ModelSystem::loadGltfFromAsset(model, gltf_model->szGetAssetPath(),
-                                       gltf_model->szGetPrefix(),
-                                       gltf_model->szGetPostfix());
-      }
-
-      if (!gltf_model->szGetURLPath().empty()) {
-        ModelSystem::loadGltfFromUrl(model, gltf_model->szGetURLPath());
-      }
-    }
+    modelSystem->vLoadModel(model);
   });
 }
 
@@ -354,8 +705,19 @@ void SceneTextDeserializer::setUpIndirectLight() {
       if (!indirectLight->getAssetPath().empty()) {
         // val shouldUpdateLight = indirectLight->getAssetPath() !=
         // scene?.skybox?.assetPath if (shouldUpdateLight) {
-        IndirectLightSystem::setIndirectLightFromHdrAsset(
-            indirectLight->getAssetPath(), indirectLight->getIntensity());
+        const auto assetPath =
+            std::filesystem::path(
+                ECSystemManager::GetInstance()->getConfigValue<std::string>(
+                    kAssetPath)) /
+            indirectLight->getAssetPath();
+        if (m_oSnapshotHdrSource.has_value() &&
+            m_oSnapshotHdrSource->szPath == assetPath.string()) {
+          IndirectLightSystem::setIndirectLightFromHdrSource(
+              *m_oSnapshotHdrSource, indirectLight->getIntensity());
+        } else {
+          IndirectLightSystem::setIndirectLightFromHdrAsset(
+              indirectLight->getAssetPath(), indirectLight->getIntensity());
+        }
         //}
 
       } else if (!indirectLight->getUrl().empty()) {
@@ -23,12 +23,21 @@
 #include <core/scene/camera/camera.h>
 #include <core/scene/indirect_light/indirect_light.h>
 #include <core/scene/light/light.h>
+#include <core/scene/serialization/binary_scene.h>
 #include <core/scene/skybox/skybox.h>
+#include <core/systems/derived/indirect_light_system.h>
 #include <encodable_value.h>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace plugin_filament_view {
 
+// Builds the initial scene from the platform view creation params, either
+// the StandardMessageCodec map or a BinaryScene. The map may also point at a
+// binary scene asset (sceneBinary) or ask for itself to be converted to one
+// (writeSceneBinary). With a sceneSnapshot path, a snapshot taken from the
+// same params is loaded instead of them; see SceneSnapshotSystem.
 class SceneTextDeserializer {
  public:
   explicit SceneTextDeserializer(const std::vector<uint8_t>& params);
@@ -42,10 +51,52 @@ class SceneTextDeserializer {
 
   void vDeserializeRootLevel(const std::vector<uint8_t>& params,
                              const std::string& flutterAssetsPath);
+  void vDeserializeRootParameter(const std::string& key,
+                                 const flutter::EncodableValue& snd,
+                                 const std::string& flutterAssetsPath);
   // This is called from vDeserializeRootLevel function when it hits a 'scene'
   // tag
   void vDeserializeSceneLevel(const flutter::EncodableValue& params,
                               const std::string& flutterAssetsPath);
+  void vDeserializeSceneParameter(const std::string& key,
+                                  const flutter::EncodableValue& snd);
+
+  // Reads settings, models and shapes straight from the view instead of
+  // decoding the whole tree; other scene entries are copied out one by one.
+  void vDeserializeBinaryRootLevel(const BinaryScene::View& root,
+                                   const std::string& flutterAssetsPath);
+  bool bLoadBinaryScene(const std::string& szPath,
+                        const std::string& flutterAssetsPath);
+  // Converter from the map format; logs codec vs binary load times.
+  static void vWriteBinaryScene(const flutter::EncodableMap& creationParams,
+                                const std::string& szPath,
+                                const std::string& flutterAssetsPath,
+                                size_t nCodecBytes,
+                                float fCodecDecodeMilliseconds);
+  // False if there is no snapshot of these params to restore.
+  bool bRestoreSnapshot(const std::string& flutterAssetsPath);
+  void vReadSnapshotInfo(const BinaryScene::View& info);
+
+  // What was loaded, handed to SceneSnapshotSystem once set up. Only kept
+  // with a sceneSnapshot param, otherwise nothing reads it.
+  [[nodiscard]] bool bIsRecording() const { return !m_szSnapshotPath.empty(); }
+  void vRecordEntity(const char* szListKey,
+                     const flutter::EncodableValue& params,
+                     const EntityGUID& guid);
+  void vRecordEntity(const char* szListKey,
+                     const BinaryScene::View& params,
+                     const EntityGUID& guid);
+  void vRecordRootSetting(const std::string& key,
+                          const flutter::EncodableValue& value);
+
+  void vAddModel(const std::string& flutterAssetsPath,
+                 const flutter::EncodableValue& params);
+  void vAddShape(const std::string& flutterAssetsPath,
+                 const flutter::EncodableValue& params);
+  void vAddModel(const std::string& flutterAssetsPath,
+                 const BinaryScene::View& params);
+  void vAddShape(const std::string& flutterAssetsPath,
+                 const BinaryScene::View& params);
 
   void setUpLoadingModels() const;
   void setUpSkybox();
@@ -59,6 +110,17 @@ class SceneTextDeserializer {
   std::unique_ptr<IndirectLight> indirect_light_;
   std::vector<std::unique_ptr<Light>> lights_;
   std::unique_ptr<Camera> camera_;
+
+  flutter::EncodableMap m_oSnapshotScene;
+  std::string m_szSnapshotPath;
+  int64_t m_nSnapshotSourceHash = 0;
+  bool m_bRestoredSnapshot = false;
+  std::optional<IndirectLightSystem::HdrSource> m_oSnapshotHdrSource;
+
+  bool m_bWarmUpMaterials = true;
+  bool m_bHoldUntilMaterialsReady = false;
+  // 0 keeps MaterialSystem's default.
+  int32_t m_nTextureBudgetMegabytes = 0;
 };
 
 }  // namespace plugin_filament_view
@@ -17,6 +17,7 @@
 #include "view_target.h"
 
 #include <core/include/literals.h>
+#include <core/scene/frame_coordinator.h>
 #include <core/systems/derived/filament_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <filament/Renderer.h>
@@ -32,6 +33,7 @@
 #include <view/flutter_view.h>
 #include <wayland/display.h>
 #include <asio/post.hpp>
+#include <chrono>
 #include <utility>
 
 using flutter::EncodableList;
@@ -55,7 +57,6 @@ ViewTarget::ViewTarget(const int32_t top,
       left_(left),
       top_(top),
       callback_(nullptr),
-      fanimator_(nullptr),
       cameraManager_(nullptr) {
   /* Setup Wayland subsurface */
   setupWaylandSubsurface();
@@ -73,6 +74,10 @@ ViewTarget::~ViewTarget() {
     callback_ = nullptr;
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  m_poPresentationFeedback.reset();
+#endif
+
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
           FilamentSystem::StaticGetTypeID(), "~ViewTarget");
@@ -104,6 +109,21 @@ void ViewTarget::setupMessageChannels(
   frameViewCallback_ = std::make_unique<flutter::MethodChannel<>>(
       plugin_registrar->messenger(), channel_name,
       &flutter::StandardMethodCodec::GetInstance());
+  m_poMessenger = plugin_registrar->messenger();
+  m_szFrameViewChannel = channel_name;
+
+  m_oUpdateFrameMessage = FrameCallbackMessage(
+      kUpdateFrame, {std::make_pair(kParam_ElapsedFrameTime,
+                                    EncodableValue(static_cast<int64_t>(0)))});
+  for (const auto& [message, szMethod] :
+       {std::pair{&m_oPreRenderFrameMessage, kPreRenderFrame},
+        std::pair{&m_oRenderFrameMessage, kRenderFrame},
+        std::pair{&m_oPostRenderFrameMessage, kPostRenderFrame}}) {
+    *message = FrameCallbackMessage(
+        szMethod,
+        {std::make_pair(kParam_TimeSinceLastRenderedSec, EncodableValue(0.0)),
+         std::make_pair(kParam_FPS, EncodableValue(0.0))});
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -156,6 +176,15 @@ void ViewTarget::setupWaylandSubsurface() {
 
   wl_subsurface_place_below(subsurface_, parent_surface_);
   wl_subsurface_set_desync(subsurface_);
+
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  m_poPresentationFeedback =
+      std::make_unique<plugin_common_wayland::PresentationFeedback>(display_);
+  if (!m_poPresentationFeedback->IsAvailable()) {
+    spdlog::debug("[ViewTarget] wp_presentation not supported");
+  }
+  m_oLastPresentationReport = std::chrono::steady_clock::now();
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -237,6 +266,27 @@ void ViewTarget::setupView(uint32_t width, uint32_t height) {
 
   cameraManager_ = std::make_unique<CameraManager>(this);
 
+  m_poQualityGovernor = std::make_unique<QualityGovernor>(fview_);
+  m_poQualityGovernor->vSetDecisionCallback(
+      [this](const QualityGovernor::Decision& decision) {
+        SendFrameViewCallback(
+            kQualityGovernorDecision,
+            {std::make_pair(kParam_Feature,
+                            EncodableValue(QualityGovernor::szGetFeatureName(
+                                decision.eFeature))),
+             std::make_pair(kParam_Degraded,
+                            EncodableValue(decision.bDegraded)),
+             std::make_pair(kParam_QualityLevel,
+                            EncodableValue(
+                                static_cast<int32_t>(decision.nLevel))),
+             std::make_pair(kParam_FrameTimeMs,
+                            EncodableValue(static_cast<double>(
+                                decision.fFrameMilliseconds))),
+             std::make_pair(kParam_BudgetMs,
+                            EncodableValue(static_cast<double>(
+                                decision.fBudgetMilliseconds)))});
+      });
+
   SPDLOG_TRACE("--{}::{}", __FILE__, __FUNCTION__);
 }
 
@@ -366,6 +416,19 @@ void ViewTarget::vChangeQualitySettings(
 
   // Now apply the settings to the Filament engine and view
   applySettings(filamentSystem->getFilamentEngine(), settings, fview_);
+
+  if (m_poQualityGovernor != nullptr) {
+    m_poQualityGovernor->vOnSettingsChanged();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ViewTarget::vConfigureQualityGovernor(
+    const QualityGovernor::Config& config) const {
+  if (m_poQualityGovernor == nullptr) {
+    return;
+  }
+  m_poQualityGovernor->vConfigure(config);
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -376,98 +439,127 @@ void ViewTarget::SendFrameViewCallback(
     return;
   }
 
+  // The codec owns the value and the map type has no allocator parameter,
+  // so this is built on the heap; at least don't copy it.
   EncodableMap encodableMap;
   for (const auto& [fst, snd] : args) {
-    encodableMap[EncodableValue(fst)] = snd;
+    encodableMap.emplace(fst, snd);
   }
 
   frameViewCallback_->InvokeMethod(
-      methodName,
-      std::make_unique<EncodableValue>(EncodableValue(encodableMap)));
+      methodName, std::make_unique<EncodableValue>(std::move(encodableMap)));
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ViewTarget::vSendFrameCallback(
+    std::optional<FrameCallbackMessage>& message,
+    const std::initializer_list<double> values) {
+  if (!message.has_value()) {
+    return;
+  }
+
+  size_t nArg = 0;
+  for (const double value : values) {
+    message->vSetArgument(nArg++, value);
+  }
+  message->vSend(m_poMessenger, m_szFrameViewChannel);
 }
 
 /////////////////////////////////////////////////////////////////////////
 const wl_callback_listener ViewTarget::frame_listener = {.done = OnFrame};
 
+////////////////////////////////////////////////////////////////////////////
+void ViewTarget::DrawFrame(const uint32_t time) {
+  if (m_poFrameCoordinator != nullptr) {
+    m_poFrameCoordinator->vRequestFrame(this, m_nWhich, time);
+    return;
+  }
+
+  post(*ECSystemManager::GetInstance()->GetStrand(),
+       [this, time] { bRenderFrame(time); });
+}
+
 /**
  * Renders the model and updates the Filament camera.
  *
  * @param time - timestamp of running program
- * rendered
+ * @return false if the renderer skipped the frame
  */
-void ViewTarget::DrawFrame(uint32_t time) {
-  post(*ECSystemManager::GetInstance()->GetStrand(), [&, time] {
-    static bool bonce = true;
-    if (bonce) {
-      bonce = false;
-
-      // will set the first frame of a cameras features.
-      doCameraFeatures(0);
+bool ViewTarget::bRenderFrame(const uint32_t time) {
+  if (m_bFirstFrame) {
+    m_bFirstFrame = false;
+
+    // will set the first frame of a cameras features.
+    doCameraFeatures(0);
+  }
+
+  if (m_LastTime == 0) {
+    m_LastTime = time;
+  }
+
+  // Frames from Native to dart, currently run in order of
+  // - updateFrame - Called regardless if a frame is going to be drawn or not
+  // - preRenderFrame - Called before native <features>, but we know we're
+  // going to draw a frame
+  // - renderFrame - Called after native <features>, right before drawing a
+  // frame
+  // - postRenderFrame - Called after we've drawn natively, right after
+  // drawing a frame.
+
+  vSendFrameCallback(m_oUpdateFrameMessage, {static_cast<double>(m_LastTime)});
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "bRenderFrame");
+
+  const auto frameStart = std::chrono::steady_clock::now();
+
+  // Render the scene, unless the renderer wants to skip the frame.
+  const bool bRendered =
+      filamentSystem->getFilamentRenderer()->beginFrame(fswapChain_, time);
+  if (bRendered) {
+    // Note you might want render time and gameplay time to be different
+    // but for smooth animation you don't. (physics would be simulated w/o
+    // render)
+    //
+    // Future tasking for making a more featured timing / frame info class.
+    const uint32_t deltaTimeMS = time - m_LastTime;
+    float timeSinceLastRenderedSec =
+        static_cast<float>(deltaTimeMS) / 1000.0f;  // convert to seconds
+    if (timeSinceLastRenderedSec == 0.0f) {
+      timeSinceLastRenderedSec += 1.0f;
     }
+    float fps = 1.0f / timeSinceLastRenderedSec;  // calculate FPS
+
+    vSendFrameCallback(m_oPreRenderFrameMessage,
+                       {timeSinceLastRenderedSec, fps});
+
+    doCameraFeatures(timeSinceLastRenderedSec);
+
+    vSendFrameCallback(m_oRenderFrameMessage, {timeSinceLastRenderedSec, fps});
+
+    filamentSystem->getFilamentRenderer()->render(fview_);
 
-    if (m_LastTime == 0) {
-      m_LastTime = time;
+    filamentSystem->getFilamentRenderer()->endFrame();
+    ECSystemManager::GetInstance()->vLogStartupPhase("First frame rendered");
+
+    if (cameraManager_ != nullptr) {
+      cameraManager_->vOnFrameSubmitted();
     }
 
-    // Frames from Native to dart, currently run in order of
-    // - updateFrame - Called regardless if a frame is going to be drawn or not
-    // - preRenderFrame - Called before native <features>, but we know we're
-    // going to draw a frame
-    // - renderFrame - Called after native <features>, right before drawing a
-    // frame
-    // - postRenderFrame - Called after we've drawn natively, right after
-    // drawing a frame.
-
-    SendFrameViewCallback(
-        kUpdateFrame,
-        {std::make_pair(kParam_ElapsedFrameTime, EncodableValue(m_LastTime))});
-
-    const auto filamentSystem =
-        ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-            FilamentSystem::StaticGetTypeID(), "DrawFrame");
-
-    // Render the scene, unless the renderer wants to skip the frame.
-    if (filamentSystem->getFilamentRenderer()->beginFrame(fswapChain_, time)) {
-      // Note you might want render time and gameplay time to be different
-      // but for smooth animation you don't. (physics would be simulated w/o
-      // render)
-      //
-      // Future tasking for making a more featured timing / frame info class.
-      const uint32_t deltaTimeMS = time - m_LastTime;
-      float timeSinceLastRenderedSec =
-          static_cast<float>(deltaTimeMS) / 1000.0f;  // convert to seconds
-      if (timeSinceLastRenderedSec == 0.0f) {
-        timeSinceLastRenderedSec += 1.0f;
-      }
-      float fps = 1.0f / timeSinceLastRenderedSec;  // calculate FPS
-
-      SendFrameViewCallback(
-          kPreRenderFrame,
-          {std::make_pair(kParam_TimeSinceLastRenderedSec,
-                          EncodableValue(timeSinceLastRenderedSec)),
-           std::make_pair(kParam_FPS, EncodableValue(fps))});
-
-      doCameraFeatures(timeSinceLastRenderedSec);
-
-      SendFrameViewCallback(
-          kRenderFrame,
-          {std::make_pair(kParam_TimeSinceLastRenderedSec,
-                          EncodableValue(timeSinceLastRenderedSec)),
-           std::make_pair(kParam_FPS, EncodableValue(fps))});
-
-      filamentSystem->getFilamentRenderer()->render(fview_);
-
-      filamentSystem->getFilamentRenderer()->endFrame();
-
-      SendFrameViewCallback(
-          kPostRenderFrame,
-          {std::make_pair(kParam_TimeSinceLastRenderedSec,
-                          EncodableValue(timeSinceLastRenderedSec)),
-           std::make_pair(kParam_FPS, EncodableValue(fps))});
+    if (m_poQualityGovernor != nullptr) {
+      const std::chrono::duration<float, std::milli> cpuTime =
+          std::chrono::steady_clock::now() - frameStart;
+      m_poQualityGovernor->vOnFrame(cpuTime.count(),
+                                    filamentSystem->getFilamentRenderer());
     }
 
-    m_LastTime = time;
-  });
+    vSendFrameCallback(m_oPostRenderFrameMessage,
+                       {timeSinceLastRenderedSec, fps});
+  }
+
+  m_LastTime = time;
+  return bRendered;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -482,6 +574,15 @@ void ViewTarget::OnFrame(void* data,
     wl_callback_destroy(callback);
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  if (obj->m_poPresentationFeedback != nullptr) {
+    obj->m_poPresentationFeedback->Dispatch();
+    // Latency is counted from here, before the frame is rendered.
+    obj->m_poPresentationFeedback->Request(obj->surface_);
+    obj->vReportPresentation();
+  }
+#endif
+
   obj->DrawFrame(time);
 
   obj->callback_ = wl_surface_frame(obj->surface_);
@@ -495,6 +596,38 @@ void ViewTarget::OnFrame(void* data,
   wl_surface_commit(obj->surface_);
 }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+////////////////////////////////////////////////////////////////////////////
+void ViewTarget::vReportPresentation() {
+  const auto now = std::chrono::steady_clock::now();
+  if (!m_poPresentationFeedback->IsAvailable() ||
+      now - m_oLastPresentationReport < kPresentationReportInterval) {
+    return;
+  }
+  m_oLastPresentationReport = now;
+
+  // Channel messages for this view all go out from the strand.
+  post(*ECSystemManager::GetInstance()->GetStrand(),
+       [this, stats = m_poPresentationFeedback->TakeStats()] {
+         SendFrameViewCallback(
+             kPresentationStats,
+             {std::make_pair(kParam_Presented,
+                             EncodableValue(
+                                 static_cast<int64_t>(stats.presented))),
+              std::make_pair(kParam_Discarded,
+                             EncodableValue(
+                                 static_cast<int64_t>(stats.discarded))),
+              std::make_pair(kParam_RefreshNs,
+                             EncodableValue(
+                                 static_cast<int64_t>(stats.refresh_ns))),
+              std::make_pair(kParam_LatencyAvgMs,
+                             EncodableValue(stats.latency_avg_ms)),
+              std::make_pair(kParam_LatencyMaxMs,
+                             EncodableValue(stats.latency_max_ms))});
+       });
+}
+#endif  // ENABLE_PRESENTATION_FEEDBACK
+
 /////////////////////////////////////////////////////////////////////////
 void ViewTarget::doCameraFeatures(const float fDeltaTime) const {
   if (cameraManager_ == nullptr)
@@ -547,6 +680,9 @@ void ViewTarget::vOnTouch(const int32_t action,
                              std::string(__FUNCTION__));
     collisionRequest.addData(ECSMessageType::CollisionRequestType,
                              eNativeOnTouchBegin);
+    collisionRequest.addData(ECSMessageType::CollisionRequestViewportPosition,
+                             touch.midpoint());
+    collisionRequest.addData(ECSMessageType::CollisionRequestView, fview_);
     ECSystemManager::GetInstance()->vRouteMessage(collisionRequest);
   }
 
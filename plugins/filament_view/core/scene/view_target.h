@@ -18,17 +18,26 @@
 
 #include <core/scene/camera/camera.h>
 #include <core/scene/camera/camera_manager.h>
+#include <core/scene/frame_callback_message.h>
+#include <core/scene/quality_governor.h>
 #include <filament/Engine.h>
 #include <flutter_desktop_plugin_registrar.h>
 #include <gltfio/AssetLoader.h>
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+#include <plugins/common/wayland/presentation_feedback.h>
+#endif
 #include <viewer/Settings.h>
 #include <asio/io_context_strand.hpp>
+#include <chrono>
 #include <cstdint>
+#include <optional>
+#include <string>
 
 namespace plugin_filament_view {
 
 class Camera;
 class CameraManager;
+class FrameCoordinator;
 
 class ViewTarget {
  public:
@@ -42,10 +51,6 @@ class ViewTarget {
   ViewTarget(const ViewTarget&) = delete;
   ViewTarget& operator=(const ViewTarget&) = delete;
 
-  void setAnimator(filament::gltfio::Animator* animator) {
-    fanimator_ = animator;
-  }
-
   void setupMessageChannels(flutter::PluginRegistrar* plugin_registrar);
 
   filament::viewer::Settings& getSettings() { return settings_; }
@@ -83,6 +88,20 @@ class ViewTarget {
   void vChangeQualitySettings(
       const ePredefinedQualitySettings qualitySettings) const;
 
+  void vConfigureQualityGovernor(const QualityGovernor::Config& config) const;
+
+  // Frame callbacks go through poFrameCoordinator once set; without one
+  // every callback posts its own render. nWhich identifies the view in
+  // the coordinator's stats.
+  void vSetFrameCoordinator(FrameCoordinator* poFrameCoordinator,
+                            const size_t nWhich) {
+    m_poFrameCoordinator = poFrameCoordinator;
+    m_nWhich = nWhich;
+  }
+
+  // Renders one frame on the strand; false if the renderer skipped it.
+  bool bRenderFrame(uint32_t time);
+
  private:
   void setupWaylandSubsurface();
 
@@ -95,6 +114,14 @@ class ViewTarget {
   bool initialized_{};
 
   std::unique_ptr<flutter::MethodChannel<>> frameViewCallback_;
+  flutter::BinaryMessenger* m_poMessenger = nullptr;
+  std::string m_szFrameViewChannel;
+
+  // The callbacks sent every frame, encoded once in setupMessageChannels.
+  std::optional<FrameCallbackMessage> m_oUpdateFrameMessage;
+  std::optional<FrameCallbackMessage> m_oPreRenderFrameMessage;
+  std::optional<FrameCallbackMessage> m_oRenderFrameMessage;
+  std::optional<FrameCallbackMessage> m_oPostRenderFrameMessage;
 
   wl_display* display_{};
   wl_surface* surface_{};
@@ -112,20 +139,26 @@ class ViewTarget {
   ::filament::SwapChain* fswapChain_{};
   ::filament::View* fview_{};
 
-  // todo to be moved
-  ::filament::gltfio::Animator* fanimator_;
-
   void SendFrameViewCallback(
       const std::string& methodName,
       std::initializer_list<std::pair<const char*, flutter::EncodableValue>>
           args) const;
 
+  // Sends message with its arguments set to values, in order.
+  void vSendFrameCallback(std::optional<FrameCallbackMessage>& message,
+                          std::initializer_list<double> values);
+
   static void OnFrame(void* data, wl_callback* callback, uint32_t time);
 
   static const wl_callback_listener frame_listener;
 
   void DrawFrame(uint32_t time);
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  // Sends the presentation counts once per kPresentationReportInterval.
+  void vReportPresentation();
+#endif
+
   void setupView(uint32_t width, uint32_t height);
 
   // elapsed time / deltatime needs to be moved to its own global namespace like
@@ -133,8 +166,22 @@ class ViewTarget {
   void doCameraFeatures(float fDeltaTime) const;
 
   uint32_t m_LastTime = 0;
+  bool m_bFirstFrame = true;
+
+  FrameCoordinator* m_poFrameCoordinator = nullptr;
+  size_t m_nWhich = 0;
+
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  static constexpr std::chrono::seconds kPresentationReportInterval{1};
+  // Null until the subsurface exists.
+  std::unique_ptr<plugin_common_wayland::PresentationFeedback>
+      m_poPresentationFeedback;
+  std::chrono::steady_clock::time_point m_oLastPresentationReport;
+#endif
 
   std::unique_ptr<CameraManager> cameraManager_;
+
+  std::unique_ptr<QualityGovernor> m_poQualityGovernor;
 };
 
 }  // namespace plugin_filament_view
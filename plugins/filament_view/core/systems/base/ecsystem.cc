@@ -17,10 +17,13 @@
 
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <memory_resource>
 #include <queue>
 #include <unordered_map>
 #include <vector>
 
+#include <core/systems/ecsystems_manager.h>
 #include <core/systems/messages/ecs_message.h>
 #include <core/systems/messages/ecs_message_types.h>
 #include <plugins/common/common.h>
@@ -45,7 +48,7 @@ void ECSystem::vRegisterMessageHandler(ECSMessageType type,
   SPDLOG_TRACE("[vRegisterMessageHandler] Attempting to acquire handlersMutex");
   std::unique_lock lock(handlersMutex);
   SPDLOG_TRACE("[vRegisterMessageHandler] handlersMutex acquired");
-  handlers_[type].push_back(handler);
+  handlers_[type].push_back(std::make_shared<const ECSMessageHandler>(handler));
   SPDLOG_TRACE(
       "[vRegisterMessageHandler] Handler registered for message type {}",
       static_cast<int>(type));
@@ -78,16 +81,20 @@ void ECSystem::vClearMessageHandlers() {
 // Process incoming messages
 void ECSystem::vProcessMessages() {
   SPDLOG_TRACE("[vProcessMessages] Attempting to acquire messagesMutex");
-  std::queue<ECSMessage> messagesToProcess;
+  std::unique_lock lock(messagesMutex);
+  SPDLOG_TRACE("[vProcessMessages] messagesMutex acquired");
+  // Most frames have nothing queued; constructing the swap queue allocates,
+  // so leave before that.
+  if (messageQueue_.empty()) {
+    return;
+  }
 
-  {
-    std::unique_lock lock(messagesMutex);
-    SPDLOG_TRACE("[vProcessMessages] messagesMutex acquired");
-    std::swap(messageQueue_, messagesToProcess);
-    SPDLOG_TRACE(
-        "[vProcessMessages] Swapped message queues. Messages to process: {}",
-        messagesToProcess.size());
-  }  // messagesMutex is unlocked here
+  std::queue<ECSMessage> messagesToProcess;
+  std::swap(messageQueue_, messagesToProcess);
+  SPDLOG_TRACE(
+      "[vProcessMessages] Swapped message queues. Messages to process: {}",
+      messagesToProcess.size());
+  lock.unlock();
 
   while (!messagesToProcess.empty()) {
     const ECSMessage& msg = messagesToProcess.front();
@@ -105,7 +112,9 @@ void ECSystem::vProcessMessages() {
 // Handle a specific message type by invoking the registered handlers
 void ECSystem::vHandleMessage(const ECSMessage& msg) {
   SPDLOG_TRACE("[vHandleMessage] Attempting to acquire handlersMutex");
-  std::vector<ECSMessageHandler> handlersToInvoke;
+  // Only called from vProcessMessages, on the filament api thread.
+  std::pmr::vector<std::shared_ptr<const ECSMessageHandler>> handlersToInvoke(
+      ECSystemManager::GetInstance()->poGetFrameResource());
   {
     std::unique_lock lock(handlersMutex);
     SPDLOG_TRACE("[vHandleMessage] handlersMutex acquired");
@@ -124,7 +133,7 @@ void ECSystem::vHandleMessage(const ECSMessage& msg) {
   for (const auto& handler : handlersToInvoke) {
     SPDLOG_TRACE("[vHandleMessage] Invoking handler");
     try {
-      handler(msg);
+      (*handler)(msg);
     } catch (const std::exception& e) {
       spdlog::error("[vHandleMessage] Exception in handler: {}", e.what());
     }
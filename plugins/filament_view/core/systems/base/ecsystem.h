@@ -16,6 +16,7 @@
 #pragma once
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <queue>
 #include <unordered_map>
 #include <vector>
@@ -25,6 +26,8 @@
 
 namespace plugin_filament_view {
 
+class ResourceReport;
+
 using ECSMessageHandler = std::function<void(const ECSMessage&)>;
 
 class ECSystem {
@@ -61,16 +64,22 @@ class ECSystem {
 
   virtual void DebugPrint() = 0;
 
+  // Adds the GPU and CPU memory this system holds to the report. Called on
+  // the filament api thread.
+  virtual void vAccountResources(ResourceReport& /*report*/) const {}
+
  protected:
   // Handle a specific message type by invoking the registered handlers
   virtual void vHandleMessage(const ECSMessage& msg);
 
  private:
   std::queue<ECSMessage> messageQueue_;  // Queue of incoming messages
+  // Registered handlers; shared so handling a message can hold on to them
+  // without copying the functions.
   std::unordered_map<ECSMessageType,
-                     std::vector<ECSMessageHandler>,
+                     std::vector<std::shared_ptr<const ECSMessageHandler>>,
                      EnumClassHash>
-      handlers_;  // Registered handlers
+      handlers_;
 
   std::mutex messagesMutex;
   std::mutex handlersMutex;
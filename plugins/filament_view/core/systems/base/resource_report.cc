@@ -0,0 +1,181 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "resource_report.h"
+
+#include <core/include/literals.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace plugin_filament_view {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<ResourceEntry> lstSortedBySize(
+    std::map<std::pair<std::string, std::string>, ResourceEntry>& totals) {
+  std::vector<ResourceEntry> result;
+  result.reserve(totals.size());
+  for (auto& [key, entry] : totals) {
+    result.push_back(std::move(entry));
+  }
+  std::sort(result.begin(), result.end(),
+            [](const ResourceEntry& a, const ResourceEntry& b) {
+              return a.nGpuBytes + a.nCpuBytes > b.nGpuBytes + b.nCpuBytes;
+            });
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////
+flutter::EncodableMap oEncodeEntry(const ResourceEntry& entry) {
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue(kResourceUsageSystem)] = entry.szSystem;
+  if (!entry.szOwner.empty()) {
+    map[flutter::EncodableValue(kResourceUsageOwner)] = entry.szOwner;
+  }
+  if (!entry.szKind.empty()) {
+    map[flutter::EncodableValue(kResourceUsageKind)] = entry.szKind;
+  }
+  map[flutter::EncodableValue(kResourceUsageGpuBytes)] =
+      static_cast<int64_t>(entry.nGpuBytes);
+  map[flutter::EncodableValue(kResourceUsageCpuBytes)] =
+      static_cast<int64_t>(entry.nCpuBytes);
+  return map;
+}
+
+////////////////////////////////////////////////////////////////////////////
+rapidjson::Value oJsonEntries(const std::vector<ResourceEntry>& entries,
+                              rapidjson::Document::AllocatorType& allocator) {
+  rapidjson::Value list(rapidjson::kArrayType);
+  list.Reserve(static_cast<rapidjson::SizeType>(entries.size()), allocator);
+  for (const auto& entry : entries) {
+    rapidjson::Value object(rapidjson::kObjectType);
+    object.AddMember(rapidjson::StringRef(kResourceUsageSystem),
+                     rapidjson::Value(entry.szSystem.c_str(), allocator),
+                     allocator);
+    if (!entry.szOwner.empty()) {
+      object.AddMember(rapidjson::StringRef(kResourceUsageOwner),
+                       rapidjson::Value(entry.szOwner.c_str(), allocator),
+                       allocator);
+    }
+    if (!entry.szKind.empty()) {
+      object.AddMember(rapidjson::StringRef(kResourceUsageKind),
+                       rapidjson::Value(entry.szKind.c_str(), allocator),
+                       allocator);
+    }
+    object.AddMember(rapidjson::StringRef(kResourceUsageGpuBytes),
+                     static_cast<uint64_t>(entry.nGpuBytes), allocator);
+    object.AddMember(rapidjson::StringRef(kResourceUsageCpuBytes),
+                     static_cast<uint64_t>(entry.nCpuBytes), allocator);
+    list.PushBack(object, allocator);
+  }
+  return list;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+void ResourceReport::vAdd(std::string szSystem,
+                          std::string szOwner,
+                          std::string szKind,
+                          const size_t nGpuBytes,
+                          const size_t nCpuBytes) {
+  m_nTotalGpuBytes += nGpuBytes;
+  m_nTotalCpuBytes += nCpuBytes;
+  m_lstEntries.push_back({std::move(szSystem), std::move(szOwner),
+                          std::move(szKind), nGpuBytes, nCpuBytes});
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<ResourceEntry> ResourceReport::lstGetSystemTotals() const {
+  std::map<std::pair<std::string, std::string>, ResourceEntry> totals;
+  for (const auto& entry : m_lstEntries) {
+    auto& total = totals[{entry.szSystem, {}}];
+    total.szSystem = entry.szSystem;
+    total.nGpuBytes += entry.nGpuBytes;
+    total.nCpuBytes += entry.nCpuBytes;
+  }
+  return lstSortedBySize(totals);
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<ResourceEntry> ResourceReport::lstGetOwnerTotals() const {
+  std::map<std::pair<std::string, std::string>, ResourceEntry> totals;
+  for (const auto& entry : m_lstEntries) {
+    auto& total = totals[{entry.szSystem, entry.szOwner}];
+    total.szSystem = entry.szSystem;
+    total.szOwner = entry.szOwner;
+    total.nGpuBytes += entry.nGpuBytes;
+    total.nCpuBytes += entry.nCpuBytes;
+  }
+  return lstSortedBySize(totals);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ResourceReport::vLogTopConsumers(const size_t nCount) const {
+  const auto owners = lstGetOwnerTotals();
+  for (size_t i = 0; i < std::min(nCount, owners.size()); ++i) {
+    spdlog::warn("  {} {}: {} KiB GPU, {} KiB CPU", owners[i].szSystem,
+                 owners[i].szOwner, owners[i].nGpuBytes / 1024,
+                 owners[i].nCpuBytes / 1024);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+flutter::EncodableMap ResourceReport::oEncode() const {
+  flutter::EncodableList systems;
+  for (const auto& entry : lstGetSystemTotals()) {
+    systems.emplace_back(oEncodeEntry(entry));
+  }
+  flutter::EncodableList owners;
+  for (const auto& entry : lstGetOwnerTotals()) {
+    owners.emplace_back(oEncodeEntry(entry));
+  }
+  flutter::EncodableList entries;
+  for (const auto& entry : m_lstEntries) {
+    entries.emplace_back(oEncodeEntry(entry));
+  }
+
+  flutter::EncodableMap map;
+  map[flutter::EncodableValue(kResourceUsageGpuBytes)] =
+      static_cast<int64_t>(m_nTotalGpuBytes);
+  map[flutter::EncodableValue(kResourceUsageCpuBytes)] =
+      static_cast<int64_t>(m_nTotalCpuBytes);
+  map[flutter::EncodableValue(kResourceUsageSystems)] = systems;
+  map[flutter::EncodableValue(kResourceUsageOwners)] = owners;
+  map[flutter::EncodableValue(kResourceUsageEntries)] = entries;
+  return map;
+}
+
+////////////////////////////////////////////////////////////////////////////
+rapidjson::Document ResourceReport::oToJson() const {
+  rapidjson::Document document(rapidjson::kObjectType);
+  auto& allocator = document.GetAllocator();
+  document.AddMember(rapidjson::StringRef(kResourceUsageGpuBytes),
+                     static_cast<uint64_t>(m_nTotalGpuBytes), allocator);
+  document.AddMember(rapidjson::StringRef(kResourceUsageCpuBytes),
+                     static_cast<uint64_t>(m_nTotalCpuBytes), allocator);
+  document.AddMember(rapidjson::StringRef(kResourceUsageSystems),
+                     oJsonEntries(lstGetSystemTotals(), allocator), allocator);
+  document.AddMember(rapidjson::StringRef(kResourceUsageOwners),
+                     oJsonEntries(lstGetOwnerTotals(), allocator), allocator);
+  document.AddMember(rapidjson::StringRef(kResourceUsageEntries),
+                     oJsonEntries(m_lstEntries, allocator), allocator);
+  return document;
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <encodable_value.h>
+#include <rapidjson/document.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// What one system holds for one owner: an entity guid, an asset path, or a
+// description for resources shared between entities. Byte counts are
+// estimates from sizes and formats, filament doesn't report its own.
+struct ResourceEntry {
+  std::string szSystem;
+  std::string szOwner;
+  std::string szKind;
+  size_t nGpuBytes = 0;
+  size_t nCpuBytes = 0;
+};
+
+// Filled by ECSystemManager::vAccountResources, each system adding what it
+// created through ECSystem::vAccountResources.
+class ResourceReport {
+ public:
+  void vAdd(std::string szSystem,
+            std::string szOwner,
+            std::string szKind,
+            size_t nGpuBytes,
+            size_t nCpuBytes);
+
+  [[nodiscard]] const std::vector<ResourceEntry>& lstGetEntries() const {
+    return m_lstEntries;
+  }
+  [[nodiscard]] size_t nGetTotalBytes() const {
+    return m_nTotalGpuBytes + m_nTotalCpuBytes;
+  }
+
+  // Entries summed per system, and per system and owner; largest first.
+  // The kind of a summed entry is left empty.
+  [[nodiscard]] std::vector<ResourceEntry> lstGetSystemTotals() const;
+  [[nodiscard]] std::vector<ResourceEntry> lstGetOwnerTotals() const;
+
+  void vLogTopConsumers(size_t nCount) const;
+
+  [[nodiscard]] flutter::EncodableMap oEncode() const;
+  [[nodiscard]] rapidjson::Document oToJson() const;
+
+ private:
+  std::vector<ResourceEntry> m_lstEntries;
+  size_t m_nTotalGpuBytes = 0;
+  size_t m_nTotalCpuBytes = 0;
+};
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,409 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "animation_system.h"
+#include "filament_system.h"
+
+#include <core/entity/derived/model/model.h>
+#include <core/include/literals.h>
+#include <core/systems/ecsystems_manager.h>
+#include <filament/RenderableManager.h>
+#include <filament/TransformManager.h>
+#include <plugins/common/common.h>
+#include <utils/JobSystem.h>
+#include <utils/Slice.h>
+#include <chrono>
+#include <cmath>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vRegisterModel(Model* poModel) {
+  auto* asset = poModel->getAsset();
+  if (asset == nullptr || asset->getInstance() == nullptr) {
+    return;
+  }
+
+  auto* animator = asset->getInstance()->getAnimator();
+  if (animator == nullptr || animator->getAnimationCount() == 0) {
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "AnimationSystem::vRegisterModel");
+  const auto& rcm =
+      filamentSystem->getFilamentEngine()->getRenderableManager();
+
+  AnimatorState state;
+  state.poModel = poModel;
+  state.lstAnimators.push_back(animator);
+
+  utils::Slice const listOfRenderables{asset->getRenderableEntities(),
+                                       asset->getRenderableEntityCount()};
+  for (const auto entity : listOfRenderables) {
+    if (rcm.getMorphTargetCount(rcm.getInstance(entity)) > 0) {
+      state.bHasMorphTargets = true;
+      break;
+    }
+  }
+
+  if (const auto* animation = poModel->GetAnimation();
+      animation != nullptr && animation->GetAutoPlay()) {
+    int32_t nIndex = animation->GetIndex().value_or(0);
+    if (!animation->GetName().empty()) {
+      for (size_t i = 0; i < animator->getAnimationCount(); ++i) {
+        if (animation->GetName() == animator->getAnimationName(i)) {
+          nIndex = static_cast<int32_t>(i);
+          break;
+        }
+      }
+    }
+    vStartAnimation(state, nIndex, true, 0.0f);
+  }
+
+  SPDLOG_DEBUG("AnimationSystem: {} registered with {} animations, morph {}",
+               poModel->GetGlobalGuid(), animator->getAnimationCount(),
+               state.bHasMorphTargets);
+
+  m_mapAnimatorStates[poModel->GetGlobalGuid()] = std::move(state);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vAddLinkedAsset(
+    const EntityGUID& guid,
+    filament::gltfio::FilamentAsset* poAsset) {
+  const auto iter = m_mapAnimatorStates.find(guid);
+  if (iter == m_mapAnimatorStates.end() || poAsset == nullptr ||
+      poAsset->getInstance() == nullptr) {
+    return;
+  }
+
+  auto* animator = poAsset->getInstance()->getAnimator();
+  const auto* primary = iter->second.lstAnimators[0];
+  if (animator == nullptr ||
+      animator->getAnimationCount() != primary->getAnimationCount()) {
+    spdlog::warn("AnimationSystem: linked asset for {} has other animations",
+                 guid);
+    return;
+  }
+  iter->second.lstAnimators.push_back(animator);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vUnregisterModel(const EntityGUID& guid) {
+  m_mapAnimatorStates.erase(guid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vStartAnimation(AnimatorState& state,
+                                      const int32_t nIndex,
+                                      const bool bLoop,
+                                      const float fCrossFadeSeconds) {
+  const auto* animator = state.lstAnimators[0];
+  if (nIndex < 0 ||
+      static_cast<size_t>(nIndex) >= animator->getAnimationCount()) {
+    spdlog::warn("AnimationSystem: {} has no animation index {}",
+                 state.poModel->GetGlobalGuid(), nIndex);
+    return;
+  }
+
+  if (fCrossFadeSeconds > 0.0f && state.bPlaying && state.nCurrent >= 0 &&
+      state.nCurrent != nIndex) {
+    state.nPrevious = state.nCurrent;
+    state.fPreviousTime = state.fTime;
+    state.fCrossFadeDuration = fCrossFadeSeconds;
+    state.fCrossFadeElapsed = 0.0f;
+  } else {
+    state.nPrevious = -1;
+  }
+
+  state.nCurrent = nIndex;
+  state.fTime = 0.0f;
+  state.bLoop = bLoop;
+  state.bPlaying = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vPlayAnimation(const EntityGUID& guid,
+                                     const int32_t nIndex,
+                                     const bool bLoop,
+                                     const float fCrossFadeSeconds) {
+  for (auto& [stateGuid, state] : m_mapAnimatorStates) {
+    if (guid.empty() || guid == stateGuid) {
+      vStartAnimation(state, nIndex, bLoop, fCrossFadeSeconds);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vPlayAnimation(const EntityGUID& guid,
+                                     const std::string& szName,
+                                     const bool bLoop,
+                                     const float fCrossFadeSeconds) {
+  for (auto& [stateGuid, state] : m_mapAnimatorStates) {
+    if (!guid.empty() && guid != stateGuid) {
+      continue;
+    }
+
+    const auto* animator = state.lstAnimators[0];
+    for (size_t i = 0; i < animator->getAnimationCount(); ++i) {
+      if (szName == animator->getAnimationName(i)) {
+        vStartAnimation(state, static_cast<int32_t>(i), bLoop,
+                        fCrossFadeSeconds);
+        break;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vAdvance(AnimatorState& state, const float fElapsedTime) {
+  if (!state.bPlaying) {
+    return;
+  }
+
+  const auto* animator = state.lstAnimators[0];
+  const float fDuration = animator->getAnimationDuration(state.nCurrent);
+
+  state.fTime += fElapsedTime;
+  if (state.fTime >= fDuration) {
+    if (state.bLoop && fDuration > 0.0f) {
+      state.fTime = std::fmod(state.fTime, fDuration);
+    } else {
+      // Hold on the last frame; it's still applied this update.
+      state.fTime = fDuration;
+      state.bPlaying = false;
+    }
+  }
+
+  if (state.nPrevious >= 0) {
+    state.fCrossFadeElapsed += fElapsedTime;
+    if (state.fCrossFadeElapsed >= state.fCrossFadeDuration) {
+      state.nPrevious = -1;
+    } else {
+      const float fPreviousDuration =
+          animator->getAnimationDuration(state.nPrevious);
+      state.fPreviousTime += fElapsedTime;
+      if (fPreviousDuration > 0.0f) {
+        state.fPreviousTime = std::fmod(state.fPreviousTime, fPreviousDuration);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vApply(const AnimatorState& state) {
+  for (auto* animator : state.lstAnimators) {
+    animator->applyAnimation(state.nCurrent, state.fTime);
+    if (state.nPrevious >= 0) {
+      animator->applyCrossFade(
+          state.nPrevious, state.fPreviousTime,
+          state.fCrossFadeElapsed / state.fCrossFadeDuration);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::setupMessageChannels(
+    flutter::PluginRegistrar* plugin_registrar) {
+  auto channel_name = std::string("plugin.filament_view.animation_info");
+
+  animationInfoCallback_ = std::make_unique<flutter::MethodChannel<>>(
+      plugin_registrar->messenger(), channel_name,
+      &flutter::StandardMethodCodec::GetInstance());
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::SendAnimationInformationCallback() const {
+  if (animationInfoCallback_ == nullptr) {
+    return;
+  }
+
+  flutter::EncodableMap encodableMap;
+  for (const auto& [guid, state] : m_mapAnimatorStates) {
+    const auto* animator = state.lstAnimators[0];
+
+    flutter::EncodableList names;
+    for (size_t i = 0; i < animator->getAnimationCount(); ++i) {
+      names.emplace_back(std::string(animator->getAnimationName(i)));
+    }
+
+    flutter::EncodableMap modelInfo;
+    modelInfo[flutter::EncodableValue(kAnimationInfoNames)] = names;
+    modelInfo[flutter::EncodableValue(kAnimationInfoCount)] =
+        static_cast<int>(animator->getAnimationCount());
+    modelInfo[flutter::EncodableValue(kAnimationInfoCurrentIndex)] =
+        state.nCurrent;
+    modelInfo[flutter::EncodableValue(kAnimationInfoIsPlaying)] =
+        state.bPlaying;
+
+    encodableMap[flutter::EncodableValue(guid)] = modelInfo;
+  }
+
+  animationInfoCallback_->InvokeMethod(
+      kAnimationInfo, std::make_unique<flutter::EncodableValue>(
+                          flutter::EncodableValue(encodableMap)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vInitSystem() {
+  vRegisterMessageHandler(
+      ECSMessageType::SetupMessageChannels, [this](const ECSMessage& msg) {
+        spdlog::debug("SetupMessageChannels");
+
+        const auto registrar = msg.getData<flutter::PluginRegistrar*>(
+            ECSMessageType::SetupMessageChannels);
+
+        setupMessageChannels(registrar);
+
+        spdlog::debug("SetupMessageChannels Complete");
+      });
+
+  const auto playHandler = [this](const ECSMessage& msg) {
+    const auto guid =
+        msg.hasData(ECSMessageType::ChangeAnimationWhichGuid)
+            ? msg.getData<EntityGUID>(ECSMessageType::ChangeAnimationWhichGuid)
+            : EntityGUID();
+    const bool bLoop = !msg.hasData(ECSMessageType::ChangeAnimationLoop) ||
+                       msg.getData<bool>(ECSMessageType::ChangeAnimationLoop);
+    const float fCrossFadeSeconds =
+        msg.hasData(ECSMessageType::ChangeAnimationCrossFadeSeconds)
+            ? msg.getData<float>(
+                  ECSMessageType::ChangeAnimationCrossFadeSeconds)
+            : 0.0f;
+
+    if (msg.hasData(ECSMessageType::ChangeAnimationByIndex)) {
+      vPlayAnimation(
+          guid, msg.getData<int32_t>(ECSMessageType::ChangeAnimationByIndex),
+          bLoop, fCrossFadeSeconds);
+    } else {
+      vPlayAnimation(
+          guid,
+          msg.getData<std::string>(ECSMessageType::ChangeAnimationByName),
+          bLoop, fCrossFadeSeconds);
+    }
+  };
+  vRegisterMessageHandler(ECSMessageType::ChangeAnimationByIndex, playHandler);
+  vRegisterMessageHandler(ECSMessageType::ChangeAnimationByName, playHandler);
+
+  vRegisterMessageHandler(ECSMessageType::RequestAnimationInfo,
+                          [this](const ECSMessage& /*msg*/) {
+                            SendAnimationInformationCallback();
+                          });
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vUpdate(const float fElapsedTime) {
+  if (m_mapAnimatorStates.empty()) {
+    return;
+  }
+
+  m_lstParallelStates.clear();
+  m_lstSerialStates.clear();
+  for (auto& [guid, state] : m_mapAnimatorStates) {
+    if (!state.bPlaying && state.nPrevious < 0) {
+      continue;
+    }
+    vAdvance(state, fElapsedTime);
+    (state.bHasMorphTargets ? m_lstSerialStates : m_lstParallelStates)
+        .push_back(&state);
+  }
+
+  if (m_lstParallelStates.empty() && m_lstSerialStates.empty()) {
+    return;
+  }
+
+  const auto evaluateStart = std::chrono::steady_clock::now();
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "AnimationSystem::vUpdate");
+  auto* engine = filamentSystem->getFilamentEngine();
+  auto& tm = engine->getTransformManager();
+
+  // Animators only write local transforms here; the world transforms of all
+  // animated hierarchies are resolved once on commit instead of per node.
+  tm.openLocalTransformTransaction();
+
+  if (m_lstParallelStates.size() >= 2 * kInstancesPerJob) {
+    // Transform-only animators touch disjoint TransformManager instances, so
+    // they can be evaluated concurrently. The engine thread adopted the
+    // JobSystem on creation and helps out in runAndWait.
+    auto& js = engine->getJobSystem();
+    auto* job = utils::jobs::parallel_for(
+        js, nullptr, 0, static_cast<uint32_t>(m_lstParallelStates.size()),
+        [this](const uint32_t start, const uint32_t count) {
+          for (uint32_t i = start; i < start + count; ++i) {
+            vApply(*m_lstParallelStates[i]);
+          }
+        },
+        utils::jobs::CountSplitter<kInstancesPerJob>());
+    js.runAndWait(job);
+  } else {
+    for (const auto* state : m_lstParallelStates) {
+      vApply(*state);
+    }
+  }
+
+  for (const auto* state : m_lstSerialStates) {
+    vApply(*state);
+  }
+
+  tm.commitLocalTransformTransaction();
+
+  // Skinning uploads go through the RenderableManager, Filament thread only.
+  for (const auto* state : m_lstParallelStates) {
+    for (auto* animator : state->lstAnimators) {
+      animator->updateBoneMatrices();
+    }
+  }
+  for (const auto* state : m_lstSerialStates) {
+    for (auto* animator : state->lstAnimators) {
+      animator->updateBoneMatrices();
+    }
+  }
+
+  const std::chrono::duration<float, std::micro> evaluateTime =
+      std::chrono::steady_clock::now() - evaluateStart;
+  m_fStatsEvaluateMicroseconds += evaluateTime.count();
+  ++m_nStatsFrames;
+  m_fStatsElapsed += fElapsedTime;
+  if (m_fStatsElapsed >= kStatsIntervalSeconds) {
+    spdlog::debug(
+        "AnimationSystem: {} playing ({} parallel on {} threads, {} serial), "
+        "avg evaluate {:.1f} us",
+        m_lstParallelStates.size() + m_lstSerialStates.size(),
+        m_lstParallelStates.size(),
+        engine->getJobSystem().getThreadCount(), m_lstSerialStates.size(),
+        m_fStatsEvaluateMicroseconds / static_cast<float>(m_nStatsFrames));
+    m_fStatsElapsed = 0.0f;
+    m_nStatsFrames = 0;
+    m_fStatsEvaluateMicroseconds = 0.0f;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::vShutdownSystem() {
+  m_mapAnimatorStates.clear();
+  animationInfoCallback_.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void AnimationSystem::DebugPrint() {
+  SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/entity/base/entityobject.h>
+#include <core/systems/base/ecsystem.h>
+#include <flutter_desktop_plugin_registrar.h>
+#include <gltfio/Animator.h>
+#include <gltfio/FilamentAsset.h>
+#include <map>
+#include <vector>
+
+namespace plugin_filament_view {
+
+class Model;
+
+// Owns the playback state of every animated model and drives the gltfio
+// Animators once per frame.
+class AnimationSystem : public ECSystem {
+ public:
+  AnimationSystem() = default;
+
+  // Disallow copy and assign.
+  AnimationSystem(const AnimationSystem&) = delete;
+  AnimationSystem& operator=(const AnimationSystem&) = delete;
+
+  // No-op for models without animations. Honors the model's autoPlay.
+  void vRegisterModel(Model* poModel);
+  // Additional assets (e.g. lod variants) that mirror the model's playback.
+  void vAddLinkedAsset(const EntityGUID& guid,
+                       filament::gltfio::FilamentAsset* poAsset);
+  void vUnregisterModel(const EntityGUID& guid);
+
+  // An empty guid applies to every animated model.
+  void vPlayAnimation(const EntityGUID& guid,
+                      int32_t nIndex,
+                      bool bLoop,
+                      float fCrossFadeSeconds);
+  void vPlayAnimation(const EntityGUID& guid,
+                      const std::string& szName,
+                      bool bLoop,
+                      float fCrossFadeSeconds);
+
+  void setupMessageChannels(flutter::PluginRegistrar* plugin_registrar);
+
+  // Sends names, count and current index of every animated model to Dart.
+  void SendAnimationInformationCallback() const;
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(AnimationSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  struct AnimatorState {
+    Model* poModel = nullptr;
+    // [0] is the model's own animator.
+    std::vector<filament::gltfio::Animator*> lstAnimators;
+    // Morph weights are pushed through the RenderableManager, which has to
+    // stay on the Filament API thread.
+    bool bHasMorphTargets = false;
+
+    int32_t nCurrent = -1;
+    float fTime = 0.0f;
+    bool bLoop = true;
+    bool bPlaying = false;
+
+    // Cross-fade source, -1 once the fade completed.
+    int32_t nPrevious = -1;
+    float fPreviousTime = 0.0f;
+    float fCrossFadeDuration = 0.0f;
+    float fCrossFadeElapsed = 0.0f;
+  };
+
+  // Below this many playing instances the job overhead outweighs the gain.
+  static constexpr size_t kInstancesPerJob = 4;
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
+  std::map<EntityGUID, AnimatorState> m_mapAnimatorStates;
+
+  // Scratch lists rebuilt every frame, kept to avoid reallocating.
+  std::vector<AnimatorState*> m_lstParallelStates;
+  std::vector<AnimatorState*> m_lstSerialStates;
+
+  std::unique_ptr<flutter::MethodChannel<>> animationInfoCallback_;
+
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsFrames = 0;
+  float m_fStatsEvaluateMicroseconds = 0.0f;
+
+  static void vStartAnimation(AnimatorState& state,
+                              int32_t nIndex,
+                              bool bLoop,
+                              float fCrossFadeSeconds);
+  static void vAdvance(AnimatorState& state, float fElapsedTime);
+  static void vApply(const AnimatorState& state);
+};
+}  // namespace plugin_filament_view
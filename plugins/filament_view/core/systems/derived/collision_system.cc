@@ -15,14 +15,20 @@
  */
 #include "collision_system.h"
 #include "filament_system.h"
+#include "model_system.h"
+#include "shape_system.h"
 
 #include <core/entity/derived/model/model.h>
 #include <core/entity/derived/shapes/cube.h>
 #include <core/entity/derived/shapes/plane.h>
 #include <core/entity/derived/shapes/sphere.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/ecsystems_manager.h>
+#include <filament/Camera.h>
 #include <filament/Scene.h>
 #include <plugins/common/common.h>
+#include <algorithm>
+#include <chrono>
 
 namespace plugin_filament_view {
 
@@ -36,8 +42,10 @@ flutter::EncodableValue HitResult::Encode() const {
 
   // Create a map to represent the HitResult
   flutter::EncodableMap encodableMap = {
-      {flutter::EncodableValue("guid"), flutter::EncodableValue(guid_)},
-      {flutter::EncodableValue("name"), flutter::EncodableValue(name_)},
+      {flutter::EncodableValue("guid"),
+       flutter::EncodableValue(std::string(guid_))},
+      {flutter::EncodableValue("name"),
+       flutter::EncodableValue(std::string(name_))},
       {flutter::EncodableValue("hitPosition"),
        flutter::EncodableValue(hitPosition)}};
 
@@ -209,10 +217,11 @@ inline float fLength2(const filament::math::float3& v) {
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
-std::list<HitResult> CollisionSystem::lstCheckForCollidable(
+std::pmr::vector<HitResult> CollisionSystem::lstCheckForCollidable(
     Ray& rayCast,
     int64_t /*collisionLayer*/) const {
-  std::list<HitResult> hitResults;
+  std::pmr::vector<HitResult> hitResults(
+      ECSystemManager::GetInstance()->poGetFrameResource());
 
   // Iterate over all entities.
   for (const auto& entity : collidables_) {
@@ -241,24 +250,121 @@ std::list<HitResult> CollisionSystem::lstCheckForCollidable(
       SPDLOG_WARN("HIT RESULT: {}", hitResult.guid_);
 
       // Add to the hit results
-      hitResults.push_back(hitResult);
+      hitResults.push_back(std::move(hitResult));
     }
   }
 
   // Sort hit results by distance from the ray's origin
-  hitResults.sort([&rayCast](const HitResult& a, const HitResult& b) {
-    // Calculate the squared distance to avoid the cost of sqrt
-    const auto distanceA = fLength2(a.hitPosition_ - rayCast.f3GetPosition());
-    const auto distanceB = fLength2(b.hitPosition_ - rayCast.f3GetPosition());
-
-    // Sort in ascending order (closest hit first)
-    return distanceA < distanceB;
-  });
+  std::sort(hitResults.begin(), hitResults.end(),
+            [&rayCast](const HitResult& a, const HitResult& b) {
+              // Calculate the squared distance to avoid the cost of sqrt
+              const auto distanceA =
+                  fLength2(a.hitPosition_ - rayCast.f3GetPosition());
+              const auto distanceB =
+                  fLength2(b.hitPosition_ - rayCast.f3GetPosition());
+
+              // Sort in ascending order (closest hit first)
+              return distanceA < distanceB;
+            });
 
   // Return the sorted list of hit results
   return hitResults;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////
+void CollisionSystem::vPick(filament::View* poView,
+                            const filament::math::float2& viewportPosition,
+                            std::string sourceQuery,
+                            const CollisionEventType eType) const {
+  const auto& viewport = poView->getViewport();
+  if (viewportPosition.x < 0.0f || viewportPosition.y < 0.0f ||
+      viewportPosition.x >= static_cast<float>(viewport.width) ||
+      viewportPosition.y >= static_cast<float>(viewport.height)) {
+    SendCollisionInformationCallback({}, std::move(sourceQuery), eType);
+    return;
+  }
+
+  const auto& camera = poView->getCamera();
+  const filament::math::float2 viewportSize(
+      static_cast<float>(viewport.width), static_cast<float>(viewport.height));
+  const auto inverseProjection = inverse(camera.getProjectionMatrix());
+  const auto cameraModel = camera.getModelMatrix();
+  const auto requestTime = std::chrono::steady_clock::now();
+
+  // The callback runs on this thread from a later beginFrame, once the
+  // frame holding the touch point has been drawn and read back.
+  poView->pick(
+      static_cast<uint32_t>(viewportPosition.x),
+      static_cast<uint32_t>(viewportPosition.y),
+      [this, viewportSize, inverseProjection, cameraModel, requestTime,
+       sourceQuery = std::move(sourceQuery),
+       eType](const filament::View::PickingQueryResult& result) {
+        std::pmr::vector<HitResult> hitList(
+            ECSystemManager::GetInstance()->poGetFrameResource());
+        if (auto hitResult = oResolvePick(result, viewportSize,
+                                          inverseProjection, cameraModel)) {
+          hitList.push_back(std::move(*hitResult));
+        }
+
+        spdlog::debug(
+            "Pick resolved {} hits in {:.1f} ms", hitList.size(),
+            std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - requestTime)
+                .count());
+
+        SendCollisionInformationCallback(hitList, sourceQuery, eType);
+      });
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+std::optional<HitResult> CollisionSystem::oResolvePick(
+    const filament::View::PickingQueryResult& result,
+    const filament::math::float2& viewportSize,
+    const filament::math::mat4& inverseProjection,
+    const filament::math::mat4& cameraModel) {
+  if (result.renderable.isNull()) {
+    return std::nullopt;
+  }
+
+  // fragCoords is in GL window space: pixels within the viewport and depth
+  // in [0, 1]. Back to clip space, then through the camera to world space.
+  const auto windowPosition = result.fragCoords.xy / viewportSize;
+  const filament::math::double4 clip(windowPosition.x * 2.0 - 1.0,
+                                     windowPosition.y * 2.0 - 1.0,
+                                     result.fragCoords.z * 2.0 - 1.0, 1.0);
+  auto viewPosition = inverseProjection * clip;
+  viewPosition /= viewPosition.w;
+  const filament::math::float3 hitPosition((cameraModel * viewPosition).xyz);
+
+  const auto ecsManager = ECSystemManager::GetInstance();
+  HitResult hitResult;
+  hitResult.hitPosition_ = hitPosition;
+
+  const auto shapeSystem = ecsManager->poGetSystemAs<ShapeSystem>(
+      ShapeSystem::StaticGetTypeID(), "oResolvePick");
+  if (const auto* shape =
+          shapeSystem ? shapeSystem->poFindShapeByRenderable(result.renderable,
+                                                             hitPosition)
+                      : nullptr) {
+    hitResult.guid_ = shape->GetGlobalGuid();
+    hitResult.name_ = shape->GetName();
+    return hitResult;
+  }
+
+  const auto modelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+      ModelSystem::StaticGetTypeID(), "oResolvePick");
+  if (const auto* model =
+          modelSystem ? modelSystem->poFindModelByRenderable(result.renderable)
+                      : nullptr) {
+    hitResult.guid_ = model->GetGlobalGuid();
+    hitResult.name_ = model->GetName();
+    return hitResult;
+  }
+
+  // Something we don't track, e.g. a debug collidable or line.
+  return std::nullopt;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 void CollisionSystem::setupMessageChannels(
     flutter::PluginRegistrar* plugin_registrar) {
@@ -271,7 +377,7 @@ void CollisionSystem::setupMessageChannels(
 
 /////////////////////////////////////////////////////////////////////////////////////////
 void CollisionSystem::SendCollisionInformationCallback(
-    const std::list<HitResult>& lstHitResults,
+    const std::pmr::vector<HitResult>& lstHitResults,
     std::string sourceQuery,
     const CollisionEventType eType) const {
   if (collisionInfoCallback_ == nullptr) {
@@ -300,8 +406,8 @@ void CollisionSystem::SendCollisionInformationCallback(
     ++iter;
   }
   collisionInfoCallback_->InvokeMethod(
-      kCollisionEvent, std::make_unique<flutter::EncodableValue>(
-                           flutter::EncodableValue(encodableMap)));
+      kCollisionEvent,
+      std::make_unique<flutter::EncodableValue>(std::move(encodableMap)));
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -314,11 +420,38 @@ void CollisionSystem::vInitSystem() {
         const auto type = msg.getData<CollisionEventType>(
             ECSMessageType::CollisionRequestType);
 
+        // Only touches carry a view to pick in; rays sent from Dart are
+        // always tested against collidables.
+        if (m_ePickingMode == PickingMode::Gpu &&
+            msg.hasData(ECSMessageType::CollisionRequestView)) {
+          vPick(msg.getData<filament::View*>(
+                    ECSMessageType::CollisionRequestView),
+                msg.getData<filament::math::float2>(
+                    ECSMessageType::CollisionRequestViewportPosition),
+                requestor, type);
+          return;
+        }
+
         const auto hitList = lstCheckForCollidable(rayInfo, 0);
 
         SendCollisionInformationCallback(hitList, requestor, type);
       });
 
+  vRegisterMessageHandler(
+      ECSMessageType::ChangePickingMode, [this](const ECSMessage& msg) {
+        const auto value =
+            msg.getData<std::string>(ECSMessageType::ChangePickingMode);
+        if (value == kPickingModeGpu) {
+          m_ePickingMode = PickingMode::Gpu;
+        } else if (value == kPickingModeCollidables) {
+          m_ePickingMode = PickingMode::Collidables;
+        } else {
+          spdlog::warn("ChangePickingMode: unknown mode {}", value);
+          return;
+        }
+        spdlog::debug("ChangePickingMode: {}", value);
+      });
+
   vRegisterMessageHandler(
       ECSMessageType::SetupMessageChannels, [this](const ECSMessage& msg) {
         spdlog::debug("SetupMessageChannels");
@@ -355,4 +488,18 @@ void CollisionSystem::vUpdate(float /*fElapsedTime*/) {}
 /////////////////////////////////////////////////////////////////////////////////////////
 void CollisionSystem::vShutdownSystem() {}
 
+/////////////////////////////////////////////////////////////////////////////////////////
+void CollisionSystem::vAccountResources(ResourceReport& report) const {
+  // Collision shapes are plain CPU structures; the debug representations
+  // share their buffers with ShapeSystem.
+  for (const auto* collidable : collidables_) {
+    report.vAdd("CollisionSystem", collidable->GetGlobalGuid(), "collidable",
+                0, sizeof(Collidable));
+  }
+  for (const auto& [guid, shape] : collidablesDebugDrawingRepresentation_) {
+    report.vAdd("CollisionSystem", guid, "debug shape", 0,
+                sizeof(shapes::BaseShape));
+  }
+}
+
 }  // namespace plugin_filament_view
@@ -20,15 +20,24 @@
 #include <core/entity/derived/shapes/baseshape.h>
 #include <core/include/literals.h>
 #include <core/systems/base/ecsystem.h>
+#include <filament/View.h>
+#include <filament/math/mat4.h>
+#include <filament/math/vec2.h>
 #include <flutter_desktop_plugin_registrar.h>
 #include <list>
+#include <memory_resource>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 namespace plugin_filament_view {
 
+// guid_ and name_ point at the hit entity's own strings; results are sent
+// within the strand task that found them, while the entity is alive.
 class HitResult {
  public:
-  EntityGUID guid_;
-  std::string name_;
+  std::string_view guid_;
+  std::string_view name_;
   ::filament::math::float3 hitPosition_;
 
   [[nodiscard]] flutter::EncodableValue Encode() const;
@@ -39,11 +48,19 @@ class HitResult {
 // efficient.
 class CollisionSystem : public ECSystem {
  public:
+  // Collidables tests touch rays against Collidable components. Gpu asks
+  // filament which renderable is drawn under the touch point; it is pixel
+  // exact on any mesh and needs no collidables, but answers a frame or two
+  // later and reports only the front most hit.
+  enum class PickingMode { Collidables, Gpu };
+
   CollisionSystem() = default;
 
   void vCleanup();
   void DebugPrint() override;
 
+  void vAccountResources(ResourceReport& report) const override;
+
   // Disallow copy and assign.
   CollisionSystem(const CollisionSystem&) = delete;
   CollisionSystem& operator=(const CollisionSystem&) = delete;
@@ -68,22 +85,41 @@ class CollisionSystem : public ECSystem {
   void setupMessageChannels(flutter::PluginRegistrar* plugin_registrar);
 
   // send in your ray, get a list of hit results back, collisionLayer not
-  // actively used - future work.
-  std::list<HitResult> lstCheckForCollidable(Ray& rayCast,
-                                             int64_t collisionLayer = 0) const;
+  // actively used - future work. The list is in the frame arena, so it must
+  // not be kept past the current strand task.
+  std::pmr::vector<HitResult> lstCheckForCollidable(
+      Ray& rayCast,
+      int64_t collisionLayer = 0) const;
 
   // this will send the hit information sent in to non-native (Dart) code.
   void SendCollisionInformationCallback(
-      const std::list<HitResult>& lstHitResults,
+      const std::pmr::vector<HitResult>& lstHitResults,
       std::string sourceQuery,
       CollisionEventType eType) const;
 
+  // Resolves the renderable under viewportPosition (pixels, origin bottom
+  // left) once filament has rendered it, then sends the hit, if any, like
+  // SendCollisionInformationCallback does.
+  void vPick(filament::View* poView,
+             const filament::math::float2& viewportPosition,
+             std::string sourceQuery,
+             CollisionEventType eType) const;
+
   // Checks to see if we already has this guid in our mapping.
   [[nodiscard]] bool bHasEntityObjectRepresentation(
       const EntityGUID& guid) const;
 
  private:
   bool currentlyDrawingDebugCollidables = false;
+  PickingMode m_ePickingMode = PickingMode::Collidables;
+
+  // Maps a pick result back to the shape or model it drew. The matrices
+  // are the camera's at request time.
+  static std::optional<HitResult> oResolvePick(
+      const filament::View::PickingQueryResult& result,
+      const filament::math::float2& viewportSize,
+      const filament::math::mat4& inverseProjection,
+      const filament::math::mat4& cameraModel);
 
   void vMatchCollidablesToRenderingModelsTransforms();
   void vMatchCollidablesToDebugDrawingTransforms();
@@ -18,88 +18,37 @@
 #include "filament_system.h"
 
 #include <core/scene/geometry/ray.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/ecsystems_manager.h>
-#include <core/utils/entitytransforms.h>
+#include <filament/Box.h>
 #include <filament/Engine.h>
 #include <filament/IndexBuffer.h>
 #include <filament/RenderableManager.h>
 #include <filament/Scene.h>
 #include <filament/VertexBuffer.h>
 #include <plugins/common/common.h>
+#include <utils/EntityManager.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 using filament::IndexBuffer;
 using filament::RenderableManager;
 using filament::VertexAttribute;
 using filament::VertexBuffer;
+using filament::math::float3;
 
 namespace plugin_filament_view {
 
-/////////////////////////////////////////////////////////////////////////////////////////
-DebugLine::DebugLine(filament::math::float3 startingPoint,
-                     filament::math::float3 endingPoint,
-                     filament::Engine* engine,
-                     std::shared_ptr<Entity> entity,
-                     float fTimeToLive)
-    : m_fRemainingTime(fTimeToLive),
-      m_poEntity(std::move(entity))  // Create entity
-{
-  vertices_.emplace_back(startingPoint);
-  vertices_.emplace_back(endingPoint);  //,
-  indices_.emplace_back(0);
-  indices_.emplace_back(1);
-
-  // Initialize the VertexBuffer for the quad
-  m_poVertexBuffer = VertexBuffer::Builder()
-                         .vertexCount(2)  // Four vertices for the quad
-                         .bufferCount(1)  // Single buffer for positions
-                         .attribute(VertexAttribute::POSITION, 0,
-                                    VertexBuffer::AttributeType::FLOAT3)
-                         .build(*engine);
-
-  // Set vertex buffer data
-  m_poVertexBuffer->setBufferAt(
-      *engine, 0,
-      VertexBuffer::BufferDescriptor(vertices_.data(),
-                                     vertices_.size() * sizeof(float) * 3));
-
-  // Initialize the IndexBuffer for the quad (two triangles)
-  constexpr int indexCount = 2;
-  m_poIndexBuffer = IndexBuffer::Builder()
-                        .indexCount(indexCount)
-                        .bufferType(IndexBuffer::IndexType::USHORT)
-                        .build(*engine);
-
-  // Set index buffer data
-  m_poIndexBuffer->setBuffer(
-      *engine, IndexBuffer::BufferDescriptor(
-                   indices_.data(), indices_.size() * sizeof(unsigned short)));
-
-  boundingBox_.min = startingPoint;
-  boundingBox_.max = endingPoint;
-
-  // Build the Renderable with the vertex and index buffers
-  RenderableManager::Builder(1)
-      .boundingBox({{}, boundingBox_.extent()})
-      .geometry(0, RenderableManager::PrimitiveType::LINES, m_poVertexBuffer,
-                m_poIndexBuffer)
-      .culling(false)
-      .receiveShadows(false)
-      .castShadows(false)
-      .build(*engine, *m_poEntity);
-}
+namespace {
 
-/////////////////////////////////////////////////////////////////////////////////////////
-void DebugLine::vCleanup(filament::Engine* engine) {
-  if (m_poVertexBuffer) {
-    engine->destroy(m_poVertexBuffer);
-    m_poVertexBuffer = nullptr;
-  }
-  if (m_poIndexBuffer) {
-    engine->destroy(m_poIndexBuffer);
-    m_poIndexBuffer = nullptr;
-  }
+void vFreeUploadBuffer(void* buffer, size_t /* size */, void* /* user */) {
+  free(buffer);
 }
 
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////////////////////////
 DebugLinesSystem::DebugLinesSystem() {}
 
@@ -110,44 +59,207 @@ void DebugLinesSystem::DebugPrint() {
 
 /////////////////////////////////////////////////////////////////////////////////////////
 void DebugLinesSystem::vCleanup() {
+  m_vecVertices.clear();
+  m_vecTimeToLive.clear();
+  m_nOldest = 0;
+  m_bDirty = false;
+
+  if (m_nCapacity == 0) {
+    return;
+  }
+
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
           FilamentSystem::StaticGetTypeID(), "DebugLinesSystem::vCleanup");
   const auto engine = filamentSystem->getFilamentEngine();
 
-  for (auto it = ourLines_.begin(); it != ourLines_.end();) {
-    filamentSystem->getFilamentScene()->removeEntities((*it)->m_poEntity.get(),
-                                                       1);
+  if (m_bInScene) {
+    filamentSystem->getFilamentScene()->remove(m_oEntity);
+    m_bInScene = false;
+  }
+
+  engine->destroy(m_oEntity);
+  engine->getEntityManager().destroy(m_oEntity);
+  m_oEntity = {};
+
+  engine->destroy(m_poVertexBuffer);
+  m_poVertexBuffer = nullptr;
+  engine->destroy(m_poIndexBuffer);
+  m_poIndexBuffer = nullptr;
+  m_nCapacity = 0;
+}
 
-    // do visual cleanup here
-    (*it)->vCleanup(engine);
+/////////////////////////////////////////////////////////////////////////////////////////
+void DebugLinesSystem::vEnsureCapacity(filament::Engine* engine,
+                                       const size_t nLines) {
+  if (nLines <= m_nCapacity) {
+    return;
+  }
 
-    it = ourLines_.erase(it);
+  size_t nCapacity = std::max(kInitialLineCapacity, m_nCapacity);
+  while (nCapacity < nLines) {
+    nCapacity *= 2;
+  }
+  nCapacity = std::min(nCapacity, kMaxLines);
+  const auto nVertices = static_cast<uint32_t>(nCapacity * 2);
+
+  auto* vertexBuffer = VertexBuffer::Builder()
+                           .vertexCount(nVertices)
+                           .bufferCount(1)
+                           .attribute(VertexAttribute::POSITION, 0,
+                                      VertexBuffer::AttributeType::FLOAT3)
+                           .build(*engine);
+
+  // Lines are drawn in vertex order, so the indices never change.
+  auto* indexBuffer = IndexBuffer::Builder()
+                          .indexCount(nVertices)
+                          .bufferType(IndexBuffer::IndexType::UINT)
+                          .build(*engine);
+  auto* indices =
+      static_cast<uint32_t*>(malloc(nVertices * sizeof(uint32_t)));
+  for (uint32_t i = 0; i < nVertices; ++i) {
+    indices[i] = i;
   }
+  indexBuffer->setBuffer(
+      *engine, IndexBuffer::BufferDescriptor(
+                   indices, nVertices * sizeof(uint32_t), vFreeUploadBuffer));
+
+  if (m_nCapacity == 0) {
+    m_oEntity = engine->getEntityManager().create();
+    RenderableManager::Builder(1)
+        .boundingBox({{}, {1.0f}})
+        .geometry(0, RenderableManager::PrimitiveType::LINES, vertexBuffer,
+                  indexBuffer, 0, 0)
+        .culling(false)
+        .receiveShadows(false)
+        .castShadows(false)
+        .build(*engine, m_oEntity);
+  } else {
+    // The renderable is repointed in vUpload, before anything is drawn.
+    auto& rm = engine->getRenderableManager();
+    rm.setGeometryAt(rm.getInstance(m_oEntity), 0,
+                     RenderableManager::PrimitiveType::LINES, vertexBuffer,
+                     indexBuffer, 0, 0);
+    engine->destroy(m_poVertexBuffer);
+    engine->destroy(m_poIndexBuffer);
+  }
+
+  m_poVertexBuffer = vertexBuffer;
+  m_poIndexBuffer = indexBuffer;
+  m_nCapacity = nCapacity;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
-void DebugLinesSystem::vUpdate(const float fElapsedTime) {
+void DebugLinesSystem::vUpload(filament::Engine* engine) {
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "DebugLinesSystem::vUpdate");
-  const auto engine = filamentSystem->getFilamentEngine();
+          FilamentSystem::StaticGetTypeID(), "DebugLinesSystem::vUpload");
+  auto* scene = filamentSystem->getFilamentScene();
+
+  const size_t nLines = m_vecTimeToLive.size();
+  if (nLines == 0) {
+    if (m_bInScene) {
+      scene->remove(m_oEntity);
+      m_bInScene = false;
+    }
+    return;
+  }
+
+  vEnsureCapacity(engine, nLines);
 
-  for (auto it = ourLines_.begin(); it != ourLines_.end();) {
-    (*it)->m_fRemainingTime -= fElapsedTime;
+  // Filament consumes the upload asynchronously, so it gets its own copy.
+  const size_t nBytes = m_vecVertices.size() * sizeof(float3);
+  auto* vertices = malloc(nBytes);
+  std::memcpy(vertices, m_vecVertices.data(), nBytes);
+  m_poVertexBuffer->setBufferAt(
+      *engine, 0,
+      VertexBuffer::BufferDescriptor(vertices, nBytes, vFreeUploadBuffer));
+
+  float3 min = m_vecVertices[0];
+  float3 max = m_vecVertices[0];
+  for (const auto& vertex : m_vecVertices) {
+    min = filament::math::min(min, vertex);
+    max = filament::math::max(max, vertex);
+  }
+
+  auto& rm = engine->getRenderableManager();
+  const auto instance = rm.getInstance(m_oEntity);
+  rm.setGeometryAt(instance, 0, RenderableManager::PrimitiveType::LINES,
+                   m_poVertexBuffer, m_poIndexBuffer, 0,
+                   m_vecVertices.size());
+  rm.setAxisAlignedBoundingBox(instance, filament::Box().set(min, max));
+
+  if (!m_bInScene) {
+    scene->addEntity(m_oEntity);
+    m_bInScene = true;
+  }
+  ++m_nStatsUploads;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+void DebugLinesSystem::vUpdate(const float fElapsedTime) {
+  ++m_nStatsFrames;
+  m_fStatsElapsed += fElapsedTime;
+
+  if (!m_vecTimeToLive.empty() || m_bDirty) {
+    const auto updateStart = std::chrono::steady_clock::now();
+
+    // Back to insertion order, so the compaction below keeps it.
+    if (m_nOldest != 0) {
+      std::rotate(m_vecTimeToLive.begin(),
+                  m_vecTimeToLive.begin() + static_cast<ptrdiff_t>(m_nOldest),
+                  m_vecTimeToLive.end());
+      std::rotate(m_vecVertices.begin(),
+                  m_vecVertices.begin() + static_cast<ptrdiff_t>(2 * m_nOldest),
+                  m_vecVertices.end());
+      m_nOldest = 0;
+    }
 
-    if ((*it)->m_fRemainingTime < 0) {
-      filamentSystem->getFilamentScene()->removeEntities(
-          (*it)->m_poEntity.get(), 1);
+    // Compact in place, keeping the surviving lines in insertion order.
+    size_t nKept = 0;
+    for (size_t i = 0; i < m_vecTimeToLive.size(); ++i) {
+      m_vecTimeToLive[i] -= fElapsedTime;
+      if (m_vecTimeToLive[i] < 0) {
+        continue;
+      }
+      if (nKept != i) {
+        m_vecTimeToLive[nKept] = m_vecTimeToLive[i];
+        m_vecVertices[2 * nKept] = m_vecVertices[2 * i];
+        m_vecVertices[2 * nKept + 1] = m_vecVertices[2 * i + 1];
+      }
+      ++nKept;
+    }
+    if (nKept != m_vecTimeToLive.size()) {
+      m_vecTimeToLive.resize(nKept);
+      m_vecVertices.resize(2 * nKept);
+      m_bDirty = true;
+    }
 
-      // do visual cleanup here
-      (*it)->vCleanup(engine);
+    if (m_bDirty) {
+      const auto filamentSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+              FilamentSystem::StaticGetTypeID(), "DebugLinesSystem::vUpdate");
+      vUpload(filamentSystem->getFilamentEngine());
+      m_bDirty = false;
+    }
 
-      it = ourLines_.erase(it);
-    } else {
-      ++it;
+    if (m_fStatsElapsed >= kStatsIntervalSeconds) {
+      const std::chrono::duration<float, std::micro> updateCost =
+          std::chrono::steady_clock::now() - updateStart;
+      spdlog::debug(
+          "DebugLinesSystem: {} lines in {} draw call, {} uploads, "
+          "avg frame {:.2f} ms, update {:.1f} us",
+          m_vecTimeToLive.size(), m_bInScene ? 1 : 0, m_nStatsUploads,
+          1000.0f * m_fStatsElapsed / static_cast<float>(m_nStatsFrames),
+          updateCost.count());
     }
   }
+
+  if (m_fStatsElapsed >= kStatsIntervalSeconds) {
+    m_fStatsElapsed = 0.0f;
+    m_nStatsFrames = 0;
+    m_nStatsUploads = 0;
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -175,20 +287,36 @@ void DebugLinesSystem::vAddLine(filament::math::float3 startPoint,
     return;
   }
 
-  auto filamentSystem =
-      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "DebugLinesSystem::vAddLine");
-  const auto engine = filamentSystem->getFilamentEngine();
-
-  utils::EntityManager& oEntitymanager = engine->getEntityManager();
-  auto oEntity = std::make_shared<Entity>(oEntitymanager.create());
-
-  auto newDebugLine = std::make_unique<DebugLine>(startPoint, endPoint, engine,
-                                                  oEntity, secondsTimeout);
+  if (m_vecTimeToLive.size() >= kMaxLines) {
+    // Overwrite the oldest line; draw order doesn't matter.
+    m_vecVertices[2 * m_nOldest] = startPoint;
+    m_vecVertices[2 * m_nOldest + 1] = endPoint;
+    m_vecTimeToLive[m_nOldest] = secondsTimeout;
+    m_nOldest = (m_nOldest + 1) % m_vecTimeToLive.size();
+    m_bDirty = true;
+    return;
+  }
 
-  filamentSystem->getFilamentScene()->addEntity(*oEntity);
+  m_vecVertices.emplace_back(startPoint);
+  m_vecVertices.emplace_back(endPoint);
+  m_vecTimeToLive.emplace_back(secondsTimeout);
+  m_bDirty = true;
+}
 
-  ourLines_.emplace_back(std::move(newDebugLine));
+////////////////////////////////////////////////////////////////////////////
+void DebugLinesSystem::vAccountResources(ResourceReport& report) const {
+  if (m_poVertexBuffer == nullptr && m_vecVertices.capacity() == 0) {
+    return;
+  }
+  // Two float3 vertices and two uint32 indices per line.
+  const size_t nGpuBytes =
+      m_nCapacity * 2 * (sizeof(::filament::math::float3) + sizeof(uint32_t));
+  const size_t nCpuBytes =
+      m_vecVertices.capacity() * sizeof(::filament::math::float3) +
+      m_vecTimeToLive.capacity() * sizeof(float);
+  report.vAdd("DebugLinesSystem",
+              std::to_string(m_vecTimeToLive.size()) + " lines",
+              "vertex/index buffers", nGpuBytes, nCpuBytes);
 }
 
 }  // namespace plugin_filament_view
@@ -17,38 +17,18 @@
 #pragma once
 
 #include <core/systems/base/ecsystem.h>
-#include <filament/Box.h>
 #include <filament/Engine.h>
+#include <filament/IndexBuffer.h>
+#include <filament/VertexBuffer.h>
 #include <math/vec3.h>
-#include <utils/EntityManager.h>
-#include <list>
+#include <utils/Entity.h>
 #include <vector>
 
-using ::utils::Entity;
-
 namespace plugin_filament_view {
 
-class DebugLine {
- public:
-  DebugLine(filament::math::float3 startingPoint,
-            filament::math::float3 endingPoint,
-            filament::Engine* engine,
-            std::shared_ptr<utils::Entity> entity,
-            float fTimeToLive);
-  virtual ~DebugLine() = default;
-  void vCleanup(filament::Engine* engine);
-
-  float m_fRemainingTime;
-  std::shared_ptr<utils::Entity> m_poEntity;
-
-  filament::VertexBuffer* m_poVertexBuffer = nullptr;
-  filament::IndexBuffer* m_poIndexBuffer = nullptr;
-
-  std::vector<::filament::math::float3> vertices_;
-  std::vector<unsigned short> indices_;
-  filament::Aabb boundingBox_;
-};
-
+// All debug lines share one vertex buffer and are drawn by a single LINES
+// renderable. Lines live in flat arrays kept in insertion order; the vertex
+// buffer is refilled once per frame when lines were added or expired.
 class DebugLinesSystem : public ECSystem {
  public:
   DebugLinesSystem();
@@ -68,6 +48,8 @@ class DebugLinesSystem : public ECSystem {
                 ::filament::math::float3 endPoint,
                 float secondsTimeout);
 
+  void vAccountResources(ResourceReport& report) const override;
+
   // called from vShutdownSystem during the systems shutdown routine.
   void vCleanup();
 
@@ -78,9 +60,35 @@ class DebugLinesSystem : public ECSystem {
   }
 
  private:
+  static constexpr size_t kInitialLineCapacity = 256;
+  // Past this each new line overwrites the oldest one.
+  static constexpr size_t kMaxLines = 1 << 16;
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
   bool m_bCurrentlyDrawingDebugLines = false;
 
-  std::list<std::unique_ptr<DebugLine>> ourLines_;
+  // Two vertices per line, parallel to m_vecTimeToLive.
+  std::vector<::filament::math::float3> m_vecVertices;
+  std::vector<float> m_vecTimeToLive;
+  // Index of the oldest line once the arrays wrapped around at kMaxLines;
+  // zero while they are in insertion order.
+  size_t m_nOldest = 0;
+  bool m_bDirty = false;
+
+  // Capacity in lines of the GPU buffers.
+  size_t m_nCapacity = 0;
+  ::filament::VertexBuffer* m_poVertexBuffer = nullptr;
+  ::filament::IndexBuffer* m_poIndexBuffer = nullptr;
+  utils::Entity m_oEntity;
+  bool m_bInScene = false;
+
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsFrames = 0;
+  size_t m_nStatsUploads = 0;
+
+  // (Re)creates the GPU buffers to hold at least nLines lines.
+  void vEnsureCapacity(::filament::Engine* engine, size_t nLines);
+  void vUpload(::filament::Engine* engine);
 };
 
 }  // namespace plugin_filament_view
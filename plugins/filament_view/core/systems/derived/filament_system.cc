@@ -15,9 +15,14 @@
  */
 #include "filament_system.h"
 
+#include <core/include/literals.h>
+#include <core/scene/quality_governor.h>
 #include <core/systems/ecsystems_manager.h>
 #include <filament/Renderer.h>
 #include <plugins/common/common.h>
+#include <utils/JobSystem.h>
+#include <algorithm>
+#include <chrono>
 
 namespace plugin_filament_view {
 
@@ -25,18 +30,123 @@ namespace plugin_filament_view {
 void FilamentSystem::vInitSystem() {
   spdlog::debug("Engine creation Filament API thread: 0x{:x}", pthread_self());
 
-  fengine_ = filament::Engine::create(filament::Engine::Backend::VULKAN);
-  iblProfiler_ = std::make_unique<IBLProfiler>(fengine_);
+  const auto ecsManager = ECSystemManager::GetInstance();
+  if (ecsManager->bHasConfigValue(kEngineProfile)) {
+    m_oProfile = ecsManager->getConfigValue<EngineProfile>(kEngineProfile);
+  }
+
+  const auto config = m_oProfile.oGetConfig();
+  fengine_ = filament::Engine::create(m_oProfile.eBackend, nullptr, nullptr,
+                                      &config);
+  if (m_oProfile.nFeatureLevel > 0) {
+    fengine_->setActiveFeatureLevel(
+        static_cast<filament::backend::FeatureLevel>(
+            std::min(m_oProfile.nFeatureLevel,
+                     static_cast<uint8_t>(
+                         fengine_->getSupportedFeatureLevel()))));
+  }
+  vLogEffectiveProfile();
   frenderer_ = fengine_->createRenderer();
   fscene_ = fengine_->createScene();
 
   auto clearOptions = frenderer_->getClearOptions();
   clearOptions.clear = true;
   frenderer_->setClearOptions(clearOptions);
+
+  vRegisterMessageHandler(
+      ECSMessageType::ConfigureQualityGovernor, [this](const ECSMessage& msg) {
+        const auto config = msg.getData<QualityGovernor::Config>(
+            ECSMessageType::ConfigureQualityGovernor);
+        vSetTargetFrameRate(config.bEnabled ? std::max(config.fTargetFps, 1.0f)
+                                            : 60.0f);
+      });
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void FilamentSystem::vSetTargetFrameRate(const float fTargetFps) const {
+  // Dynamic resolution aims for one frame per display refresh, so the
+  // target rate is handed to it as the refresh rate.
+  frenderer_->setDisplayInfo({.refreshRate = fTargetFps});
+  frenderer_->setFrameRateOptions({.interval = 1});
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+IBLProfiler* FilamentSystem::getIBLProfiler() {
+  if (iblProfiler_ == nullptr) {
+    const auto start = std::chrono::steady_clock::now();
+    iblProfiler_ = std::make_unique<IBLProfiler>(fengine_);
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    spdlog::debug("IBLProfiler created in {:.1f} ms", elapsed.count());
+  }
+  return iblProfiler_.get();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void FilamentSystem::vUpdate(const float fElapsedTime) {
+  if (m_oProfile.bBenchmark) {
+    vSampleBenchmark(fElapsedTime);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void FilamentSystem::vLogEffectiveProfile() const {
+  // Filament clamps what it was given; these are the values it settled on.
+  const auto& config = fengine_->getConfig();
+  spdlog::info(
+      "Engine created: backend {}, feature level {}, {} job threads, command "
+      "buffer {} MB (min {} MB), per frame commands {} MB, per render pass "
+      "arena {} MB, driver handle arena {} MB, {} stereo eyes",
+      static_cast<int>(fengine_->getBackend()),
+      static_cast<int>(fengine_->getActiveFeatureLevel()),
+      fengine_->getJobSystem().getThreadCount(), config.commandBufferSizeMB,
+      config.minCommandBufferSizeMB, config.perFrameCommandsSizeMB,
+      config.perRenderPassArenaSizeMB, config.driverHandleArenaSizeMB,
+      config.stereoscopicEyeCount);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-void FilamentSystem::vUpdate(float /*fElapsedTime*/) {}
+void FilamentSystem::vSampleBenchmark(const float fElapsedTime) {
+  // Frames newer than the last sample; the history holds the most recent
+  // first and only frames whose GPU timer already resolved.
+  const auto history =
+      frenderer_->getFrameInfoHistory(frenderer_->getMaxFrameHistorySize());
+  for (const auto& info : history) {
+    if (info.frameId <= m_nLastBenchmarkFrameId) {
+      break;
+    }
+    if (info.gpuFrameDuration > 0) {
+      m_lstBenchmarkFrameMilliseconds.push_back(
+          static_cast<float>(info.gpuFrameDuration) / 1.0e6f);
+    }
+  }
+  if (!history.empty()) {
+    m_nLastBenchmarkFrameId = history[0].frameId;
+  }
+
+  m_fBenchmarkElapsed += fElapsedTime;
+  if (m_fBenchmarkElapsed < kBenchmarkIntervalSeconds ||
+      m_lstBenchmarkFrameMilliseconds.empty()) {
+    return;
+  }
+
+  auto& samples = m_lstBenchmarkFrameMilliseconds;
+  std::sort(samples.begin(), samples.end());
+  float fTotal = 0.0f;
+  for (const auto fSample : samples) {
+    fTotal += fSample;
+  }
+  const auto p95 = samples[std::min(samples.size() - 1,
+                                    samples.size() * 95 / 100)];
+  spdlog::info(
+      "[Benchmark] {} job threads: {} frames, GPU avg {:.2f} ms, p95 {:.2f} "
+      "ms, max {:.2f} ms",
+      fengine_->getJobSystem().getThreadCount(), samples.size(),
+      fTotal / static_cast<float>(samples.size()), p95, samples.back());
+
+  samples.clear();
+  m_fBenchmarkElapsed = 0.0f;
+}
 
 ////////////////////////////////////////////////////////////////////////////////////
 void FilamentSystem::vShutdownSystem() {
@@ -16,8 +16,10 @@
 
 #pragma once
 
+#include <core/scene/engine_profile.h>
 #include <core/systems/base/ecsystem.h>
 #include <core/utils/ibl_profiler.h>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -44,9 +46,9 @@ class FilamentSystem : public ECSystem {
     return fengine_;
   }
 
-  [[nodiscard]] IBLProfiler* getIBLProfiler() const {
-    return iblProfiler_.get();
-  }
+  // Created on first use; its prefilter materials are only needed once an
+  // HDR skybox or indirect light is loaded.
+  [[nodiscard]] IBLProfiler* getIBLProfiler();
 
   [[nodiscard]] ::filament::Scene* getFilamentScene() const { return fscene_; }
 
@@ -55,6 +57,20 @@ class FilamentSystem : public ECSystem {
   }
 
  private:
+  static constexpr float kBenchmarkIntervalSeconds = 5.0f;
+
+  void vLogEffectiveProfile() const;
+  // The renderer is shared by every view, so its target frame rate is set
+  // here once rather than by each view's QualityGovernor.
+  void vSetTargetFrameRate(float fTargetFps) const;
+  void vSampleBenchmark(float fElapsedTime);
+
+  EngineProfile m_oProfile;
+  // GPU frame times since the last benchmark report, in milliseconds.
+  std::vector<float> m_lstBenchmarkFrameMilliseconds;
+  float m_fBenchmarkElapsed = 0.0f;
+  uint32_t m_nLastBenchmarkFrameId = 0;
+
   ::filament::Engine* fengine_{};
   ::filament::Renderer* frenderer_{};
   ::filament::Scene* fscene_{};
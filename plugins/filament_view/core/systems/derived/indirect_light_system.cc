@@ -16,13 +16,21 @@
 
 #include "indirect_light_system.h"
 
+#include <core/include/file_utils.h>
 #include <core/include/literals.h>
+#include <core/scene/material/loader/texture_loader.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/derived/filament_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <core/utils/hdr_loader.h>
+#include <core/utils/ibl_cache.h>
+#include <filament/IndirectLight.h>
+#include <filament/Scene.h>
 #include <filament/Texture.h>
 #include <plugins/common/common.h>
+#include <plugins/common/curl_client/curl_client.h>
 #include <asio/post.hpp>
+#include <chrono>
 #include <filesystem>
 #include <memory>
 #include <utility>
@@ -84,16 +92,24 @@ std::future<Resource<std::string_view>> IndirectLightSystem::setIndirectLight(
 ////////////////////////////////////////////////////////////////////////////////////
 std::future<Resource<std::string_view>>
 IndirectLightSystem::setIndirectLightFromKtxAsset(std::string path,
-                                                  double /*intensity*/) {
+                                                  double intensity) {
   const auto promise(
       std::make_shared<std::promise<Resource<std::string_view>>>());
   auto future(promise->get_future());
 
   const asio::io_context::strand& strand_(
       *ECSystemManager::GetInstance()->GetStrand());
+  const auto assetPath =
+      ECSystemManager::GetInstance()->getConfigValue<std::string>(kAssetPath);
 
-  post(strand_, [&, promise, path = std::move(path) /*, intensity*/] {
-    promise->set_value(Resource<std::string_view>::Error("Not implemented"));
+  post(strand_, [&, promise, path = std::move(path), intensity, assetPath] {
+    const auto buffer = readBinaryFile(path, assetPath);
+    if (buffer.empty()) {
+      promise->set_value(
+          Resource<std::string_view>::Error("Asset path not valid"));
+      return;
+    }
+    promise->set_value(loadIndirectLightKtxFromBuffer(buffer, intensity));
   });
   return future;
 }
@@ -101,7 +117,7 @@ IndirectLightSystem::setIndirectLightFromKtxAsset(std::string path,
 ////////////////////////////////////////////////////////////////////////////////////
 std::future<Resource<std::string_view>>
 IndirectLightSystem::setIndirectLightFromKtxUrl(std::string url,
-                                                double /*intensity*/) {
+                                                double intensity) {
   const auto promise(
       std::make_shared<std::promise<Resource<std::string_view>>>());
   auto future(promise->get_future());
@@ -109,46 +125,248 @@ IndirectLightSystem::setIndirectLightFromKtxUrl(std::string url,
   const asio::io_context::strand& strand_(
       *ECSystemManager::GetInstance()->GetStrand());
 
-  post(strand_, [&, promise, url = std::move(url) /*, intensity*/] {
-    promise->set_value(Resource<std::string_view>::Error("Not implemented"));
+  post(strand_, [&, promise, url = std::move(url), intensity] {
+    plugin_common_curl::CurlClient client;
+    client.Init(url, {}, {});
+    const auto buffer = client.RetrieveContentAsVector();
+    if (client.GetCode() != CURLE_OK || buffer.empty()) {
+      promise->set_value(
+          Resource<std::string_view>::Error("Couldn't download KTX light"));
+      return;
+    }
+    promise->set_value(loadIndirectLightKtxFromBuffer(buffer, intensity));
   });
   return future;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+void IndirectLightSystem::vSetSceneIndirectLight(
+    filament::IndirectLight* indirectLight) {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vSetSceneIndirectLight");
+  const auto engine = filamentSystem->getFilamentEngine();
+
+  const auto prevIndirectLight =
+      filamentSystem->getFilamentScene()->getIndirectLight();
+  if (prevIndirectLight) {
+    engine->destroy(prevIndirectLight);
+  }
+
+  filamentSystem->getFilamentScene()->setIndirectLight(indirectLight);
+  vSetHdrSource(std::nullopt);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void IndirectLightSystem::vSetHdrSource(std::optional<HdrSource> source) {
+  if (const auto indirectLightSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<IndirectLightSystem>(
+              StaticGetTypeID(), "vSetHdrSource")) {
+    indirectLightSystem->m_oHdrSource = std::move(source);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void IndirectLightSystem::vStoreInCache(const std::string& szKey,
+                                        const std::vector<uint8_t>& buffer) {
+  if (const auto indirectLightSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<IndirectLightSystem>(
+              StaticGetTypeID(), "vStoreInCache")) {
+    indirectLightSystem->m_oIblCacheWriter.vStoreAsync(szKey, buffer);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+std::optional<IndirectLightSystem::HdrSource>
+IndirectLightSystem::oStatHdrSource(const std::string& szPath) {
+  std::error_code error;
+  const auto nByteSize = std::filesystem::file_size(szPath, error);
+  if (error) {
+    return std::nullopt;
+  }
+  const auto writeTime = std::filesystem::last_write_time(szPath, error);
+  if (error) {
+    return std::nullopt;
+  }
+
+  HdrSource source;
+  source.szPath = szPath;
+  source.nByteSize = static_cast<int64_t>(nByteSize);
+  source.nWriteTime = static_cast<int64_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(
+          writeTime.time_since_epoch())
+          .count());
+  return source;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Resource<std::string_view> IndirectLightSystem::loadIndirectLightKtxFromBuffer(
+    const std::vector<uint8_t>& buffer,
+    const double intensity) {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "loadIndirectLightKtxFromBuffer");
+
+  const auto ibl = IblCache::poCreateIndirectLightFromKtx(
+      filamentSystem->getFilamentEngine(), buffer,
+      static_cast<float>(intensity));
+  if (ibl == nullptr) {
+    return Resource<std::string_view>::Error("Could not decode KTX file");
+  }
+
+  vSetSceneIndirectLight(ibl);
+  return Resource<std::string_view>::Success(
+      "loaded Indirect light successfully");
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool IndirectLightSystem::bSetIndirectLightFromCache(const HdrSource& source,
+                                                     const double intensity,
+                                                     const char* szVia) {
+  const auto loadStart = std::chrono::steady_clock::now();
+  const auto engine =
+      ECSystemManager::GetInstance()
+          ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                          "bSetIndirectLightFromCache")
+          ->getFilamentEngine();
+  auto* ibl = IblCache::poLoadCached(engine, source.szCacheKey,
+                                     static_cast<float>(intensity));
+  if (ibl == nullptr) {
+    return false;
+  }
+  vSetSceneIndirectLight(ibl);
+  vSetHdrSource(source);
+
+  const std::chrono::duration<float, std::milli> loadTime =
+      std::chrono::steady_clock::now() - loadStart;
+  spdlog::info("Indirect light ready in {:.1f} ms ({})", loadTime.count(),
+               szVia);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 Resource<std::string_view> IndirectLightSystem::loadIndirectLightHdrFromFile(
     const std::string& asset_path,
-    const double intensity) {
+    const double intensity,
+    filament::Texture* environmentCubemap) {
+  auto source = oStatHdrSource(asset_path);
+  // An unchanged file that was loaded before is found by its header alone.
+  if (source.has_value()) {
+    if (auto key = IblCache::oszFindKeyForFile(asset_path)) {
+      source->szCacheKey = std::move(*key);
+      if (bSetIndirectLightFromCache(*source, intensity, "warm cache")) {
+        return Resource<std::string_view>::Success(
+            "loaded Indirect light successfully");
+      }
+    }
+  }
+
+  const std::filesystem::path path(asset_path);
+  const auto buffer = readBinaryFile(path.filename().string(),
+                                     path.parent_path().string());
+  if (buffer.empty()) {
+    return Resource<std::string_view>::Error("Could not read HDR file");
+  }
+
+  auto key = IblCache::szCacheKey(buffer);
+  auto result = loadIndirectLightHdrFromBuffer(buffer, intensity,
+                                               environmentCubemap, key);
+  if (result.getStatus() == Status::Success && source.has_value()) {
+    IblCache::vRecordKeyForFile(asset_path, key);
+    source->szCacheKey = std::move(key);
+    vSetHdrSource(std::move(source));
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+std::future<Resource<std::string_view>>
+IndirectLightSystem::setIndirectLightFromHdrSource(HdrSource source,
+                                                   double intensity) {
+  const auto promise(
+      std::make_shared<std::promise<Resource<std::string_view>>>());
+  auto future(promise->get_future());
+
+  const asio::io_context::strand& strand_(
+      *ECSystemManager::GetInstance()->GetStrand());
+
+  post(strand_, [promise, source = std::move(source), intensity] {
+    // Only the file's metadata is read when the cache entry is still good.
+    if (const auto current = oStatHdrSource(source.szPath);
+        current.has_value() && current->nByteSize == source.nByteSize &&
+        current->nWriteTime == source.nWriteTime &&
+        bSetIndirectLightFromCache(source, intensity, "snapshot")) {
+      promise->set_value(Resource<std::string_view>::Success(
+          "loaded Indirect light successfully"));
+      return;
+    }
+
+    try {
+      promise->set_value(
+          loadIndirectLightHdrFromFile(source.szPath, intensity));
+    } catch (...) {
+      promise->set_value(Resource<std::string_view>::Error(
+          "Couldn't changed Light from asset"));
+    }
+  });
+  return future;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Resource<std::string_view> IndirectLightSystem::loadIndirectLightHdrFromBuffer(
+    const std::vector<uint8_t>& buffer,
+    const double intensity,
+    filament::Texture* environmentCubemap,
+    const std::string& szCacheKey) {
+  const auto loadStart = std::chrono::steady_clock::now();
+
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "loadIndirectLightHdrFromFile");
+          FilamentSystem::StaticGetTypeID(), "loadIndirectLightHdrFromBuffer");
   const auto engine = filamentSystem->getFilamentEngine();
 
-  filament::Texture* texture;
-  try {
-    texture = HDRLoader::createTexture(engine, asset_path);
-  } catch (...) {
-    return Resource<std::string_view>::Error("Could not decode HDR file");
-  }
-  const auto skyboxTexture =
-      filamentSystem->getIBLProfiler()->createCubeMapTexture(texture);
-  engine->destroy(texture);
+  const auto key =
+      szCacheKey.empty() ? IblCache::szCacheKey(buffer) : szCacheKey;
+  auto* ibl =
+      IblCache::poLoadCached(engine, key, static_cast<float>(intensity));
+  const bool bCacheHit = ibl != nullptr;
+
+  if (!bCacheHit) {
+    auto* cubemap = environmentCubemap;
+    if (cubemap == nullptr) {
+      filament::Texture* texture;
+      try {
+        texture = HDRLoader::createTexture(engine, buffer);
+      } catch (...) {
+        return Resource<std::string_view>::Error("Could not decode HDR file");
+      }
+      if (texture == nullptr) {
+        return Resource<std::string_view>::Error("Could not decode HDR file");
+      }
+      cubemap = filamentSystem->getIBLProfiler()->createCubeMapTexture(texture);
+      engine->destroy(texture);
+    }
 
-  const auto reflections =
-      filamentSystem->getIBLProfiler()->getLightReflection(skyboxTexture);
+    const auto reflections =
+        filamentSystem->getIBLProfiler()->getLightReflection(cubemap);
+    if (cubemap != environmentCubemap) {
+      engine->destroy(cubemap);
+    }
 
-  const auto ibl = filament::IndirectLight::Builder()
-                       .reflections(reflections)
-                       .intensity(static_cast<float>(intensity))
-                       .build(*engine);
+    ibl = filament::IndirectLight::Builder()
+              .reflections(reflections)
+              .intensity(static_cast<float>(intensity))
+              .build(*engine);
 
-  const auto prevIndirectLight =
-      filamentSystem->getFilamentScene()->getIndirectLight();
-  if (prevIndirectLight) {
-    engine->destroy(prevIndirectLight);
+    vStoreInCache(key, buffer);
   }
 
-  filamentSystem->getFilamentScene()->setIndirectLight(ibl);
+  vSetSceneIndirectLight(ibl);
+
+  const std::chrono::duration<float, std::milli> loadTime =
+      std::chrono::steady_clock::now() - loadStart;
+  spdlog::info("Indirect light ready in {:.1f} ms ({} cache)",
+               loadTime.count(), bCacheHit ? "warm" : "cold");
 
   return Resource<std::string_view>::Success(
       "loaded Indirect light successfully");
@@ -226,6 +444,8 @@ void IndirectLightSystem::vUpdate(float /*fElapsedTime*/) {}
 
 ////////////////////////////////////////////////////////////////////////////////////
 void IndirectLightSystem::vShutdownSystem() {
+  m_oIblCacheWriter.vStop();
+
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
           FilamentSystem::StaticGetTypeID(), "setIndirectLight");
@@ -245,4 +465,31 @@ void IndirectLightSystem::DebugPrint() {
   spdlog::debug("{}::{}", __FILE__, __FUNCTION__);
 }
 
-}  // namespace plugin_filament_view
\ No newline at end of file
+////////////////////////////////////////////////////////////////////////////////////
+void IndirectLightSystem::vAccountResources(ResourceReport& report) const {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vAccountResources");
+  if (filamentSystem == nullptr ||
+      filamentSystem->getFilamentScene() == nullptr) {
+    return;
+  }
+
+  const auto* indirectLight =
+      filamentSystem->getFilamentScene()->getIndirectLight();
+  if (indirectLight == nullptr) {
+    return;
+  }
+  // Spherical harmonics only lights have no textures.
+  size_t nGpuBytes = 0;
+  if (const auto* texture = indirectLight->getReflectionsTexture()) {
+    nGpuBytes += TextureLoader::nEstimateTextureBytes(texture);
+  }
+  if (const auto* texture = indirectLight->getIrradianceTexture()) {
+    nGpuBytes += TextureLoader::nEstimateTextureBytes(texture);
+  }
+  report.vAdd("IndirectLightSystem", "scene indirect light", "ibl cubemaps",
+              nGpuBytes, 0);
+}
+
+}  // namespace plugin_filament_view
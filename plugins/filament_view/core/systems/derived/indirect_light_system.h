@@ -19,7 +19,11 @@
 #include <core/scene/indirect_light/indirect_light.h>
 #include <core/scene/view_target.h>
 #include <core/systems/base/ecsystem.h>
+#include <core/utils/ibl_cache.h>
 #include <core/utils/ibl_profiler.h>
+#include <cstdint>
+#include <optional>
+#include <string>
 
 namespace plugin_filament_view {
 
@@ -30,6 +34,16 @@ class HdrIndirectLight;
 
 class IndirectLightSystem : public ECSystem {
  public:
+  // The HDR file the scene's light was built from and its IblCache key, so
+  // a scene snapshot can restore the light without reading and hashing the
+  // HDR again. Size and write time tell whether the file changed since.
+  struct HdrSource {
+    std::string szPath;
+    std::string szCacheKey;
+    int64_t nByteSize = 0;
+    int64_t nWriteTime = 0;
+  };
+
   IndirectLightSystem() = default;
 
   void setDefaultIndirectLight();
@@ -50,8 +64,35 @@ class IndirectLightSystem : public ECSystem {
       std::string url,
       double intensity);
 
+  // Loads from the cache entry named by source if the file is unchanged,
+  // otherwise from the file like setIndirectLightFromHdrAsset.
+  static std::future<Resource<std::string_view>> setIndirectLightFromHdrSource(
+      HdrSource source,
+      double intensity);
+
+  // environmentCubemap is passed on to loadIndirectLightHdrFromBuffer.
   static Resource<std::string_view> loadIndirectLightHdrFromFile(
       const std::string& asset_path,
+      double intensity,
+      ::filament::Texture* environmentCubemap = nullptr);
+
+  // Uses the cached prefilter of this HDR when there is one, otherwise
+  // prefilters on the GPU and has the cache entry built in the background.
+  // environmentCubemap, if given, is the HDR already converted to a cube map
+  // and is not taken over. szCacheKey is computed from buffer when empty.
+  static Resource<std::string_view> loadIndirectLightHdrFromBuffer(
+      const std::vector<uint8_t>& buffer,
+      double intensity,
+      ::filament::Texture* environmentCubemap = nullptr,
+      const std::string& szCacheKey = {});
+
+  // Set while the scene's light comes from an HDR file.
+  [[nodiscard]] const std::optional<HdrSource>& oGetHdrSource() const {
+    return m_oHdrSource;
+  }
+
+  static Resource<std::string_view> loadIndirectLightKtxFromBuffer(
+      const std::vector<uint8_t>& buffer,
       double intensity);
 
   static std::future<Resource<std::string_view>> setIndirectLight(
@@ -74,7 +115,26 @@ class IndirectLightSystem : public ECSystem {
   void vShutdownSystem() override;
   void DebugPrint() override;
 
+  void vAccountResources(ResourceReport& report) const override;
+
  private:
   std::unique_ptr<DefaultIndirectLight> indirect_light_;
+  std::optional<HdrSource> m_oHdrSource;
+  // Builds cache entries for HDR lights prefiltered on the GPU; stopped on
+  // shutdown so no build outlives the system.
+  IblCacheWriter m_oIblCacheWriter;
+
+  // Replaces and destroys the scene's current indirect light, and forgets
+  // the HDR source.
+  static void vSetSceneIndirectLight(::filament::IndirectLight* indirectLight);
+  static void vSetHdrSource(std::optional<HdrSource> source);
+  static void vStoreInCache(const std::string& szKey,
+                            const std::vector<uint8_t>& buffer);
+  // Size and write time of the file; nullopt if it can't be read.
+  static std::optional<HdrSource> oStatHdrSource(const std::string& szPath);
+  // Sets the light from source's cache entry; false on a cache miss.
+  static bool bSetIndirectLightFromCache(const HdrSource& source,
+                                         double intensity,
+                                         const char* szVia);
 };
 }  // namespace plugin_filament_view
\ No newline at end of file
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "lod_system.h"
+#include "filament_system.h"
+#include "view_target_system.h"
+
+#include <core/components/derived/basetransform.h>
+#include <core/entity/derived/model/model.h>
+#include <core/entity/derived/shapes/baseshape.h>
+#include <core/systems/ecsystems_manager.h>
+#include <filament/Camera.h>
+#include <filament/Scene.h>
+#include <filament/TransformManager.h>
+#include <filament/View.h>
+#include <math/mat4.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace plugin_filament_view {
+
+using filament::math::float3;
+using filament::math::float4;
+using filament::math::mat4f;
+
+namespace {
+
+// Largest axis scale of a world transform, to scale a bounding radius.
+float fMaxScale(const mat4f& world) {
+  return std::max(
+      {length(world[0].xyz), length(world[1].xyz), length(world[2].xyz)});
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vRegisterModel(Model* poModel,
+                               std::vector<LodLevel> levels,
+                               const float fHysteresis) {
+  if (levels.size() < 2 || levels[0].poAsset != poModel->getAsset()) {
+    spdlog::warn("LodSystem: ignoring model {} without reduced levels",
+                 poModel->GetGlobalGuid());
+    return;
+  }
+
+  LodGroup group;
+  group.poModel = poModel;
+  group.levels = std::move(levels);
+  group.fHysteresis = fHysteresis;
+  m_mapLodGroups[poModel->GetGlobalGuid()] = std::move(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vRegisterShape(shapes::BaseShape* poShape,
+                               std::vector<LodLevel> levels,
+                               const float fHysteresis) {
+  if (levels.size() < 2) {
+    return;
+  }
+
+  LodGroup group;
+  group.poShape = poShape;
+  group.levels = std::move(levels);
+  group.fHysteresis = fHysteresis;
+  m_mapLodGroups[poShape->GetGlobalGuid()] = std::move(group);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vUnregister(const EntityGUID& guid) {
+  m_mapLodGroups.erase(guid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+size_t LodSystem::nSelectLevel(const LodGroup& group, const float fScreenSize) {
+  const auto& levels = group.levels;
+  const size_t nCurrent = group.nActiveLevel;
+
+  size_t nTarget = 0;
+  for (size_t i = 1; i < levels.size(); ++i) {
+    if (fScreenSize < levels[i].fScreenSize) {
+      nTarget = i;
+    }
+  }
+
+  // Only commit to a coarser level once we're clearly below its threshold,
+  // and only go back to a finer one once clearly above the threshold we
+  // crossed, so objects sitting on a boundary don't flicker between levels.
+  while (nTarget > nCurrent &&
+         fScreenSize >=
+             levels[nTarget].fScreenSize * (1.0f - group.fHysteresis)) {
+    --nTarget;
+  }
+  while (nTarget < nCurrent &&
+         fScreenSize <
+             levels[nTarget + 1].fScreenSize * (1.0f + group.fHysteresis)) {
+    ++nTarget;
+  }
+
+  return nTarget;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vSyncVariantTransform(const LodGroup& group) {
+  if (group.poModel == nullptr || group.nActiveLevel == 0) {
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(),
+          "LodSystem::vSyncVariantTransform");
+  auto& tm = filamentSystem->getFilamentEngine()->getTransformManager();
+
+  const auto source = tm.getInstance(group.levels[0].poAsset->getRoot());
+  const auto target =
+      tm.getInstance(group.levels[group.nActiveLevel].poAsset->getRoot());
+  tm.setTransform(target, tm.getTransform(source));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vActivateLevel(LodGroup& group, const size_t nLevel) {
+  if (group.poShape != nullptr) {
+    group.poShape->vSetActiveLodLevel(nLevel);
+    group.nActiveLevel = nLevel;
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "LodSystem::vActivateLevel");
+  auto* scene = filamentSystem->getFilamentScene();
+
+  const auto* from = group.levels[group.nActiveLevel].poAsset;
+  scene->removeEntities(from->getRenderableEntities(),
+                        from->getRenderableEntityCount());
+
+  group.nActiveLevel = nLevel;
+  vSyncVariantTransform(group);
+
+  const auto* to = group.levels[nLevel].poAsset;
+  scene->addEntities(to->getRenderableEntities(),
+                     to->getRenderableEntityCount());
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vInitSystem() {}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vUpdate(const float fElapsedTime) {
+  if (m_mapLodGroups.empty()) {
+    return;
+  }
+
+  const auto updateStart = std::chrono::steady_clock::now();
+
+  // LOD is chosen against the first view; additional views render whatever
+  // level the first one picked.
+  const auto viewTargetSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<ViewTargetSystem>(
+          ViewTargetSystem::StaticGetTypeID(), "LodSystem::vUpdate");
+  const filament::View* view =
+      viewTargetSystem ? viewTargetSystem->getFilamentView(0) : nullptr;
+  if (view == nullptr || !view->hasCamera()) {
+    return;
+  }
+
+  const auto& camera = view->getCamera();
+  const float3 eye = float3(camera.getPosition());
+  // For a perspective projection this is cot(fov / 2), converting a size at
+  // unit distance into a fraction of the viewport height.
+  const auto fProjectionScale =
+      static_cast<float>(camera.getProjectionMatrix()[1][1]);
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "LodSystem::vUpdate");
+  const auto& tm = filamentSystem->getFilamentEngine()->getTransformManager();
+
+  size_t nActiveTriangles = 0;
+  size_t nFullTriangles = 0;
+
+  for (auto& [guid, group] : m_mapLodGroups) {
+    float3 center;
+    float fRadius;
+
+    if (group.poModel != nullptr) {
+      // Until the asset has loaded and every renderable is in the scene,
+      // the model system still owns scene membership for it.
+      if (!group.poModel->bIsSceneLoaded()) {
+        continue;
+      }
+
+      const auto* asset = group.levels[0].poAsset;
+
+      const auto box = asset->getBoundingBox();
+      const mat4f world =
+          tm.getWorldTransform(tm.getInstance(asset->getRoot()));
+      center = (world * float4(box.center(), 1.0f)).xyz;
+      fRadius = length(box.extent()) * fMaxScale(world);
+    } else {
+      const auto transform = std::dynamic_pointer_cast<BaseTransform>(
+          group.poShape->GetComponentByStaticTypeID(
+              BaseTransform::StaticGetTypeID()));
+      if (transform == nullptr) {
+        continue;
+      }
+      // Kept by TransformSystem, so parented shapes are placed and scaled
+      // by their whole chain.
+      const auto& world = transform->GetWorldTransform();
+      center = world[3].xyz;
+      fRadius = length(transform->GetExtentsSize()) * 0.5f * fMaxScale(world);
+    }
+
+    const float fDistance = length(center - eye);
+    const float fScreenSize =
+        fDistance > fRadius ? 2.0f * fRadius * fProjectionScale / fDistance
+                            : std::numeric_limits<float>::max();
+
+    if (const size_t nLevel = nSelectLevel(group, fScreenSize);
+        nLevel != group.nActiveLevel) {
+      vActivateLevel(group, nLevel);
+      ++m_nStatsSwitches;
+    } else {
+      vSyncVariantTransform(group);
+    }
+
+    nActiveTriangles += group.levels[group.nActiveLevel].nTriangleCount;
+    nFullTriangles += group.levels[0].nTriangleCount;
+  }
+
+  ++m_nStatsFrames;
+  m_fStatsElapsed += fElapsedTime;
+  if (m_fStatsElapsed >= kStatsIntervalSeconds) {
+    const std::chrono::duration<float, std::micro> updateCost =
+        std::chrono::steady_clock::now() - updateStart;
+    spdlog::debug(
+        "LodSystem: {} objects, {} triangles submitted of {} at full detail, "
+        "{} level switches, avg frame {:.2f} ms, lod update {:.1f} us",
+        m_mapLodGroups.size(), nActiveTriangles, nFullTriangles,
+        m_nStatsSwitches,
+        1000.0f * m_fStatsElapsed / static_cast<float>(m_nStatsFrames),
+        updateCost.count());
+    m_fStatsElapsed = 0.0f;
+    m_nStatsFrames = 0;
+    m_nStatsSwitches = 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::vShutdownSystem() {
+  m_mapLodGroups.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void LodSystem::DebugPrint() {
+  SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
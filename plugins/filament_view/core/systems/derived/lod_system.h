@@ -0,0 +1,97 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/entity/base/entityobject.h>
+#include <core/systems/base/ecsystem.h>
+#include <gltfio/FilamentAsset.h>
+#include <map>
+#include <vector>
+
+namespace plugin_filament_view {
+
+class Model;
+
+namespace shapes {
+class BaseShape;
+}
+
+// Picks a level of detail per registered entity every frame, based on how
+// large its bounding sphere projects on the primary view.
+class LodSystem : public ECSystem {
+ public:
+  struct LodLevel {
+    // Used once the projected size drops below this; ignored on level 0.
+    float fScreenSize = 0.0f;
+    size_t nTriangleCount = 0;
+    // Models only, the asset whose renderables represent this level.
+    // Not owned; the model system creates and destroys these.
+    filament::gltfio::FilamentAsset* poAsset = nullptr;
+  };
+
+  LodSystem() = default;
+
+  // Disallow copy and assign.
+  LodSystem(const LodSystem&) = delete;
+  LodSystem& operator=(const LodSystem&) = delete;
+
+  // levels[0] must be the model's own asset.
+  void vRegisterModel(Model* poModel,
+                      std::vector<LodLevel> levels,
+                      float fHysteresis);
+  // The shape owns its alternate index buffers; see
+  // BaseShape::vSetActiveLodLevel.
+  void vRegisterShape(shapes::BaseShape* poShape,
+                      std::vector<LodLevel> levels,
+                      float fHysteresis);
+  void vUnregister(const EntityGUID& guid);
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(LodSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  struct LodGroup {
+    Model* poModel = nullptr;
+    shapes::BaseShape* poShape = nullptr;
+    std::vector<LodLevel> levels;
+    size_t nActiveLevel = 0;
+    float fHysteresis = 0.0f;
+  };
+
+  // How often the triangle / frame time stats are logged.
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
+  std::map<EntityGUID, LodGroup> m_mapLodGroups;
+
+  // Stats since the last report.
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsFrames = 0;
+  size_t m_nStatsSwitches = 0;
+
+  [[nodiscard]] static size_t nSelectLevel(const LodGroup& group,
+                                           float fScreenSize);
+  static void vActivateLevel(LodGroup& group, size_t nLevel);
+  static void vSyncVariantTransform(const LodGroup& group);
+};
+}  // namespace plugin_filament_view
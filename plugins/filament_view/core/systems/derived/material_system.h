@@ -19,10 +19,13 @@
 #include <core/scene/material/loader/material_loader.h>
 #include <core/scene/material/loader/texture_loader.h>
 #include <core/systems/base/ecsystem.h>
+#include <filament/MaterialEnums.h>
 #include <filament/MaterialInstance.h>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -37,9 +40,66 @@ class MaterialSystem : public ECSystem {
   MaterialSystem();
   ~MaterialSystem() override;
 
+  struct ResourceUsage {
+    size_t nTextureCount = 0;
+    size_t nUnreferencedTextureCount = 0;
+    size_t nTextureBytes = 0;
+    size_t nTextureBudgetBytes = 0;
+    size_t nMaterialCount = 0;
+    size_t nMaterialInstanceCount = 0;
+    // Holders of those instances; above the count when instances are shared.
+    size_t nMaterialInstanceUsers = 0;
+  };
+
+  // Definitions with the same material, parameter values and textures share
+  // one instance, so callers must not change its parameters. The returned
+  // instance holds a reference on its material and textures until every
+  // holder handed it back through vReleaseMaterialInstance.
   Resource<::filament::MaterialInstance*> getMaterialInstance(
       const MaterialDefinitions* materialDefinitions);
 
+  // Destroys the instance once its last holder released it. Textures and
+  // materials it was the last user of stay cached until the budget forces
+  // them out.
+  void vReleaseMaterialInstance(::filament::MaterialInstance* poInstance);
+
+  // Unreferenced textures are evicted least recently used first once the
+  // estimated texture memory goes above this.
+  void vSetTextureBudget(size_t nBytes);
+
+  [[nodiscard]] ResourceUsage GetResourceUsage() const;
+
+  // Variants every scene material can end up using. Fog and stereo are never
+  // enabled on our views, so those variants are left out.
+  static constexpr ::filament::UserVariantFilterMask kSceneVariants =
+      static_cast<::filament::UserVariantFilterMask>(
+          ::filament::UserVariantFilterBit::DIRECTIONAL_LIGHTING) |
+      static_cast<::filament::UserVariantFilterMask>(
+          ::filament::UserVariantFilterBit::DYNAMIC_LIGHTING) |
+      static_cast<::filament::UserVariantFilterMask>(
+          ::filament::UserVariantFilterBit::SHADOW_RECEIVER) |
+      static_cast<::filament::UserVariantFilterMask>(
+          ::filament::UserVariantFilterBit::VSM);
+
+  // Called when a scene starts loading; frame times are tracked from here on
+  // until every warm-up finished, see vUpdate.
+  void vBeginSceneEntry(bool bWarmUpMaterials, bool bHoldEntitiesUntilReady);
+
+  // Asks the backend to compile the given variants of the material ahead of
+  // first use. Materials already warmed up are skipped.
+  void vWarmUpMaterial(::filament::Material* poMaterial,
+                       ::filament::UserVariantFilterMask variants);
+
+  // True while entities should be kept out of the scene because their
+  // programs are still compiling. Each warm-up holds them back for at most
+  // kMaxHoldSeconds from when it was requested.
+  [[nodiscard]] bool bIsHoldingEntities() const;
+
+  // Material warm-ups still compiling.
+  [[nodiscard]] size_t nGetPendingWarmUps() const {
+    return m_mapPendingWarmUps.size();
+  }
+
   // Disallow copy and assign.
   MaterialSystem(const MaterialSystem&) = delete;
   MaterialSystem& operator=(const MaterialSystem&) = delete;
@@ -49,6 +109,8 @@ class MaterialSystem : public ECSystem {
   void vShutdownSystem() override;
   void DebugPrint() override;
 
+  void vAccountResources(ResourceReport& report) const override;
+
   [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
 
   [[nodiscard]] static size_t StaticGetTypeID() {
@@ -78,5 +140,66 @@ class MaterialSystem : public ECSystem {
   // makes sense to have a check if a material needs a texture, to load it in
   // that stack chain.
   TextureMap loadedTextures_;
+
+  struct CacheEntry {
+    size_t nRefCount = 0;
+    // m_nUseTick at last use, for LRU ordering.
+    size_t nLastUsed = 0;
+    size_t nBytes = 0;
+  };
+
+  struct InstanceReferences {
+    std::string szInstanceKey;
+    size_t nRefCount = 0;
+    std::string szMaterialLookupName;
+    std::vector<std::string> lstTexturePaths;
+  };
+
+  static constexpr size_t kDefaultTextureBudgetBytes = 256 * 1024 * 1024;
+  // Materials hold compiled programs rather than texture memory, so they are
+  // capped by count instead of by the byte budget.
+  static constexpr size_t kMaxUnreferencedMaterials = 8;
+
+  std::map<std::string, CacheEntry> m_mapTextureEntries;
+  std::map<std::string, CacheEntry> m_mapMaterialEntries;
+  std::map<const ::filament::MaterialInstance*, InstanceReferences>
+      m_mapInstanceReferences;
+  // MaterialDefinitions::szGetInstanceKey to the instance made for it.
+  std::map<std::string, ::filament::MaterialInstance*> m_mapInternedInstances;
+  size_t m_nTextureBytes = 0;
+  size_t m_nTextureBudgetBytes = kDefaultTextureBudgetBytes;
+  size_t m_nUseTick = 0;
+
+  void vEvictUnreferenced();
+  void vDropExpiredWarmUps();
+
+  // Never hold entities back longer than this, in case a backend doesn't
+  // report compile completion.
+  static constexpr float kMaxHoldSeconds = 5.0f;
+  // Minimum length of the scene entry window used for the frame time report.
+  static constexpr float kSceneEntryMinSeconds = 3.0f;
+
+  // Warm-up state is only touched on the Filament API thread, compile
+  // callbacks are dispatched there too.
+  // Variant bits already compiled per material; a later request for other
+  // variants of the same material still gets them compiled.
+  std::map<const ::filament::Material*, ::filament::UserVariantFilterMask>
+      m_mapWarmedUpVariants;
+  // When each warm-up still waiting for its compile callback was requested,
+  // by ticket. Dropped after kMaxHoldSeconds if the callback never comes.
+  std::map<size_t, std::chrono::steady_clock::time_point> m_mapPendingWarmUps;
+  size_t m_nNextWarmUpTicket = 0;
+  bool m_bWarmUpMaterials = true;
+  bool m_bHoldEntitiesUntilReady = false;
+
+  bool m_bInSceneEntry = false;
+  float m_fSceneEntryElapsed = 0.0f;
+  float m_fSceneEntryWorstFrame = 0.0f;
+  size_t m_nSceneEntryFrames = 0;
+  size_t m_nSceneEntryWarmUps = 0;
+  float m_fWarmUpDoneAt = -1.0f;
+  size_t m_nSceneEntryInstanceRequests = 0;
+  size_t m_nSceneEntryInstancesCreated = 0;
+  float m_fSceneEntryInstanceMilliseconds = 0.0f;
 };
 }  // namespace plugin_filament_view
\ No newline at end of file
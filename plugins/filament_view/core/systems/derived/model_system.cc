@@ -14,23 +14,32 @@
  * limitations under the License.
  */
 #include "model_system.h"
+#include "animation_system.h"
 #include "collision_system.h"
 #include "filament_system.h"
+#include "lod_system.h"
+#include "material_system.h"
+#include "transform_system.h"
 
 #include <core/components/derived/collidable.h>
 #include <core/include/file_utils.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/ecsystems_manager.h>
 #include <core/utils/entitytransforms.h>
+#include <core/utils/mesh_simplifier.h>
 #include <curl_client/curl_client.h>
 #include <filament/Scene.h>
+#include <filament/filament/Material.h>
 #include <filament/filament/RenderableManager.h>
 #include <filament/filament/TransformManager.h>
+#include <filament/gltfio/FilamentInstance.h>
 #include <filament/gltfio/ResourceLoader.h>
 #include <filament/gltfio/TextureProvider.h>
 #include <filament/gltfio/materials/uberarchive.h>
 #include <filament/utils/Slice.h>
 #include <algorithm>  // for max
 #include <asio/post.hpp>
+#include <chrono>
 #include <sstream>
 
 namespace plugin_filament_view {
@@ -42,11 +51,19 @@ using filament::gltfio::ResourceLoader;
 
 ////////////////////////////////////////////////////////////////////////////////////
 void ModelSystem::destroyAllAssetsOnModels() {
+  const auto animationSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<AnimationSystem>(
+          AnimationSystem::StaticGetTypeID(), "destroyAllAssetsOnModels");
   for (const auto& [fst, snd] : m_mapszpoAssets) {
+    if (animationSystem) {
+      animationSystem->vUnregisterModel(fst);
+    }
+    vDestroyLodLevels(fst);
     destroyAsset(snd->getAsset());  // NOLINT
     delete snd;                     // NOLINT
   }
   m_mapszpoAssets.clear();
+  m_mapnSourceBytes.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -76,19 +93,115 @@ filament::gltfio::FilamentAsset* ModelSystem::poFindAssetByGuid(
   return iter->second->getAsset();
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+Model* ModelSystem::poFindModelByGuid(const EntityGUID& guid) const {
+  const auto iter = m_mapszpoAssets.find(guid);
+  return iter == m_mapszpoAssets.end() ? nullptr : iter->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+Model* ModelSystem::poFindModelByRenderable(const utils::Entity& entity) const {
+  const auto bOwns = [&entity](const filament::gltfio::FilamentAsset* asset) {
+    if (asset == nullptr) {
+      return false;
+    }
+    const auto* renderables = asset->getRenderableEntities();
+    const auto* end = renderables + asset->getRenderableEntityCount();
+    return std::find(renderables, end, entity) != end;
+  };
+
+  for (const auto& [guid, model] : m_mapszpoAssets) {
+    if (bOwns(model->getAsset())) {
+      return model;
+    }
+  }
+  for (const auto& [guid, lstAssets] : m_mapszlstLodAssets) {
+    if (std::any_of(lstAssets.begin(), lstAssets.end(), bOwns)) {
+      return poFindModelByGuid(guid);
+    }
+  }
+  return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vGetRootEntities(const EntityGUID& guid,
+                                   std::vector<utils::Entity>& lstRoots) const {
+  if (const auto* model = poFindModelByGuid(guid);
+      model != nullptr && model->getAsset() != nullptr) {
+    lstRoots.push_back(model->getAsset()->getRoot());
+  }
+  if (const auto iter = m_mapszlstLodAssets.find(guid);
+      iter != m_mapszlstLodAssets.end()) {
+    for (const auto* asset : iter->second) {
+      lstRoots.push_back(asset->getRoot());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vLoadModel(Model* poModel) {
+  if (const auto glb_model = dynamic_cast<GlbModel*>(poModel)) {
+    if (!glb_model->szGetAssetPath().empty()) {
+      loadGlbFromAsset(poModel, glb_model->szGetAssetPath(), false);
+    }
+
+    if (!glb_model->szGetURLPath().empty()) {
+      loadGlbFromUrl(poModel, glb_model->szGetURLPath());
+    }
+  } else if (const auto gltf_model = dynamic_cast<GltfModel*>(poModel)) {
+    if (!gltf_model->szGetAssetPath().empty()) {
+      loadGltfFromAsset(poModel, gltf_model->szGetAssetPath(),
+                        gltf_model->szGetPrefix(), gltf_model->szGetPostfix());
+    }
+
+    if (!gltf_model->szGetURLPath().empty()) {
+      loadGltfFromUrl(poModel, gltf_model->szGetURLPath());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool ModelSystem::bRemoveModel(const EntityGUID& guid) {
+  const auto iter = m_mapszpoAssets.find(guid);
+  if (iter == m_mapszpoAssets.end()) {
+    return false;
+  }
+  Model* model = iter->second;
+
+  if (const auto transformSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<TransformSystem>(
+              TransformSystem::StaticGetTypeID(), "bRemoveModel")) {
+    transformSystem->vRemoveNode(guid);
+  }
+
+  if (const auto animationSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<AnimationSystem>(
+              AnimationSystem::StaticGetTypeID(), "bRemoveModel")) {
+    animationSystem->vUnregisterModel(guid);
+  }
+  if (model->HasComponentByStaticTypeID(Collidable::StaticGetTypeID())) {
+    if (const auto collisionSystem =
+            ECSystemManager::GetInstance()->poGetSystemAs<CollisionSystem>(
+                CollisionSystem::StaticGetTypeID(), "bRemoveModel")) {
+      collisionSystem->vRemoveCollidable(model);
+    }
+  }
+  vDestroyLodLevels(guid);
+  destroyAsset(model->getAsset());
+
+  m_mapszpoAssets.erase(iter);
+  m_mapnSourceBytes.erase(guid);
+  delete model;  // NOLINT
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void ModelSystem::loadModelGlb(Model* poOurModel,
                                const std::vector<uint8_t>& buffer,
                                const std::string& /*assetName*/) {
-  if (assetLoader_ == nullptr) {
-    // NOTE, this should only be temporary until CustomModelViewer isn't
-    // necessary in implementation.
-    vInitSystem();
-
-    if (assetLoader_ == nullptr) {
-      spdlog::error("unable to initialize model system");
-      return;
-    }
+  if (!bCreateLoaders()) {
+    spdlog::error("unable to initialize model system");
+    return;
   }
 
   auto* asset = assetLoader_->createAsset(buffer.data(),
@@ -104,10 +217,7 @@ void ModelSystem::loadModelGlb(Model* poOurModel,
   const auto engine = filamentSystem->getFilamentEngine();
 
   resourceLoader_->asyncBeginLoad(asset);
-
-  // TODO
-  // This will move to be on the model itself.
-  // modelViewer->setAnimator(asset->getInstance()->getAnimator());
+  vWarmUpMaterials(asset);
 
   // NOTE if this is a prefab/instance you will NOT Want to do this.
   asset->releaseSourceData();
@@ -133,10 +243,131 @@ void ModelSystem::loadModelGlb(Model* poOurModel,
   EntityTransforms::vApplyTransform(poOurModel->getAsset(),
                                     *poOurModel->GetBaseTransform());
 
-  // todo
-  // setUpAnimation(poCurrModel->GetAnimation());
+  vRegisterAnimations(poOurModel);
 
   m_mapszpoAssets.insert(std::pair(poOurModel->GetGlobalGuid(), poOurModel));
+  m_mapnSourceBytes[poOurModel->GetGlobalGuid()] = buffer.size();
+
+  if (const auto lod = std::dynamic_pointer_cast<Lod>(
+          poOurModel->GetComponentByStaticTypeID(Lod::StaticGetTypeID()))) {
+    vCreateLodLevels(poOurModel, buffer, *lod);
+  }
+
+  vAddToHierarchy(poOurModel);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vAddToHierarchy(const Model* poOurModel) {
+  if (const auto transformSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<TransformSystem>(
+              TransformSystem::StaticGetTypeID(), "vAddToHierarchy")) {
+    transformSystem->vAddNode(poOurModel->GetGlobalGuid());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vCreateLodLevels(Model* poOurModel,
+                                   const std::vector<uint8_t>& buffer,
+                                   const Lod& lod) {
+  const auto lodSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<LodSystem>(
+          LodSystem::StaticGetTypeID(), "vCreateLodLevels");
+  if (lodSystem == nullptr) {
+    spdlog::warn("Failed to get lod system, loading {} at full detail only",
+                 poOurModel->GetGlobalGuid());
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vCreateLodLevels");
+  const auto engine = filamentSystem->getFilamentEngine();
+  auto& rcm = engine->getRenderableManager();
+
+  const auto assetPath =
+      ECSystemManager::GetInstance()->getConfigValue<std::string>(kAssetPath);
+
+  std::vector<LodSystem::LodLevel> levels;
+  levels.push_back({0.0f, MeshSimplifier::nCountGlbTriangles(buffer),
+                    poOurModel->getAsset()});
+
+  auto& lodAssets = m_mapszlstLodAssets[poOurModel->GetGlobalGuid()];
+  for (const auto& definition : lod.GetLevels()) {
+    size_t nTriangleCount = 0;
+    std::vector<uint8_t> levelBuffer;
+    if (definition.szAssetPath.empty()) {
+      levelBuffer = MeshSimplifier::vecSimplifyGlb(
+          buffer, definition.fTriangleRatio, &nTriangleCount);
+    } else {
+      levelBuffer = readBinaryFile(definition.szAssetPath, assetPath);
+      nTriangleCount = MeshSimplifier::nCountGlbTriangles(levelBuffer);
+    }
+
+    auto* asset = levelBuffer.empty()
+                      ? nullptr
+                      : assetLoader_->createAsset(
+                            levelBuffer.data(),
+                            static_cast<uint32_t>(levelBuffer.size()));
+    if (!asset) {
+      spdlog::warn("Failed to create lod level for {}, skipping it",
+                   poOurModel->GetGlobalGuid());
+      continue;
+    }
+
+    lodResourceLoader_->loadResources(asset);
+    asset->releaseSourceData();
+
+    utils::Slice const listOfRenderables{asset->getRenderableEntities(),
+                                         asset->getRenderableEntityCount()};
+    for (const auto entity : listOfRenderables) {
+      const auto ri = rcm.getInstance(entity);
+      rcm.setCastShadows(
+          ri, poOurModel->GetCommonRenderable()->IsCastShadowsEnabled());
+      rcm.setReceiveShadows(
+          ri, poOurModel->GetCommonRenderable()->IsReceiveShadowsEnabled());
+      rcm.setScreenSpaceContactShadows(ri, false);
+    }
+
+    EntityTransforms::vApplyTransform(asset, *poOurModel->GetBaseTransform());
+
+    // Reduced levels keep the skeleton, so they play along with level 0.
+    if (const auto animationSystem =
+            ECSystemManager::GetInstance()->poGetSystemAs<AnimationSystem>(
+                AnimationSystem::StaticGetTypeID(), "vCreateLodLevels")) {
+      animationSystem->vAddLinkedAsset(poOurModel->GetGlobalGuid(), asset);
+    }
+
+    lodAssets.push_back(asset);
+    m_mapnLodSourceBytes[poOurModel->GetGlobalGuid()] += levelBuffer.size();
+    levels.push_back({definition.fScreenSize, nTriangleCount, asset});
+
+    spdlog::debug("Model {} lod level {}: {} triangles (full detail {})",
+                  poOurModel->GetGlobalGuid(), levels.size() - 1,
+                  nTriangleCount, levels[0].nTriangleCount);
+  }
+
+  lodSystem->vRegisterModel(poOurModel, std::move(levels),
+                            lod.GetHysteresis());
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vDestroyLodLevels(const EntityGUID& guid) {
+  if (const auto lodSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<LodSystem>(
+              LodSystem::StaticGetTypeID(), "vDestroyLodLevels")) {
+    lodSystem->vUnregister(guid);
+  }
+
+  m_mapnLodSourceBytes.erase(guid);
+  const auto iter = m_mapszlstLodAssets.find(guid);
+  if (iter == m_mapszlstLodAssets.end()) {
+    return;
+  }
+
+  for (const auto* asset : iter->second) {
+    destroyAsset(asset);
+  }
+  m_mapszlstLodAssets.erase(iter);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -145,6 +376,11 @@ void ModelSystem::loadModelGltf(
     const std::vector<uint8_t>& buffer,
     std::function<const filament::backend::BufferDescriptor&(
         std::string uri)>& /* callback */) {
+  if (!bCreateLoaders()) {
+    spdlog::error("unable to initialize model system");
+    return;
+  }
+
   auto* asset = assetLoader_->createAsset(buffer.data(),
                                           static_cast<uint32_t>(buffer.size()));
   if (!asset) {
@@ -167,7 +403,7 @@ void ModelSystem::loadModelGltf(
 #endif  // TODO
   }
   resourceLoader_->asyncBeginLoad(asset);
-  // modelViewer->setAnimator(asset->getInstance()->getAnimator());
+  vWarmUpMaterials(asset);
   asset->releaseSourceData();
 
   const auto filamentSystem =
@@ -192,7 +428,47 @@ void ModelSystem::loadModelGltf(
   }
 
   poOurModel->setAsset(asset);
+  vRegisterAnimations(poOurModel);
   m_mapszpoAssets.insert(std::pair(poOurModel->GetGlobalGuid(), poOurModel));
+  m_mapnSourceBytes[poOurModel->GetGlobalGuid()] = buffer.size();
+  vAddToHierarchy(poOurModel);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vWarmUpMaterials(
+    const filament::gltfio::FilamentAsset* asset) {
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "vWarmUpMaterials");
+  if (materialSystem == nullptr) {
+    return;
+  }
+
+  const auto* instance = asset->getInstance();
+  auto variants = MaterialSystem::kSceneVariants;
+  if (instance->getSkinCount() > 0) {
+    variants |= static_cast<filament::UserVariantFilterMask>(
+        filament::UserVariantFilterBit::SKINNING);
+  }
+
+  // These are the ubershader provider's materials, shared by every asset; the
+  // material system only compiles each of them once.
+  utils::Slice const materialInstances{instance->getMaterialInstances(),
+                                       instance->getMaterialInstanceCount()};
+  for (const auto* materialInstance : materialInstances) {
+    materialSystem->vWarmUpMaterial(
+        const_cast<filament::Material*>(materialInstance->getMaterial()),
+        variants);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vRegisterAnimations(Model* poOurModel) {
+  if (const auto animationSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<AnimationSystem>(
+              AnimationSystem::StaticGetTypeID(), "vRegisterAnimations")) {
+    animationSystem->vRegisterModel(poOurModel);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -244,8 +520,18 @@ void ModelSystem::populateSceneWithAsyncLoadedAssets(const Model* model) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+bool ModelSystem::bIsAsyncLoadComplete() const {
+  return resourceLoader_ == nullptr ||
+         resourceLoader_->asyncGetLoadProgress() == 1.0f;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void ModelSystem::updateAsyncAssetLoading() {
+  if (resourceLoader_ == nullptr) {
+    return;
+  }
+
   resourceLoader_->asyncUpdateLoad();
 
   // This does not specify per resource, but a global, best we can do with this
@@ -255,13 +541,26 @@ void ModelSystem::updateAsyncAssetLoading() {
   // eventually settle
   const float percentComplete = resourceLoader_->asyncGetLoadProgress();
 
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "updateAsyncAssetLoading");
+  const bool bHoldEntities =
+      materialSystem != nullptr && materialSystem->bIsHoldingEntities();
+
   for (const auto& [fst, snd] : m_mapszpoAssets) {
-    populateSceneWithAsyncLoadedAssets(snd);
+    // Renderables stay queued in the asset until their programs are ready.
+    if (!bHoldEntities) {
+      populateSceneWithAsyncLoadedAssets(snd);
+    }
 
     if (percentComplete != 1.0f) {
       continue;
     }
 
+    if (!bHoldEntities && snd->getAsset()->popRenderables(nullptr, 0) == 0) {
+      snd->vSetSceneLoaded();
+    }
+
     auto collisionSystem =
         ECSystemManager::GetInstance()->poGetSystemAs<CollisionSystem>(
             CollisionSystem::StaticGetTypeID(), "updateAsyncAssetLoading");
@@ -382,20 +681,28 @@ std::future<Resource<std::string_view>> ModelSystem::loadGltfFromUrl(
 
 ////////////////////////////////////////////////////////////////////////////////////
 void ModelSystem::vInitSystem() {
+  // The loaders wait for the first model, see bCreateLoaders; creating the
+  // ubershader provider is the costliest part of startup after the engine.
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool ModelSystem::bCreateLoaders() {
   if (materialProvider_ != nullptr) {
-    return;
+    return assetLoader_ != nullptr;
   }
 
   const auto filamentSystem =
       ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "ModelSystem::vInitSystem");
+          FilamentSystem::StaticGetTypeID(), "ModelSystem::bCreateLoaders");
   const auto engine = filamentSystem->getFilamentEngine();
 
   if (engine == nullptr) {
-    spdlog::error("Engine is null, delaying vInitSystem");
-    return;
+    spdlog::error("Engine is null, delaying bCreateLoaders");
+    return false;
   }
 
+  const auto start = std::chrono::steady_clock::now();
+
   materialProvider_ = filament::gltfio::createUbershaderProvider(
       engine, UBERARCHIVE_DEFAULT_DATA,
       static_cast<size_t>(UBERARCHIVE_DEFAULT_SIZE));
@@ -412,10 +719,18 @@ void ModelSystem::vInitSystem() {
   resourceConfiguration.engine = engine;
   resourceConfiguration.normalizeSkinningWeights = true;
   resourceLoader_ = new ResourceLoader(resourceConfiguration);
+  lodResourceLoader_ = new ResourceLoader(resourceConfiguration);
 
   const auto decoder = filament::gltfio::createStbProvider(engine);
   resourceLoader_->addTextureProvider("image/png", decoder);
   resourceLoader_->addTextureProvider("image/jpeg", decoder);
+  lodResourceLoader_->addTextureProvider("image/png", decoder);
+  lodResourceLoader_->addTextureProvider("image/jpeg", decoder);
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  spdlog::debug("Model loaders created in {:.1f} ms", elapsed.count());
+  return assetLoader_ != nullptr;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -428,6 +743,8 @@ void ModelSystem::vShutdownSystem() {
   destroyAllAssetsOnModels();
   delete resourceLoader_;
   resourceLoader_ = nullptr;
+  delete lodResourceLoader_;
+  lodResourceLoader_ = nullptr;
 
   if (assetLoader_) {
     AssetLoader::destroy(&assetLoader_);
@@ -440,4 +757,29 @@ void ModelSystem::DebugPrint() {
   SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+void ModelSystem::vAccountResources(ResourceReport& report) const {
+  for (const auto& [guid, model] : m_mapszpoAssets) {
+    const auto* asset = model->getAsset();
+    const auto sourceIter = m_mapnSourceBytes.find(guid);
+    report.vAdd("ModelSystem", guid,
+                "gltf asset (" +
+                    std::to_string(asset ? asset->getRenderableEntityCount()
+                                         : 0) +
+                    " renderables)",
+                sourceIter == m_mapnSourceBytes.end() ? 0 : sourceIter->second,
+                sizeof(Model));
+
+    const auto lodIter = m_mapszlstLodAssets.find(guid);
+    const auto lodBytesIter = m_mapnLodSourceBytes.find(guid);
+    if (lodIter != m_mapszlstLodAssets.end() &&
+        lodBytesIter != m_mapnLodSourceBytes.end()) {
+      report.vAdd("ModelSystem", guid,
+                  "lod assets (" + std::to_string(lodIter->second.size()) +
+                      " levels)",
+                  lodBytesIter->second, 0);
+    }
+  }
+}
+
 }  // namespace plugin_filament_view
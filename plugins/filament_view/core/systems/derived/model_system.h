@@ -15,6 +15,7 @@
  */
 #pragma once
 
+#include <core/components/derived/lod.h>
 #include <core/entity/derived/model/model.h>
 #include <core/include/resource.h>
 #include <core/systems/base/ecsystem.h>
@@ -45,9 +46,29 @@ class ModelSystem : public ECSystem {
                          std::string uri)>& callback);
 
   filament::gltfio::FilamentAsset* poFindAssetByGuid(const std::string& szGUID);
+  [[nodiscard]] Model* poFindModelByGuid(const EntityGUID& guid) const;
+  // The model whose asset, or one of its lod variants, owns the renderable
+  // entity; for picking.
+  [[nodiscard]] Model* poFindModelByRenderable(
+      const utils::Entity& entity) const;
+  // Root entity of the model's asset followed by those of its lod variants.
+  void vGetRootEntities(const EntityGUID& guid,
+                        std::vector<utils::Entity>& lstRoots) const;
+
+  // Starts loading the model from its asset path or url.
+  void vLoadModel(Model* poModel);
+  // Destroys a loaded model; false if no loaded model has that guid.
+  bool bRemoveModel(const EntityGUID& guid);
 
   void updateAsyncAssetLoading();
 
+  // Models whose source has been read, loaded or still loading.
+  [[nodiscard]] size_t nGetModelCount() const {
+    return m_mapszpoAssets.size();
+  }
+  // True once gltfio has loaded every resource it was handed.
+  [[nodiscard]] bool bIsAsyncLoadComplete() const;
+
   std::future<Resource<std::string_view>> loadGlbFromAsset(
       Model* poOurModel,
       const std::string& path,
@@ -73,6 +94,10 @@ class ModelSystem : public ECSystem {
   void vShutdownSystem() override;
   void DebugPrint() override;
 
+  // Models are sized by their source glb / gltf bytes, gltfio doesn't tell
+  // what it uploaded; decoded textures make the real figure larger.
+  void vAccountResources(ResourceReport& report) const override;
+
   [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
 
   [[nodiscard]] static size_t StaticGetTypeID() {
@@ -83,10 +108,22 @@ class ModelSystem : public ECSystem {
   ::filament::gltfio::AssetLoader* assetLoader_{};
   ::filament::gltfio::MaterialProvider* materialProvider_{};
   ::filament::gltfio::ResourceLoader* resourceLoader_{};
+  // Lod variants load synchronously, kept apart so they don't disturb the
+  // async progress of resourceLoader_.
+  ::filament::gltfio::ResourceLoader* lodResourceLoader_{};
 
   // This is the EntityObject guids to model instantiated.
   std::map<EntityGUID, Model*> m_mapszpoAssets;  // NOLINT
 
+  // Reduced detail assets per model, finest first; not in the scene unless
+  // the LodSystem switched to them.
+  std::map<EntityGUID, std::vector<filament::gltfio::FilamentAsset*>>
+      m_mapszlstLodAssets;
+
+  // Source buffer sizes per model and for all of its lod variants.
+  std::map<EntityGUID, size_t> m_mapnSourceBytes;
+  std::map<EntityGUID, size_t> m_mapnLodSourceBytes;
+
   // This will be needed for a list of prefab instances to load from
   // std::map<Model*> <name>models_;
 
@@ -99,8 +136,21 @@ class ModelSystem : public ECSystem {
   // not actively used, to be moved
   std::vector<float> morphWeights_;
 
+  // Creates the ubershader provider and the asset and resource loaders on
+  // first use; false if they can't be created yet.
+  bool bCreateLoaders();
+
   void populateSceneWithAsyncLoadedAssets(const Model* model);
 
+  void vCreateLodLevels(Model* poOurModel,
+                        const std::vector<uint8_t>& buffer,
+                        const Lod& lod);
+  void vDestroyLodLevels(const EntityGUID& guid);
+  static void vRegisterAnimations(Model* poOurModel);
+  // Links the model to its parent once its root entities exist.
+  static void vAddToHierarchy(const Model* poOurModel);
+  static void vWarmUpMaterials(const filament::gltfio::FilamentAsset* asset);
+
   using PromisePtr = std::shared_ptr<std::promise<Resource<std::string_view>>>;
   void handleFile(
       Model* poOurModel,
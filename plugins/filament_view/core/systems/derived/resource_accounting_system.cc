@@ -0,0 +1,148 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "resource_accounting_system.h"
+
+#include <core/include/literals.h>
+#include <core/systems/base/resource_report.h>
+#include <core/systems/ecsystems_manager.h>
+#include <plugins/common/common.h>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::setupMessageChannels(
+    flutter::PluginRegistrar* plugin_registrar) {
+  auto channel_name = std::string("plugin.filament_view.resource_usage");
+
+  resourceUsageCallback_ = std::make_unique<flutter::MethodChannel<>>(
+      plugin_registrar->messenger(), channel_name,
+      &flutter::StandardMethodCodec::GetInstance());
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vSendReport(
+    const ResourceReport& report) const {
+  if (resourceUsageCallback_ == nullptr) {
+    return;
+  }
+
+  resourceUsageCallback_->InvokeMethod(
+      kResourceUsage, std::make_unique<flutter::EncodableValue>(
+                          flutter::EncodableValue(report.oEncode())));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vDumpReport(const ResourceReport& report,
+                                           const std::string& szPath) {
+  std::string path = szPath;
+  if (!plugin_common::JsonUtils::WriteJsonDocumentToFile(path,
+                                                         report.oToJson())) {
+    spdlog::error("Unable to write resource usage to {}", szPath);
+    return;
+  }
+  spdlog::info("Resource usage written to {}", szPath);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vCheckBudget(const ResourceReport& report) {
+  const size_t nTotalBytes = report.nGetTotalBytes();
+  if (m_bOverBudget) {
+    if (static_cast<float>(nTotalBytes) <
+        static_cast<float>(m_nBudgetBytes) * kRearmRatio) {
+      spdlog::info("Resource usage back under budget: {} of {} MiB",
+                   nTotalBytes / (1024 * 1024), m_nBudgetBytes / (1024 * 1024));
+      m_bOverBudget = false;
+    }
+    return;
+  }
+
+  if (nTotalBytes <= m_nBudgetBytes) {
+    return;
+  }
+
+  m_bOverBudget = true;
+  spdlog::warn("Resource usage over budget: {} of {} MiB, top consumers:",
+               nTotalBytes / (1024 * 1024), m_nBudgetBytes / (1024 * 1024));
+  report.vLogTopConsumers(kTopConsumerCount);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vInitSystem() {
+  vRegisterMessageHandler(
+      ECSMessageType::SetupMessageChannels, [this](const ECSMessage& msg) {
+        spdlog::debug("SetupMessageChannels");
+
+        const auto registrar = msg.getData<flutter::PluginRegistrar*>(
+            ECSMessageType::SetupMessageChannels);
+
+        setupMessageChannels(registrar);
+
+        spdlog::debug("SetupMessageChannels Complete");
+      });
+
+  vRegisterMessageHandler(
+      ECSMessageType::RequestResourceUsage, [this](const ECSMessage& msg) {
+        const auto szDumpPath =
+            msg.getData<std::string>(ECSMessageType::RequestResourceUsage);
+
+        ResourceReport report;
+        ECSystemManager::GetInstance()->vAccountResources(report);
+
+        vSendReport(report);
+        if (!szDumpPath.empty()) {
+          vDumpReport(report, szDumpPath);
+        }
+      });
+
+  vRegisterMessageHandler(
+      ECSMessageType::SetResourceBudget, [this](const ECSMessage& msg) {
+        m_nBudgetBytes = msg.getData<size_t>(ECSMessageType::SetResourceBudget);
+        m_bOverBudget = false;
+        // Check on the next update rather than waiting out the interval.
+        m_fCheckElapsed = kCheckIntervalSeconds;
+        spdlog::debug("Resource budget set to {} MiB",
+                      m_nBudgetBytes / (1024 * 1024));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vUpdate(const float fElapsedTime) {
+  if (m_nBudgetBytes == 0) {
+    return;
+  }
+
+  m_fCheckElapsed += fElapsedTime;
+  if (m_fCheckElapsed < kCheckIntervalSeconds) {
+    return;
+  }
+  m_fCheckElapsed = 0.0f;
+
+  ResourceReport report;
+  ECSystemManager::GetInstance()->vAccountResources(report);
+  vCheckBudget(report);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::vShutdownSystem() {
+  resourceUsageCallback_.reset();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ResourceAccountingSystem::DebugPrint() {
+  spdlog::debug("{}::{}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
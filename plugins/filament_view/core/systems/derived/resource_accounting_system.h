@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/systems/base/ecsystem.h>
+#include <flutter_desktop_plugin_registrar.h>
+#include <memory>
+#include <string>
+
+namespace plugin_filament_view {
+
+class ResourceReport;
+
+// Collects what every system holds into a ResourceReport on request, and
+// watches the total against an optional budget. Crossing the budget warns
+// once with the largest consumers; it warns again only after the total fell
+// back under kRearmRatio of the budget.
+class ResourceAccountingSystem : public ECSystem {
+ public:
+  ResourceAccountingSystem() = default;
+
+  // Disallow copy and assign.
+  ResourceAccountingSystem(const ResourceAccountingSystem&) = delete;
+  ResourceAccountingSystem& operator=(const ResourceAccountingSystem&) =
+      delete;
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(ResourceAccountingSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  static constexpr float kCheckIntervalSeconds = 5.0f;
+  static constexpr float kRearmRatio = 0.9f;
+  static constexpr size_t kTopConsumerCount = 10;
+
+  void setupMessageChannels(flutter::PluginRegistrar* plugin_registrar);
+  void vSendReport(const ResourceReport& report) const;
+  static void vDumpReport(const ResourceReport& report,
+                          const std::string& szPath);
+  void vCheckBudget(const ResourceReport& report);
+
+  // Used for sending resource_usage reports back over to Dart.
+  std::unique_ptr<flutter::MethodChannel<>> resourceUsageCallback_;
+
+  size_t m_nBudgetBytes = 0;
+  bool m_bOverBudget = false;
+  float m_fCheckElapsed = 0.0f;
+};
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,414 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "scene_patch_system.h"
+#include "collision_system.h"
+#include "filament_system.h"
+#include "model_system.h"
+#include "scene_snapshot_system.h"
+#include "shape_system.h"
+#include "transform_system.h"
+
+#include <core/components/derived/basetransform.h>
+#include <core/components/derived/collidable.h>
+#include <core/entity/derived/model/model.h>
+#include <core/entity/derived/shapes/baseshape.h>
+#include <core/include/literals.h>
+#include <core/systems/ecsystems_manager.h>
+#include <core/utils/deserialize.h>
+#include <core/utils/entitytransforms.h>
+#include <filament/TransformManager.h>
+#include <plugins/common/common.h>
+#include <chrono>
+#include <cmath>
+
+namespace plugin_filament_view {
+
+using filament::math::float3;
+using filament::math::mat4f;
+using filament::math::quatf;
+
+namespace {
+
+// Null unless the scene is being recorded, so patches aren't copied for it.
+std::shared_ptr<SceneSnapshotSystem> poGetRecordingSnapshotSystem() {
+  auto snapshotSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<SceneSnapshotSystem>(
+          SceneSnapshotSystem::StaticGetTypeID(), "ScenePatchSystem");
+  if (snapshotSystem == nullptr || !snapshotSystem->bIsRecording()) {
+    return nullptr;
+  }
+  return snapshotSystem;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////
+ScenePatchSystem::Systems ScenePatchSystem::oGetSystems() {
+  const auto ecsManager = ECSystemManager::GetInstance();
+  Systems systems;
+  systems.poShapeSystem = ecsManager->poGetSystemAs<ShapeSystem>(
+      ShapeSystem::StaticGetTypeID(), "ScenePatchSystem::oGetSystems");
+  systems.poModelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+      ModelSystem::StaticGetTypeID(), "ScenePatchSystem::oGetSystems");
+  systems.poTransformSystem = ecsManager->poGetSystemAs<TransformSystem>(
+      TransformSystem::StaticGetTypeID(), "ScenePatchSystem::oGetSystems");
+  systems.poTransformManager =
+      &ecsManager
+           ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                           "ScenePatchSystem::oGetSystems")
+           ->getFilamentEngine()
+           ->getTransformManager();
+  return systems;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+ScenePatchSystem::Target ScenePatchSystem::oResolve(const Systems& systems,
+                                                    const EntityGUID& guid) {
+  Target target;
+  if (systems.poShapeSystem != nullptr) {
+    target.poShape = systems.poShapeSystem->poFindShapeByGuid(guid);
+  }
+  if (target.poShape == nullptr && systems.poModelSystem != nullptr) {
+    target.poModel = systems.poModelSystem->poFindModelByGuid(guid);
+  }
+
+  EntityObject* entityObject = target.poShape != nullptr
+                                   ? static_cast<EntityObject*>(target.poShape)
+                                   : static_cast<EntityObject*>(target.poModel);
+  if (entityObject != nullptr) {
+    target.poTransform = dynamic_cast<BaseTransform*>(
+        entityObject
+            ->GetComponentByStaticTypeID(BaseTransform::StaticGetTypeID())
+            .get());
+  }
+  return target;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vApplyTransform(const Systems& systems,
+                                       const EntityGUID& guid,
+                                       const Target& target,
+                                       const float3& translation,
+                                       const quatf& rotation,
+                                       const float3& scale) {
+  if (target.poShape == nullptr && target.poModel == nullptr) {
+    return;
+  }
+
+  // Kept current so lod and later rebuilds see the new placement.
+  if (target.poTransform != nullptr) {
+    target.poTransform->SetCenterPosition(translation);
+    target.poTransform->SetRotation(rotation);
+    target.poTransform->SetScale(scale);
+  }
+
+  const mat4f local = mat4f::translation(translation) *
+                      EntityTransforms::QuaternionToMat4f(rotation) *
+                      mat4f::scaling(scale);
+  auto& tm = *systems.poTransformManager;
+
+  // World transforms and collidables of the subtree follow on its update.
+  if (systems.poTransformSystem != nullptr) {
+    systems.poTransformSystem->vMarkDirty(guid);
+  }
+
+  if (target.poShape != nullptr) {
+    if (target.poShape->bIsInstanced()) {
+      systems.poShapeSystem->vSetInstanceTransform(target.poShape, local);
+    } else if (const auto& entity = target.poShape->poGetEntity();
+               entity != nullptr) {
+      tm.setTransform(tm.getInstance(*entity), local);
+    }
+    return;
+  }
+
+  m_lstRootScratch.clear();
+  systems.poModelSystem->vGetRootEntities(guid, m_lstRootScratch);
+  for (const auto root : m_lstRootScratch) {
+    tm.setTransform(tm.getInstance(root), local);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vApplyPatch(const ScenePatch& patch) {
+  ++m_nStatsPatches;
+  vApplyOperations(patch.lstOperations);
+  vApplyBulkTransforms(patch);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vApplyOperations(
+    const flutter::EncodableList& lstOperations) {
+  const auto ecsManager = ECSystemManager::GetInstance();
+  const std::string& flutterAssetsPath =
+      ecsManager->getConfigValue<std::string>(kAssetPath);
+
+  for (const auto& operation : lstOperations) {
+    const auto* params = std::get_if<flutter::EncodableMap>(&operation);
+    if (params == nullptr) {
+      continue;
+    }
+    const auto opIter = params->find(flutter::EncodableValue(kPatchOp));
+    if (opIter == params->end() ||
+        !std::holds_alternative<std::string>(opIter->second)) {
+      spdlog::warn("ScenePatchSystem: operation without an op");
+      continue;
+    }
+    const auto& op = std::get<std::string>(opIter->second);
+
+    if (op == kPatchOpAdd) {
+      if (const auto it = params->find(flutter::EncodableValue(kShape));
+          it != params->end() &&
+          std::holds_alternative<flutter::EncodableMap>(it->second)) {
+        if (auto shape = ShapeSystem::poDeserializeShapeFromData(
+                flutterAssetsPath,
+                std::get<flutter::EncodableMap>(it->second))) {
+          if (const auto snapshotSystem = poGetRecordingSnapshotSystem()) {
+            snapshotSystem->vRecordAdd(
+                kShapes, std::get<flutter::EncodableMap>(it->second),
+                shape->GetGlobalGuid());
+          }
+          m_lstPendingShapes.emplace_back(std::move(shape));
+          ++m_nStatsAdds;
+        }
+      } else if (const auto modelIt =
+                     params->find(flutter::EncodableValue(kModel));
+                 modelIt != params->end() &&
+                 std::holds_alternative<flutter::EncodableMap>(
+                     modelIt->second)) {
+        const auto& modelParams =
+            std::get<flutter::EncodableMap>(modelIt->second);
+        auto model = Model::Deserialize(flutterAssetsPath, modelParams);
+        if (model == nullptr) {
+          spdlog::error("ScenePatchSystem: unable to deserialize model");
+          continue;
+        }
+        if (const auto snapshotSystem = poGetRecordingSnapshotSystem()) {
+          snapshotSystem->vRecordAdd(kModels, modelParams,
+                                     model->GetGlobalGuid());
+        }
+        // The model system owns loaded models.
+        ecsManager
+            ->poGetSystemAs<ModelSystem>(ModelSystem::StaticGetTypeID(),
+                                         "vApplyOperations")
+            ->vLoadModel(model.release());
+        ++m_nStatsAdds;
+      }
+      continue;
+    }
+
+    // Later operations may refer to shapes added before them.
+    vFlushPendingShapes();
+
+    if (op == kPatchOpRemove) {
+      EntityGUID guid;
+      Deserialize::DecodeParameterWithDefault(kGlobalGuid, &guid, *params,
+                                              EntityGUID());
+      const auto shapeSystem = ecsManager->poGetSystemAs<ShapeSystem>(
+          ShapeSystem::StaticGetTypeID(), "vApplyOperations");
+      const auto modelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+          ModelSystem::StaticGetTypeID(), "vApplyOperations");
+      if (shapeSystem->bRemoveShape(guid) || modelSystem->bRemoveModel(guid)) {
+        if (const auto snapshotSystem = poGetRecordingSnapshotSystem()) {
+          snapshotSystem->vRecordRemove(guid);
+        }
+        ++m_nStatsRemoves;
+      } else {
+        spdlog::warn("ScenePatchSystem: nothing to remove for {}", guid);
+      }
+    } else if (op == kPatchOpUpdate) {
+      vApplyUpdate(*params);
+    } else {
+      spdlog::warn("ScenePatchSystem: unknown op {}", op);
+    }
+  }
+
+  vFlushPendingShapes();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vApplyUpdate(const flutter::EncodableMap& params) {
+  const auto start = std::chrono::steady_clock::now();
+
+  EntityGUID guid;
+  Deserialize::DecodeParameterWithDefault(kGlobalGuid, &guid, params,
+                                          EntityGUID());
+  const auto systems = oGetSystems();
+  const auto target = oResolve(systems, guid);
+  const auto* transform = target.poTransform;
+  if (transform == nullptr) {
+    spdlog::warn("ScenePatchSystem: nothing to update for {}", guid);
+    return;
+  }
+
+  // An empty parent guid detaches the entity.
+  if (const auto it = params.find(flutter::EncodableValue(kParentGuid));
+      it != params.end() && std::holds_alternative<std::string>(it->second)) {
+    systems.poTransformSystem->vSetParent(guid,
+                                          std::get<std::string>(it->second));
+  }
+
+  // Fields left out keep their current value.
+  float3 translation;
+  quatf rotation;
+  float3 scale;
+  Deserialize::DecodeParameterWithDefault(kCenterPosition, &translation,
+                                          params,
+                                          transform->GetCenterPosition());
+  Deserialize::DecodeParameterWithDefault(kRotation, &rotation, params,
+                                          transform->GetRotation());
+  Deserialize::DecodeParameterWithDefault(kScale, &scale, params,
+                                          transform->GetScale());
+
+  vApplyTransform(systems, guid, target, translation, rotation, scale);
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  ++m_nStatsUpdates;
+  m_fStatsUpdateMilliseconds += elapsed.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vApplyBulkTransforms(const ScenePatch& patch) {
+  const size_t nRecords = patch.vecTransforms.size() / kTransformStride;
+  if (nRecords == 0) {
+    return;
+  }
+  if (patch.vecTransforms.size() % kTransformStride != 0) {
+    spdlog::warn("ScenePatchSystem: {} trailing transform floats ignored",
+                 patch.vecTransforms.size() % kTransformStride);
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  const auto systems = oGetSystems();
+  std::vector<Target> lstTargets;
+  lstTargets.reserve(patch.lstTransformGuids.size());
+  for (const auto& guid : patch.lstTransformGuids) {
+    lstTargets.emplace_back(oResolve(systems, guid));
+  }
+
+  auto& tm = *systems.poTransformManager;
+
+  // World transforms of the whole hierarchy are resolved once, on commit.
+  tm.openLocalTransformTransaction();
+  size_t nApplied = 0;
+  for (size_t i = 0; i < nRecords; ++i) {
+    const float* record = patch.vecTransforms.data() + i * kTransformStride;
+    // Checked as a float first, converting one out of range is undefined.
+    if (!std::isfinite(record[0]) || record[0] < 0.0f ||
+        record[0] >= static_cast<float>(lstTargets.size())) {
+      continue;
+    }
+    const auto nIndex = static_cast<size_t>(record[0]);
+    vApplyTransform(systems, patch.lstTransformGuids[nIndex],
+                    lstTargets[nIndex], float3(record[1], record[2], record[3]),
+                    quatf(record[7], record[4], record[5], record[6]),
+                    float3(record[8], record[9], record[10]));
+    ++nApplied;
+  }
+  tm.commitLocalTransformTransaction();
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  m_nStatsBulkTransforms += nApplied;
+  m_fStatsBulkMilliseconds += elapsed.count();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vFlushPendingShapes() {
+  if (m_lstPendingShapes.empty()) {
+    return;
+  }
+
+  const auto ecsManager = ECSystemManager::GetInstance();
+  if (const auto collisionSystem = ecsManager->poGetSystemAs<CollisionSystem>(
+          CollisionSystem::StaticGetTypeID(), "vFlushPendingShapes")) {
+    for (const auto& shape : m_lstPendingShapes) {
+      if (shape->HasComponentByStaticTypeID(Collidable::StaticGetTypeID())) {
+        collisionSystem->vAddCollidable(shape.get());
+      }
+    }
+  }
+
+  // This releases the shapes.
+  ecsManager
+      ->poGetSystemAs<ShapeSystem>(ShapeSystem::StaticGetTypeID(),
+                                   "vFlushPendingShapes")
+      ->addShapesToScene(&m_lstPendingShapes);
+  m_lstPendingShapes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vInitSystem() {
+  vRegisterMessageHandler(
+      ECSMessageType::ApplyScenePatch, [this](const ECSMessage& msg) {
+        const auto patch = msg.getData<std::shared_ptr<ScenePatch>>(
+            ECSMessageType::ApplyScenePatch);
+        if (patch != nullptr) {
+          vApplyPatch(*patch);
+        }
+      });
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vUpdate(const float fElapsedTime) {
+  m_fStatsElapsed += fElapsedTime;
+  if (m_fStatsElapsed < kStatsIntervalSeconds) {
+    return;
+  }
+
+  if (m_nStatsPatches > 0) {
+    // Per entity updates are what separate calls cost natively, before the
+    // channel round trip each of them also pays.
+    spdlog::debug(
+        "ScenePatchSystem: {} patches, {} adds, {} removes; bulk {} "
+        "transforms in {:.2f} ms ({:.0f}/s), per entity {} updates in "
+        "{:.2f} ms ({:.0f}/s)",
+        m_nStatsPatches, m_nStatsAdds, m_nStatsRemoves, m_nStatsBulkTransforms,
+        m_fStatsBulkMilliseconds,
+        m_fStatsBulkMilliseconds > 0.0f
+            ? static_cast<float>(m_nStatsBulkTransforms) * 1000.0f /
+                  m_fStatsBulkMilliseconds
+            : 0.0f,
+        m_nStatsUpdates, m_fStatsUpdateMilliseconds,
+        m_fStatsUpdateMilliseconds > 0.0f
+            ? static_cast<float>(m_nStatsUpdates) * 1000.0f /
+                  m_fStatsUpdateMilliseconds
+            : 0.0f);
+  }
+
+  m_fStatsElapsed = 0.0f;
+  m_nStatsPatches = 0;
+  m_nStatsBulkTransforms = 0;
+  m_fStatsBulkMilliseconds = 0.0f;
+  m_nStatsUpdates = 0;
+  m_fStatsUpdateMilliseconds = 0.0f;
+  m_nStatsAdds = 0;
+  m_nStatsRemoves = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::vShutdownSystem() {
+  m_lstPendingShapes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ScenePatchSystem::DebugPrint() {
+  SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/entity/base/entityobject.h>
+#include <core/systems/base/ecsystem.h>
+#include <encodable_value.h>
+#include <filament/math/quat.h>
+#include <filament/math/vec3.h>
+#include <utils/Entity.h>
+#include <memory>
+#include <vector>
+
+namespace filament {
+class TransformManager;
+}
+
+namespace plugin_filament_view {
+
+class BaseTransform;
+class Model;
+class ModelSystem;
+class ShapeSystem;
+class TransformSystem;
+
+namespace shapes {
+class BaseShape;
+}
+
+// One batch of scene changes sent from Dart in a single message.
+struct ScenePatch {
+  // Maps with an "op" of "add" (with a "shape" or "model" map), "remove" or
+  // "update" (global_guid plus any of centerPosition, rotation, scale and
+  // parentGuid). Applied in order.
+  flutter::EncodableList lstOperations;
+
+  // Bulk transform records, kTransformStride floats each:
+  //   guid index, translation xyz, rotation xyzw, scale xyz
+  // The guid index points into lstTransformGuids, so every guid is looked
+  // up once per patch rather than once per record.
+  std::vector<EntityGUID> lstTransformGuids;
+  std::vector<float> vecTransforms;
+};
+
+// Applies ScenePatch messages after the initial scene load. Bulk transforms
+// are set inside one TransformManager transaction.
+class ScenePatchSystem : public ECSystem {
+ public:
+  static constexpr size_t kTransformStride = 11;
+
+  ScenePatchSystem() = default;
+
+  // Disallow copy and assign.
+  ScenePatchSystem(const ScenePatchSystem&) = delete;
+  ScenePatchSystem& operator=(const ScenePatchSystem&) = delete;
+
+  void vApplyPatch(const ScenePatch& patch);
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(ScenePatchSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
+  // What a guid resolved to; at most one of shape and model is set.
+  struct Target {
+    shapes::BaseShape* poShape = nullptr;
+    Model* poModel = nullptr;
+    BaseTransform* poTransform = nullptr;
+  };
+
+  // Systems a transform touches, looked up once per patch rather than once
+  // per record.
+  struct Systems {
+    std::shared_ptr<ShapeSystem> poShapeSystem;
+    std::shared_ptr<ModelSystem> poModelSystem;
+    std::shared_ptr<TransformSystem> poTransformSystem;
+    filament::TransformManager* poTransformManager = nullptr;
+  };
+
+  [[nodiscard]] static Systems oGetSystems();
+  [[nodiscard]] static Target oResolve(const Systems& systems,
+                                       const EntityGUID& guid);
+
+  // Updates the entity's transform component and its renderables. Call
+  // with a transform transaction open to batch the hierarchy update.
+  void vApplyTransform(const Systems& systems,
+                       const EntityGUID& guid,
+                       const Target& target,
+                       const filament::math::float3& translation,
+                       const filament::math::quatf& rotation,
+                       const filament::math::float3& scale);
+
+  void vApplyOperations(const flutter::EncodableList& lstOperations);
+  void vApplyBulkTransforms(const ScenePatch& patch);
+  void vApplyUpdate(const flutter::EncodableMap& params);
+  // Added together so identical shapes can still be instanced.
+  void vFlushPendingShapes();
+
+  std::vector<std::unique_ptr<shapes::BaseShape>> m_lstPendingShapes;
+  // Reused across records to avoid reallocating.
+  std::vector<utils::Entity> m_lstRootScratch;
+
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsPatches = 0;
+  size_t m_nStatsBulkTransforms = 0;
+  float m_fStatsBulkMilliseconds = 0.0f;
+  size_t m_nStatsUpdates = 0;
+  float m_fStatsUpdateMilliseconds = 0.0f;
+  size_t m_nStatsAdds = 0;
+  size_t m_nStatsRemoves = 0;
+};
+
+}  // namespace plugin_filament_view
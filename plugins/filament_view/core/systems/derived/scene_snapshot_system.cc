@@ -0,0 +1,381 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "scene_snapshot_system.h"
+
+#include <core/components/derived/basetransform.h>
+#include <core/include/file_utils.h>
+#include <core/include/literals.h>
+#include <core/scene/serialization/binary_scene.h>
+#include <core/systems/derived/indirect_light_system.h>
+#include <core/systems/derived/material_system.h>
+#include <core/systems/derived/model_system.h>
+#include <core/systems/derived/shape_system.h>
+#include <core/systems/ecsystems_manager.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <chrono>
+
+namespace plugin_filament_view {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+namespace {
+
+EncodableValue oEncodeFloat3(const filament::math::float3& value) {
+  return EncodableValue(EncodableMap{
+      {EncodableValue("x"), EncodableValue(static_cast<double>(value.x))},
+      {EncodableValue("y"), EncodableValue(static_cast<double>(value.y))},
+      {EncodableValue("z"), EncodableValue(static_cast<double>(value.z))},
+  });
+}
+
+EncodableValue oEncodeQuat(const filament::math::quatf& value) {
+  return EncodableValue(EncodableMap{
+      {EncodableValue("x"), EncodableValue(static_cast<double>(value.x))},
+      {EncodableValue("y"), EncodableValue(static_cast<double>(value.y))},
+      {EncodableValue("z"), EncodableValue(static_cast<double>(value.z))},
+      {EncodableValue("w"), EncodableValue(static_cast<double>(value.w))},
+  });
+}
+
+// FNV-1a; stable across runs, unlike std::hash.
+uint64_t nHashBytes(uint64_t nHash, const uint8_t* data, const size_t nSize) {
+  for (size_t i = 0; i < nSize; ++i) {
+    nHash ^= data[i];
+    nHash *= 1099511628211ull;
+  }
+  return nHash;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////////
+std::filesystem::path SceneSnapshotSystem::oResolvePath(
+    const std::string& szPath) {
+  const std::filesystem::path path(szPath);
+  if (path.is_absolute()) {
+    return path;
+  }
+  return getCacheDirectory() / "snapshots" / path;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int64_t SceneSnapshotSystem::nHashParams(const std::vector<uint8_t>& params) {
+  return static_cast<int64_t>(
+      nHashBytes(14695981039346656037ull, params.data(), params.size()));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+int64_t SceneSnapshotSystem::nHashFile(const int64_t nHash,
+                                       const std::filesystem::path& path) {
+  // A missing file hashes as -1 for both, still unlike any file there.
+  int64_t stat[2] = {-1, -1};
+  std::error_code error;
+  if (const auto nByteSize = std::filesystem::file_size(path, error); !error) {
+    stat[0] = static_cast<int64_t>(nByteSize);
+  }
+  if (const auto writeTime = std::filesystem::last_write_time(path, error);
+      !error) {
+    stat[1] = static_cast<int64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            writeTime.time_since_epoch())
+            .count());
+  }
+  return static_cast<int64_t>(
+      nHashBytes(static_cast<uint64_t>(nHash),
+                 reinterpret_cast<const uint8_t*>(stat), sizeof(stat)));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vSetScene(EncodableMap scene,
+                                    const std::string& szPath,
+                                    const int64_t nSourceHash,
+                                    const bool bRestored,
+                                    const bool bWaitForHdrLight) {
+  m_oScene = std::move(scene);
+  m_oPath = szPath.empty() ? std::filesystem::path() : oResolvePath(szPath);
+  m_nSourceHash = nSourceHash;
+  m_bHasScene = true;
+  m_bRestored = bRestored;
+  m_bWaitForHdrLight = bWaitForHdrLight;
+  m_bComplete = false;
+
+  const auto it = m_oScene.find(EncodableValue(kModels));
+  m_nExpectedModels = it != m_oScene.end() &&
+                              std::holds_alternative<EncodableList>(it->second)
+                          ? std::get<EncodableList>(it->second).size()
+                          : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vRecordAdd(const char* szListKey,
+                                     EncodableMap params,
+                                     const EntityGUID& guid) {
+  params[EncodableValue(kGlobalGuid)] = EncodableValue(guid);
+
+  auto& list = m_oScene[EncodableValue(szListKey)];
+  if (!std::holds_alternative<EncodableList>(list)) {
+    list = EncodableList();
+  }
+  std::get<EncodableList>(list).emplace_back(std::move(params));
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vRecordRemove(const EntityGUID& guid) {
+  const EncodableValue guidValue(guid);
+  for (const char* szListKey : {kModels, kShapes}) {
+    const auto it = m_oScene.find(EncodableValue(szListKey));
+    if (it == m_oScene.end() ||
+        !std::holds_alternative<EncodableList>(it->second)) {
+      continue;
+    }
+    auto& list = std::get<EncodableList>(it->second);
+    list.erase(
+        std::remove_if(list.begin(), list.end(),
+                       [&guidValue](const EncodableValue& entry) {
+                         const auto* params = std::get_if<EncodableMap>(&entry);
+                         if (params == nullptr) {
+                           return false;
+                         }
+                         const auto guidIt =
+                             params->find(EncodableValue(kGlobalGuid));
+                         return guidIt != params->end() &&
+                                guidIt->second == guidValue;
+                       }),
+        list.end());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+EncodableMap& SceneSnapshotSystem::oSceneEntry(const char* szKey) {
+  auto& scene = m_oScene[EncodableValue(kScene)];
+  if (!std::holds_alternative<EncodableMap>(scene)) {
+    scene = EncodableMap();
+  }
+  auto& entry = std::get<EncodableMap>(scene)[EncodableValue(szKey)];
+  if (!std::holds_alternative<EncodableMap>(entry)) {
+    entry = EncodableMap();
+  }
+  return std::get<EncodableMap>(entry);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vCaptureTransform(EncodableMap& params) {
+  const auto guidIt = params.find(EncodableValue(kGlobalGuid));
+  if (guidIt == params.end() ||
+      !std::holds_alternative<std::string>(guidIt->second)) {
+    return;
+  }
+  const auto& guid = std::get<std::string>(guidIt->second);
+
+  const auto ecsManager = ECSystemManager::GetInstance();
+  EntityObject* entityObject = nullptr;
+  if (const auto shapeSystem = ecsManager->poGetSystemAs<ShapeSystem>(
+          ShapeSystem::StaticGetTypeID(), "vCaptureTransform")) {
+    entityObject = shapeSystem->poFindShapeByGuid(guid);
+  }
+  if (entityObject == nullptr) {
+    if (const auto modelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+            ModelSystem::StaticGetTypeID(), "vCaptureTransform")) {
+      entityObject = modelSystem->poFindModelByGuid(guid);
+    }
+  }
+  if (entityObject == nullptr) {
+    // Still loading; it will be placed as its params say.
+    return;
+  }
+
+  const auto transform = std::dynamic_pointer_cast<BaseTransform>(
+      entityObject->GetComponentByStaticTypeID(
+          BaseTransform::StaticGetTypeID()));
+  if (transform == nullptr) {
+    return;
+  }
+
+  params[EncodableValue(kCenterPosition)] =
+      oEncodeFloat3(transform->GetCenterPosition());
+  params[EncodableValue(kRotation)] = oEncodeQuat(transform->GetRotation());
+  params[EncodableValue(kScale)] = oEncodeFloat3(transform->GetScale());
+  if (transform->GetParentGuid().empty()) {
+    params.erase(EncodableValue(kParentGuid));
+  } else {
+    params[EncodableValue(kParentGuid)] =
+        EncodableValue(transform->GetParentGuid());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+EncodableMap SceneSnapshotSystem::oEncodeInfo() const {
+  EncodableMap info{
+      {EncodableValue(kSnapshotVersion), EncodableValue(kFormatVersion)},
+      {EncodableValue(kSnapshotSourceHash), EncodableValue(m_nSourceHash)},
+  };
+
+  if (const auto indirectLightSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<IndirectLightSystem>(
+              IndirectLightSystem::StaticGetTypeID(), "oEncodeInfo")) {
+    if (const auto& source = indirectLightSystem->oGetHdrSource()) {
+      info[EncodableValue(kSnapshotIblPath)] = EncodableValue(source->szPath);
+      info[EncodableValue(kSnapshotIblCacheKey)] =
+          EncodableValue(source->szCacheKey);
+      info[EncodableValue(kSnapshotIblByteSize)] =
+          EncodableValue(source->nByteSize);
+      info[EncodableValue(kSnapshotIblWriteTime)] =
+          EncodableValue(source->nWriteTime);
+    }
+  }
+  return info;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool SceneSnapshotSystem::bWrite(const std::filesystem::path& path) const {
+  if (!m_bHasScene) {
+    spdlog::warn("[SceneSnapshotSystem] No scene to write yet");
+    return false;
+  }
+  const auto start = std::chrono::steady_clock::now();
+
+  auto scene = m_oScene;
+  for (const char* szListKey : {kModels, kShapes}) {
+    const auto it = scene.find(EncodableValue(szListKey));
+    if (it == scene.end() ||
+        !std::holds_alternative<EncodableList>(it->second)) {
+      continue;
+    }
+    for (auto& entry : std::get<EncodableList>(it->second)) {
+      if (auto* params = std::get_if<EncodableMap>(&entry)) {
+        vCaptureTransform(*params);
+      }
+    }
+  }
+  scene[EncodableValue(kSnapshotInfo)] = EncodableValue(oEncodeInfo());
+
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  if (!BinaryScene::bWriteFile(path.string(), EncodableValue(scene))) {
+    spdlog::error("[SceneSnapshotSystem] Unable to write {}", path.c_str());
+    return false;
+  }
+
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  spdlog::info("[SceneSnapshotSystem] Wrote {} ({} bytes) in {:.2f} ms",
+               path.c_str(), std::filesystem::file_size(path, error),
+               elapsed.count());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool SceneSnapshotSystem::bIsSceneComplete() const {
+  const auto ecsManager = ECSystemManager::GetInstance();
+
+  const auto modelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+      ModelSystem::StaticGetTypeID(), "bIsSceneComplete");
+  if (modelSystem == nullptr ||
+      modelSystem->nGetModelCount() < m_nExpectedModels ||
+      !modelSystem->bIsAsyncLoadComplete()) {
+    return false;
+  }
+
+  const auto materialSystem = ecsManager->poGetSystemAs<MaterialSystem>(
+      MaterialSystem::StaticGetTypeID(), "bIsSceneComplete");
+  if (materialSystem == nullptr || materialSystem->nGetPendingWarmUps() > 0) {
+    return false;
+  }
+
+  if (m_bWaitForHdrLight) {
+    const auto indirectLightSystem =
+        ecsManager->poGetSystemAs<IndirectLightSystem>(
+            IndirectLightSystem::StaticGetTypeID(), "bIsSceneComplete");
+    if (indirectLightSystem == nullptr ||
+        !indirectLightSystem->oGetHdrSource().has_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vInitSystem() {
+  vRegisterMessageHandler(
+      ECSMessageType::SaveSceneSnapshot, [this](const ECSMessage& msg) {
+        const auto szPath =
+            msg.getData<std::string>(ECSMessageType::SaveSceneSnapshot);
+        if (!bIsRecording()) {
+          spdlog::warn(
+              "[SceneSnapshotSystem] The scene is only recorded with a {} "
+              "creation param",
+              kSceneSnapshot);
+        } else if (!szPath.empty()) {
+          bWrite(oResolvePath(szPath));
+        } else {
+          bWrite(m_oPath);
+        }
+      });
+
+  vRegisterMessageHandler(
+      ECSMessageType::ChangeSceneLightProperties,
+      [this](const ECSMessage& msg) {
+        auto& light = oSceneEntry(kLight);
+        light[EncodableValue(kLightColor)] =
+            EncodableValue(msg.getData<std::string>(
+                ECSMessageType::ChangeSceneLightPropertiesColorValue));
+        light[EncodableValue(kLightIntensity)] =
+            EncodableValue(static_cast<double>(msg.getData<float>(
+                ECSMessageType::ChangeSceneLightPropertiesIntensity)));
+      });
+
+  vRegisterMessageHandler(
+      ECSMessageType::ChangeSceneIndirectLightProperties,
+      [this](const ECSMessage& msg) {
+        oSceneEntry(kIndirectLight)[EncodableValue(kLightIntensity)] =
+            EncodableValue(static_cast<double>(msg.getData<float>(
+                ECSMessageType::ChangeSceneIndirectLightPropertiesIntensity)));
+      });
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vUpdate(float /*fElapsedTime*/) {
+  if (!m_bHasScene || m_bComplete || !bIsSceneComplete()) {
+    return;
+  }
+  m_bComplete = true;
+
+  // Startup time to a scene with every model, material and light in place,
+  // to compare a cold load against a restore.
+  ECSystemManager::GetInstance()->vLogStartupPhase(
+      m_bRestored ? "Scene complete (restored from snapshot)"
+                  : "Scene complete (cold)");
+
+  if (!m_bRestored && !m_oPath.empty()) {
+    bWrite(m_oPath);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::vShutdownSystem() {
+  m_oScene.clear();
+  m_bHasScene = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void SceneSnapshotSystem::DebugPrint() {
+  spdlog::debug("{}::{}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/entity/base/entityobject.h>
+#include <core/systems/base/ecsystem.h>
+#include <encodable_value.h>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Keeps the scene as it stands, in creation params form, so it can be
+// written as a BinaryScene and restored by SceneTextDeserializer on the
+// next launch without rebuilding it from the app's params.
+//
+// The deserializer hands over the scene it loaded, every entity with its
+// guid filled in; patches and light changes keep it current, and
+// transforms are read back from the entities when writing. The snapshot
+// also carries kSnapshotInfo: the hash of the creation params it was taken
+// from, so a changed scene isn't restored from a stale snapshot, and the
+// cache keys of processed assets.
+//
+// After a cold load with a sceneSnapshot path, the snapshot is written as
+// soon as the scene is complete.
+class SceneSnapshotSystem : public ECSystem {
+ public:
+  static constexpr int32_t kFormatVersion = 1;
+
+  SceneSnapshotSystem() = default;
+
+  // Disallow copy and assign.
+  SceneSnapshotSystem(const SceneSnapshotSystem&) = delete;
+  SceneSnapshotSystem& operator=(const SceneSnapshotSystem&) = delete;
+
+  // Relative paths are in the user cache directory.
+  static std::filesystem::path oResolvePath(const std::string& szPath);
+  // Identifies the creation params a snapshot was taken from.
+  static int64_t nHashParams(const std::vector<uint8_t>& params);
+  // Folds the size and write time of a file the params read into nHash, so
+  // the snapshot goes stale when the file changes.
+  static int64_t nHashFile(int64_t nHash, const std::filesystem::path& path);
+
+  // szPath is the sceneSnapshot param, empty without one. bWaitForHdrLight
+  // makes the HDR indirect light part of a complete scene.
+  void vSetScene(flutter::EncodableMap scene,
+                 const std::string& szPath,
+                 int64_t nSourceHash,
+                 bool bRestored,
+                 bool bWaitForHdrLight);
+
+  // Whether the scene had a sceneSnapshot param; nothing is recorded or
+  // written without one.
+  [[nodiscard]] bool bIsRecording() const { return !m_oPath.empty(); }
+
+  // szListKey is kModels or kShapes.
+  void vRecordAdd(const char* szListKey,
+                  flutter::EncodableMap params,
+                  const EntityGUID& guid);
+  void vRecordRemove(const EntityGUID& guid);
+
+  bool bWrite(const std::filesystem::path& path) const;
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(SceneSnapshotSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  [[nodiscard]] bool bIsSceneComplete() const;
+  // Overwrites the transform fields of one models / shapes entry with the
+  // entity's current transform.
+  static void vCaptureTransform(flutter::EncodableMap& params);
+  [[nodiscard]] flutter::EncodableMap oEncodeInfo() const;
+  flutter::EncodableMap& oSceneEntry(const char* szKey);
+
+  flutter::EncodableMap m_oScene;
+  // Empty without a sceneSnapshot param.
+  std::filesystem::path m_oPath;
+  int64_t m_nSourceHash = 0;
+  bool m_bHasScene = false;
+  bool m_bRestored = false;
+  bool m_bWaitForHdrLight = false;
+  size_t m_nExpectedModels = 0;
+  bool m_bComplete = false;
+};
+
+}  // namespace plugin_filament_view
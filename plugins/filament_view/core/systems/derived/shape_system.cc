@@ -15,20 +15,37 @@
  */
 
 #include "shape_system.h"
+#include "collision_system.h"
 #include "filament_system.h"
+#include "lod_system.h"
+#include "transform_system.h"
 
+#include <core/components/derived/collidable.h>
+#include <core/components/derived/commonrenderable.h>
 #include <core/entity/derived/shapes/baseshape.h>
 #include <core/entity/derived/shapes/cube.h>
 #include <core/entity/derived/shapes/plane.h>
+#include <core/entity/derived/shapes/shape_geometry_cache.h>
 #include <core/entity/derived/shapes/sphere.h>
+#include <core/scene/material/material_definitions.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/ecsystems_manager.h>
+#include <filament/Box.h>
 #include <filament/Engine.h>
+#include <filament/RenderableManager.h>
 #include <filament/Scene.h>
 #include <plugins/common/common.h>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <sstream>
 
 namespace plugin_filament_view {
 
+using filament::math::float3;
+using filament::math::mat4f;
 using shapes::BaseShape;
+using shapes::ShapeGeometryCache;
 using utils::Entity;
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -42,11 +59,360 @@ void ShapeSystem::vToggleAllShapesInScene(const bool bValue) const {
       shape->vRemoveEntityFromScene();
     }
   }
+
+  if (m_lstInstanceBatches.empty()) {
+    return;
+  }
+
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vToggleAllShapesInScene");
+  auto* scene = filamentSystem->getFilamentScene();
+  for (const auto& batch : m_lstInstanceBatches) {
+    if (bValue) {
+      scene->addEntity(batch.oEntity);
+    } else {
+      scene->remove(batch.oEntity);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+std::string ShapeSystem::szInstanceGroupKey(const BaseShape& shape) {
+  const auto geometryKey = shape.oGetGeometryKey();
+  const auto renderable = std::dynamic_pointer_cast<CommonRenderable>(
+      shape.GetComponentByStaticTypeID(CommonRenderable::StaticGetTypeID()));
+
+  std::ostringstream key;
+  key << static_cast<int>(geometryKey.eType) << ':'
+      << geometryKey.bDoubleSided << ':' << geometryKey.nStacks << ':'
+      << geometryKey.nSlices << ':';
+  if (renderable != nullptr) {
+    key << renderable->IsCullingOfObjectEnabled()
+        << renderable->IsReceiveShadowsEnabled()
+        << renderable->IsCastShadowsEnabled();
+  }
+  key << '|' << shape.poGetMaterialDefinitions()->szGetInstanceKey();
+  return key.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool ShapeSystem::bBuildInstanceBatch(
+    filament::Engine* engine,
+    const std::string& szGroupKey,
+    const std::vector<BaseShape*>& lstShapes) {
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "bBuildInstanceBatch");
+  if (materialSystem == nullptr) {
+    return false;
+  }
+
+  const auto* first = lstShapes.front();
+  auto materialInstance =
+      materialSystem->getMaterialInstance(first->poGetMaterialDefinitions());
+  if (materialInstance.getStatus() != Status::Success) {
+    return false;
+  }
+
+  const auto* geometry = first->poAcquireGeometry(engine);
+  if (geometry == nullptr) {
+    materialSystem->vReleaseMaterialInstance(
+        materialInstance.getData().value());
+    return false;
+  }
+
+  std::vector<mat4f> transforms;
+  transforms.reserve(lstShapes.size());
+  for (const auto* shape : lstShapes) {
+    transforms.emplace_back(shape->oGetLocalTransform());
+  }
+
+  InstanceBatch batch;
+  batch.szGroupKey = szGroupKey;
+  batch.oGeometryKey = first->oGetGeometryKey();
+  batch.oGeometryBounds = geometry->oBounds;
+  batch.nInstanceCount = lstShapes.size();
+  batch.nLiveCount = lstShapes.size();
+  batch.lstTransforms = std::move(transforms);
+  batch.lstLiveSlots.assign(lstShapes.size(), true);
+  batch.poMaterialInstance = materialInstance.getData().value();
+  batch.poInstanceBuffer = filament::InstanceBuffer::Builder(lstShapes.size())
+                               .localTransforms(batch.lstTransforms.data())
+                               .build(*engine);
+  batch.oEntity = engine->getEntityManager().create();
+
+  const auto renderable = std::dynamic_pointer_cast<CommonRenderable>(
+      first->GetComponentByStaticTypeID(CommonRenderable::StaticGetTypeID()));
+  filament::RenderableManager::Builder(1)
+      .boundingBox(oGetInstanceBatchBounds(batch))
+      .material(0, batch.poMaterialInstance)
+      .geometry(0, filament::RenderableManager::PrimitiveType::TRIANGLES,
+                geometry->poVertexBuffer, geometry->poIndexBuffer)
+      .instances(lstShapes.size(), batch.poInstanceBuffer)
+      .culling(renderable == nullptr || renderable->IsCullingOfObjectEnabled())
+      .receiveShadows(renderable != nullptr &&
+                      renderable->IsReceiveShadowsEnabled())
+      .castShadows(renderable != nullptr && renderable->IsCastShadowsEnabled())
+      .build(*engine, batch.oEntity);
+
+  for (size_t i = 0; i < lstShapes.size(); ++i) {
+    lstShapes[i]->vSetInstanced();
+    m_mapInstanceSlots[lstShapes[i]] = {m_lstInstanceBatches.size(), i};
+  }
+  m_lstInstanceBatches.emplace_back(std::move(batch));
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+filament::Box ShapeSystem::oGetInstanceBatchBounds(
+    const InstanceBatch& batch) {
+  float3 min(std::numeric_limits<float>::max());
+  float3 max(std::numeric_limits<float>::lowest());
+  bool bAny = false;
+  for (size_t i = 0; i < batch.lstTransforms.size(); ++i) {
+    if (!batch.lstLiveSlots[i]) {
+      continue;
+    }
+    const auto bounds = batch.oGeometryBounds.transform(batch.lstTransforms[i]);
+    min = filament::math::min(min, bounds.min);
+    max = filament::math::max(max, bounds.max);
+    bAny = true;
+  }
+  return bAny ? filament::Box().set(min, max) : filament::Box();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+size_t ShapeSystem::nFillFreeSlots(const std::string& szGroupKey,
+                                   std::vector<BaseShape*>& lstShapes) {
+  size_t nPlaced = 0;
+  for (size_t nBatch = 0;
+       nBatch < m_lstInstanceBatches.size() && !lstShapes.empty(); ++nBatch) {
+    auto& batch = m_lstInstanceBatches[nBatch];
+    if (batch.szGroupKey != szGroupKey ||
+        batch.nLiveCount == batch.nInstanceCount) {
+      continue;
+    }
+
+    for (size_t nSlot = 0; nSlot < batch.nInstanceCount && !lstShapes.empty();
+         ++nSlot) {
+      if (batch.lstLiveSlots[nSlot]) {
+        continue;
+      }
+      auto* shape = lstShapes.back();
+      lstShapes.pop_back();
+
+      shape->vSetInstanced();
+      batch.lstTransforms[nSlot] = shape->oGetLocalTransform();
+      batch.lstLiveSlots[nSlot] = true;
+      batch.bTransformsDirty = true;
+      ++batch.nLiveCount;
+      m_mapInstanceSlots[shape] = {nBatch, nSlot};
+      ++nPlaced;
+    }
+  }
+  return nPlaced;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vReleaseInstanceBatch(const InstanceBatch& batch) {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vReleaseInstanceBatch");
+  const auto engine = filamentSystem->getFilamentEngine();
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "vReleaseInstanceBatch");
+
+  filamentSystem->getFilamentScene()->remove(batch.oEntity);
+  engine->destroy(batch.oEntity);
+  engine->getEntityManager().destroy(batch.oEntity);
+  engine->destroy(batch.poInstanceBuffer);
+  ShapeGeometryCache::vRelease(engine, batch.oGeometryKey);
+  if (materialSystem != nullptr) {
+    materialSystem->vReleaseMaterialInstance(batch.poMaterialInstance);
+  } else {
+    engine->destroy(batch.poMaterialInstance);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vDestroyInstanceBatch(const size_t nBatch) {
+  vReleaseInstanceBatch(m_lstInstanceBatches[nBatch]);
+
+  const size_t nLast = m_lstInstanceBatches.size() - 1;
+  if (nBatch != nLast) {
+    m_lstInstanceBatches[nBatch] = std::move(m_lstInstanceBatches[nLast]);
+    for (auto& [poShape, slot] : m_mapInstanceSlots) {
+      if (slot.first == nLast) {
+        slot.first = nBatch;
+      }
+    }
+  }
+  m_lstInstanceBatches.pop_back();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vDestroyInstanceBatches() {
+  for (const auto& batch : m_lstInstanceBatches) {
+    vReleaseInstanceBatch(batch);
+  }
+  m_lstInstanceBatches.clear();
+  m_mapInstanceSlots.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+BaseShape* ShapeSystem::poFindShapeByGuid(const EntityGUID& guid) const {
+  const auto iter = m_mapShapesByGuid.find(guid);
+  return iter == m_mapShapesByGuid.end() ? nullptr : iter->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+const BaseShape* ShapeSystem::poFindShapeByRenderable(
+    const Entity& entity,
+    const float3& hitPosition) const {
+  for (const auto& shape : shapes_) {
+    if (!shape->bIsInstanced() && shape->poGetEntity() != nullptr &&
+        *shape->poGetEntity() == entity) {
+      return shape.get();
+    }
+  }
+
+  const auto batch = std::find_if(
+      m_lstInstanceBatches.begin(), m_lstInstanceBatches.end(),
+      [&entity](const InstanceBatch& b) { return b.oEntity == entity; });
+  if (batch == m_lstInstanceBatches.end()) {
+    return nullptr;
+  }
+  const auto nBatch =
+      static_cast<size_t>(std::distance(m_lstInstanceBatches.begin(), batch));
+
+  const BaseShape* poNearest = nullptr;
+  float fNearest = std::numeric_limits<float>::max();
+  for (const auto& [poShape, slot] : m_mapInstanceSlots) {
+    if (slot.first != nBatch) {
+      continue;
+    }
+    const auto& transform = batch->lstTransforms[slot.second];
+    const auto fDistance = length2(transform[3].xyz - hitPosition);
+    if (fDistance < fNearest) {
+      fNearest = fDistance;
+      poNearest = poShape;
+    }
+  }
+  return poNearest;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vSetInstanceTransform(const BaseShape* poShape,
+                                        const mat4f& transform) {
+  const auto iter = m_mapInstanceSlots.find(poShape);
+  if (iter == m_mapInstanceSlots.end()) {
+    return;
+  }
+  auto& batch = m_lstInstanceBatches[iter->second.first];
+  batch.lstTransforms[iter->second.second] = transform;
+  batch.bTransformsDirty = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vUploadInstanceTransforms() {
+  filament::Engine* engine = nullptr;
+
+  for (auto& batch : m_lstInstanceBatches) {
+    if (!batch.bTransformsDirty) {
+      continue;
+    }
+    batch.bTransformsDirty = false;
+
+    if (engine == nullptr) {
+      engine = ECSystemManager::GetInstance()
+                   ->poGetSystemAs<FilamentSystem>(
+                       FilamentSystem::StaticGetTypeID(),
+                       "vUploadInstanceTransforms")
+                   ->getFilamentEngine();
+    }
+
+    batch.poInstanceBuffer->setLocalTransforms(
+        batch.lstTransforms.data(), batch.lstTransforms.size(), 0);
+    auto& rcm = engine->getRenderableManager();
+    rcm.setAxisAlignedBoundingBox(rcm.getInstance(batch.oEntity),
+                                  oGetInstanceBatchBounds(batch));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool ShapeSystem::bRemoveShape(const EntityGUID& guid) {
+  const auto iter =
+      std::find_if(shapes_.begin(), shapes_.end(), [&guid](const auto& shape) {
+        return shape->GetGlobalGuid() == guid;
+      });
+  if (iter == shapes_.end()) {
+    return false;
+  }
+  BaseShape* shape = iter->get();
+
+  if (const auto transformSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<TransformSystem>(
+              TransformSystem::StaticGetTypeID(), "bRemoveShape")) {
+    transformSystem->vRemoveNode(guid);
+  }
+  if (const auto lodSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<LodSystem>(
+              LodSystem::StaticGetTypeID(), "bRemoveShape")) {
+    lodSystem->vUnregister(guid);
+  }
+  if (shape->HasComponentByStaticTypeID(Collidable::StaticGetTypeID())) {
+    if (const auto collisionSystem =
+            ECSystemManager::GetInstance()->poGetSystemAs<CollisionSystem>(
+                CollisionSystem::StaticGetTypeID(), "bRemoveShape")) {
+      collisionSystem->vRemoveCollidable(shape);
+    }
+  }
+
+  if (shape->bIsInstanced()) {
+    // A zero scale collapses the slot to a point, it draws nothing.
+    vSetInstanceTransform(shape, mat4f::scaling(float3(0.0f)));
+    if (const auto slot = m_mapInstanceSlots.find(shape);
+        slot != m_mapInstanceSlots.end()) {
+      const auto [nBatch, nSlot] = slot->second;
+      m_mapInstanceSlots.erase(slot);
+      auto& batch = m_lstInstanceBatches[nBatch];
+      batch.lstLiveSlots[nSlot] = false;
+      if (--batch.nLiveCount == 0) {
+        vDestroyInstanceBatch(nBatch);
+      }
+    }
+  } else if (const auto& entity = shape->poGetEntity(); entity != nullptr) {
+    shape->vRemoveEntityFromScene();
+    const auto engine =
+        ECSystemManager::GetInstance()
+            ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                            "bRemoveShape")
+            ->getFilamentEngine();
+    engine->destroy(*entity);
+    engine->getEntityManager().destroy(*entity);
+  }
+
+  m_mapShapesByGuid.erase(guid);
+  shapes_.erase(iter);
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
 void ShapeSystem::vRemoveAllShapesInScene() {
   vToggleAllShapesInScene(false);
+
+  if (const auto lodSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<LodSystem>(
+              LodSystem::StaticGetTypeID(), "vRemoveAllShapesInScene")) {
+    for (const auto& shape : shapes_) {
+      lodSystem->vUnregister(shape->GetGlobalGuid());
+    }
+  }
+
+  vDestroyInstanceBatches();
+  m_mapShapesByGuid.clear();
   shapes_.clear();
 }
 
@@ -88,6 +454,29 @@ std::unique_ptr<BaseShape> ShapeSystem::poDeserializeShapeFromData(
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+std::unique_ptr<BaseShape> ShapeSystem::poDeserializeShapeFromData(
+    const std::string& flutter_assets_path,
+    const BinaryScene::View& data) {
+  const auto typeValue = data.oFind("shapeType");
+  if (typeValue.eGetType() != BinaryScene::Type::Int32) {
+    spdlog::error("shapeType not found or is of incorrect type");
+    return nullptr;
+  }
+
+  switch (const auto type = static_cast<ShapeType>(*typeValue.onGetInt())) {
+    case ShapeType::Plane:
+      return std::make_unique<shapes::Plane>(flutter_assets_path, data);
+    case ShapeType::Cube:
+      return std::make_unique<shapes::Cube>(flutter_assets_path, data);
+    case ShapeType::Sphere:
+      return std::make_unique<shapes::Sphere>(flutter_assets_path, data);
+    default:
+      spdlog::error("Invalid shape type value: {}", static_cast<int32_t>(type));
+      return nullptr;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void ShapeSystem::addShapesToScene(
     std::vector<std::unique_ptr<BaseShape>>* shapes) {
@@ -106,17 +495,81 @@ void ShapeSystem::addShapesToScene(
   filament::Engine* poFilamentEngine = engine;
   filament::Scene* poFilamentScene = filamentSystem->getFilamentScene();
   utils::EntityManager& oEntitymanager = poFilamentEngine->getEntityManager();
+  const auto lodSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<LodSystem>(
+          LodSystem::StaticGetTypeID(), "addShapesToScene");
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "addShapesToScene");
   // Ideally this is changed to create all entities on the first go, then
   // we pass them through, upon use this failed in filament engine, more R&D
   // needed
   // oEntitymanager.create(shapes.size(), lstEntities);
 
+  // Large groups of identical shapes are drawn instanced, a renderable per
+  // batch instead of per shape.
+  std::map<std::string, std::vector<BaseShape*>> mapInstanceGroups;
+  for (const auto& shape : *shapes) {
+    if (shape != nullptr && shape->bCanBeInstanced()) {
+      mapInstanceGroups[szInstanceGroupKey(*shape)].push_back(shape.get());
+    }
+  }
+
+  // Slots freed by removed shapes are taken first, so adding and removing
+  // shapes over a session doesn't keep growing the batch count.
+  size_t nReusedSlots = 0;
+  const size_t nFirstNewBatch = m_lstInstanceBatches.size();
+  for (auto& [key, group] : mapInstanceGroups) {
+    nReusedSlots += nFillFreeSlots(key, group);
+    if (group.size() < kMinInstanceBatchSize) {
+      continue;
+    }
+    for (size_t i = 0; i < group.size(); i += kMaxInstancesPerBatch) {
+      const size_t nEnd = std::min(group.size(), i + kMaxInstancesPerBatch);
+      bBuildInstanceBatch(
+          poFilamentEngine, key,
+          {group.begin() + static_cast<std::ptrdiff_t>(i),
+           group.begin() + static_cast<std::ptrdiff_t>(nEnd)});
+    }
+  }
+
+  const bool bHoldBack =
+      materialSystem != nullptr && materialSystem->bIsHoldingEntities();
+  for (size_t i = nFirstNewBatch; i < m_lstInstanceBatches.size(); ++i) {
+    if (bHoldBack) {
+      m_bShapesHeldBack = true;
+    } else {
+      poFilamentScene->addEntity(m_lstInstanceBatches[i].oEntity);
+    }
+  }
+
+  size_t nInstancedShapes = 0;
+  std::vector<EntityGUID> lstAddedGuids;
+  lstAddedGuids.reserve(shapes->size());
   for (auto& shape : *shapes) {
+    m_mapShapesByGuid[shape->GetGlobalGuid()] = shape.get();
+    lstAddedGuids.push_back(shape->GetGlobalGuid());
+    if (shape->bIsInstanced()) {
+      ++nInstancedShapes;
+      shapes_.emplace_back(shape.release());
+      continue;
+    }
+
     auto oEntity = std::make_shared<Entity>(oEntitymanager.create());
 
     shape->bInitAndCreateShape(poFilamentEngine, oEntity);
 
-    poFilamentScene->addEntity(*oEntity);
+    // Checked per shape, building the first one queues the material warm-up.
+    if (materialSystem != nullptr && materialSystem->bIsHoldingEntities()) {
+      m_bShapesHeldBack = true;
+    } else {
+      poFilamentScene->addEntity(*oEntity);
+    }
+
+    if (lodSystem != nullptr && !shape->GetLodLevels().empty()) {
+      lodSystem->vRegisterShape(shape.get(), shape->GetLodLevels(),
+                                shape->fGetLodHysteresis());
+    }
 
     // To investigate a better system for implementing layer mask
     // across dart to here.
@@ -128,6 +581,22 @@ void ShapeSystem::addShapesToScene(
     shapes_.emplace_back(shape.release());
   }
 
+  // Linked once the whole batch exists, parents may be part of it.
+  if (const auto transformSystem =
+          ECSystemManager::GetInstance()->poGetSystemAs<TransformSystem>(
+              TransformSystem::StaticGetTypeID(), "addShapesToScene")) {
+    transformSystem->vAddNodes(lstAddedGuids);
+  }
+
+  spdlog::debug(
+      "ShapeSystem: {} shapes, {} drawn in {} new instanced batches and {} "
+      "reused slots, {} with own renderables; {} shared geometries, {:.1f} "
+      "KB vertex/index buffers",
+      shapes_.size(), nInstancedShapes,
+      m_lstInstanceBatches.size() - nFirstNewBatch, nReusedSlots,
+      shapes->size() - nInstancedShapes, ShapeGeometryCache::nGetEntryCount(),
+      static_cast<float>(ShapeGeometryCache::nGetBufferBytes()) / 1024.0f);
+
   SPDLOG_TRACE("--{} {}", __FILE__, __FUNCTION__);
 }
 
@@ -140,6 +609,7 @@ void ShapeSystem::vInitSystem() {
         const auto value =
             msg.getData<bool>(ECSMessageType::ToggleShapesInScene);
 
+        m_bShapesHeldBack = false;
         vToggleAllShapesInScene(value);
 
         spdlog::debug("ToggleShapesInScene Complete");
@@ -147,7 +617,23 @@ void ShapeSystem::vInitSystem() {
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-void ShapeSystem::vUpdate(float /*fElapsedTime*/) {}
+void ShapeSystem::vUpdate(float /*fElapsedTime*/) {
+  vUploadInstanceTransforms();
+
+  if (!m_bShapesHeldBack) {
+    return;
+  }
+
+  const auto materialSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<MaterialSystem>(
+          MaterialSystem::StaticGetTypeID(), "ShapeSystem::vUpdate");
+  if (materialSystem != nullptr && materialSystem->bIsHoldingEntities()) {
+    return;
+  }
+
+  m_bShapesHeldBack = false;
+  vToggleAllShapesInScene(true);
+}
 
 ////////////////////////////////////////////////////////////////////////////////////
 void ShapeSystem::vShutdownSystem() {
@@ -159,4 +645,49 @@ void ShapeSystem::vShutdownSystem() {
 void ShapeSystem::DebugPrint() {
   SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
 }
+
+////////////////////////////////////////////////////////////////////////////////////
+void ShapeSystem::vAccountResources(ResourceReport& report) const {
+  // Geometry is shared between shapes, so it's owned by its cache entry.
+  shapes::ShapeGeometryCache::vForEach(
+      [&](const shapes::ShapeGeometryKey& key,
+          const shapes::ShapeGeometry& geometry) {
+        const size_t nCpuBytes =
+            geometry.vecPositions.capacity() *
+                sizeof(filament::math::float3) +
+            geometry.vecNormals.capacity() * sizeof(filament::math::float3) +
+            geometry.vecUVs.capacity() * sizeof(filament::math::float2) +
+            geometry.vecIndices.capacity() * sizeof(unsigned short);
+        report.vAdd("ShapeSystem",
+                    "geometry type " +
+                        std::to_string(static_cast<int>(key.eType)) + " " +
+                        std::to_string(key.nStacks) + "x" +
+                        std::to_string(key.nSlices) + " (" +
+                        std::to_string(geometry.nReferences) + " shapes)",
+                    "vertex/index buffers", geometry.nBufferBytes, nCpuBytes);
+      });
+
+  for (size_t i = 0; i < m_lstInstanceBatches.size(); ++i) {
+    const auto& batch = m_lstInstanceBatches[i];
+    report.vAdd("ShapeSystem",
+                "instance batch " + std::to_string(i) + " (" +
+                    std::to_string(batch.nInstanceCount) + " shapes)",
+                "instance buffer",
+                batch.nInstanceCount * sizeof(filament::math::mat4f),
+                batch.lstTransforms.capacity() *
+                    sizeof(filament::math::mat4f));
+  }
+
+  // Reduced lod levels are built per shape, not shared with the geometry.
+  for (const auto& shape : shapes_) {
+    const size_t nLodBytes = shape->nGetLodIndexBufferBytes();
+    if (nLodBytes == 0) {
+      continue;
+    }
+    report.vAdd("ShapeSystem", shape->GetGlobalGuid(), "lod index buffers",
+                nLodBytes, shape->GetLodLevels().capacity() *
+                               sizeof(LodSystem::LodLevel));
+  }
+}
+
 }  // namespace plugin_filament_view
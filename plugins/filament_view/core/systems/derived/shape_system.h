@@ -21,7 +21,10 @@
 #include <core/entity/derived/shapes/baseshape.h>
 #include <core/systems/base/ecsystem.h>
 #include <core/systems/derived/material_system.h>
+#include <filament/InstanceBuffer.h>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -45,12 +48,35 @@ class ShapeSystem : public ECSystem {
 
   void vRemoveAllShapesInScene();
 
+  [[nodiscard]] shapes::BaseShape* poFindShapeByGuid(
+      const EntityGUID& guid) const;
+
+  // The shape drawn by a renderable entity, for picking. An instance batch
+  // is a single renderable, so of its shapes the one whose origin is
+  // nearest to hitPosition is taken.
+  [[nodiscard]] const shapes::BaseShape* poFindShapeByRenderable(
+      const utils::Entity& entity,
+      const filament::math::float3& hitPosition) const;
+
+  // Takes the shape out of the scene and destroys it. Instanced shapes
+  // leave a collapsed slot in their batch for the next matching shape
+  // added; a batch is destroyed once its last shape is removed.
+  bool bRemoveShape(const EntityGUID& guid);
+
+  // Moves an instanced shape within its batch; the instance buffer is
+  // uploaded once per frame for all shapes moved in it.
+  void vSetInstanceTransform(const shapes::BaseShape* poShape,
+                             const filament::math::mat4f& transform);
+
   // Creates the derived class of BaseShape based on the map data sent in, does
   // not add it to any list only returns the shape for you, Also does not build
   // the data out, only stores it for building when ready.
   static std::unique_ptr<shapes::BaseShape> poDeserializeShapeFromData(
       const std::string& flutter_assets_path,
       const flutter::EncodableMap& mapData);
+  static std::unique_ptr<shapes::BaseShape> poDeserializeShapeFromData(
+      const std::string& flutter_assets_path,
+      const BinaryScene::View& data);
 
   [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
 
@@ -63,7 +89,64 @@ class ShapeSystem : public ECSystem {
   void vShutdownSystem() override;
   void DebugPrint() override;
 
+  void vAccountResources(ResourceReport& report) const override;
+
  private:
+  // Smaller groups of identical shapes keep one renderable per shape.
+  static constexpr size_t kMinInstanceBatchSize = 16;
+  // Filament's per renderable instance limit (CONFIG_MAX_INSTANCES).
+  static constexpr size_t kMaxInstancesPerBatch = 64;
+
+  // One instanced renderable drawing shapes that share geometry, material
+  // and render flags. The shapes themselves stay in shapes_.
+  struct InstanceBatch {
+    utils::Entity oEntity;
+    filament::InstanceBuffer* poInstanceBuffer = nullptr;
+    filament::MaterialInstance* poMaterialInstance = nullptr;
+    // szInstanceGroupKey of its shapes.
+    std::string szGroupKey;
+    shapes::ShapeGeometryKey oGeometryKey;
+    // Object-space bounds of the shared geometry.
+    filament::Aabb oGeometryBounds;
+    size_t nInstanceCount = 0;
+    size_t nLiveCount = 0;
+    // Per slot, kept to upload and re-bound the batch after moves.
+    std::vector<filament::math::mat4f> lstTransforms;
+    // Cleared for slots whose shape was removed.
+    std::vector<bool> lstLiveSlots;
+    bool bTransformsDirty = false;
+  };
+
   std::list<std::unique_ptr<shapes::BaseShape>> shapes_;
+  std::map<EntityGUID, shapes::BaseShape*> m_mapShapesByGuid;
+  std::vector<InstanceBatch> m_lstInstanceBatches;
+  // Batch index and slot of every instanced shape.
+  std::map<const shapes::BaseShape*, std::pair<size_t, size_t>>
+      m_mapInstanceSlots;
+
+  // Union of the live slots' bounds, empty if there are none.
+  static filament::Box oGetInstanceBatchBounds(const InstanceBatch& batch);
+
+  // Shapes with equal keys can be drawn by the same batch.
+  static std::string szInstanceGroupKey(const shapes::BaseShape& shape);
+
+  // Marks the shapes instanced on success.
+  bool bBuildInstanceBatch(filament::Engine* engine,
+                           const std::string& szGroupKey,
+                           const std::vector<shapes::BaseShape*>& lstShapes);
+  // Places shapes from the back of lstShapes into the free slots of
+  // existing batches with the same group key, removing the ones placed.
+  // Returns how many were placed.
+  size_t nFillFreeSlots(const std::string& szGroupKey,
+                        std::vector<shapes::BaseShape*>& lstShapes);
+  static void vReleaseInstanceBatch(const InstanceBatch& batch);
+  // Releases the batch and moves the last one into its index.
+  void vDestroyInstanceBatch(size_t nBatch);
+  void vDestroyInstanceBatches();
+  void vUploadInstanceTransforms();
+
+  // Set when shapes were built while their materials were still warming up;
+  // they're added to the scene once MaterialSystem stops holding them back.
+  bool m_bShapesHeldBack = false;
 };
 }  // namespace plugin_filament_view
\ No newline at end of file
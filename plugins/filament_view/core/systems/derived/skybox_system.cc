@@ -21,10 +21,15 @@
 #include <sstream>
 
 #include <core/include/color.h>
+#include <core/include/file_utils.h>
 #include <core/include/literals.h>
+#include <core/scene/material/loader/texture_loader.h>
 #include <core/systems/derived/filament_system.h>
+#include <core/systems/derived/indirect_light_system.h>
+#include <core/systems/base/resource_report.h>
 #include <core/systems/ecsystems_manager.h>
 #include <core/utils/hdr_loader.h>
+#include <core/utils/ibl_cache.h>
 #include <filament/IndirectLight.h>
 #include <filament/Scene.h>
 #include <filament/Skybox.h>
@@ -170,6 +175,7 @@ std::future<Resource<std::string_view>> SkyboxSystem::setSkyboxFromKTXAsset(
   if (path.empty() || !exists(asset_path)) {
     promise->set_value(
         Resource<std::string_view>::Error("KTX Asset path is not valid"));
+    return future;
   }
   const asio::io_context::strand& strand_(
       *ECSystemManager::GetInstance()->GetStrand());
@@ -179,13 +185,7 @@ std::future<Resource<std::string_view>> SkyboxSystem::setSkyboxFromKTXAsset(
     std::ifstream stream(asset_path, std::ios::in | std::ios::binary);
     std::vector<uint8_t> buffer((std::istreambuf_iterator(stream)),
                                 std::istreambuf_iterator<char>());
-    if (!buffer.empty()) {
-#if 0  // TODO
-                auto skybox = KTX1Loader.createSkybox(*engine, buffer);
-                modelViewer_->destroySkybox();
-                modelViewer_->getFilamentScene()->setSkybox(skybox);
-                modelViewer_->setSkyboxState(SceneState::LOADED);
-#endif
+    if (bApplyKtxSkybox(buffer)) {
       std::stringstream ss;
       ss << "Loaded environment successfully from " << asset_path;
       promise->set_value(Resource<std::string_view>::Success(ss.str()));
@@ -216,21 +216,16 @@ std::future<Resource<std::string_view>> SkyboxSystem::setSkyboxFromKTXUrl(
   post(strand_, [&, promise, url] {
     plugin_common_curl::CurlClient client;
 
-    // TODO client.Init(url, {}, {});
-    auto buffer = client.RetrieveContentAsVector();
+    client.Init(url, {}, {});
+    const auto buffer = client.RetrieveContentAsVector();
     if (client.GetCode() != CURLE_OK) {
       std::stringstream ss;
       ss << "Couldn't load skybox from " << url;
       promise->set_value(Resource<std::string_view>::Error(ss.str()));
+      return;
     }
 
-    if (!buffer.empty()) {
-#if 0  // TODO
-                auto skybox = KTX1Loader.createSkybox(*engine, buffer);
-                modelViewer_->destroySkybox();
-                modelViewer_->getFilamentScene()->setSkybox(skybox);
-                modelViewer_->setSkyboxState(SceneState::LOADED);
-#endif
+    if (bApplyKtxSkybox(buffer)) {
       std::stringstream ss;
       ss << "Loaded skybox successfully from " << url;
       promise->set_value(Resource<std::string_view>::Success(ss.str()));
@@ -278,62 +273,59 @@ std::future<Resource<std::string_view>> SkyboxSystem::setSkyboxFromColor(
   return future;
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+bool SkyboxSystem::bApplyKtxSkybox(const std::vector<uint8_t>& buffer) {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "bApplyKtxSkybox");
+  const auto engine = filamentSystem->getFilamentEngine();
+
+  const auto cubemap = IblCache::poCreateCubemapFromKtx(engine, buffer);
+  if (cubemap == nullptr) {
+    return false;
+  }
+
+  const auto sky =
+      filament::Skybox::Builder().environment(cubemap).build(*engine);
+
+  if (const auto prevSkybox = filamentSystem->getFilamentScene()->getSkybox()) {
+    engine->destroy(prevSkybox);
+  }
+
+  filamentSystem->getFilamentScene()->setSkybox(sky);
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 Resource<std::string_view> SkyboxSystem::loadSkyboxFromHdrFile(
     const std::string& assetPath,
     const bool showSun,
     const bool shouldUpdateLight,
     const float intensity) {
-  filament::Texture* texture;
-
-  const auto filamentSystem =
-      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "loadSkyboxFromHdrFile");
-  const auto engine = filamentSystem->getFilamentEngine();
+  const auto engine =
+      ECSystemManager::GetInstance()
+          ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                          "loadSkyboxFromHdrFile")
+          ->getFilamentEngine();
 
+  filament::Texture* texture;
   try {
-    texture = HDRLoader::createTexture(engine, assetPath);
+    texture = HDRLoader::createTexture(engine, assetPath, assetPath);
   } catch (...) {
-    return Resource<std::string_view>::Error("Could not decode HDR buffer");
+    return Resource<std::string_view>::Error("Could not decode HDR file");
   }
-  if (texture) {
-    const auto skyboxTexture =
-        filamentSystem->getIBLProfiler()->createCubeMapTexture(texture);
-    engine->destroy(texture);
-
-    if (skyboxTexture) {
-      const auto sky = filament::Skybox::Builder()
-                           .environment(skyboxTexture)
-                           .showSun(showSun)
-                           .build(*engine);
-
-      // updates scene light with skybox when loaded with the same hdr file
-      if (shouldUpdateLight) {
-        const auto reflections =
-            filamentSystem->getIBLProfiler()->getLightReflection(skyboxTexture);
-        const auto ibl = filament::IndirectLight::Builder()
-                             .reflections(reflections)
-                             .intensity(intensity)
-                             .build(*engine);
-        // destroy the previous IBl
-        const auto indirectLight =
-            filamentSystem->getFilamentScene()->getIndirectLight();
-        engine->destroy(indirectLight);
-        filamentSystem->getFilamentScene()->setIndirectLight(ibl);
-      }
-
-      if (const auto prevSkybox =
-              filamentSystem->getFilamentScene()->getSkybox()) {
-        engine->destroy(prevSkybox);
-      }
-
-      filamentSystem->getFilamentScene()->setSkybox(sky);
-    }
-    return Resource<std::string_view>::Success(
-        "Loaded hdr skybox successfully");
+  if (texture == nullptr) {
+    return Resource<std::string_view>::Error("Could not decode HDR file");
   }
 
-  return Resource<std::string_view>::Error("Could not decode HDR file");
+  const auto skyboxTexture = poSetSkyboxFromHdrTexture(texture, showSun);
+  // updates scene light with skybox when loaded with the same hdr file,
+  // reusing the cube map on a prefilter cache miss
+  if (skyboxTexture != nullptr && shouldUpdateLight) {
+    IndirectLightSystem::loadIndirectLightHdrFromFile(assetPath, intensity,
+                                                      skyboxTexture);
+  }
+  return Resource<std::string_view>::Success("Loaded hdr skybox successfully");
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -342,56 +334,57 @@ Resource<std::string_view> SkyboxSystem::loadSkyboxFromHdrBuffer(
     const bool showSun,
     const bool shouldUpdateLight,
     const float intensity) {
-  filament::Texture* texture;
-
-  const auto filamentSystem =
-      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
-          FilamentSystem::StaticGetTypeID(), "loadSkyboxFromHdrBuffer");
-  const auto engine = filamentSystem->getFilamentEngine();
+  const auto engine =
+      ECSystemManager::GetInstance()
+          ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                          "loadSkyboxFromHdrBuffer")
+          ->getFilamentEngine();
 
+  filament::Texture* texture;
   try {
     texture = HDRLoader::createTexture(engine, buffer);
   } catch (...) {
     return Resource<std::string_view>::Error("Could not decode HDR buffer");
   }
-  if (texture) {
-    const auto skyboxTexture =
-        filamentSystem->getIBLProfiler()->createCubeMapTexture(texture);
-    engine->destroy(texture);
-
-    if (skyboxTexture) {
-      const auto sky = filament::Skybox::Builder()
-                           .environment(skyboxTexture)
-                           .showSun(showSun)
-                           .build(*engine);
-
-      // updates scene light with skybox when loaded with the same hdr file
-      if (shouldUpdateLight) {
-        const auto reflections =
-            filamentSystem->getIBLProfiler()->getLightReflection(skyboxTexture);
-        const auto ibl = filament::IndirectLight::Builder()
-                             .reflections(reflections)
-                             .intensity(intensity)
-                             .build(*engine);
-        // destroy the previous IBl
-        const auto indirectLight =
-            filamentSystem->getFilamentScene()->getIndirectLight();
-        engine->destroy(indirectLight);
-        filamentSystem->getFilamentScene()->setIndirectLight(ibl);
-      }
-
-      if (const auto prevSkybox =
-              filamentSystem->getFilamentScene()->getSkybox()) {
-        engine->destroy(prevSkybox);
-      }
-
-      filamentSystem->getFilamentScene()->setSkybox(sky);
-    }
-    return Resource<std::string_view>::Success(
-        "Loaded hdr skybox successfully");
+  if (texture == nullptr) {
+    return Resource<std::string_view>::Error("Could not decode HDR file");
+  }
+
+  const auto skyboxTexture = poSetSkyboxFromHdrTexture(texture, showSun);
+  // updates scene light with skybox when loaded with the same hdr file,
+  // reusing the cube map on a prefilter cache miss
+  if (skyboxTexture != nullptr && shouldUpdateLight) {
+    IndirectLightSystem::loadIndirectLightHdrFromBuffer(buffer, intensity,
+                                                        skyboxTexture);
+  }
+  return Resource<std::string_view>::Success("Loaded hdr skybox successfully");
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+filament::Texture* SkyboxSystem::poSetSkyboxFromHdrTexture(
+    filament::Texture* texture,
+    const bool showSun) {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "poSetSkyboxFromHdrTexture");
+  const auto engine = filamentSystem->getFilamentEngine();
+
+  const auto skyboxTexture =
+      filamentSystem->getIBLProfiler()->createCubeMapTexture(texture);
+  engine->destroy(texture);
+  if (skyboxTexture == nullptr) {
+    return nullptr;
   }
 
-  return Resource<std::string_view>::Error("Could not decode HDR file");
+  const auto sky = filament::Skybox::Builder()
+                       .environment(skyboxTexture)
+                       .showSun(showSun)
+                       .build(*engine);
+  if (const auto prevSkybox = filamentSystem->getFilamentScene()->getSkybox()) {
+    engine->destroy(prevSkybox);
+  }
+  filamentSystem->getFilamentScene()->setSkybox(sky);
+  return skyboxTexture;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -419,4 +412,22 @@ void SkyboxSystem::DebugPrint() {
   spdlog::debug("{}::{}", __FILE__, __FUNCTION__);
 }
 
-}  // namespace plugin_filament_view
\ No newline at end of file
+////////////////////////////////////////////////////////////////////////////////////
+void SkyboxSystem::vAccountResources(ResourceReport& report) const {
+  const auto filamentSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<FilamentSystem>(
+          FilamentSystem::StaticGetTypeID(), "vAccountResources");
+  if (filamentSystem == nullptr ||
+      filamentSystem->getFilamentScene() == nullptr) {
+    return;
+  }
+
+  const auto* skybox = filamentSystem->getFilamentScene()->getSkybox();
+  if (skybox == nullptr || skybox->getTexture() == nullptr) {
+    return;
+  }
+  report.vAdd("SkyboxSystem", "scene skybox", "cubemap",
+              TextureLoader::nEstimateTextureBytes(skybox->getTexture()), 0);
+}
+
+}  // namespace plugin_filament_view
@@ -57,6 +57,8 @@ class SkyboxSystem : public ECSystem {
       bool shouldUpdateLight,
       float intensity);
 
+  // The file is memory mapped for decoding; it is only read into memory
+  // when the indirect light has to be prefiltered from it.
   static Resource<std::string_view> loadSkyboxFromHdrFile(
       const std::string& assetPath,
       bool showSun,
@@ -80,7 +82,18 @@ class SkyboxSystem : public ECSystem {
   void vShutdownSystem() override;
   void DebugPrint() override;
 
+  void vAccountResources(ResourceReport& report) const override;
+
  private:
   static void setTransparentSkybox();
+
+  // Replaces the scene skybox with the KTX cube map, false if unreadable.
+  static bool bApplyKtxSkybox(const std::vector<uint8_t>& buffer);
+
+  // Makes the decoded HDR the scene's skybox and destroys it. Returns the
+  // skybox's cube map, nullptr on failure.
+  static ::filament::Texture* poSetSkyboxFromHdrTexture(
+      ::filament::Texture* texture,
+      bool showSun);
 };
 }  // namespace plugin_filament_view
\ No newline at end of file
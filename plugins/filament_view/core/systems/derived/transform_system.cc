@@ -0,0 +1,396 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "transform_system.h"
+#include "filament_system.h"
+#include "model_system.h"
+#include "shape_system.h"
+
+#include <core/components/derived/basetransform.h>
+#include <core/components/derived/collidable.h>
+#include <core/entity/derived/model/model.h>
+#include <core/entity/derived/shapes/baseshape.h>
+#include <core/systems/ecsystems_manager.h>
+#include <filament/TransformManager.h>
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <chrono>
+
+namespace plugin_filament_view {
+
+using filament::math::mat4f;
+
+// Guards the parent walk against a corrupt (cyclic) chain.
+static constexpr size_t kMaxHierarchyDepth = 1024;
+
+////////////////////////////////////////////////////////////////////////////////////
+filament::TransformManager& TransformSystem::oGetTransformManager() {
+  return ECSystemManager::GetInstance()
+      ->poGetSystemAs<FilamentSystem>(FilamentSystem::StaticGetTypeID(),
+                                      "TransformSystem::oGetTransformManager")
+      ->getFilamentEngine()
+      ->getTransformManager();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+TransformSystem::Systems TransformSystem::oGetSystems() {
+  Systems systems;
+  systems.poShapeSystem =
+      ECSystemManager::GetInstance()->poGetSystemAs<ShapeSystem>(
+          ShapeSystem::StaticGetTypeID(), "TransformSystem::oGetSystems");
+  systems.poTransformManager = &oGetTransformManager();
+  return systems;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+TransformSystem::Node* TransformSystem::poFindNode(const EntityGUID& guid) {
+  const auto iter = m_mapNodes.find(guid);
+  return iter == m_mapNodes.end() ? nullptr : &iter->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+const TransformSystem::Node* TransformSystem::poFindNode(
+    const EntityGUID& guid) const {
+  const auto iter = m_mapNodes.find(guid);
+  return iter == m_mapNodes.end() ? nullptr : &iter->second;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool TransformSystem::bIsAncestor(const EntityGUID& ancestorGuid,
+                                  const EntityGUID& guid) const {
+  const EntityGUID* current = &guid;
+  for (size_t i = 0; i < kMaxHierarchyDepth && !current->empty(); ++i) {
+    if (*current == ancestorGuid) {
+      return true;
+    }
+    const auto* node = poFindNode(*current);
+    if (node == nullptr) {
+      return false;
+    }
+    current = &node->poTransform->GetParentGuid();
+  }
+  return !current->empty();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+bool TransformSystem::bLink(filament::TransformManager& tm,
+                            const EntityGUID& guid,
+                            const EntityGUID& parentGuid) {
+  const auto* child = poFindNode(guid);
+  if (child == nullptr) {
+    return false;
+  }
+
+  const Node* parent = nullptr;
+  filament::TransformManager::Instance parentInstance;
+  if (!parentGuid.empty()) {
+    parent = poFindNode(parentGuid);
+    if (parent == nullptr) {
+      return false;
+    }
+    if (bIsAncestor(guid, parentGuid)) {
+      spdlog::warn("TransformSystem: {} is below {}, not parenting it there",
+                   parentGuid, guid);
+      return true;
+    }
+    if (parent->lstEntities.empty()) {
+      spdlog::warn("TransformSystem: {} has no entity of its own and can't "
+                   "be a parent",
+                   parentGuid);
+      return true;
+    }
+    parentInstance = tm.getInstance(parent->lstEntities[0]);
+  }
+
+  if (const auto& oldParentGuid = child->poTransform->GetParentGuid();
+      !oldParentGuid.empty() && oldParentGuid != parentGuid) {
+    if (const auto* oldParent = poFindNode(oldParentGuid);
+        oldParent != nullptr) {
+      oldParent->poTransform->vRemoveChild(guid);
+    }
+  }
+  child->poTransform->SetParentGuid(parentGuid);
+  if (parent != nullptr) {
+    parent->poTransform->vAddChild(guid);
+  }
+
+  for (const auto entity : child->lstEntities) {
+    tm.setParent(tm.getInstance(entity), parentInstance);
+  }
+
+  vMarkDirty(guid);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vSetParent(const EntityGUID& guid,
+                                 const EntityGUID& parentGuid) {
+  vSetParent(oGetTransformManager(), guid, parentGuid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vSetParent(filament::TransformManager& tm,
+                                 const EntityGUID& guid,
+                                 const EntityGUID& parentGuid) {
+  if (guid.empty() || guid == parentGuid) {
+    spdlog::warn("TransformSystem: invalid parent {} for {}", parentGuid,
+                 guid);
+    return;
+  }
+
+  // The latest request for an entity wins over one still waiting.
+  m_lstPendingLinks.erase(
+      std::remove_if(m_lstPendingLinks.begin(), m_lstPendingLinks.end(),
+                     [&guid](const auto& link) { return link.first == guid; }),
+      m_lstPendingLinks.end());
+
+  if (!bLink(tm, guid, parentGuid)) {
+    m_lstPendingLinks.emplace_back(guid, parentGuid);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vAddNode(const EntityGUID& guid) {
+  vAddNodes({guid});
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vAddNodes(const std::vector<EntityGUID>& lstGuids) {
+  const auto ecsManager = ECSystemManager::GetInstance();
+  const auto shapeSystem = ecsManager->poGetSystemAs<ShapeSystem>(
+      ShapeSystem::StaticGetTypeID(), "TransformSystem::vAddNodes");
+  const auto modelSystem = ecsManager->poGetSystemAs<ModelSystem>(
+      ModelSystem::StaticGetTypeID(), "TransformSystem::vAddNodes");
+
+  auto& tm = oGetTransformManager();
+
+  // Registered first, so links within the batch find their parents.
+  std::vector<EntityGUID> lstLinks;
+  for (const auto& guid : lstGuids) {
+    Node node;
+    EntityObject* entityObject = nullptr;
+    if (shapeSystem != nullptr) {
+      node.poShape = shapeSystem->poFindShapeByGuid(guid);
+      entityObject = node.poShape;
+    }
+    if (node.poShape == nullptr && modelSystem != nullptr) {
+      node.poModel = modelSystem->poFindModelByGuid(guid);
+      entityObject = node.poModel;
+    }
+    if (entityObject == nullptr) {
+      continue;
+    }
+    node.poTransform = dynamic_cast<BaseTransform*>(
+        entityObject
+            ->GetComponentByStaticTypeID(BaseTransform::StaticGetTypeID())
+            .get());
+    if (node.poTransform == nullptr) {
+      continue;
+    }
+    node.poCollidable = dynamic_cast<Collidable*>(
+        entityObject->GetComponentByStaticTypeID(Collidable::StaticGetTypeID())
+            .get());
+
+    if (node.poShape != nullptr) {
+      if (const auto& entity = node.poShape->poGetEntity();
+          !node.poShape->bIsInstanced() && entity != nullptr &&
+          !entity->isNull()) {
+        node.lstEntities.push_back(*entity);
+      }
+    } else {
+      modelSystem->vGetRootEntities(guid, node.lstEntities);
+    }
+
+    m_mapNodes[guid] = std::move(node);
+    lstLinks.push_back(guid);
+  }
+
+  for (const auto& guid : lstLinks) {
+    if (const auto parentGuid = m_mapNodes[guid].poTransform->GetParentGuid();
+        !parentGuid.empty()) {
+      vSetParent(tm, guid, parentGuid);
+    } else {
+      vMarkDirty(guid);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vRemoveNode(const EntityGUID& guid) {
+  m_lstPendingLinks.erase(
+      std::remove_if(m_lstPendingLinks.begin(), m_lstPendingLinks.end(),
+                     [&guid](const auto& link) { return link.first == guid; }),
+      m_lstPendingLinks.end());
+
+  const auto iter = m_mapNodes.find(guid);
+  if (iter == m_mapNodes.end()) {
+    return;
+  }
+  const auto& node = iter->second;
+
+  auto& tm = oGetTransformManager();
+  for (const auto& childGuid : node.poTransform->GetChildGuids()) {
+    const auto* child = poFindNode(childGuid);
+    if (child == nullptr) {
+      continue;
+    }
+    child->poTransform->SetParentGuid({});
+    for (const auto entity : child->lstEntities) {
+      tm.setParent(tm.getInstance(entity), {});
+    }
+    vMarkDirty(childGuid);
+  }
+
+  if (const auto& parentGuid = node.poTransform->GetParentGuid();
+      !parentGuid.empty()) {
+    if (const auto* parent = poFindNode(parentGuid); parent != nullptr) {
+      parent->poTransform->vRemoveChild(guid);
+    }
+  }
+
+  m_mapNodes.erase(iter);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vMarkDirty(const EntityGUID& guid) {
+  const auto* node = poFindNode(guid);
+  if (node == nullptr || node->poTransform->bIsDirty()) {
+    return;
+  }
+  node->poTransform->vSetDirty(true);
+  m_lstDirty.push_back(guid);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vRefreshSubtree(const Systems& systems,
+                                      const EntityGUID& rootGuid) {
+  const auto& tm = *systems.poTransformManager;
+
+  m_lstStack.clear();
+  if (const auto* root = poFindNode(rootGuid); root != nullptr) {
+    m_lstStack.push_back(root);
+  }
+  while (!m_lstStack.empty()) {
+    const auto* node = m_lstStack.back();
+    m_lstStack.pop_back();
+
+    auto* transform = node->poTransform;
+    transform->vSetDirty(false);
+
+    mat4f world;
+    if (!node->lstEntities.empty()) {
+      // Filament has already composed the hierarchy.
+      world = tm.getWorldTransform(tm.getInstance(node->lstEntities[0]));
+    } else if (node->poShape != nullptr) {
+      // Instanced; the parent is visited before its children, so its cached
+      // world transform is current.
+      world = transform->oGetLocalTransform();
+      if (const auto* parent = poFindNode(transform->GetParentGuid());
+          parent != nullptr) {
+        world = parent->poTransform->GetWorldTransform() * world;
+      }
+      if (systems.poShapeSystem != nullptr) {
+        systems.poShapeSystem->vSetInstanceTransform(node->poShape, world);
+      }
+    }
+    transform->SetWorldTransform(world);
+
+    if (node->poCollidable != nullptr &&
+        node->poCollidable->GetShouldMatchAttachedObject()) {
+      node->poCollidable->SetCenterPoint(world[3].xyz);
+    }
+
+    ++m_nStatsNodes;
+    for (const auto& childGuid : transform->GetChildGuids()) {
+      if (const auto* child = poFindNode(childGuid); child != nullptr) {
+        m_lstStack.push_back(child);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vInitSystem() {}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vUpdate(const float fElapsedTime) {
+  if (!m_lstPendingLinks.empty() || !m_lstDirty.empty()) {
+    const auto systems = oGetSystems();
+
+    if (!m_lstPendingLinks.empty()) {
+      auto lstPending = std::move(m_lstPendingLinks);
+      m_lstPendingLinks.clear();
+      for (const auto& [guid, parentGuid] : lstPending) {
+        if (!bLink(*systems.poTransformManager, guid, parentGuid)) {
+          m_lstPendingLinks.emplace_back(guid, parentGuid);
+        }
+      }
+    }
+
+    if (!m_lstDirty.empty()) {
+      const auto start = std::chrono::steady_clock::now();
+      const size_t nNodesBefore = m_nStatsNodes;
+
+      for (const auto& guid : m_lstDirty) {
+        // Already refreshed with a dirty ancestor's subtree.
+        if (const auto* node = poFindNode(guid);
+            node != nullptr && node->poTransform->bIsDirty()) {
+          vRefreshSubtree(systems, guid);
+        }
+      }
+      m_lstDirty.clear();
+
+      const std::chrono::duration<float, std::milli> elapsed =
+          std::chrono::steady_clock::now() - start;
+      m_fStatsMilliseconds += elapsed.count();
+      m_nStatsMaxNodes =
+          std::max(m_nStatsMaxNodes, m_nStatsNodes - nNodesBefore);
+      ++m_nStatsFrames;
+    }
+  }
+
+  m_fStatsElapsed += fElapsedTime;
+  if (m_fStatsElapsed < kStatsIntervalSeconds) {
+    return;
+  }
+
+  if (m_nStatsFrames > 0) {
+    spdlog::debug(
+        "TransformSystem: {} nodes refreshed over {} frames in {:.2f} ms "
+        "(max {} per frame), {} links pending",
+        m_nStatsNodes, m_nStatsFrames, m_fStatsMilliseconds, m_nStatsMaxNodes,
+        m_lstPendingLinks.size());
+  }
+
+  m_fStatsElapsed = 0.0f;
+  m_nStatsFrames = 0;
+  m_nStatsNodes = 0;
+  m_nStatsMaxNodes = 0;
+  m_fStatsMilliseconds = 0.0f;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::vShutdownSystem() {
+  m_lstPendingLinks.clear();
+  m_lstDirty.clear();
+  m_mapNodes.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+void TransformSystem::DebugPrint() {
+  SPDLOG_DEBUG("{} {}", __FILE__, __FUNCTION__);
+}
+
+}  // namespace plugin_filament_view
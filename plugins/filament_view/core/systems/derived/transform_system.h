@@ -0,0 +1,138 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <core/entity/base/entityobject.h>
+#include <core/systems/base/ecsystem.h>
+#include <filament/math/mat4.h>
+#include <utils/Entity.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace filament {
+class TransformManager;
+}
+
+namespace plugin_filament_view {
+
+class BaseTransform;
+class Collidable;
+class Model;
+class ShapeSystem;
+
+namespace shapes {
+class BaseShape;
+}
+
+// Parent / child links between shapes and models.
+//
+// Links are set on the filament TransformManager, so moving a parent moves
+// its whole subtree without touching the children. Each BaseTransform keeps
+// its parent and children by guid plus a cached world transform; moving an
+// entity marks it dirty, and on update only the dirty subtrees have their
+// world transforms and collidables refreshed.
+//
+// Instanced shapes have no entity of their own. They can be children (their
+// instance transform is composed with the parent's world transform here)
+// but not parents.
+class TransformSystem : public ECSystem {
+ public:
+  TransformSystem() = default;
+
+  // Disallow copy and assign.
+  TransformSystem(const TransformSystem&) = delete;
+  TransformSystem& operator=(const TransformSystem&) = delete;
+
+  // Call once the entity has its renderables; links it to the parent named
+  // in its transform, if any.
+  void vAddNode(const EntityGUID& guid);
+  void vAddNodes(const std::vector<EntityGUID>& lstGuids);
+  // Call before the entity is destroyed; its children become roots.
+  void vRemoveNode(const EntityGUID& guid);
+
+  // Makes guid a child of parentGuid, or a root if parentGuid is empty.
+  // Links to entities that are still loading are retried every update.
+  void vSetParent(const EntityGUID& guid, const EntityGUID& parentGuid);
+
+  // Call after changing the local transform of guid.
+  void vMarkDirty(const EntityGUID& guid);
+
+  [[nodiscard]] size_t GetTypeID() const override { return StaticGetTypeID(); }
+
+  [[nodiscard]] static size_t StaticGetTypeID() {
+    return typeid(TransformSystem).hash_code();
+  }
+
+  void vInitSystem() override;
+  void vUpdate(float fElapsedTime) override;
+  void vShutdownSystem() override;
+  void DebugPrint() override;
+
+ private:
+  static constexpr float kStatsIntervalSeconds = 5.0f;
+
+  // An entity added with vAddNode, resolved once there. At most one of
+  // poShape and poModel is set; the pointers stay valid until vRemoveNode,
+  // which is called before the entity is destroyed.
+  struct Node {
+    shapes::BaseShape* poShape = nullptr;
+    Model* poModel = nullptr;
+    BaseTransform* poTransform = nullptr;
+    Collidable* poCollidable = nullptr;
+    // The entities carrying the node's transform: the shape's entity, or
+    // the model's root and lod roots. Empty for instanced shapes.
+    std::vector<utils::Entity> lstEntities;
+  };
+
+  // Systems the hierarchy touches, looked up once per call or update rather
+  // than once per node.
+  struct Systems {
+    std::shared_ptr<ShapeSystem> poShapeSystem;
+    filament::TransformManager* poTransformManager = nullptr;
+  };
+
+  [[nodiscard]] static filament::TransformManager& oGetTransformManager();
+  [[nodiscard]] static Systems oGetSystems();
+  [[nodiscard]] Node* poFindNode(const EntityGUID& guid);
+  [[nodiscard]] const Node* poFindNode(const EntityGUID& guid) const;
+
+  void vSetParent(filament::TransformManager& tm,
+                  const EntityGUID& guid,
+                  const EntityGUID& parentGuid);
+  // False if the link has to wait for an entity that isn't added yet.
+  bool bLink(filament::TransformManager& tm,
+             const EntityGUID& guid,
+             const EntityGUID& parentGuid);
+  [[nodiscard]] bool bIsAncestor(const EntityGUID& ancestorGuid,
+                                 const EntityGUID& guid) const;
+  void vRefreshSubtree(const Systems& systems, const EntityGUID& rootGuid);
+
+  std::map<EntityGUID, Node> m_mapNodes;
+  std::vector<std::pair<EntityGUID, EntityGUID>> m_lstPendingLinks;
+  std::vector<EntityGUID> m_lstDirty;
+  // Reused across updates to avoid reallocating.
+  std::vector<const Node*> m_lstStack;
+
+  float m_fStatsElapsed = 0.0f;
+  size_t m_nStatsFrames = 0;
+  size_t m_nStatsNodes = 0;
+  size_t m_nStatsMaxNodes = 0;
+  float m_fStatsMilliseconds = 0.0f;
+};
+
+}  // namespace plugin_filament_view
@@ -95,6 +95,15 @@ void ViewTargetSystem::vInitSystem() {
 
         vSetCameraFromSerializedData();
       });
+
+  vRegisterMessageHandler(
+      ECSMessageType::ConfigureQualityGovernor, [this](const ECSMessage& msg) {
+        const auto config = msg.getData<QualityGovernor::Config>(
+            ECSMessageType::ConfigureQualityGovernor);
+        for (size_t i = 0; i < m_lstViewTargets.size(); ++i) {
+          vConfigureQualityGovernor(i, config);
+        }
+      });
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -138,6 +147,13 @@ void ViewTargetSystem::vChangeViewQualitySettings(
   m_lstViewTargets[nWhich]->vChangeQualitySettings(settings);
 }
 
+////////////////////////////////////////////////////////////////////////////////////
+void ViewTargetSystem::vConfigureQualityGovernor(
+    const size_t nWhich,
+    const QualityGovernor::Config& config) const {
+  m_lstViewTargets[nWhich]->vConfigureQualityGovernor(config);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////
 void ViewTargetSystem::vSetCameraFromSerializedData() const {
   for (const auto& viewTarget : m_lstViewTargets) {
@@ -159,7 +175,9 @@ size_t ViewTargetSystem::nSetupViewTargetFromDesktopState(
     int32_t left,
     FlutterDesktopEngineState* state) {
   m_lstViewTargets.emplace_back(std::make_unique<ViewTarget>(top, left, state));
-  return m_lstViewTargets.size() - 1;
+  const size_t nWhich = m_lstViewTargets.size() - 1;
+  m_lstViewTargets[nWhich]->vSetFrameCoordinator(&m_oFrameCoordinator, nWhich);
+  return nWhich;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <core/scene/frame_coordinator.h>
 #include <core/scene/view_target.h>
 #include <core/systems/base/ecsystem.h>
 #include <filament/Engine.h>
@@ -75,8 +76,12 @@ class ViewTargetSystem : public ECSystem {
       const size_t nWhich,
       const ViewTarget::ePredefinedQualitySettings settings) const;
 
+  void vConfigureQualityGovernor(size_t nWhich,
+                                 const QualityGovernor::Config& config) const;
+
  private:
   std::vector<std::unique_ptr<ViewTarget>> m_lstViewTargets;
+  FrameCoordinator m_oFrameCoordinator;
 
   std::unique_ptr<Camera> m_poCamera;
 };
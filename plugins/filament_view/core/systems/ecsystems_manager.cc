@@ -46,6 +46,27 @@ ECSystemManager::ECSystemManager()
   vSetupThreadingInternals();
 }
 
+////////////////////////////////////////////////////////////////////////////
+bool ECSystemManager::bBeginInitialization() {
+  auto eExpected = NotInitialized;
+  if (!m_eCurrentState.compare_exchange_strong(eExpected, Initializing)) {
+    return false;
+  }
+  m_oStartupBegin = std::chrono::steady_clock::now();
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ECSystemManager::vLogStartupPhase(const std::string& szPhase) {
+  const std::chrono::duration<float, std::milli> elapsed =
+      std::chrono::steady_clock::now() - m_oStartupBegin;
+
+  std::lock_guard lock(m_oStartupPhasesMutex);
+  if (m_setLoggedStartupPhases.insert(szPhase).second) {
+    spdlog::info("[Startup] {} at {:.1f} ms", szPhase, elapsed.count());
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////
 void ECSystemManager::StartRunLoop() {
   if (m_bIsRunning) {
@@ -86,7 +107,9 @@ void ECSystemManager::RunLoop() {
     // Calculate the time difference between this frame and the last frame
     std::chrono::duration<float> elapsedTime = start - lastFrameTime;
 
-    if (!isHandlerExecuting.load()) {
+    // Until vInitSystems is done the strand is busy with it; frames posted
+    // meanwhile would only pile up behind it.
+    if (m_bSystemsInitialized.load() && !isHandlerExecuting.load()) {
       // Use asio::post to schedule work on the main thread (API thread)
       post(*strand_, [elapsedTime = elapsedTime.count(), this] {
         isHandlerExecuting.store(true);
@@ -149,10 +172,20 @@ void ECSystemManager::vInitSystems() {
   // it needs to run on the main thread.
   // asio::post(*ECSystemManager::GetInstance()->GetStrand(), [&] {
   for (const auto& system : m_vecSystems) {
+    const auto start = std::chrono::steady_clock::now();
     system->vInitSystem();
+    const std::chrono::duration<float, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    spdlog::debug("[Startup] {} initialized in {:.1f} ms",
+                  typeid(*system).name(), elapsed.count());
   }
 
-  m_eCurrentState = Initialized;
+  // The run loop may already be going; it has set Running by then.
+  auto eExpected = Initializing;
+  m_eCurrentState.compare_exchange_strong(eExpected, Initialized);
+  m_bSystemsInitialized = true;
+  vLogStartupPhase("Systems initialized");
+  DebugPrint();
 
   //});
 }
@@ -160,7 +193,7 @@ void ECSystemManager::vInitSystems() {
 ////////////////////////////////////////////////////////////////////////////
 std::shared_ptr<ECSystem> ECSystemManager::poGetSystem(
     const size_t systemTypeID,
-    const std::string& where) {
+    const std::string_view where) {
   if (const auto callingThread = pthread_self();
       callingThread != filament_api_thread_id_) {
     // Note we should have a 'log once' base functionality in common
@@ -176,7 +209,7 @@ std::shared_ptr<ECSystem> ECSystemManager::poGetSystem(
           "do your work.",
           where);
 
-      m_mapOffThreadCallers.insert(std::pair(where, 0));
+      m_mapOffThreadCallers.emplace(where, 0);
     }
   }
 
@@ -199,23 +232,45 @@ void ECSystemManager::vAddSystem(std::shared_ptr<ECSystem> system) {
 
 ////////////////////////////////////////////////////////////////////////////
 void ECSystemManager::vUpdate(const float deltaTime) {
-  // Copy systems under mutex
+  {
+    // Copy systems under mutex
+    std::pmr::vector<std::shared_ptr<ECSystem>> systemsCopy(
+        poGetFrameResource());
+    {
+      std::unique_lock lock(vecSystemsMutex);
+
+      // Copy the systems vector
+      systemsCopy.assign(m_vecSystems.begin(), m_vecSystems.end());
+    }  // Mutex is unlocked here
+
+    // Iterate over the copy without holding the mutex
+    for (const auto& system : systemsCopy) {
+      if (system) {
+        system->vProcessMessages();
+        system->vUpdate(deltaTime);
+      } else {
+        spdlog::error("Encountered null system pointer!");
+      }
+    }
+  }  // Released before the arena is reset
+
+  m_oFrameArena.vReset();
+
+  if constexpr (kCountAllocations) {
+    m_oAllocationStats.vOnFrame();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void ECSystemManager::vAccountResources(ResourceReport& report) {
   std::vector<std::shared_ptr<ECSystem>> systemsCopy;
   {
     std::unique_lock lock(vecSystemsMutex);
-
-    // Copy the systems vector
     systemsCopy = m_vecSystems;
-  }  // Mutex is unlocked here
+  }
 
-  // Iterate over the copy without holding the mutex
   for (const auto& system : systemsCopy) {
-    if (system) {
-      system->vProcessMessages();
-      system->vUpdate(deltaTime);
-    } else {
-      spdlog::error("Encountered null system pointer!");
-    }
+    system->vAccountResources(report);
   }
 }
 
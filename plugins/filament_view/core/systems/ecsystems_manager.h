@@ -16,19 +16,30 @@
 #pragma once
 
 #include <core/systems/base/ecsystem.h>
+#include <core/utils/allocation_counter.h>
+#include <core/utils/frame_arena.h>
 #include <asio/io_context_strand.hpp>
+#include <atomic>
+#include <chrono>
 #include <future>
 #include <map>
 #include <memory>
+#include <set>
 #include <shared_mutex>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace plugin_filament_view {
 
+class ResourceReport;
+
 class ECSystemManager {
  public:
   enum RunState {
     NotInitialized,
+    // Systems are added, vInitSystems hasn't finished yet.
+    Initializing,
     Initialized,
     Running,
     ShutdownStarted,
@@ -36,6 +47,14 @@ class ECSystemManager {
   };
   RunState getRunState() const { return m_eCurrentState; }
 
+  // Moves NotInitialized to Initializing and starts the startup clock; false
+  // if initialization was already started.
+  bool bBeginInitialization();
+
+  // Logs how long after bBeginInitialization the named phase was reached,
+  // the first time each phase is reported. Callable from any thread.
+  void vLogStartupPhase(const std::string& szPhase);
+
   static ECSystemManager* GetInstance();
 
   ECSystemManager(const ECSystemManager&) = delete;
@@ -65,11 +84,11 @@ class ECSystemManager {
   }
 
   std::shared_ptr<ECSystem> poGetSystem(size_t systemTypeID,
-                                        const std::string& where);
+                                        std::string_view where);
 
   template <typename Target>
   std::shared_ptr<Target> poGetSystemAs(size_t systemTypeID,
-                                        const std::string& where) {
+                                        std::string_view where) {
     // Retrieve the system from the manager using its type ID
     auto system = poGetSystem(systemTypeID, where);
     // Perform dynamic pointer cast to the desired type
@@ -77,11 +96,15 @@ class ECSystemManager {
   }
 
   void vInitSystems();
+  // Resets the frame arena once every system has updated.
   void vUpdate(float deltaTime);
   void vShutdownSystems();
 
   void DebugPrint() const;
 
+  // Asks every system for its resources; call on the filament api thread.
+  void vAccountResources(ResourceReport& report);
+
   void StartRunLoop();
   void StopRunLoop();
 
@@ -101,11 +124,22 @@ class ECSystemManager {
     return strand_;
   }
 
+  // For transient containers on the filament api thread; see FrameArena.
+  // Nothing allocated from it may outlive the strand task it was made in.
+  [[nodiscard]] std::pmr::memory_resource* poGetFrameResource() {
+    return m_oFrameArena.poGetResource();
+  }
+
   template <typename T>
   void setConfigValue(const std::string& key, T value) {
     m_mapConfigurationValues[key] = value;
   }
 
+  [[nodiscard]] bool bHasConfigValue(const std::string& key) const {
+    return m_mapConfigurationValues.find(key) !=
+           m_mapConfigurationValues.end();
+  }
+
   // Getter for any type of value
   template <typename T>
   T getConfigValue(const std::string& key) const {
@@ -143,6 +177,8 @@ class ECSystemManager {
   std::thread loopThread_;
 
   std::atomic<bool> isHandlerExecuting{false};
+  // Set on the strand once vInitSystems is done; the run loop waits for it.
+  std::atomic<bool> m_bSystemsInitialized{false};
 
   std::vector<std::shared_ptr<ECSystem>> m_vecSystems;
 
@@ -150,8 +186,15 @@ class ECSystemManager {
 
   std::map<std::string, std::any> m_mapConfigurationValues;
 
-  std::map<std::string, int> m_mapOffThreadCallers;
+  std::map<std::string, int, std::less<>> m_mapOffThreadCallers;
+
+  FrameArena m_oFrameArena;
+  FrameAllocationStats m_oAllocationStats;
+
+  std::atomic<RunState> m_eCurrentState;
 
-  RunState m_eCurrentState;
+  std::chrono::steady_clock::time_point m_oStartupBegin;
+  std::set<std::string> m_setLoggedStartupPhases;
+  std::mutex m_oStartupPhasesMutex;
 };
 }  // namespace plugin_filament_view
\ No newline at end of file
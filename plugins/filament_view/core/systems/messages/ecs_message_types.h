@@ -22,6 +22,11 @@ enum class ECSMessageType {
   CollisionRequest,
   CollisionRequestRequestor,
   CollisionRequestType,
+  // Touch point in viewport coordinates, origin bottom left, and the
+  // filament::View* it hit; only used for GPU picking.
+  CollisionRequestViewportPosition,
+  CollisionRequestView,
+  ChangePickingMode,
 
   ViewTargetCreateRequest,
   ViewTargetCreateRequestTop,
@@ -47,6 +52,24 @@ enum class ECSMessageType {
 
   ChangeViewQualitySettings,
   ChangeViewQualitySettingsWhichView,
+  ConfigureQualityGovernor,
+
+  ChangeAnimationByIndex,
+  ChangeAnimationByName,
+  ChangeAnimationWhichGuid,
+  ChangeAnimationLoop,
+  ChangeAnimationCrossFadeSeconds,
+
+  RequestAnimationInfo,
+
+  // Optional json dump path as the value.
+  RequestResourceUsage,
+  SetResourceBudget,
+
+  ApplyScenePatch,
+
+  // Snapshot path as the value, empty for the one from the creation params.
+  SaveSceneSnapshot,
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "allocation_counter.h"
+
+#include <plugins/common/common.h>
+#include <algorithm>
+#include <atomic>
+
+namespace plugin_filament_view {
+
+namespace {
+std::atomic<size_t> g_nAllocations{0};
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+void vCountAllocation() {
+  g_nAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t nGetAllocationCount() {
+  return g_nAllocations.load(std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameAllocationStats::vOnFrame() {
+  const size_t nCount = nGetAllocationCount();
+  const auto now = std::chrono::steady_clock::now();
+  if (!m_bStarted) {
+    m_bStarted = true;
+    m_nLastCount = nCount;
+    m_oLastReport = now;
+    return;
+  }
+
+  const size_t nFrameAllocations = nCount - m_nLastCount;
+  m_nLastCount = nCount;
+  m_nFewest = m_nFrames == 0 ? nFrameAllocations
+                             : std::min(m_nFewest, nFrameAllocations);
+  m_nMost = std::max(m_nMost, nFrameAllocations);
+  m_nTotal += nFrameAllocations;
+  ++m_nFrames;
+
+  if (now - m_oLastReport < kReportInterval) {
+    return;
+  }
+  spdlog::info("Heap allocations per frame over {} frames: {} min, {} avg, "
+               "{} max",
+               m_nFrames, m_nFewest, m_nTotal / m_nFrames, m_nMost);
+  m_oLastReport = now;
+  m_nFrames = 0;
+  m_nTotal = 0;
+  m_nMost = 0;
+  // Don't count the report against the next frame.
+  m_nLastCount = nGetAllocationCount();
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace plugin_filament_view {
+
+// Building with FILAMENT_VIEW_COUNT_ALLOCATIONS links in
+// allocation_counting_new.cc, which replaces the global operator new with one
+// that counts calls, to check that steady frames don't touch the heap. The
+// count covers every thread in the process. frame_allocation_test links the
+// same file into its own executable instead, so the check can run without
+// replacing new in the host.
+#if defined(FILAMENT_VIEW_COUNT_ALLOCATIONS)
+inline constexpr bool kCountAllocations = true;
+#else
+inline constexpr bool kCountAllocations = false;
+#endif
+
+// Called by the counting operator new.
+void vCountAllocation();
+
+// Calls to operator new so far; always 0 unless the counting operator new
+// is linked in.
+size_t nGetAllocationCount();
+
+// Logs the fewest, mean and most allocations per frame about once a second.
+// For a scene that is standing still the fewest is the one to look at.
+class FrameAllocationStats {
+ public:
+  // Call once per frame, on the same thread.
+  void vOnFrame();
+
+ private:
+  static constexpr std::chrono::seconds kReportInterval{1};
+
+  bool m_bStarted = false;
+  size_t m_nLastCount = 0;
+  size_t m_nFrames = 0;
+  size_t m_nTotal = 0;
+  size_t m_nFewest = 0;
+  size_t m_nMost = 0;
+  std::chrono::steady_clock::time_point m_oLastReport;
+};
+
+}  // namespace plugin_filament_view
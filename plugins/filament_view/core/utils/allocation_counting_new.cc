@@ -0,0 +1,59 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "allocation_counter.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new for whichever executable links this file
+// in; see allocation_counter.h.
+//
+// The other forms of new and delete in libstdc++ go through these, or
+// allocate with aligned_alloc and release with free themselves.
+
+////////////////////////////////////////////////////////////////////////////
+void* operator new(size_t nBytes) {
+  plugin_filament_view::vCountAllocation();
+  if (void* p = std::malloc(nBytes == 0 ? 1 : nBytes)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void* operator new[](const size_t nBytes) {
+  return operator new(nBytes);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void operator delete(void* p, size_t /*nBytes*/) noexcept {
+  std::free(p);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void operator delete[](void* p, size_t /*nBytes*/) noexcept {
+  std::free(p);
+}
@@ -136,4 +136,133 @@ void Deserialize::DecodeParameterWithDefaultInt64(
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+filament::math::float3 Deserialize::Format3(const BinaryScene::View& map) {
+  const auto x = map.oFind("x").ofGetDouble();
+  const auto y = map.oFind("y").ofGetDouble();
+  const auto z = map.oFind("z").ofGetDouble();
+  return {static_cast<float>(x.value_or(0.0)),
+          static_cast<float>(y.value_or(0.0)),
+          static_cast<float>(z.value_or(0.0))};
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::math::quatf Deserialize::Format4(const BinaryScene::View& map) {
+  const auto x = map.oFind("x").ofGetDouble();
+  const auto y = map.oFind("y").ofGetDouble();
+  const auto z = map.oFind("z").ofGetDouble();
+  const auto w = map.oFind("w").ofGetDouble();
+  return {static_cast<float>(w.value_or(1.0)),
+          static_cast<float>(x.value_or(0.0)),
+          static_cast<float>(y.value_or(0.0)),
+          static_cast<float>(z.value_or(0.0))};
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(
+    const char* key,
+    std::optional<std::unique_ptr<MaterialDefinitions>>& out_value,
+    const BinaryScene::View& params,
+    const std::string& flutter_assets_path) {
+  // Material definitions only read the codec form; this copies out just the
+  // material subtree.
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Map) {
+    out_value = std::make_unique<MaterialDefinitions>(
+        flutter_assets_path,
+        std::get<flutter::EncodableMap>(value.oToEncodable()));
+  } else {
+    out_value.reset();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(const char* key,
+                                             bool* out_value,
+                                             const BinaryScene::View& params,
+                                             const bool& default_value) {
+  *out_value = params.oFind(key).obGetBool().value_or(default_value);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(const char* key,
+                                             int32_t* out_value,
+                                             const BinaryScene::View& params,
+                                             const int32_t& default_value) {
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Int32) {
+    *out_value = static_cast<int32_t>(*value.onGetInt());
+  } else {
+    *out_value = default_value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(
+    const char* key,
+    std::string* out_value,
+    const BinaryScene::View& params,
+    const std::string& default_value) {
+  if (const auto value = params.oFind(key).oszGetString()) {
+    *out_value = std::string(*value);
+  } else {
+    *out_value = default_value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(
+    const char* key,
+    filament::math::float3* out_value,
+    const BinaryScene::View& params,
+    const filament::math::float3& default_value) {
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Map) {
+    *out_value = Format3(value);
+  } else {
+    *out_value = default_value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(
+    const char* key,
+    filament::math::quatf* out_value,
+    const BinaryScene::View& params,
+    const filament::math::quatf& default_value) {
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Map) {
+    *out_value = Format4(value);
+  } else {
+    *out_value = default_value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefault(const char* key,
+                                             double* out_value,
+                                             const BinaryScene::View& params,
+                                             const double& default_value) {
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Double) {
+    *out_value = *value.ofGetDouble();
+  } else {
+    *out_value = default_value;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void Deserialize::DecodeParameterWithDefaultInt64(
+    const char* key,
+    int64_t* out_value,
+    const BinaryScene::View& params,
+    const int64_t& default_value) {
+  if (const auto value = params.oFind(key);
+      value.eGetType() == BinaryScene::Type::Int64) {
+    *out_value = *value.onGetInt();
+  } else {
+    *out_value = default_value;
+  }
+}
+
 }  // namespace plugin_filament_view
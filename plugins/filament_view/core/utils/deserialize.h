@@ -20,6 +20,7 @@
 #include <flutter/encodable_value.h>
 
 #include <core/scene/material/material_definitions.h>
+#include <core/scene/serialization/binary_scene.h>
 
 namespace plugin_filament_view {
 
@@ -28,6 +29,8 @@ class Deserialize {
   Deserialize() = default;
   static ::filament::math::float3 Format3(const flutter::EncodableMap& map);
   static ::filament::math::quatf Format4(const flutter::EncodableMap& map);
+  static ::filament::math::float3 Format3(const BinaryScene::View& map);
+  static ::filament::math::quatf Format4(const BinaryScene::View& map);
 
   static const flutter::EncodableValue& DeserializeParameter(
       const char* key,
@@ -104,5 +107,64 @@ class Deserialize {
       int64_t* out_value,
       const flutter::EncodableMap& params,
       const int64_t& default_value);
+
+  // The same lookups read straight from a binary scene, see BinaryScene.
+  template <typename T>
+  static void DecodeEnumParameterWithDefault(
+      const char* key,
+      T* out_value,
+      const BinaryScene::View& params,
+      const T& default_value,
+      std::enable_if_t<std::is_enum<T>::value>* = nullptr) {
+    const auto value = params.oFind(key);
+    if (value.eGetType() == BinaryScene::Type::Int32) {
+      *out_value = static_cast<T>(*value.onGetInt());
+    } else {
+      *out_value = default_value;
+    }
+  }
+
+  static void DecodeParameterWithDefault(
+      const char* key,
+      std::optional<std::unique_ptr<MaterialDefinitions>>& out_value,
+      const BinaryScene::View& params,
+      const std::string& flutter_assets_path);
+
+  static void DecodeParameterWithDefault(const char* key,
+                                         bool* out_value,
+                                         const BinaryScene::View& params,
+                                         const bool& default_value);
+
+  static void DecodeParameterWithDefault(const char* key,
+                                         int32_t* out_value,
+                                         const BinaryScene::View& params,
+                                         const int32_t& default_value);
+
+  static void DecodeParameterWithDefault(const char* key,
+                                         std::string* out_value,
+                                         const BinaryScene::View& params,
+                                         const std::string& default_value);
+
+  static void DecodeParameterWithDefault(
+      const char* key,
+      filament::math::float3* out_value,
+      const BinaryScene::View& params,
+      const filament::math::float3& default_value);
+
+  static void DecodeParameterWithDefault(
+      const char* key,
+      filament::math::quatf* out_value,
+      const BinaryScene::View& params,
+      const filament::math::quatf& default_value);
+
+  static void DecodeParameterWithDefault(const char* key,
+                                         double* out_value,
+                                         const BinaryScene::View& params,
+                                         const double& default_value);
+
+  static void DecodeParameterWithDefaultInt64(const char* key,
+                                              int64_t* out_value,
+                                              const BinaryScene::View& params,
+                                              const int64_t& default_value);
 };
 }  // namespace plugin_filament_view
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "frame_arena.h"
+
+#include <plugins/common/common.h>
+
+namespace plugin_filament_view {
+
+////////////////////////////////////////////////////////////////////////////
+void* FrameArena::OverflowResource::do_allocate(const size_t nBytes,
+                                                const size_t nAlignment) {
+  m_nBytes += nBytes;
+  return std::pmr::new_delete_resource()->allocate(nBytes, nAlignment);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameArena::OverflowResource::do_deallocate(void* p,
+                                                 const size_t nBytes,
+                                                 const size_t nAlignment) {
+  std::pmr::new_delete_resource()->deallocate(p, nBytes, nAlignment);
+}
+
+////////////////////////////////////////////////////////////////////////////
+FrameArena::FrameArena() {
+  vCreateResource();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameArena::vCreateResource() {
+  m_oResource.reset();
+  m_poBuffer = std::make_unique<std::byte[]>(m_nCapacity);
+  m_oResource.emplace(m_poBuffer.get(), m_nCapacity, &m_oOverflow);
+}
+
+////////////////////////////////////////////////////////////////////////////
+void FrameArena::vReset() {
+  if (m_oOverflow.m_nBytes == 0) {
+    m_oResource->release();
+    return;
+  }
+
+  // Room for the whole of the last frame, with some headroom.
+  m_nCapacity = (m_nCapacity + m_oOverflow.m_nBytes) * 2;
+  m_oOverflow.m_nBytes = 0;
+  vCreateResource();
+  spdlog::debug("Frame arena grown to {} KiB", m_nCapacity / 1024);
+}
+
+}  // namespace plugin_filament_view
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+namespace plugin_filament_view {
+
+// Monotonic memory for containers that live no longer than one frame on the
+// filament api thread, released all at once by vReset.
+//
+// A frame that outgrows the buffer falls back to the heap; the next reset
+// grows the buffer to cover it, so a scene whose per-frame work is steady
+// stops touching the heap after a few frames.
+class FrameArena {
+ public:
+  FrameArena();
+
+  // Disallow copy and assign.
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  [[nodiscard]] std::pmr::memory_resource* poGetResource() {
+    return &*m_oResource;
+  }
+
+  // Invalidates everything allocated since the last reset.
+  void vReset();
+
+  [[nodiscard]] size_t nGetCapacity() const { return m_nCapacity; }
+
+ private:
+  static constexpr size_t kInitialCapacity = 64 * 1024;
+
+  // Passes through to the heap, counting what the arena couldn't hold.
+  class OverflowResource : public std::pmr::memory_resource {
+   public:
+    size_t m_nBytes = 0;
+
+   private:
+    void* do_allocate(size_t nBytes, size_t nAlignment) override;
+    void do_deallocate(void* p, size_t nBytes, size_t nAlignment) override;
+    [[nodiscard]] bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  void vCreateResource();
+
+  size_t m_nCapacity = kInitialCapacity;
+  std::unique_ptr<std::byte[]> m_poBuffer;
+  OverflowResource m_oOverflow;
+  std::optional<std::pmr::monotonic_buffer_resource> m_oResource;
+};
+
+}  // namespace plugin_filament_view
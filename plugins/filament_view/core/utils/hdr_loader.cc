@@ -15,11 +15,27 @@
  */
 #include "hdr_loader.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__F16C__) && defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 #include <imageio/ImageDecoder.h>
 #include <plugins/common/common.h>
+#include <utils/JobSystem.h>
 
 namespace plugin_filament_view {
 
@@ -27,6 +43,26 @@ using namespace filament;
 using namespace image;
 using namespace utils;
 
+namespace {
+
+// 2^(e - 136): the shared exponent with the 8 mantissa bits folded in.
+// Exponents that would give a denormal scale are treated as black, as e == 0
+// is, which is well below anything half floats can represent anyway.
+constexpr uint32_t kMinExponent = 10;
+constexpr uint32_t kExponentBias = 9;
+
+float fRgbeScale(const uint8_t exponent) {
+  if (exponent < kMinExponent) {
+    return 0.0f;
+  }
+  const uint32_t bits = static_cast<uint32_t>(exponent - kExponentBias) << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return scale;
+}
+
+}  // namespace
+
 ////////////////////////////////////////////////////////////////////////////
 Texture* HDRLoader::deleteImageAndLogError(const LinearImage* image) {
   spdlog::error("Unable to create Filament Texture from HDR image.");
@@ -69,23 +105,346 @@ Texture* HDRLoader::createTextureFromImage(Engine* engine, LinearImage* image) {
   return texture;
 }
 
+////////////////////////////////////////////////////////////////////////////
+bool HDRLoader::bParseHeader(const uint8_t* data,
+                             const size_t size,
+                             uint32_t& width,
+                             uint32_t& height,
+                             size_t& headerSize) {
+  if (size < 2 || data[0] != '#' || data[1] != '?') {
+    return false;
+  }
+
+  size_t pos = 0;
+  auto nextLine = [&](std::string& line) {
+    const auto* begin = data + pos;
+    const auto* newline =
+        static_cast<const uint8_t*>(std::memchr(begin, '\n', size - pos));
+    if (newline == nullptr) {
+      return false;
+    }
+    line.assign(reinterpret_cast<const char*>(begin),
+                static_cast<size_t>(newline - begin));
+    pos = static_cast<size_t>(newline - data) + 1;
+    return true;
+  };
+
+  std::string line;
+  do {
+    if (!nextLine(line)) {
+      return false;
+    }
+    // XYZE files need a color space conversion, leave them to imageio.
+    if (line.rfind("FORMAT=", 0) == 0 && line != "FORMAT=32-bit_rle_rgbe") {
+      return false;
+    }
+  } while (!line.empty());
+
+  // Flipped or transposed images are rare enough to go through imageio.
+  if (!nextLine(line) ||
+      std::sscanf(line.c_str(), "-Y %u +X %u", &height, &width) != 2) {
+    return false;
+  }
+
+  headerSize = pos;
+  return width > 0 && height > 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool HDRLoader::bIndexScanlines(const uint8_t* data,
+                                const size_t size,
+                                size_t offset,
+                                const uint32_t width,
+                                const uint32_t height,
+                                std::vector<size_t>& offsets) {
+  // Only new style RLE, which needs 8 <= width < 32768; flat and old style
+  // RLE files can't be split without decoding them.
+  if (width < 8 || width >= 0x8000) {
+    return false;
+  }
+
+  offsets.resize(height);
+  for (uint32_t y = 0; y < height; ++y) {
+    if (offset + 4 > size || data[offset] != 2 || data[offset + 1] != 2 ||
+        ((static_cast<uint32_t>(data[offset + 2]) << 8) | data[offset + 3]) !=
+            width) {
+      return false;
+    }
+    offsets[y] = offset;
+    offset += 4;
+
+    for (int component = 0; component < 4; ++component) {
+      uint32_t x = 0;
+      while (x < width) {
+        if (offset >= size) {
+          return false;
+        }
+        const uint32_t count = data[offset++];
+        if (count > 128) {
+          x += count - 128;
+          offset += 1;
+        } else {
+          if (count == 0) {
+            return false;
+          }
+          x += count;
+          offset += count;
+        }
+      }
+      if (x != width || offset > size) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool HDRLoader::bDecodeScanline(const uint8_t* src,
+                                const uint8_t* end,
+                                const uint32_t width,
+                                uint8_t* planar) {
+  // Skip the 2, 2, width marker, bIndexScanlines validated it.
+  src += 4;
+  for (int component = 0; component < 4; ++component) {
+    uint8_t* dst = planar + component * width;
+    const uint8_t* const dstEnd = dst + width;
+    while (dst < dstEnd) {
+      if (src >= end) {
+        return false;
+      }
+      const uint32_t count = *src++;
+      if (count > 128) {
+        const uint32_t run = count - 128;
+        if (src >= end || dst + run > dstEnd) {
+          return false;
+        }
+        std::memset(dst, *src++, run);
+        dst += run;
+      } else {
+        if (src + count > end || dst + count > dstEnd) {
+          return false;
+        }
+        std::memcpy(dst, src, count);
+        src += count;
+        dst += count;
+      }
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void HDRLoader::vConvertScanline(const uint8_t* planar,
+                                 const uint32_t width,
+                                 math::half* dst) {
+  const uint8_t* r = planar;
+  const uint8_t* g = planar + width;
+  const uint8_t* b = planar + 2 * width;
+  const uint8_t* e = planar + 3 * width;
+
+  uint32_t x = 0;
+
+#if defined(__aarch64__)
+  auto load = [](const uint8_t* src) {
+    uint32_t word;
+    std::memcpy(&word, src, sizeof(word));
+    return vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(
+        vdup_n_u32(word)))));
+  };
+  const uint32x4_t minExponent = vdupq_n_u32(kMinExponent - 1);
+  const uint32x4_t bias = vdupq_n_u32(kExponentBias);
+  for (; x + 4 <= width; x += 4) {
+    const uint32x4_t exponent = load(e + x);
+    const float32x4_t scale = vreinterpretq_f32_u32(
+        vandq_u32(vshlq_n_u32(vsubq_u32(exponent, bias), 23),
+                  vcgtq_u32(exponent, minExponent)));
+    uint16x4x3_t rgb;
+    rgb.val[0] = vreinterpret_u16_f16(
+        vcvt_f16_f32(vmulq_f32(vcvtq_f32_u32(load(r + x)), scale)));
+    rgb.val[1] = vreinterpret_u16_f16(
+        vcvt_f16_f32(vmulq_f32(vcvtq_f32_u32(load(g + x)), scale)));
+    rgb.val[2] = vreinterpret_u16_f16(
+        vcvt_f16_f32(vmulq_f32(vcvtq_f32_u32(load(b + x)), scale)));
+    vst3_u16(reinterpret_cast<uint16_t*>(dst + 3 * x), rgb);
+  }
+#elif defined(__F16C__) && defined(__SSE4_1__)
+  auto load = [](const uint8_t* src) {
+    int32_t word;
+    std::memcpy(&word, src, sizeof(word));
+    return _mm_cvtepu8_epi32(_mm_cvtsi32_si128(word));
+  };
+  const __m128i minExponent = _mm_set1_epi32(kMinExponent - 1);
+  const __m128i bias = _mm_set1_epi32(kExponentBias);
+  for (; x + 4 <= width; x += 4) {
+    const __m128i exponent = load(e + x);
+    const __m128 scale = _mm_castsi128_ps(
+        _mm_and_si128(_mm_slli_epi32(_mm_sub_epi32(exponent, bias), 23),
+                      _mm_cmpgt_epi32(exponent, minExponent)));
+    alignas(16) uint16_t lanes[3][8];
+    _mm_store_si128(
+        reinterpret_cast<__m128i*>(lanes[0]),
+        _mm_cvtps_ph(_mm_mul_ps(_mm_cvtepi32_ps(load(r + x)), scale),
+                     _MM_FROUND_TO_NEAREST_INT));
+    _mm_store_si128(
+        reinterpret_cast<__m128i*>(lanes[1]),
+        _mm_cvtps_ph(_mm_mul_ps(_mm_cvtepi32_ps(load(g + x)), scale),
+                     _MM_FROUND_TO_NEAREST_INT));
+    _mm_store_si128(
+        reinterpret_cast<__m128i*>(lanes[2]),
+        _mm_cvtps_ph(_mm_mul_ps(_mm_cvtepi32_ps(load(b + x)), scale),
+                     _MM_FROUND_TO_NEAREST_INT));
+    auto* out = reinterpret_cast<uint16_t*>(dst + 3 * x);
+    for (int i = 0; i < 4; ++i) {
+      out[3 * i] = lanes[0][i];
+      out[3 * i + 1] = lanes[1][i];
+      out[3 * i + 2] = lanes[2][i];
+    }
+  }
+#endif
+
+  for (; x < width; ++x) {
+    const float scale = fRgbeScale(e[x]);
+    dst[3 * x] = math::half(static_cast<float>(r[x]) * scale);
+    dst[3 * x + 1] = math::half(static_cast<float>(g[x]) * scale);
+    dst[3 * x + 2] = math::half(static_cast<float>(b[x]) * scale);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+Texture* HDRLoader::createTextureFromRgbe(Engine* engine,
+                                          const uint8_t* data,
+                                          const size_t size) {
+  const auto decodeStart = std::chrono::steady_clock::now();
+
+  uint32_t width, height;
+  size_t headerSize;
+  std::vector<size_t> offsets;
+  if (!bParseHeader(data, size, width, height, headerSize) ||
+      !bIndexScanlines(data, size, headerSize, width, height, offsets)) {
+    return nullptr;
+  }
+
+  // Handed to Filament with the upload, freed by the backend once consumed.
+  const size_t pixelBytes =
+      static_cast<size_t>(width) * height * 3 * sizeof(math::half);
+  auto* pixels = static_cast<math::half*>(malloc(pixelBytes));
+  if (pixels == nullptr) {
+    return nullptr;
+  }
+
+  std::atomic_bool bFailed{false};
+  auto decodeRows = [&](const uint32_t start, const uint32_t count) {
+    std::vector<uint8_t> planar(static_cast<size_t>(width) * 4);
+    for (uint32_t y = start; y < start + count; ++y) {
+      const uint8_t* end =
+          y + 1 < height ? data + offsets[y + 1] : data + size;
+      if (!bDecodeScanline(data + offsets[y], end, width, planar.data())) {
+        bFailed = true;
+        return;
+      }
+      vConvertScanline(planar.data(), width,
+                       pixels + static_cast<size_t>(y) * width * 3);
+    }
+  };
+
+  // Called on the engine thread, which adopted the JobSystem on creation and
+  // helps out in runAndWait.
+  auto& js = engine->getJobSystem();
+  auto* job = jobs::parallel_for(js, nullptr, 0, height, std::cref(decodeRows),
+                                 jobs::CountSplitter<kRowsPerJob>());
+  js.runAndWait(job);
+
+  if (bFailed) {
+    free(pixels);
+    return nullptr;
+  }
+
+  const std::chrono::duration<float, std::milli> decodeTime =
+      std::chrono::steady_clock::now() - decodeStart;
+  const float fMegabytes = static_cast<float>(size) / (1024.0f * 1024.0f);
+  spdlog::debug(
+      "HDRLoader: decoded {}x{} ({:.1f} MB) in {:.1f} ms, {:.0f} MB/s", width,
+      height, fMegabytes, decodeTime.count(),
+      fMegabytes / std::max(decodeTime.count() / 1000.0f, 1e-6f));
+
+  Texture* texture = Texture::Builder()
+                         .width(width)
+                         .height(height)
+                         .levels(0xff)
+                         .format(Texture::InternalFormat::R11F_G11F_B10F)
+                         .sampler(Texture::Sampler::SAMPLER_2D)
+                         .build(*engine);
+  if (!texture) {
+    spdlog::error("Unable to create Filament Texture from HDR image.");
+    free(pixels);
+    return nullptr;
+  }
+
+  Texture::PixelBufferDescriptor pbd(
+      pixels, pixelBytes, Texture::PixelBufferDescriptor::PixelDataFormat::RGB,
+      Texture::PixelBufferDescriptor::PixelDataType::HALF,
+      [](void* buffer, size_t, void*) { free(buffer); });
+
+  texture->setImage(*engine, 0, std::move(pbd));
+  texture->generateMipmaps(*engine);
+  return texture;
+}
+
+////////////////////////////////////////////////////////////////////////////
+Texture* HDRLoader::createTextureFromData(Engine* engine,
+                                          const uint8_t* data,
+                                          const size_t size,
+                                          const std::string& name) {
+  if (auto* texture = createTextureFromRgbe(engine, data, size)) {
+    return texture;
+  }
+
+  SPDLOG_DEBUG("HDRLoader: {} not RLE RGBE, decoding with imageio", name);
+  const std::string str(reinterpret_cast<const char*>(data), size);
+  std::istringstream ins(str);
+  auto* image = new LinearImage(ImageDecoder::decode(ins, name));
+  return createTextureFromImage(engine, image);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 Texture* HDRLoader::createTexture(Engine* engine,
                                   const std::string& asset_path,
                                   const std::string& name) {
   SPDLOG_DEBUG("Loading {}", asset_path.c_str());
-  std::ifstream ins(asset_path, std::ios::binary);
-  auto* image = new LinearImage(ImageDecoder::decode(ins, name));
-  return createTextureFromImage(engine, image);
+
+  const int fd = open(asset_path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st {};
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    spdlog::error("Unable to open HDR file {}", asset_path);
+    return nullptr;
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (mapped == MAP_FAILED) {
+    std::ifstream ins(asset_path, std::ios::binary);
+    auto* image = new LinearImage(ImageDecoder::decode(ins, name));
+    return createTextureFromImage(engine, image);
+  }
+
+  // Scanlines are read front to back by the decode jobs.
+  madvise(mapped, size, MADV_SEQUENTIAL);
+  auto* texture = createTextureFromData(
+      engine, static_cast<const uint8_t*>(mapped), size, name);
+  munmap(mapped, size);
+  return texture;
 }
 
 ////////////////////////////////////////////////////////////////////////////
 Texture* HDRLoader::createTexture(Engine* engine,
                                   const std::vector<uint8_t>& buffer,
                                   const std::string& name) {
-  const std::string str(buffer.begin(), buffer.end());
-  std::istringstream ins(str);
-  auto* image = new LinearImage(ImageDecoder::decode(ins, name));
-  return createTextureFromImage(engine, image);
+  return createTextureFromData(engine, buffer.data(), buffer.size(), name);
 }
-}  // namespace plugin_filament_view
\ No newline at end of file
+}  // namespace plugin_filament_view
@@ -20,11 +20,17 @@
 #include <filament/Engine.h>
 #include <filament/Texture.h>
 #include <image/LinearImage.h>
+#include <math/half.h>
 
 namespace plugin_filament_view {
 
+// Radiance HDR files with RLE scanlines (what practically every exporter
+// writes) are decoded here: scanlines in parallel on the engine JobSystem,
+// RGBE converted straight to half floats in the upload buffer. Anything else
+// falls back to imageio.
 class HDRLoader {
  public:
+  // The file is memory mapped rather than read.
   static ::filament::Texture* createTexture(
       ::filament::Engine* engine,
       const std::string& asset_path,
@@ -36,6 +42,44 @@ class HDRLoader {
       const std::string& name = "memory.hdr");
 
  private:
+  // Rows handed to one decode job.
+  static constexpr uint32_t kRowsPerJob = 16;
+
+  // nullptr if the data isn't an RLE encoded, -Y +X oriented RGBE image.
+  static ::filament::Texture* createTextureFromRgbe(::filament::Engine* engine,
+                                                    const uint8_t* data,
+                                                    size_t size);
+
+  static ::filament::Texture* createTextureFromData(
+      ::filament::Engine* engine,
+      const uint8_t* data,
+      size_t size,
+      const std::string& name);
+
+  static bool bParseHeader(const uint8_t* data,
+                           size_t size,
+                           uint32_t& width,
+                           uint32_t& height,
+                           size_t& headerSize);
+
+  // Offsets of every scanline, so they can be decoded independently.
+  static bool bIndexScanlines(const uint8_t* data,
+                              size_t size,
+                              size_t offset,
+                              uint32_t width,
+                              uint32_t height,
+                              std::vector<size_t>& offsets);
+
+  // Decodes one RLE scanline into planar R, G, B, E rows of width bytes.
+  static bool bDecodeScanline(const uint8_t* src,
+                              const uint8_t* end,
+                              uint32_t width,
+                              uint8_t* planar);
+
+  static void vConvertScanline(const uint8_t* planar,
+                               uint32_t width,
+                               ::filament::math::half* dst);
+
   static ::filament::Texture* deleteImageAndLogError(
       const image::LinearImage* image);
 
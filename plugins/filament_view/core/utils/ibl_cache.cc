@@ -0,0 +1,461 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ibl_cache.h"
+
+#include <core/include/file_utils.h>
+#include <ibl/Cubemap.h>
+#include <ibl/CubemapIBL.h>
+#include <ibl/CubemapSH.h>
+#include <ibl/CubemapUtils.h>
+#include <ibl/Image.h>
+#include <image/Ktx1Bundle.h>
+#include <imageio/ImageDecoder.h>
+#include <ktxreader/Ktx1Reader.h>
+#include <ktxreader/Ktx2Reader.h>
+#include <math/half.h>
+#include <math/vec3.h>
+#include <plugins/common/common.h>
+#include <utils/JobSystem.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace plugin_filament_view {
+
+using filament::math::float3;
+using filament::math::half3;
+
+namespace {
+
+// "«KTX 11»" / "«KTX 20»", only the version digits differ.
+bool bIsKtx2(const std::vector<uint8_t>& buffer) {
+  return buffer.size() > 6 && buffer[5] == '2' && buffer[6] == '0';
+}
+
+// Same curve cmgen and Filament's prefilter use to spread roughness over
+// the mip chain.
+float fLodToPerceptualRoughness(const float fLod) {
+  constexpr float a = 2.0f;
+  constexpr float b = -1.0f;
+  return fLod != 0.0f ? std::clamp((std::sqrt(a * a + 4.0f * b * fLod) - a) /
+                                       (2.0f * b),
+                                   0.0f, 1.0f)
+                      : 0.0f;
+}
+
+// FNV-1a, enough to tell cache entries apart.
+class Fnv1a {
+ public:
+  void vMix(const void* data, const size_t nSize) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < nSize; ++i) {
+      m_nHash ^= bytes[i];
+      m_nHash *= 1099511628211ull;
+    }
+  }
+
+  [[nodiscard]] std::string szHex() const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << m_nHash;
+    return ss.str();
+  }
+
+ private:
+  uint64_t m_nHash = 14695981039346656037ull;
+};
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+filament::Texture* IblCache::poCreateCubemapFromKtx(
+    filament::Engine* engine,
+    const std::vector<uint8_t>& buffer) {
+  filament::Texture* texture = nullptr;
+
+  if (bIsKtx2(buffer)) {
+    ktxreader::Ktx2Reader reader(*engine, true);
+    reader.requestFormat(filament::Texture::InternalFormat::R11F_G11F_B10F);
+    reader.requestFormat(filament::Texture::InternalFormat::RGBA16F);
+    reader.requestFormat(filament::Texture::InternalFormat::RGB16F);
+    reader.requestFormat(filament::Texture::InternalFormat::SRGB8_A8);
+    reader.requestFormat(filament::Texture::InternalFormat::RGBA8);
+    texture = reader.load(buffer.data(), buffer.size(),
+                          ktxreader::Ktx2Reader::TransferFunction::LINEAR);
+  } else {
+    // The reader takes ownership of the bundle and frees it after upload.
+    auto* bundle = new image::Ktx1Bundle(
+        buffer.data(), static_cast<uint32_t>(buffer.size()));
+    texture = ktxreader::Ktx1Reader::createTexture(engine, bundle, false);
+  }
+
+  if (texture != nullptr &&
+      texture->getTarget() != filament::Texture::Sampler::SAMPLER_CUBEMAP) {
+    spdlog::error("KTX environment is not a cube map");
+    engine->destroy(texture);
+    return nullptr;
+  }
+  return texture;
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::IndirectLight* IblCache::poCreateIndirectLightFromKtx(
+    filament::Engine* engine,
+    const std::vector<uint8_t>& buffer,
+    const float fIntensity) {
+  float3 harmonics[9];
+  bool bHasHarmonics = false;
+  if (!bIsKtx2(buffer)) {
+    const image::Ktx1Bundle bundle(buffer.data(),
+                                   static_cast<uint32_t>(buffer.size()));
+    bHasHarmonics = bundle.getSphericalHarmonics(harmonics);
+  }
+
+  auto* reflections = poCreateCubemapFromKtx(engine, buffer);
+  if (reflections == nullptr) {
+    return nullptr;
+  }
+
+  auto builder = filament::IndirectLight::Builder();
+  builder.reflections(reflections).intensity(fIntensity);
+  if (bHasHarmonics) {
+    builder.irradiance(3, harmonics);
+  }
+  return builder.build(*engine);
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::string IblCache::szCacheKey(const std::vector<uint8_t>& hdrBuffer) {
+  // The source and the settings that shape the output.
+  Fnv1a hash;
+  hash.vMix(hdrBuffer.data(), hdrBuffer.size());
+  for (const uint32_t setting :
+       {kCubemapSize, kMinLevelSize, kSampleCount, kCacheVersion}) {
+    hash.vMix(&setting, sizeof(setting));
+  }
+  return hash.szHex();
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::filesystem::path IblCache::fileKeyPath(const std::string& szPath) {
+  std::error_code error;
+  const auto nByteSize = std::filesystem::file_size(szPath, error);
+  if (error) {
+    return {};
+  }
+  const auto writeTime = std::filesystem::last_write_time(szPath, error);
+  if (error) {
+    return {};
+  }
+
+  // A changed file or changed settings get a different entry.
+  const auto nWriteTime = writeTime.time_since_epoch().count();
+  Fnv1a hash;
+  hash.vMix(szPath.data(), szPath.size());
+  hash.vMix(&nByteSize, sizeof(nByteSize));
+  hash.vMix(&nWriteTime, sizeof(nWriteTime));
+  for (const uint32_t setting :
+       {kCubemapSize, kMinLevelSize, kSampleCount, kCacheVersion}) {
+    hash.vMix(&setting, sizeof(setting));
+  }
+  return getCacheDirectory() / "ibl" / "files" / (hash.szHex() + ".key");
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::optional<std::string> IblCache::oszFindKeyForFile(
+    const std::string& szPath) {
+  const auto path = fileKeyPath(szPath);
+  if (path.empty()) {
+    return std::nullopt;
+  }
+  std::ifstream in(path);
+  std::string szKey;
+  if (!(in >> szKey) || szKey.empty()) {
+    return std::nullopt;
+  }
+  return szKey;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void IblCache::vRecordKeyForFile(const std::string& szPath,
+                                 const std::string& szKey) {
+  const auto path = fileKeyPath(szPath);
+  if (path.empty()) {
+    return;
+  }
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+  auto tempPath = path;
+  tempPath += ".tmp";
+  std::ofstream out(tempPath, std::ios::trunc);
+  out << szKey;
+  out.close();
+  if (out) {
+    std::filesystem::rename(tempPath, path, error);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::filesystem::path IblCache::cachePath(const std::string& szKey) {
+  return getCacheDirectory() / "ibl" / (szKey + ".ktx");
+}
+
+////////////////////////////////////////////////////////////////////////////
+filament::IndirectLight* IblCache::poLoadCached(filament::Engine* engine,
+                                                const std::string& szKey,
+                                                const float fIntensity) {
+  const auto path = cachePath(szKey);
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    return nullptr;
+  }
+
+  const auto buffer =
+      readBinaryFile(path.filename().string(), path.parent_path().string());
+  if (buffer.empty()) {
+    return nullptr;
+  }
+  return poCreateIndirectLightFromKtx(engine, buffer, fIntensity);
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<uint8_t> IblCache::vecPrefilter(
+    const std::vector<uint8_t>& hdrBuffer,
+    const std::atomic<bool>& bStop) {
+  const std::string str(hdrBuffer.begin(), hdrBuffer.end());
+  std::istringstream ins(str);
+  const auto linear = image::ImageDecoder::decode(ins, "memory.hdr");
+  if (linear.getChannels() != 3) {
+    return {};
+  }
+
+  const size_t nWidth = linear.getWidth();
+  const size_t nHeight = linear.getHeight();
+  ibl::Image source(nWidth, nHeight);
+  for (size_t y = 0; y < nHeight; ++y) {
+    std::memcpy(source.getPixelRef(0, y), linear.getPixelRef(0, y),
+                nWidth * sizeof(float3));
+  }
+
+  // Private job system, adopted by this thread for runAndWait.
+  utils::JobSystem js(kPrefilterThreads);
+  js.adopt();
+
+  // Source mip chain the roughness filter samples from.
+  std::vector<ibl::Image> images;
+  std::vector<ibl::Cubemap> levels;
+  {
+    ibl::Image image;
+    auto cube = ibl::CubemapUtils::create(image, kCubemapSize);
+    ibl::CubemapUtils::equirectangularToCubemap(js, cube, source);
+    cube.makeSeamless();
+    images.push_back(std::move(image));
+    levels.push_back(std::move(cube));
+  }
+  for (uint32_t size = kCubemapSize / 2; size >= 1; size /= 2) {
+    ibl::Image image;
+    auto cube = ibl::CubemapUtils::create(image, size);
+    ibl::CubemapUtils::downsampleCubemapLevelBoxFilter(js, cube,
+                                                       levels.back());
+    cube.makeSeamless();
+    images.push_back(std::move(image));
+    levels.push_back(std::move(cube));
+  }
+
+  auto harmonics = ibl::CubemapSH::computeSH(js, levels[0], 3, true);
+  ibl::CubemapSH::preprocessSHForShader(harmonics);
+
+  uint32_t nOutputLevels = 0;
+  for (uint32_t size = kCubemapSize; size >= kMinLevelSize; size /= 2) {
+    ++nOutputLevels;
+  }
+
+  image::Ktx1Bundle bundle(nOutputLevels, 1, true);
+  auto& info = bundle.info();
+  info.endianness = image::Ktx1Bundle::ENDIAN_DEFAULT;
+  info.glType = image::Ktx1Bundle::HALF_FLOAT;
+  info.glTypeSize = 2;
+  info.glFormat = image::Ktx1Bundle::RGB;
+  info.glInternalFormat = image::Ktx1Bundle::RGB16F;
+  info.glBaseInternalFormat = image::Ktx1Bundle::RGB;
+  info.pixelWidth = kCubemapSize;
+  info.pixelHeight = kCubemapSize;
+  info.pixelDepth = 0;
+
+  // Cube maps are stored mirrored, as cmgen does by default.
+  const float3 mirror{-1.0f, 1.0f, 1.0f};
+
+  std::vector<half3> faceData;
+  for (uint32_t level = 0; level < nOutputLevels; ++level) {
+    if (bStop) {
+      js.emancipate();
+      return {};
+    }
+
+    const uint32_t size = kCubemapSize >> level;
+    const float fLod =
+        nOutputLevels > 1
+            ? static_cast<float>(level) / static_cast<float>(nOutputLevels - 1)
+            : 0.0f;
+    const float fPerceptualRoughness = fLodToPerceptualRoughness(fLod);
+
+    ibl::Image image;
+    auto cube = ibl::CubemapUtils::create(image, size);
+    ibl::CubemapIBL::roughnessFilter(
+        js, cube, levels, fPerceptualRoughness * fPerceptualRoughness,
+        kSampleCount, mirror, true);
+
+    faceData.resize(static_cast<size_t>(size) * size);
+    for (size_t face = 0; face < 6; ++face) {
+      const auto& faceImage =
+          cube.getImageForFace(static_cast<ibl::Cubemap::Face>(face));
+      for (size_t y = 0; y < size; ++y) {
+        const auto* row =
+            static_cast<const float3*>(faceImage.getPixelRef(0, y));
+        for (size_t x = 0; x < size; ++x) {
+          faceData[y * size + x] = half3(row[x]);
+        }
+      }
+      bundle.setBlob({level, 0, static_cast<uint32_t>(face)},
+                     reinterpret_cast<const uint8_t*>(faceData.data()),
+                     static_cast<uint32_t>(faceData.size() * sizeof(half3)));
+    }
+  }
+
+  // Same text layout Ktx1Bundle::getSphericalHarmonics parses.
+  std::stringstream sh;
+  for (size_t i = 0; i < 9; ++i) {
+    sh << harmonics[i].r << " " << harmonics[i].g << " " << harmonics[i].b
+       << "\n";
+  }
+  bundle.setMetadata("sh", sh.str().c_str());
+
+  js.emancipate();
+
+  std::vector<uint8_t> out(bundle.getSerializedLength());
+  if (!bundle.serialize(out.data(), static_cast<uint32_t>(out.size()))) {
+    return {};
+  }
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////
+IblCacheWriter::~IblCacheWriter() {
+  vStop();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void IblCacheWriter::vStoreAsync(const std::string& szKey,
+                                 std::vector<uint8_t> hdrBuffer) {
+  std::error_code error;
+  if (std::filesystem::exists(IblCache::cachePath(szKey), error)) {
+    return;
+  }
+
+  std::lock_guard lock(m_oMutex);
+  if (m_bStop || !m_setKeys.insert(szKey).second) {
+    return;
+  }
+  m_lstPending.emplace_back(szKey, std::move(hdrBuffer));
+  if (!m_oWorker.joinable()) {
+    m_oWorker = std::thread(&IblCacheWriter::vRun, this);
+  }
+  m_oWake.notify_one();
+}
+
+////////////////////////////////////////////////////////////////////////////
+void IblCacheWriter::vStop() {
+  {
+    std::lock_guard lock(m_oMutex);
+    m_bStop = true;
+    m_lstPending.clear();
+  }
+  m_oWake.notify_one();
+  if (m_oWorker.joinable()) {
+    m_oWorker.join();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void IblCacheWriter::vRun() {
+  // Linux applies the nice value per thread.
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)),
+                  kWorkerNiceValue) != 0) {
+    spdlog::warn("IBL cache: unable to lower the build thread priority");
+  }
+
+  std::unique_lock lock(m_oMutex);
+  while (true) {
+    m_oWake.wait(lock, [this] { return m_bStop || !m_lstPending.empty(); });
+    if (m_bStop) {
+      return;
+    }
+
+    auto [szKey, hdrBuffer] = std::move(m_lstPending.front());
+    m_lstPending.pop_front();
+    lock.unlock();
+    vBuild(szKey, hdrBuffer, m_bStop);
+    lock.lock();
+    m_setKeys.erase(szKey);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+void IblCacheWriter::vBuild(const std::string& szKey,
+                            const std::vector<uint8_t>& hdrBuffer,
+                            const std::atomic<bool>& bStop) {
+  const auto buildStart = std::chrono::steady_clock::now();
+
+  std::vector<uint8_t> ktx;
+  try {
+    ktx = IblCache::vecPrefilter(hdrBuffer, bStop);
+  } catch (const std::exception& e) {
+    spdlog::error("IBL cache: prefilter failed: {}", e.what());
+  }
+  if (ktx.empty()) {
+    return;
+  }
+
+  const auto path = IblCache::cachePath(szKey);
+  std::error_code error;
+  std::filesystem::create_directories(path.parent_path(), error);
+
+  // Written next to the target and renamed, so a reader never sees a
+  // partial file.
+  auto tempPath = path;
+  tempPath += ".tmp";
+  std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(ktx.data()),
+            static_cast<std::streamsize>(ktx.size()));
+  out.close();
+  if (out) {
+    std::filesystem::rename(tempPath, path, error);
+  }
+
+  const std::chrono::duration<float, std::milli> buildTime =
+      std::chrono::steady_clock::now() - buildStart;
+  spdlog::info("IBL cache: wrote {} ({} KiB) in {:.0f} ms", path.c_str(),
+               ktx.size() / 1024, buildTime.count());
+}
+
+}  // namespace plugin_filament_view
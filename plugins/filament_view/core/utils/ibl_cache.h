@@ -0,0 +1,137 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <filament/Engine.h>
+#include <filament/IndirectLight.h>
+#include <filament/Texture.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Loads KTX environments and keeps an on-disk cache of prefiltered image
+// based lighting, so an HDR environment only goes through the specular
+// prefilter once per device.
+//
+// Cache entries are cmgen style KTX1 files (prefiltered reflection cubemap
+// with the irradiance spherical harmonics in the "sh" metadata), keyed by a
+// hash of the source HDR and the filter settings.
+class IblCache {
+ public:
+  // Cube map from a KTX1 or KTX2 buffer, for skyboxes and reflections.
+  // Returns nullptr if the buffer isn't a cube map we can read.
+  static ::filament::Texture* poCreateCubemapFromKtx(
+      ::filament::Engine* engine,
+      const std::vector<uint8_t>& buffer);
+
+  // Indirect light from a KTX1 or KTX2 buffer. Spherical harmonics are used
+  // when the file carries them (KTX1 from cmgen), otherwise Filament derives
+  // irradiance from the reflections.
+  static ::filament::IndirectLight* poCreateIndirectLightFromKtx(
+      ::filament::Engine* engine,
+      const std::vector<uint8_t>& buffer,
+      float fIntensity);
+
+  [[nodiscard]] static std::string szCacheKey(
+      const std::vector<uint8_t>& hdrBuffer);
+
+  // Cache key of an HDR file from an earlier load, found by its path, size
+  // and write time, so an unchanged file is neither read nor hashed.
+  // Returns nullopt when the file changed or was never recorded.
+  [[nodiscard]] static std::optional<std::string> oszFindKeyForFile(
+      const std::string& szPath);
+
+  // Records szKey as the cache key of the HDR file at szPath.
+  static void vRecordKeyForFile(const std::string& szPath,
+                                const std::string& szKey);
+
+  // Returns nullptr on a cache miss.
+  static ::filament::IndirectLight* poLoadCached(::filament::Engine* engine,
+                                                 const std::string& szKey,
+                                                 float fIntensity);
+
+  friend class IblCacheWriter;
+
+ private:
+  // Reflection cube map size and filter settings; part of the cache key.
+  static constexpr uint32_t kCubemapSize = 256;
+  static constexpr uint32_t kMinLevelSize = 16;
+  static constexpr uint32_t kSampleCount = 1024;
+  // Bump when the cache file layout changes.
+  static constexpr uint32_t kCacheVersion = 1;
+  // The build runs next to rendering, keep it from taking every core.
+  static constexpr size_t kPrefilterThreads = 2;
+
+  static std::filesystem::path cachePath(const std::string& szKey);
+  // Where the key recorded for an HDR file with this header hash lives.
+  static std::filesystem::path fileKeyPath(const std::string& szPath);
+
+  // Returns an empty buffer on failure, or once bStop is set.
+  static std::vector<uint8_t> vecPrefilter(
+      const std::vector<uint8_t>& hdrBuffer,
+      const std::atomic<bool>& bStop);
+};
+
+// Builds IblCache entries one at a time on a low priority worker thread,
+// started on first use. vStop, or destroying the writer, abandons the
+// queue, stops the build in progress between roughness levels and joins
+// the thread; a stopped writer ignores further requests.
+class IblCacheWriter {
+ public:
+  IblCacheWriter() = default;
+  ~IblCacheWriter();
+
+  // Disallow copy and assign.
+  IblCacheWriter(const IblCacheWriter&) = delete;
+  IblCacheWriter& operator=(const IblCacheWriter&) = delete;
+
+  // Queues the CPU prefilter of hdrBuffer and the write of its cache entry.
+  // Does nothing if the entry file exists or is already queued.
+  void vStoreAsync(const std::string& szKey, std::vector<uint8_t> hdrBuffer);
+
+  void vStop();
+
+ private:
+  // The build competes with rendering for the CPU; it gets the lowest
+  // priority, and the threads of its job system inherit it.
+  static constexpr int kWorkerNiceValue = 19;
+
+  std::mutex m_oMutex;
+  std::condition_variable m_oWake;
+  std::deque<std::pair<std::string, std::vector<uint8_t>>> m_lstPending;
+  // Queued or being built.
+  std::set<std::string> m_setKeys;
+  std::atomic<bool> m_bStop{false};
+  std::thread m_oWorker;
+
+  void vRun();
+  static void vBuild(const std::string& szKey,
+                     const std::vector<uint8_t>& hdrBuffer,
+                     const std::atomic<bool>& bStop);
+};
+
+}  // namespace plugin_filament_view
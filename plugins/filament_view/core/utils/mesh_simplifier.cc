@@ -0,0 +1,414 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mesh_simplifier.h"
+
+#include <meshoptimizer.h>
+#include <plugins/common/common.h>
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <string>
+
+namespace plugin_filament_view {
+
+namespace {
+
+constexpr uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+constexpr uint32_t kGlbVersion = 2;
+constexpr uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+constexpr uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+constexpr size_t kGlbHeaderSize = 12;
+constexpr size_t kGlbChunkHeaderSize = 8;
+
+constexpr unsigned kGltfModeTriangles = 4;
+constexpr unsigned kGltfUnsignedByte = 5121;
+constexpr unsigned kGltfUnsignedShort = 5123;
+constexpr unsigned kGltfUnsignedInt = 5125;
+constexpr unsigned kGltfFloat = 5126;
+
+// Allowed deviation relative to the mesh extents. Reduced levels are only
+// shown when small on screen, so this can be fairly generous.
+constexpr float kSimplifyTargetError = 0.02f;
+
+struct GlbChunks {
+  std::string szJson;
+  const uint8_t* pBin = nullptr;
+  size_t nBinSize = 0;
+};
+
+// Where an accessor's elements live inside the BIN chunk.
+struct AccessorView {
+  size_t nOffset = 0;
+  size_t nCount = 0;
+  size_t nStride = 0;
+  unsigned nComponentType = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////
+uint32_t nReadU32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////////
+void vAppendU32(std::vector<uint8_t>& out, const uint32_t value) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(value));
+}
+
+////////////////////////////////////////////////////////////////////////////
+unsigned nGetUint(const rapidjson::Value& object,
+                  const char* key,
+                  const unsigned defaultValue) {
+  if (!object.IsObject()) {
+    return defaultValue;
+  }
+  const auto it = object.FindMember(key);
+  if (it == object.MemberEnd() || !it->value.IsUint()) {
+    return defaultValue;
+  }
+  return it->value.GetUint();
+}
+
+////////////////////////////////////////////////////////////////////////////
+bool bSplitGlb(const std::vector<uint8_t>& glb, GlbChunks* chunks) {
+  if (glb.size() < kGlbHeaderSize + kGlbChunkHeaderSize ||
+      nReadU32(glb.data()) != kGlbMagic) {
+    return false;
+  }
+
+  size_t offset = kGlbHeaderSize;
+  while (offset + kGlbChunkHeaderSize <= glb.size()) {
+    const size_t length = nReadU32(&glb[offset]);
+    const uint32_t type = nReadU32(&glb[offset + 4]);
+    offset += kGlbChunkHeaderSize;
+    if (offset + length > glb.size()) {
+      return false;
+    }
+
+    if (type == kGlbChunkJson) {
+      chunks->szJson.assign(reinterpret_cast<const char*>(&glb[offset]),
+                            length);
+    } else if (type == kGlbChunkBin && chunks->pBin == nullptr) {
+      chunks->pBin = &glb[offset];
+      chunks->nBinSize = length;
+    }
+    offset += length;
+  }
+
+  return !chunks->szJson.empty();
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t nComponentSize(const unsigned componentType) {
+  switch (componentType) {
+    case kGltfUnsignedByte:
+      return 1;
+    case kGltfUnsignedShort:
+      return 2;
+    case kGltfUnsignedInt:
+    case kGltfFloat:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Only plain (non sparse) accessors into the GLB's own BIN chunk resolve.
+bool bResolveAccessor(const rapidjson::Document& doc,
+                      const unsigned accessorIndex,
+                      const size_t nBinSize,
+                      AccessorView* view) {
+  if (!doc.HasMember("accessors") || !doc["accessors"].IsArray() ||
+      !doc.HasMember("bufferViews") || !doc["bufferViews"].IsArray()) {
+    return false;
+  }
+  const auto& accessors = doc["accessors"];
+  if (accessorIndex >= accessors.Size()) {
+    return false;
+  }
+  const auto& accessor = accessors[accessorIndex];
+  if (!accessor.IsObject() || accessor.HasMember("sparse") ||
+      !accessor.HasMember("type") || !accessor["type"].IsString()) {
+    return false;
+  }
+
+  const unsigned bufferViewIndex = nGetUint(accessor, "bufferView", ~0u);
+  const auto& bufferViews = doc["bufferViews"];
+  if (bufferViewIndex >= bufferViews.Size()) {
+    return false;
+  }
+  const auto& bufferView = bufferViews[bufferViewIndex];
+  if (nGetUint(bufferView, "buffer", 0) != 0) {
+    return false;
+  }
+
+  const std::string szType = accessor["type"].GetString();
+  size_t nComponents;
+  if (szType == "SCALAR") {
+    nComponents = 1;
+  } else if (szType == "VEC3") {
+    nComponents = 3;
+  } else {
+    return false;
+  }
+
+  view->nComponentType = nGetUint(accessor, "componentType", 0);
+  const size_t nElementSize =
+      nComponentSize(view->nComponentType) * nComponents;
+  if (nElementSize == 0) {
+    return false;
+  }
+
+  view->nCount = nGetUint(accessor, "count", 0);
+  view->nStride = nGetUint(bufferView, "byteStride", 0);
+  if (view->nStride == 0) {
+    view->nStride = nElementSize;
+  }
+  view->nOffset = static_cast<size_t>(nGetUint(bufferView, "byteOffset", 0)) +
+                  nGetUint(accessor, "byteOffset", 0);
+
+  return view->nCount > 0 &&
+         view->nOffset + view->nStride * (view->nCount - 1) + nElementSize <=
+             nBinSize;
+}
+
+////////////////////////////////////////////////////////////////////////////
+template <typename Fn>
+void vForEachTrianglePrimitive(rapidjson::Document& doc, Fn&& fn) {
+  if (!doc.HasMember("meshes") || !doc["meshes"].IsArray()) {
+    return;
+  }
+  for (auto& mesh : doc["meshes"].GetArray()) {
+    if (!mesh.IsObject() || !mesh.HasMember("primitives") ||
+        !mesh["primitives"].IsArray()) {
+      continue;
+    }
+    for (auto& primitive : mesh["primitives"].GetArray()) {
+      if (nGetUint(primitive, "mode", kGltfModeTriangles) ==
+          kGltfModeTriangles) {
+        fn(primitive);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t nPrimitiveTriangleCount(const rapidjson::Document& doc,
+                               const rapidjson::Value& primitive) {
+  if (!doc.HasMember("accessors") || !doc["accessors"].IsArray()) {
+    return 0;
+  }
+  const auto& accessors = doc["accessors"];
+
+  unsigned accessorIndex = nGetUint(primitive, "indices", ~0u);
+  if (accessorIndex == ~0u && primitive.HasMember("attributes")) {
+    accessorIndex = nGetUint(primitive["attributes"], "POSITION", ~0u);
+  }
+  if (accessorIndex >= accessors.Size()) {
+    return 0;
+  }
+  return nGetUint(accessors[accessorIndex], "count", 0) / 3;
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<uint32_t> MeshSimplifier::vecSimplifyIndices(
+    const float* positions,
+    const size_t vertexCount,
+    const size_t vertexStride,
+    const uint32_t* indices,
+    const size_t indexCount,
+    const float fTriangleRatio) {
+  std::vector<uint32_t> result(indices, indices + indexCount);
+  if (indexCount < 6 || fTriangleRatio >= 1.0f) {
+    return result;
+  }
+
+  const size_t nTargetIndexCount = std::max<size_t>(
+      3, static_cast<size_t>(static_cast<float>(indexCount / 3) *
+                             fTriangleRatio) *
+             3);
+
+  const size_t nSimplifiedCount = meshopt_simplify(
+      result.data(), indices, indexCount, positions, vertexCount, vertexStride,
+      nTargetIndexCount, kSimplifyTargetError, 0, nullptr);
+  if (nSimplifiedCount == 0) {
+    result.assign(indices, indices + indexCount);
+    return result;
+  }
+
+  result.resize(nSimplifiedCount);
+  meshopt_optimizeVertexCache(result.data(), result.data(), result.size(),
+                              vertexCount);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<uint8_t> MeshSimplifier::vecSimplifyGlb(
+    const std::vector<uint8_t>& glb,
+    const float fTriangleRatio,
+    size_t* pnTriangleCount) {
+  GlbChunks chunks;
+  if (!bSplitGlb(glb, &chunks)) {
+    spdlog::error("MeshSimplifier: buffer is not a valid glb.");
+    return {};
+  }
+
+  rapidjson::Document doc;
+  doc.Parse(chunks.szJson.c_str(), chunks.szJson.size());
+  if (doc.HasParseError() || !doc.IsObject()) {
+    spdlog::error("MeshSimplifier: failed to parse glb json chunk.");
+    return {};
+  }
+
+  std::vector<uint8_t> bin(chunks.pBin, chunks.pBin + chunks.nBinSize);
+  std::set<unsigned> simplifiedAccessors;
+  std::vector<uint32_t> indices;
+  size_t nTriangleCount = 0;
+
+  vForEachTrianglePrimitive(doc, [&](rapidjson::Value& primitive) {
+    const unsigned indicesAccessor = nGetUint(primitive, "indices", ~0u);
+    const unsigned positionAccessor =
+        primitive.HasMember("attributes")
+            ? nGetUint(primitive["attributes"], "POSITION", ~0u)
+            : ~0u;
+
+    AccessorView indexView;
+    AccessorView positionView;
+    // Draco compressed primitives don't have their data in the BIN chunk in
+    // a form we can rewrite, and shared index accessors are only reduced once.
+    if ((primitive.HasMember("extensions") &&
+         primitive["extensions"].HasMember("KHR_draco_mesh_compression")) ||
+        !simplifiedAccessors.insert(indicesAccessor).second ||
+        !bResolveAccessor(doc, indicesAccessor, bin.size(), &indexView) ||
+        !bResolveAccessor(doc, positionAccessor, bin.size(), &positionView) ||
+        positionView.nComponentType != kGltfFloat ||
+        indexView.nComponentType == kGltfFloat) {
+      nTriangleCount += nPrimitiveTriangleCount(doc, primitive);
+      return;
+    }
+
+    indices.resize(indexView.nCount);
+    for (size_t i = 0; i < indexView.nCount; ++i) {
+      const uint8_t* src = &bin[indexView.nOffset + i * indexView.nStride];
+      switch (indexView.nComponentType) {
+        case kGltfUnsignedByte:
+          indices[i] = *src;
+          break;
+        case kGltfUnsignedShort: {
+          uint16_t value;
+          std::memcpy(&value, src, sizeof(value));
+          indices[i] = value;
+          break;
+        }
+        default:
+          indices[i] = nReadU32(src);
+          break;
+      }
+      if (indices[i] >= positionView.nCount) {
+        spdlog::warn("MeshSimplifier: index out of range, skipping primitive.");
+        nTriangleCount += indexView.nCount / 3;
+        return;
+      }
+    }
+
+    const auto simplified = vecSimplifyIndices(
+        reinterpret_cast<const float*>(&bin[positionView.nOffset]),
+        positionView.nCount, positionView.nStride, indices.data(),
+        indices.size(), fTriangleRatio);
+
+    // Simplified lists are never longer than the source, so they fit in the
+    // same bufferView region.
+    for (size_t i = 0; i < simplified.size(); ++i) {
+      uint8_t* dst = &bin[indexView.nOffset + i * indexView.nStride];
+      switch (indexView.nComponentType) {
+        case kGltfUnsignedByte:
+          *dst = static_cast<uint8_t>(simplified[i]);
+          break;
+        case kGltfUnsignedShort: {
+          const auto value = static_cast<uint16_t>(simplified[i]);
+          std::memcpy(dst, &value, sizeof(value));
+          break;
+        }
+        default:
+          std::memcpy(dst, &simplified[i], sizeof(uint32_t));
+          break;
+      }
+    }
+    doc["accessors"][indicesAccessor]["count"].SetUint(
+        static_cast<unsigned>(simplified.size()));
+    nTriangleCount += simplified.size() / 3;
+  });
+
+  rapidjson::StringBuffer jsonBuffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(jsonBuffer);
+  doc.Accept(writer);
+
+  std::string szJson(jsonBuffer.GetString(), jsonBuffer.GetSize());
+  // Chunks must stay 4 byte aligned; the spec pads json with spaces.
+  szJson.resize((szJson.size() + 3) & ~static_cast<size_t>(3), ' ');
+
+  std::vector<uint8_t> out;
+  out.reserve(kGlbHeaderSize + 2 * kGlbChunkHeaderSize + szJson.size() +
+              bin.size());
+  vAppendU32(out, kGlbMagic);
+  vAppendU32(out, kGlbVersion);
+  vAppendU32(out, 0);  // total length, patched below
+  vAppendU32(out, static_cast<uint32_t>(szJson.size()));
+  vAppendU32(out, kGlbChunkJson);
+  out.insert(out.end(), szJson.begin(), szJson.end());
+  if (!bin.empty()) {
+    vAppendU32(out, static_cast<uint32_t>(bin.size()));
+    vAppendU32(out, kGlbChunkBin);
+    out.insert(out.end(), bin.begin(), bin.end());
+  }
+  const auto nTotal = static_cast<uint32_t>(out.size());
+  std::memcpy(&out[8], &nTotal, sizeof(nTotal));
+
+  if (pnTriangleCount != nullptr) {
+    *pnTriangleCount = nTriangleCount;
+  }
+  return out;
+}
+
+////////////////////////////////////////////////////////////////////////////
+size_t MeshSimplifier::nCountGlbTriangles(const std::vector<uint8_t>& glb) {
+  GlbChunks chunks;
+  if (!bSplitGlb(glb, &chunks)) {
+    return 0;
+  }
+
+  rapidjson::Document doc;
+  doc.Parse(chunks.szJson.c_str(), chunks.szJson.size());
+  if (doc.HasParseError() || !doc.IsObject()) {
+    return 0;
+  }
+
+  size_t nTriangleCount = 0;
+  vForEachTrianglePrimitive(doc, [&](const rapidjson::Value& primitive) {
+    nTriangleCount += nPrimitiveTriangleCount(doc, primitive);
+  });
+  return nTriangleCount;
+}
+
+}  // namespace plugin_filament_view
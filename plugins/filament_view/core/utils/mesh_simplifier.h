@@ -0,0 +1,49 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace plugin_filament_view {
+
+// Wrappers around meshoptimizer used to build reduced detail levels.
+class MeshSimplifier {
+ public:
+  // Returns a reduced index list over the same vertices, aiming for
+  // fTriangleRatio of the source triangles. Returns the source indices when
+  // they can't be reduced.
+  static std::vector<uint32_t> vecSimplifyIndices(const float* positions,
+                                                  size_t vertexCount,
+                                                  size_t vertexStride,
+                                                  const uint32_t* indices,
+                                                  size_t indexCount,
+                                                  float fTriangleRatio);
+
+  // Rewrites the index data of every triangle primitive in a GLB blob with a
+  // simplified version. Vertex data, materials and node layout are left as is
+  // so the result loads through gltfio like any authored variant. Returns an
+  // empty buffer if the blob can't be parsed.
+  static std::vector<uint8_t> vecSimplifyGlb(const std::vector<uint8_t>& glb,
+                                             float fTriangleRatio,
+                                             size_t* pnTriangleCount);
+
+  // Total triangles over all triangle primitives in a GLB blob.
+  static size_t nCountGlbTriangles(const std::vector<uint8_t>& glb);
+};
+
+}  // namespace plugin_filament_view
@@ -16,15 +16,22 @@
 
 #include "filament_view_plugin.h"
 
+#include <core/scene/engine_profile.h>
 #include <core/scene/serialization/scene_text_deserializer.h>
+#include <core/systems/derived/animation_system.h>
 #include <core/systems/derived/collision_system.h>
 #include <core/systems/derived/debug_lines_system.h>
 #include <core/systems/derived/filament_system.h>
 #include <core/systems/derived/indirect_light_system.h>
 #include <core/systems/derived/light_system.h>
+#include <core/systems/derived/lod_system.h>
 #include <core/systems/derived/model_system.h>
+#include <core/systems/derived/resource_accounting_system.h>
+#include <core/systems/derived/scene_patch_system.h>
+#include <core/systems/derived/scene_snapshot_system.h>
 #include <core/systems/derived/shape_system.h>
 #include <core/systems/derived/skybox_system.h>
+#include <core/systems/derived/transform_system.h>
 #include <core/systems/derived/view_target_system.h>
 #include <core/systems/ecsystems_manager.h>
 #include <messages.g.h>
@@ -45,36 +52,49 @@ bool m_bHasSetupRegistrar = false;
 void RunOnceCheckAndInitializeECSystems() {
   const auto ecsManager = ECSystemManager::GetInstance();
 
-  if (ecsManager->getRunState() != ECSystemManager::RunState::NotInitialized) {
+  if (!ecsManager->bBeginInitialization()) {
     return;
   }
 
   // Get the strand from the ECSystemManager
   const auto& strand = *ecsManager->GetStrand();
 
-  std::promise<void> initPromise;
-  const std::future<void> initFuture = initPromise.get_future();
+  std::promise<void> addedPromise;
+  const std::future<void> addedFuture = addedPromise.get_future();
 
-  // Post the initialization code to the strand
-  post(strand, [=, &initPromise]() mutable {
+  // Only adding the systems is waited for, so that messages routed from here
+  // on reach them. Initializing them, engine creation above all, carries on
+  // on the strand while this thread parses the scene; whatever is routed in
+  // the meantime is handled once that is done.
+  post(strand, [=, &addedPromise]() mutable {
     // Add systems to the ECSystemManager
     ecsManager->vAddSystem(std::move(std::make_unique<FilamentSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<DebugLinesSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<CollisionSystem>()));
+    // Ahead of the model and shape systems, so patched transforms (and the
+    // instance transforms of their subtrees) are uploaded in the same frame.
+    ecsManager->vAddSystem(std::move(std::make_unique<ScenePatchSystem>()));
+    ecsManager->vAddSystem(std::move(std::make_unique<TransformSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<ModelSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<MaterialSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<ShapeSystem>()));
+    ecsManager->vAddSystem(std::move(std::make_unique<LodSystem>()));
+    ecsManager->vAddSystem(std::move(std::make_unique<AnimationSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<IndirectLightSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<SkyboxSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<LightSystem>()));
     ecsManager->vAddSystem(std::move(std::make_unique<ViewTargetSystem>()));
+    ecsManager->vAddSystem(
+        std::move(std::make_unique<ResourceAccountingSystem>()));
+    ecsManager->vAddSystem(std::move(std::make_unique<SceneSnapshotSystem>()));
 
-    ecsManager->vInitSystems();
+    addedPromise.set_value();
 
-    initPromise.set_value();
+    ecsManager->vInitSystems();
   });
 
-  initFuture.wait();
+  addedFuture.wait();
+  ecsManager->vLogStartupPhase("Systems added");
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -94,23 +114,20 @@ void DeserializeDataAndSetupMessageChannels(
   // Get the strand from the ECSystemManager
   const auto& strand = *ecsManager->GetStrand();
 
-  std::promise<void> initPromise;
-  const std::future<void> initFuture = initPromise.get_future();
-
   // Safeguarded to only be called once no matter how many times this method is
   // called.
   if (postSetupDeserializer == nullptr) {
-    post(strand, [=, &initPromise]() mutable {
-      sceneTextDeserializer = std::make_unique<SceneTextDeserializer>(params);
-      postSetupDeserializer = sceneTextDeserializer.get();
+    // Parsing doesn't touch filament, so it runs here, alongside the system
+    // initialization on the strand.
+    sceneTextDeserializer = std::make_unique<SceneTextDeserializer>(params);
+    postSetupDeserializer = sceneTextDeserializer.get();
+    ecsManager->vLogStartupPhase("Scene parsed");
 
+    post(strand, [] {
       // making sure this is only called once!
       postSetupDeserializer->vRunPostSetupLoad();
-
-      initPromise.set_value();
+      ECSystemManager::GetInstance()->vLogStartupPhase("Scene set up");
     });
-
-    initFuture.wait();
   }
 
   // Ok to be called infinite times.
@@ -149,6 +166,13 @@ void FilamentViewPlugin::RegisterWithRegistrar(
     }
   }*/
 
+  // The engine is created once, with the first view.
+  if (ecsManager->getRunState() == ECSystemManager::RunState::NotInitialized) {
+    if (const auto profile = EngineProfile::oFromCreationParams(params)) {
+      ecsManager->setConfigValue(kEngineProfile, *profile);
+    }
+  }
+
   // Safeguarded inside
   RunOnceCheckAndInitializeECSystems();
 
@@ -240,8 +264,19 @@ FilamentViewPlugin::~FilamentViewPlugin() {
 
 //////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::ChangeAnimationByIndex(
-    int32_t /* index */,
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    const int32_t index,
+    const std::string guid,
+    const bool loop,
+    const double crossFadeSeconds,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage animationData;
+  animationData.addData(ECSMessageType::ChangeAnimationByIndex, index);
+  animationData.addData(ECSMessageType::ChangeAnimationWhichGuid, guid);
+  animationData.addData(ECSMessageType::ChangeAnimationLoop, loop);
+  animationData.addData(ECSMessageType::ChangeAnimationCrossFadeSeconds,
+                        static_cast<float>(crossFadeSeconds));
+  ECSystemManager::GetInstance()->vRouteMessage(animationData);
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::ChangeDirectLightByIndex(
@@ -277,6 +312,15 @@ void FilamentViewPlugin::ToggleDebugCollidableViewsInScene(
   ECSystemManager::GetInstance()->vRouteMessage(toggleMessage);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::ChangePickingMode(
+    std::string szValue,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage pickingModeMessage;
+  pickingModeMessage.addData(ECSMessageType::ChangePickingMode, szValue);
+  ECSystemManager::GetInstance()->vRouteMessage(pickingModeMessage);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::ChangeCameraMode(
     const std::string szValue,
@@ -313,6 +357,50 @@ void FilamentViewPlugin::ChangeViewQualitySettings(
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::ConfigureQualityGovernor(
+    const bool enabled,
+    const double targetFps,
+    std::vector<std::string> pinned,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  QualityGovernor::Config config;
+  config.bEnabled = enabled;
+  config.fTargetFps = static_cast<float>(targetFps);
+  for (const auto& name : pinned) {
+    if (const auto feature = QualityGovernor::oFeatureFromName(name)) {
+      config.nPinnedMask |= 1u << static_cast<uint32_t>(*feature);
+    } else {
+      spdlog::warn("ConfigureQualityGovernor: unknown feature {}", name);
+    }
+  }
+
+  ECSMessage governorConfig;
+  governorConfig.addData(ECSMessageType::ConfigureQualityGovernor, config);
+  ECSystemManager::GetInstance()->vRouteMessage(governorConfig);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::RequestResourceUsage(
+    std::string szDumpPath,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage usageRequest;
+  usageRequest.addData(ECSMessageType::RequestResourceUsage,
+                       std::move(szDumpPath));
+  ECSystemManager::GetInstance()->vRouteMessage(usageRequest);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::SetResourceBudget(
+    const double budgetMB,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage budget;
+  budget.addData(ECSMessageType::SetResourceBudget,
+                 budgetMB > 0.0
+                     ? static_cast<size_t>(budgetMB * 1024 * 1024)
+                     : size_t{0});
+  ECSystemManager::GetInstance()->vRouteMessage(budget);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::SetCameraRotation(
     const float fValue,
@@ -324,21 +412,76 @@ void FilamentViewPlugin::SetCameraRotation(
   viewTargetSystem->vSetCurrentCameraOrbitAngle(0, fValue);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::ApplyScenePatch(
+    flutter::EncodableList operations,
+    std::vector<std::string> transformGuids,
+    std::vector<float> transforms,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  // Shared so the payload isn't copied again on its way through the queue.
+  auto patch = std::make_shared<ScenePatch>();
+  patch->lstOperations = std::move(operations);
+  patch->lstTransformGuids = std::move(transformGuids);
+  patch->vecTransforms = std::move(transforms);
+
+  ECSMessage patchMessage;
+  patchMessage.addData(ECSMessageType::ApplyScenePatch, patch);
+  ECSystemManager::GetInstance()->vRouteMessage(patchMessage);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+void FilamentViewPlugin::SaveSceneSnapshot(
+    std::string szPath,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage snapshotRequest;
+  snapshotRequest.addData(ECSMessageType::SaveSceneSnapshot,
+                          std::move(szPath));
+  ECSystemManager::GetInstance()->vRouteMessage(snapshotRequest);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::ChangeAnimationByName(
-    std::string /* name */,
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    const std::string name,
+    const std::string guid,
+    const bool loop,
+    const double crossFadeSeconds,
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage animationData;
+  animationData.addData(ECSMessageType::ChangeAnimationByName, name);
+  animationData.addData(ECSMessageType::ChangeAnimationWhichGuid, guid);
+  animationData.addData(ECSMessageType::ChangeAnimationLoop, loop);
+  animationData.addData(ECSMessageType::ChangeAnimationCrossFadeSeconds,
+                        static_cast<float>(crossFadeSeconds));
+  ECSystemManager::GetInstance()->vRouteMessage(animationData);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// The animation getters all answer asynchronously with the full animation
+// state of every model, see AnimationSystem::SendAnimationInformationCallback.
 void FilamentViewPlugin::GetAnimationNames(
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    std::function<void(std::optional<FlutterError> reply)> /*result*/) {
+  ECSMessage infoRequest;
+  infoRequest.addData(ECSMessageType::RequestAnimationInfo, true);
+  ECSystemManager::GetInstance()->vRouteMessage(infoRequest);
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::GetAnimationCount(
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    std::function<void(std::optional<FlutterError> reply)> result) {
+  GetAnimationNames(std::move(result));
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::GetCurrentAnimationIndex(
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    std::function<void(std::optional<FlutterError> reply)> result) {
+  GetAnimationNames(std::move(result));
+}
 
+//////////////////////////////////////////////////////////////////////////////////////////
 void FilamentViewPlugin::GetAnimationNameByIndex(
-    std::function<void(std::optional<FlutterError> reply)> /* result */) {}
+    std::function<void(std::optional<FlutterError> reply)> result) {
+  GetAnimationNames(std::move(result));
+}
 
 void FilamentViewPlugin::ChangeSkyboxByAsset(
     std::string /* path */,
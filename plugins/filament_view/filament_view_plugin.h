@@ -80,6 +80,10 @@ class FilamentViewPlugin : public flutter::Plugin,
       bool value,
       std::function<void(std::optional<FlutterError> reply)> result) override;
 
+  void ChangePickingMode(
+      std::string szValue,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
   void ChangeCameraMode(
       std::string szValue,
       std::function<void(std::optional<FlutterError> reply)> result) override;
@@ -90,16 +94,46 @@ class FilamentViewPlugin : public flutter::Plugin,
   void ChangeViewQualitySettings(
       std::function<void(std::optional<FlutterError> reply)> result) override;
 
+  void ConfigureQualityGovernor(
+      bool enabled,
+      double targetFps,
+      std::vector<std::string> pinned,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
+  void RequestResourceUsage(
+      std::string szDumpPath,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
+  void SetResourceBudget(
+      double budgetMB,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
   void SetCameraRotation(
       float fValue,
       std::function<void(std::optional<FlutterError> reply)> result) override;
 
+  void ApplyScenePatch(
+      flutter::EncodableList operations,
+      std::vector<std::string> transformGuids,
+      std::vector<float> transforms,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
+  void SaveSceneSnapshot(
+      std::string szPath,
+      std::function<void(std::optional<FlutterError> reply)> result) override;
+
   void ChangeAnimationByIndex(
       int32_t index,
+      std::string guid,
+      bool loop,
+      double crossFadeSeconds,
       std::function<void(std::optional<FlutterError> reply)> result) override;
 
   void ChangeAnimationByName(
       std::string name,
+      std::string guid,
+      bool loop,
+      double crossFadeSeconds,
       std::function<void(std::optional<FlutterError> reply)> result) override;
 
   void GetAnimationNames(
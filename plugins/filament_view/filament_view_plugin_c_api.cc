@@ -58,12 +58,14 @@ void FilamentViewPluginCApiRegisterWithRegistrar(
       assetDirectory, engine, addListener, removeListener,
       platform_view_context);*/
 
-  // after we're done doing setup, kick off the run loops
+  // after we're done doing setup, kick off the run loops; they start posting
+  // frames once initialization on the strand is done.
   if (const auto ecsManager =
           plugin_filament_view::ECSystemManager::GetInstance();
       ecsManager->getRunState() ==
-      plugin_filament_view::ECSystemManager::RunState::Initialized) {
-    ecsManager->DebugPrint();
+          plugin_filament_view::ECSystemManager::RunState::Initializing ||
+      ecsManager->getRunState() ==
+          plugin_filament_view::ECSystemManager::RunState::Initialized) {
     ecsManager->StartRunLoop();
   }
 }
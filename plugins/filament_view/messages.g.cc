@@ -57,7 +57,44 @@ void FilamentViewApi::SetUp(flutter::BinaryMessenger* binary_messenger,
                                               result) {
         spdlog::trace("[{}]", methodCall.method_name());
 
-        if (methodCall.method_name() == kChangeAnimationByIndex) {
+        if (methodCall.method_name() == kChangeAnimationByIndex ||
+            methodCall.method_name() == kChangeAnimationByName) {
+          const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
+          int32_t index = 0;
+          std::string name;
+          std::string guid;
+          bool loop = true;
+          double crossFadeSeconds = 0.0;
+          for (const auto& [fst, snd] : *args) {
+            if (kChangeAnimationByIndexValue == std::get<std::string>(fst) &&
+                std::holds_alternative<int32_t>(snd)) {
+              index = std::get<int32_t>(snd);
+            } else if (kChangeAnimationByNameValue ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<std::string>(snd)) {
+              name = std::get<std::string>(snd);
+            } else if (kChangeAnimationGuid == std::get<std::string>(fst) &&
+                       std::holds_alternative<std::string>(snd)) {
+              guid = std::get<std::string>(snd);
+            } else if (kChangeAnimationLoop == std::get<std::string>(fst) &&
+                       std::holds_alternative<bool>(snd)) {
+              loop = std::get<bool>(snd);
+            } else if (kChangeAnimationCrossFadeSeconds ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<double>(snd)) {
+              crossFadeSeconds = std::get<double>(snd);
+            }
+          }
+          if (methodCall.method_name() == kChangeAnimationByIndex) {
+            api->ChangeAnimationByIndex(index, guid, loop, crossFadeSeconds,
+                                        nullptr);
+          } else {
+            api->ChangeAnimationByName(name, guid, loop, crossFadeSeconds,
+                                       nullptr);
+          }
+          result->Success();
+        } else if (methodCall.method_name() == kRequestAnimationInfo) {
+          api->GetAnimationNames(nullptr);
           result->Success();
         } else if (methodCall.method_name() == kChangeLightColorByIndex) {
           const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
@@ -101,6 +138,15 @@ void FilamentViewApi::SetUp(flutter::BinaryMessenger* binary_messenger,
             }
           }
           result->Success();
+        } else if (methodCall.method_name() == kChangePickingMode) {
+          const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
+          for (const auto& [fst, snd] : *args) {
+            if (kChangePickingModeValue == std::get<std::string>(fst) &&
+                std::holds_alternative<std::string>(snd)) {
+              api->ChangePickingMode(std::get<std::string>(snd), nullptr);
+            }
+          }
+          result->Success();
         } else if (methodCall.method_name() == kChangeCameraMode) {
           const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
           for (const auto& [fst, snd] : *args) {
@@ -123,9 +169,104 @@ void FilamentViewApi::SetUp(flutter::BinaryMessenger* binary_messenger,
             }
           }
           result->Success();
+        } else if (methodCall.method_name() == kApplyScenePatch) {
+          const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
+          EncodableList operations;
+          std::vector<std::string> transformGuids;
+          std::vector<float> transforms;
+          for (const auto& [fst, snd] : *args) {
+            if (kApplyScenePatchOperations == std::get<std::string>(fst) &&
+                std::holds_alternative<EncodableList>(snd)) {
+              operations = std::get<EncodableList>(snd);
+            } else if (kApplyScenePatchTransformGuids ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<EncodableList>(snd)) {
+              for (const auto& guid : std::get<EncodableList>(snd)) {
+                transformGuids.emplace_back(
+                    std::holds_alternative<std::string>(guid)
+                        ? std::get<std::string>(guid)
+                        : std::string());
+              }
+            } else if (kApplyScenePatchTransforms ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<std::vector<float>>(snd)) {
+              transforms = std::get<std::vector<float>>(snd);
+            }
+          }
+          api->ApplyScenePatch(std::move(operations), std::move(transformGuids),
+                               std::move(transforms), nullptr);
+          result->Success();
+        } else if (methodCall.method_name() == kSaveSceneSnapshot) {
+          std::string path;
+          if (const auto& args =
+                  std::get_if<EncodableMap>(methodCall.arguments())) {
+            for (const auto& [fst, snd] : *args) {
+              if (kSaveSceneSnapshotPath == std::get<std::string>(fst) &&
+                  std::holds_alternative<std::string>(snd)) {
+                path = std::get<std::string>(snd);
+              }
+            }
+          }
+          api->SaveSceneSnapshot(std::move(path), nullptr);
+          result->Success();
         } else if (methodCall.method_name() == kChangeQualitySettings) {
           api->ChangeViewQualitySettings(nullptr);
           result->Success();
+        } else if (methodCall.method_name() == kConfigureQualityGovernor) {
+          const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
+          bool enabled = false;
+          double targetFps = 60.0;
+          std::vector<std::string> pinned;
+          for (const auto& [fst, snd] : *args) {
+            if (kConfigureQualityGovernorEnabled ==
+                    std::get<std::string>(fst) &&
+                std::holds_alternative<bool>(snd)) {
+              enabled = std::get<bool>(snd);
+            } else if (kConfigureQualityGovernorTargetFps ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<double>(snd)) {
+              targetFps = std::get<double>(snd);
+            } else if (kConfigureQualityGovernorPinned ==
+                           std::get<std::string>(fst) &&
+                       std::holds_alternative<EncodableList>(snd)) {
+              for (const auto& name : std::get<EncodableList>(snd)) {
+                if (std::holds_alternative<std::string>(name)) {
+                  pinned.emplace_back(std::get<std::string>(name));
+                }
+              }
+            }
+          }
+          api->ConfigureQualityGovernor(enabled, targetFps, std::move(pinned),
+                                        nullptr);
+          result->Success();
+        } else if (methodCall.method_name() == kRequestResourceUsage) {
+          std::string dumpPath;
+          if (const auto& args =
+                  std::get_if<EncodableMap>(methodCall.arguments())) {
+            for (const auto& [fst, snd] : *args) {
+              if (kRequestResourceUsageDumpPath ==
+                      std::get<std::string>(fst) &&
+                  std::holds_alternative<std::string>(snd)) {
+                dumpPath = std::get<std::string>(snd);
+              }
+            }
+          }
+          api->RequestResourceUsage(std::move(dumpPath), nullptr);
+          result->Success();
+        } else if (methodCall.method_name() == kSetResourceBudget) {
+          const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
+          double budgetMB = 0.0;
+          for (const auto& [fst, snd] : *args) {
+            if (kSetResourceBudgetMB == std::get<std::string>(fst)) {
+              if (std::holds_alternative<double>(snd)) {
+                budgetMB = std::get<double>(snd);
+              } else if (std::holds_alternative<int32_t>(snd)) {
+                budgetMB = std::get<int32_t>(snd);
+              }
+            }
+          }
+          api->SetResourceBudget(budgetMB, nullptr);
+          result->Success();
         } else if (methodCall.method_name() == kCollisionRayRequest) {
           const auto& args = std::get_if<EncodableMap>(methodCall.arguments());
           filament::math::float3 origin(0);
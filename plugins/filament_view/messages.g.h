@@ -25,6 +25,7 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace plugin_filament_view {
 
@@ -117,6 +118,11 @@ class FilamentViewApi {
       bool value,
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
 
+  // szValue is kPickingModeCollidables or kPickingModeGpu.
+  virtual void ChangePickingMode(
+      std::string szValue,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
   virtual void ChangeCameraMode(
       std::string szValue,
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
@@ -127,16 +133,51 @@ class FilamentViewApi {
   virtual void ChangeViewQualitySettings(
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
 
+  // pinned holds feature names, see kConfigureQualityGovernorPinned.
+  virtual void ConfigureQualityGovernor(
+      bool enabled,
+      double targetFps,
+      std::vector<std::string> pinned,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
+  // An empty szDumpPath only sends the report over the resource_usage
+  // channel.
+  virtual void RequestResourceUsage(
+      std::string szDumpPath,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
+  virtual void SetResourceBudget(
+      double budgetMB,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
   virtual void SetCameraRotation(
       float fValue,
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
 
+  // transforms holds packed records, see ScenePatch.
+  virtual void ApplyScenePatch(
+      flutter::EncodableList operations,
+      std::vector<std::string> transformGuids,
+      std::vector<float> transforms,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
+  // An empty szPath writes to the sceneSnapshot creation param.
+  virtual void SaveSceneSnapshot(
+      std::string szPath,
+      std::function<void(std::optional<FlutterError> reply)> result) = 0;
+
   virtual void ChangeAnimationByIndex(
       int32_t index,
+      std::string guid,
+      bool loop,
+      double crossFadeSeconds,
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
 
   virtual void ChangeAnimationByName(
       std::string name,
+      std::string guid,
+      bool loop,
+      double crossFadeSeconds,
       std::function<void(std::optional<FlutterError> reply)> result) = 0;
 
   virtual void GetAnimationNames(
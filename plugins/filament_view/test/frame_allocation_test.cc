@@ -0,0 +1,232 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Steady frames must not touch the heap.
+//
+// Builds a static scene of shapes on the noop backend, runs enough frames for
+// the frame arena and the systems' scratch containers to reach their high
+// water mark, then drives ECSystemManager::vUpdate for a number of frames and
+// fails if operator new was called during them. The counting operator new
+// is linked into this executable only (allocation_counting_new.cc).
+//
+// Usage: frame_allocation_test <dir with shape_unlit.filamat> [frames]
+
+#include <core/entity/derived/shapes/baseshape.h>
+#include <core/include/literals.h>
+#include <core/include/shapetypes.h>
+#include <core/scene/engine_profile.h>
+#include <core/systems/derived/collision_system.h>
+#include <core/systems/derived/filament_system.h>
+#include <core/systems/derived/lod_system.h>
+#include <core/systems/derived/material_system.h>
+#include <core/systems/derived/scene_patch_system.h>
+#include <core/systems/derived/shape_system.h>
+#include <core/systems/derived/transform_system.h>
+#include <core/systems/ecsystems_manager.h>
+#include <core/utils/allocation_counter.h>
+#include <asio/post.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using plugin_filament_view::ECSystemManager;
+using plugin_filament_view::ShapeType;
+
+namespace {
+
+constexpr float kFrameSeconds = 1.0f / 60.0f;
+constexpr int kWarmUpFrames = 120;
+constexpr int kDefaultFrames = 600;
+constexpr char kMaterialAsset[] = "shape_unlit.filamat";
+
+// Enough cubes of one material to be drawn as an instance batch.
+constexpr int kInstancedCubes = 48;
+constexpr int kParentSpheres = 4;
+constexpr int kChildrenPerSphere = 3;
+
+////////////////////////////////////////////////////////////////////////////
+flutter::EncodableMap oVector(const float x, const float y, const float z) {
+  return {{flutter::EncodableValue("x"), flutter::EncodableValue(double{x})},
+          {flutter::EncodableValue("y"), flutter::EncodableValue(double{y})},
+          {flutter::EncodableValue("z"), flutter::EncodableValue(double{z})}};
+}
+
+////////////////////////////////////////////////////////////////////////////
+flutter::EncodableMap oShapeParams(const std::string& szGuid,
+                                   const ShapeType eType,
+                                   const float x,
+                                   const float y,
+                                   const float z,
+                                   const std::string& szParentGuid = {}) {
+  using plugin_filament_view::kCenterPosition;
+  using plugin_filament_view::kGlobalGuid;
+  using plugin_filament_view::kMaterial;
+  using plugin_filament_view::kName;
+  using plugin_filament_view::kParentGuid;
+  using plugin_filament_view::kScale;
+  using plugin_filament_view::kShapeType;
+  using plugin_filament_view::kSize;
+
+  flutter::EncodableMap params{
+      {flutter::EncodableValue(kGlobalGuid), flutter::EncodableValue(szGuid)},
+      {flutter::EncodableValue(kName), flutter::EncodableValue(szGuid)},
+      {flutter::EncodableValue(kShapeType),
+       flutter::EncodableValue(static_cast<int32_t>(eType))},
+      {flutter::EncodableValue(kCenterPosition),
+       flutter::EncodableValue(oVector(x, y, z))},
+      {flutter::EncodableValue(kSize),
+       flutter::EncodableValue(oVector(1, 1, 1))},
+      {flutter::EncodableValue(kScale),
+       flutter::EncodableValue(oVector(1, 1, 1))},
+      {flutter::EncodableValue(kMaterial),
+       flutter::EncodableValue(flutter::EncodableMap{
+           {flutter::EncodableValue("assetPath"),
+            flutter::EncodableValue(kMaterialAsset)}})},
+  };
+  if (!szParentGuid.empty()) {
+    params[flutter::EncodableValue(kParentGuid)] =
+        flutter::EncodableValue(szParentGuid);
+  }
+  return params;
+}
+
+////////////////////////////////////////////////////////////////////////////
+std::vector<std::unique_ptr<plugin_filament_view::shapes::BaseShape>>
+lstBuildScene(const std::string& szAssetPath) {
+  using plugin_filament_view::ShapeSystem;
+
+  std::vector<flutter::EncodableMap> lstParams;
+  for (int i = 0; i < kInstancedCubes; ++i) {
+    lstParams.push_back(oShapeParams("cube_" + std::to_string(i),
+                                     ShapeType::Cube, static_cast<float>(i % 8),
+                                     0, static_cast<float>(i / 8)));
+  }
+  for (int i = 0; i < kParentSpheres; ++i) {
+    const auto szSphere = "sphere_" + std::to_string(i);
+    lstParams.push_back(oShapeParams(szSphere, ShapeType::Sphere,
+                                     static_cast<float>(i * 3), 4, 0));
+    for (int j = 0; j < kChildrenPerSphere; ++j) {
+      lstParams.push_back(oShapeParams(szSphere + "_plane_" + std::to_string(j),
+                                       ShapeType::Plane, 0,
+                                       static_cast<float>(j + 1), 0, szSphere));
+    }
+  }
+
+  // One collidable, so the collision system has something to keep.
+  using plugin_filament_view::kCollidable;
+  lstParams.front()[flutter::EncodableValue(kCollidable)] =
+      flutter::EncodableValue(flutter::EncodableMap{});
+
+  std::vector<std::unique_ptr<plugin_filament_view::shapes::BaseShape>>
+      lstShapes;
+  for (const auto& params : lstParams) {
+    if (auto shape = ShapeSystem::poDeserializeShapeFromData(szAssetPath,
+                                                             params)) {
+      lstShapes.push_back(std::move(shape));
+    }
+  }
+  return lstShapes;
+}
+
+////////////////////////////////////////////////////////////////////////////
+template <typename Function>
+void vRunOnStrand(ECSystemManager* ecsManager, Function&& function) {
+  std::promise<void> donePromise;
+  const std::future<void> doneFuture = donePromise.get_future();
+  asio::post(*ecsManager->GetStrand(), [&] {
+    function();
+    donePromise.set_value();
+  });
+  doneFuture.wait();
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////
+int main(const int argc, char** argv) {
+  using namespace plugin_filament_view;
+
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <asset dir> [frames]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string szAssetPath = argv[1];
+  const int nFrames = argc > 2 ? std::atoi(argv[2]) : kDefaultFrames;
+  if (!std::filesystem::exists(std::filesystem::path(szAssetPath) /
+                               kMaterialAsset)) {
+    std::cerr << kMaterialAsset << " not found in " << szAssetPath
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto ecsManager = ECSystemManager::GetInstance();
+  ecsManager->setConfigValue(kAssetPath, szAssetPath);
+  EngineProfile profile;
+  profile.eBackend = filament::Engine::Backend::NOOP;
+  ecsManager->setConfigValue(kEngineProfile, profile);
+  ecsManager->bBeginInitialization();
+
+  size_t nBefore = 0;
+  size_t nAfter = 0;
+  vRunOnStrand(ecsManager, [&] {
+    ecsManager->vAddSystem(std::make_unique<FilamentSystem>());
+    ecsManager->vAddSystem(std::make_unique<CollisionSystem>());
+    ecsManager->vAddSystem(std::make_unique<ScenePatchSystem>());
+    ecsManager->vAddSystem(std::make_unique<TransformSystem>());
+    ecsManager->vAddSystem(std::make_unique<MaterialSystem>());
+    ecsManager->vAddSystem(std::make_unique<ShapeSystem>());
+    ecsManager->vAddSystem(std::make_unique<LodSystem>());
+    ecsManager->vInitSystems();
+
+    // Materials are used as soon as they are loaded, nothing is held back
+    // waiting for a compile callback.
+    ecsManager
+        ->poGetSystemAs<MaterialSystem>(MaterialSystem::StaticGetTypeID(),
+                                        __FUNCTION__)
+        ->vBeginSceneEntry(false, false);
+
+    auto lstShapes = lstBuildScene(szAssetPath);
+    std::cout << lstShapes.size() << " shapes" << std::endl;
+    ecsManager
+        ->poGetSystemAs<ShapeSystem>(ShapeSystem::StaticGetTypeID(),
+                                     __FUNCTION__)
+        ->addShapesToScene(&lstShapes);
+
+    for (int i = 0; i < kWarmUpFrames; ++i) {
+      ecsManager->vUpdate(kFrameSeconds);
+    }
+
+    nBefore = nGetAllocationCount();
+    for (int i = 0; i < nFrames; ++i) {
+      ecsManager->vUpdate(kFrameSeconds);
+    }
+    nAfter = nGetAllocationCount();
+  });
+
+  ecsManager->vShutdownSystems();
+  vRunOnStrand(ecsManager, [] {});
+  ecsManager->StopRunLoop();
+
+  std::cout << nFrames << " frames after " << kWarmUpFrames
+            << " warm-up frames: " << nAfter - nBefore << " heap allocations"
+            << std::endl;
+  return nAfter == nBefore ? EXIT_SUCCESS : EXIT_FAILURE;
+}
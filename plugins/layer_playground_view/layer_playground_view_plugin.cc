@@ -17,6 +17,7 @@
 #include "layer_playground_view_plugin.h"
 
 #include <flutter/standard_message_codec.h>
+#include <flutter/standard_method_codec.h>
 
 #include "plugins/common/common.h"
 
@@ -46,6 +47,7 @@ void LayerPlaygroundViewPlugin::RegisterWithRegistrar(
       std::move(assetDirectory), engine, addListener, removeListener,
       platform_view_context);
 
+  plugin->SetupPresentationChannel(registrar->messenger());
   registrar->AddPlugin(std::move(plugin));
 }
 
@@ -100,6 +102,12 @@ LayerPlaygroundViewPlugin::LayerPlaygroundViewPlugin(
 
   wl_subsurface_set_desync(subsurface_);
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  presentation_feedback_ =
+      std::make_unique<plugin_common_wayland::PresentationFeedback>(display_);
+  last_presentation_report_ = std::chrono::steady_clock::now();
+#endif
+
   eglMakeCurrent(egl_display_, egl_surface_, egl_surface_, egl_context_);
   InitializeScene();
 
@@ -159,6 +167,10 @@ void LayerPlaygroundViewPlugin::on_dispose(bool /* hybrid */, void* data) {
     plugin->callback_ = nullptr;
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  plugin->presentation_feedback_.reset();
+#endif
+
   if (plugin->subsurface_) {
     wl_subsurface_destroy(plugin->subsurface_);
     plugin->subsurface_ = nullptr;
@@ -194,6 +206,15 @@ void LayerPlaygroundViewPlugin::on_frame(void* data,
     wl_callback_destroy(callback);
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  if (obj->presentation_feedback_) {
+    obj->presentation_feedback_->Dispatch();
+    // Attaches to the commit made by the buffer swap in DrawFrame.
+    obj->presentation_feedback_->Request(obj->surface_);
+    obj->ReportPresentation();
+  }
+#endif
+
   obj->DrawFrame(time);
 
   // Z-Order
@@ -212,6 +233,30 @@ void LayerPlaygroundViewPlugin::on_frame(void* data,
 const wl_callback_listener LayerPlaygroundViewPlugin::frame_listener = {
     .done = on_frame};
 
+void LayerPlaygroundViewPlugin::SetupPresentationChannel(
+    flutter::BinaryMessenger* messenger) {
+  presentation_channel_ = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "layer_playground_view/presentation/" + std::to_string(id_),
+      &flutter::StandardMethodCodec::GetInstance());
+}
+
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+void LayerPlaygroundViewPlugin::ReportPresentation() {
+  const auto now = std::chrono::steady_clock::now();
+  if (!presentation_channel_ || !presentation_feedback_->IsAvailable() ||
+      now - last_presentation_report_ < kPresentationReportInterval) {
+    return;
+  }
+  last_presentation_report_ = now;
+
+  presentation_channel_->InvokeMethod(
+      "presentationStats",
+      std::make_unique<flutter::EncodableValue>(
+          plugin_common_wayland::PresentationFeedback::Encode(
+              presentation_feedback_->TakeStats())));
+}
+#endif
+
 GLuint LoadShader(const GLchar* shaderSrc, const GLenum type) {
   // Create the shader object
   const GLuint shader = glCreateShader(type);
@@ -17,6 +17,7 @@
 #ifndef FLUTTER_PLUGIN_LAYER_PLAYGROUND_PLUGIN_H_
 #define FLUTTER_PLUGIN_LAYER_PLAYGROUND_PLUGIN_H_
 
+#include <chrono>
 #include <memory>
 
 #include <EGL/egl.h>
@@ -26,6 +27,9 @@
 #include <flutter/plugin_registrar.h>
 #include <wayland-client.h>
 #include <wayland-egl.h>
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+#include <plugins/common/wayland/presentation_feedback.h>
+#endif
 
 #include "flutter_desktop_engine_state.h"
 #include "flutter_homescreen.h"
@@ -89,6 +93,20 @@ class LayerPlaygroundViewPlugin : public flutter::Plugin, PlatformView {
   static void on_frame(void* data, wl_callback* callback, uint32_t time);
   static const wl_callback_listener frame_listener;
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  static constexpr std::chrono::seconds kPresentationReportInterval{1};
+  std::unique_ptr<plugin_common_wayland::PresentationFeedback>
+      presentation_feedback_;
+  std::chrono::steady_clock::time_point last_presentation_report_;
+#endif
+  std::unique_ptr<flutter::MethodChannel<>> presentation_channel_;
+
+  void SetupPresentationChannel(flutter::BinaryMessenger* messenger);
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  // Sends the presentation counts once per kPresentationReportInterval.
+  void ReportPresentation();
+#endif
+
   EGLDisplay egl_display_;
   wl_egl_window* egl_window_;
   int buffer_size_ = 32;
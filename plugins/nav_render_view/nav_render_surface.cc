@@ -2,6 +2,7 @@
 #include "nav_render_surface.h"
 
 #include <flutter/standard_message_codec.h>
+#include <flutter/standard_method_codec.h>
 #include <plugins/common/common.h>
 
 #include <utility>
@@ -30,6 +31,7 @@ void NavRenderSurface::RegisterWithRegistrar(
       id, std::move(viewType), direction, top, left, width, height, params,
       std::move(assetDirectory), engine, addListener, removeListener,
       platform_view_context);
+  plugin->SetupPresentationChannel(registrar->messenger());
   registrar->AddPlugin(std::move(plugin));
 }
 
@@ -147,6 +149,12 @@ NavRenderSurface::NavRenderSurface(int32_t id,
 
   wl_subsurface_set_desync(subsurface_);
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  presentation_feedback_ =
+      std::make_unique<plugin_common_wayland::PresentationFeedback>(display_);
+  last_presentation_report_ = std::chrono::steady_clock::now();
+#endif
+
   addListener(platformViewsContext_, id, &platform_view_listener_, this);
   SPDLOG_TRACE("--NavRenderSurface::NavRenderSurface");
 }
@@ -167,6 +175,15 @@ void NavRenderSurface::on_frame(void* data,
     wl_callback_destroy(callback);
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  if (obj->presentation_feedback_) {
+    obj->presentation_feedback_->Dispatch();
+    // Latency is counted from here, before the frame is drawn.
+    obj->presentation_feedback_->Request(obj->surface_);
+    obj->ReportPresentation();
+  }
+#endif
+
   obj->DrawFrame();
 
   if (obj->subsurface_ == nullptr)
@@ -185,6 +202,30 @@ void NavRenderSurface::on_frame(void* data,
   wl_surface_commit(obj->surface_);
 }
 
+void NavRenderSurface::SetupPresentationChannel(
+    flutter::BinaryMessenger* messenger) {
+  presentation_channel_ = std::make_unique<flutter::MethodChannel<>>(
+      messenger, "nav_render_view/presentation/" + std::to_string(id_),
+      &flutter::StandardMethodCodec::GetInstance());
+}
+
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+void NavRenderSurface::ReportPresentation() {
+  const auto now = std::chrono::steady_clock::now();
+  if (!presentation_channel_ || !presentation_feedback_->IsAvailable() ||
+      now - last_presentation_report_ < kPresentationReportInterval) {
+    return;
+  }
+  last_presentation_report_ = now;
+
+  presentation_channel_->InvokeMethod(
+      "presentationStats",
+      std::make_unique<flutter::EncodableValue>(
+          plugin_common_wayland::PresentationFeedback::Encode(
+              presentation_feedback_->TakeStats())));
+}
+#endif
+
 const wl_callback_listener NavRenderSurface::frame_listener = {.done =
                                                                    on_frame};
 
@@ -203,6 +244,10 @@ void NavRenderSurface::Dispose() {
     callback_ = nullptr;
   }
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  presentation_feedback_.reset();
+#endif
+
   if (subsurface_) {
     wl_subsurface_destroy(subsurface_);
     subsurface_ = nullptr;
@@ -3,6 +3,14 @@
 #include <wayland-client.h>
 #include <wayland-egl.h>
 
+#include <chrono>
+#include <memory>
+
+#include <flutter/method_channel.h>
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+#include <plugins/common/wayland/presentation_feedback.h>
+#endif
+
 #include "flutter_desktop_engine_state.h"
 #include "flutter_homescreen.h"
 #include "libnav_render.h"
@@ -86,6 +94,21 @@ class NavRenderSurface final : public PlatformView, public flutter::Plugin {
   PlatformViewRemoveListener removeListener_;
   const std::string flutterAssetsPath_;
 
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  static constexpr std::chrono::seconds kPresentationReportInterval{1};
+  std::unique_ptr<plugin_common_wayland::PresentationFeedback>
+      presentation_feedback_;
+  std::chrono::steady_clock::time_point last_presentation_report_;
+#endif
+  std::unique_ptr<flutter::MethodChannel<>> presentation_channel_;
+
+  void SetupPresentationChannel(flutter::BinaryMessenger* messenger);
+
+#if defined(ENABLE_PRESENTATION_FEEDBACK)
+  // Sends the presentation counts once per kPresentationReportInterval.
+  void ReportPresentation();
+#endif
+
   void DrawFrame();
 
   void Dispose();
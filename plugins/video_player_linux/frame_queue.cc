@@ -0,0 +1,173 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_queue.h"
+
+#include <plugins/common/common.h>
+#include <utility>
+
+namespace video_player_linux {
+
+namespace {
+
+GstClockTime GetRunningTime(GstElement* element) {
+  GstClock* clock = gst_element_get_clock(element);
+  if (clock == nullptr) {
+    return GST_CLOCK_TIME_NONE;
+  }
+  const GstClockTime now = gst_clock_get_time(clock);
+  gst_object_unref(clock);
+  const GstClockTime base_time = gst_element_get_base_time(element);
+  return now > base_time ? now - base_time : 0;
+}
+
+GstClockTime GetSampleRunningTime(GstSample* sample) {
+  const GstBuffer* buffer = gst_sample_get_buffer(sample);
+  const GstSegment* segment = gst_sample_get_segment(sample);
+  if (buffer == nullptr || segment == nullptr ||
+      !GST_BUFFER_PTS_IS_VALID(buffer)) {
+    return GST_CLOCK_TIME_NONE;
+  }
+  return gst_segment_to_running_time(segment, GST_FORMAT_TIME,
+                                     GST_BUFFER_PTS(buffer));
+}
+
+}  // namespace
+
+FrameQueue::FrameQueue(std::function<void()> on_frame_available)
+    : on_frame_available_(std::move(on_frame_available)) {}
+
+FrameQueue::~FrameQueue() {
+  Detach();
+  Flush();
+}
+
+void FrameQueue::Attach(GstElement* appsink) {
+  Detach();
+  sink_ = GST_ELEMENT(gst_object_ref(appsink));
+
+  // The sink keeps to the clock and drops late buffers with QoS, so audio
+  // sync doesn't depend on how fast the consumer takes frames.
+  g_object_set(sink_, "sync", TRUE, nullptr);
+  g_object_set(sink_, "qos", TRUE, nullptr);
+  g_object_set(sink_, "max-lateness", kMaxLateness, nullptr);
+  g_object_set(sink_, "max-buffers", static_cast<guint>(kMaxFrames), nullptr);
+  g_object_set(sink_, "drop", TRUE, nullptr);
+  g_object_set(sink_, "emit-signals", TRUE, nullptr);
+  new_sample_handler_id_ = g_signal_connect(
+      sink_, "new-sample", reinterpret_cast<GCallback>(OnNewSample), this);
+  GstPad* sink_pad = gst_element_get_static_pad(sink_, "sink");
+  flush_probe_id_ = gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+                                      OnSinkFlush, this, nullptr);
+  gst_object_unref(sink_pad);
+}
+
+void FrameQueue::Detach() {
+  if (sink_ == nullptr) {
+    return;
+  }
+  g_signal_handler_disconnect(G_OBJECT(sink_), new_sample_handler_id_);
+  GstPad* sink_pad = gst_element_get_static_pad(sink_, "sink");
+  gst_pad_remove_probe(sink_pad, flush_probe_id_);
+  gst_object_unref(sink_pad);
+  gst_object_unref(sink_);
+  sink_ = nullptr;
+  new_sample_handler_id_ = 0;
+  flush_probe_id_ = 0;
+}
+
+GstFlowReturn FrameQueue::OnNewSample(GstElement* appsink,
+                                      gpointer user_data) {
+  const auto obj = static_cast<FrameQueue*>(user_data);
+  GstSample* sample = nullptr;
+  g_signal_emit_by_name(appsink, "pull-sample", &sample);
+  if (sample == nullptr) {
+    return GST_FLOW_EOS;
+  }
+
+  GstSample* dropped = nullptr;
+  {
+    std::lock_guard lock(obj->mutex_);
+    if (obj->samples_.size() >= kMaxFrames) {
+      dropped = obj->samples_.front();
+      obj->samples_.pop_front();
+    }
+    obj->samples_.push_back(sample);
+  }
+  if (dropped != nullptr) {
+    gst_sample_unref(dropped);
+    ++obj->dropped_;
+    SPDLOG_TRACE("[VideoPlayer] queue full, dropped: {}",
+                 obj->dropped_.load());
+  }
+
+  if (obj->on_frame_available_) {
+    obj->on_frame_available_();
+  }
+  return GST_FLOW_OK;
+}
+
+GstSample* FrameQueue::TakeDue(GstElement* pipeline) {
+  const GstClockTime now = GetRunningTime(pipeline);
+
+  GstSample* sample;
+  bool more;
+  {
+    std::lock_guard lock(mutex_);
+    if (samples_.empty()) {
+      return nullptr;
+    }
+    // A frame is late once the one after it is due; it would only be on
+    // screen in place of the newer frame.
+    while (now != GST_CLOCK_TIME_NONE && samples_.size() > 1) {
+      const GstClockTime next = GetSampleRunningTime(samples_[1]);
+      if (next == GST_CLOCK_TIME_NONE || next > now) {
+        break;
+      }
+      gst_sample_unref(samples_.front());
+      samples_.pop_front();
+      ++dropped_;
+      SPDLOG_TRACE("[VideoPlayer] late frame, dropped: {}", dropped_.load());
+    }
+    sample = samples_.front();
+    samples_.pop_front();
+    more = !samples_.empty();
+  }
+  if (more && on_frame_available_) {
+    on_frame_available_();
+  }
+  return sample;
+}
+
+GstPadProbeReturn FrameQueue::OnSinkFlush(GstPad* /* pad */,
+                                          GstPadProbeInfo* info,
+                                          gpointer user_data) {
+  // Everything queued before the flush ends is from before the seek.
+  if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_FLUSH_STOP) {
+    static_cast<FrameQueue*>(user_data)->Flush();
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+void FrameQueue::Flush() {
+  std::lock_guard lock(mutex_);
+  for (const auto sample : samples_) {
+    gst_sample_unref(sample);
+  }
+  samples_.clear();
+}
+
+}  // namespace video_player_linux
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+extern "C" {
+#include <gst/gst.h>
+}
+
+namespace video_player_linux {
+
+/**
+ * @brief Decoded frames between an appsink and the texture pull, oldest first
+ *
+ * The streaming thread only appends and never waits for the consumer; a full
+ * queue drops its oldest frame. The consumer takes the frame that is due on
+ * the pipeline clock and drops the ones that are already late.
+ */
+class FrameQueue {
+ public:
+  static constexpr size_t kMaxFrames = 3;
+  // How late a buffer may reach the sink before it is dropped there.
+  static constexpr gint64 kMaxLateness = 20 * GST_MSECOND;
+
+  /**
+   * @brief Constructor
+   * @param[in] on_frame_available Called whenever a frame is ready to take,
+   * from the streaming thread or the consumer's
+   */
+  explicit FrameQueue(std::function<void()> on_frame_available);
+  ~FrameQueue();
+
+  FrameQueue(const FrameQueue&) = delete;
+  FrameQueue& operator=(const FrameQueue&) = delete;
+
+  /**
+   * @brief Sets an appsink up to keep to the clock and feed this queue
+   * @param[in] appsink Sink to configure and take the samples from
+   * @return void
+   * @relation
+   * gstreamer
+   */
+  void Attach(GstElement* appsink);
+
+  /**
+   * @brief Stops taking samples from the attached appsink
+   * @return void
+   * @relation
+   * gstreamer
+   */
+  void Detach();
+
+  /**
+   * @brief Takes the frame to show now, dropping frames that are late
+   * @param[in] pipeline Element whose clock and base time give "now"
+   * @return GstSample* Owned by the caller, nullptr if the queue is empty
+   * @relation
+   * gstreamer
+   */
+  GstSample* TakeDue(GstElement* pipeline);
+
+  /**
+   * @brief Drops all queued frames
+   * @return void
+   * @relation
+   * gstreamer
+   */
+  void Flush();
+
+  /**
+   * @brief Frames dropped so far, for being late or the queue being full
+   * @return uint64_t
+   */
+  [[nodiscard]] uint64_t dropped() const { return dropped_.load(); }
+
+ private:
+  std::function<void()> on_frame_available_;
+  std::mutex mutex_;
+  std::deque<GstSample*> samples_;
+  std::atomic<uint64_t> dropped_{};
+
+  GstElement* sink_{};
+  gulong new_sample_handler_id_{};
+  gulong flush_probe_id_{};
+
+  static GstFlowReturn OnNewSample(GstElement* appsink, gpointer user_data);
+
+  static GstPadProbeReturn OnSinkFlush(GstPad* pad,
+                                       GstPadProbeInfo* info,
+                                       gpointer user_data);
+};
+
+}  // namespace video_player_linux
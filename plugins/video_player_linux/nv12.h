@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <EGL/egl.h>
 #include <GLES3/gl3.h>
 #include <glib.h>
 
+#include <cstdint>
+#include <cstring>
+
 #include <plugins/common/common.h>
 
 namespace video_player_linux::nv12 {
@@ -58,21 +62,105 @@ static const GLchar* kFragmentSource = R"glsl(
   }
 )glsl";
 
+/**
+ * Saves the GL state the conversion touches and restores it on destruction.
+ * The conversion runs inside the compositor's context, which expects its
+ * own bindings to be left alone. Capabilities that could clip or blend the
+ * conversion are disabled for the lifetime of the scope.
+ */
+class ScopedGlState {
+ public:
+  ScopedGlState() {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_framebuffer_);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_framebuffer_);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertex_array_);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program_);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &array_buffer_);
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack_buffer_);
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment_);
+    glGetIntegerv(GL_UNPACK_ROW_LENGTH, &unpack_row_length_);
+    glGetIntegerv(GL_VIEWPORT, &viewport_[0]);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, &clear_color_[0]);
+    glGetBooleanv(GL_COLOR_WRITEMASK, &color_mask_[0]);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active_texture_);
+    for (GLuint unit = 0; unit < kTextureUnits; unit++) {
+      glActiveTexture(GL_TEXTURE0 + unit);
+      glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture_[unit]);
+      glGetIntegerv(GL_SAMPLER_BINDING, &sampler_[unit]);
+      glBindSampler(unit, 0);
+    }
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      enabled_[i] = glIsEnabled(kCapabilities[i]);
+      glDisable(kCapabilities[i]);
+    }
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+  }
+
+  ~ScopedGlState() {
+    for (size_t i = 0; i < kCapabilityCount; i++) {
+      if (enabled_[i]) {
+        glEnable(kCapabilities[i]);
+      }
+    }
+    for (GLuint unit = 0; unit < kTextureUnits; unit++) {
+      glActiveTexture(GL_TEXTURE0 + unit);
+      glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(texture_[unit]));
+      glBindSampler(unit, static_cast<GLuint>(sampler_[unit]));
+    }
+    glActiveTexture(static_cast<GLenum>(active_texture_));
+    glColorMask(color_mask_[0], color_mask_[1], color_mask_[2],
+                color_mask_[3]);
+    glClearColor(clear_color_[0], clear_color_[1], clear_color_[2],
+                 clear_color_[3]);
+    glViewport(viewport_[0], viewport_[1], viewport_[2], viewport_[3]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, unpack_row_length_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment_);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, static_cast<GLuint>(unpack_buffer_));
+    glBindBuffer(GL_ARRAY_BUFFER, static_cast<GLuint>(array_buffer_));
+    glUseProgram(static_cast<GLuint>(program_));
+    glBindVertexArray(static_cast<GLuint>(vertex_array_));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER,
+                      static_cast<GLuint>(read_framebuffer_));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER,
+                      static_cast<GLuint>(draw_framebuffer_));
+  }
+
+  // Disallow copy and assign.
+  ScopedGlState(const ScopedGlState&) = delete;
+  ScopedGlState& operator=(const ScopedGlState&) = delete;
+
+ private:
+  static constexpr GLuint kTextureUnits = 2;
+  static constexpr size_t kCapabilityCount = 5;
+  static constexpr GLenum kCapabilities[kCapabilityCount] = {
+      GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+
+  GLint draw_framebuffer_{};
+  GLint read_framebuffer_{};
+  GLint vertex_array_{};
+  GLint program_{};
+  GLint array_buffer_{};
+  GLint unpack_buffer_{};
+  GLint unpack_alignment_{};
+  GLint unpack_row_length_{};
+  GLint viewport_[4]{};
+  GLfloat clear_color_[4]{};
+  GLboolean color_mask_[4]{};
+  GLint active_texture_{};
+  GLint texture_[kTextureUnits]{};
+  GLint sampler_[kTextureUnits]{};
+  GLboolean enabled_[kCapabilityCount]{};
+};
+
 class Shader {
  public:
   GLuint textureId{};
-  GLuint framebuffer{};
   GLuint program;
   GLsizei width, height;
-  GLuint vertex_arr_id_{};
 
+  // Only objects shared between contexts are created here: the conversion
+  // later runs in the compositor's context, not in the one current now.
   Shader(GLsizei _width, GLsizei _height) : width(_width), height(_height) {
-    glGenFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-
-    glGenVertexArrays(1, &vertex_arr_id_);
-    glBindVertexArray(vertex_arr_id_);
-
     program = load_shaders();
     texY = glGetUniformLocation(program, "textureY");
     texUV = glGetUniformLocation(program, "textureUV");
@@ -80,41 +168,27 @@ class Shader {
 
     glGenTextures(2, &innerTexture[0]);
     glGenTextures(1, &textureId);
-    glClearColor(1.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
 
     glBindTexture(GL_TEXTURE_2D, textureId);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, nullptr);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           textureId, 0);
+    set_sampler_params();
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+    clear_texture();
 
-    auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if (status != GL_FRAMEBUFFER_COMPLETE) {
-      spdlog::error("FramebufferStatus: 0x{:X}", status);
-    }
+    // The planes are overwritten in place every frame, so their storage is
+    // allocated once, at the output size, without mip levels.
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, innerTexture[0]);
+    set_sampler_params();
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, height);
+    glUniform1i(texY, 0);
 
-    auto size = static_cast<unsigned long>(width) *
-                static_cast<unsigned long>(height) * 3;
-    auto pixels = new unsigned char[size]{0};
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, static_cast<GLsizei>(width),
-                 static_cast<GLsizei>(height), 0, GL_RGB, GL_UNSIGNED_BYTE,
-                 pixels);
-    delete[] pixels;
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, innerTexture[1]);
+    set_sampler_params();
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG8, uv_width(), uv_height());
+    glUniform1i(texUV, 1);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glGenBuffers(kPixelBufferCount, &pixel_buffer_[0]);
 
     glGenBuffers(1, &vertex_buffer_);
     glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
@@ -133,29 +207,33 @@ class Shader {
     glBufferData(GL_ARRAY_BUFFER, sizeof(coord_buffer_data), coord_buffer_data,
                  GL_STATIC_DRAW);
 
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, coord_buffer_);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glDisableVertexAttribArray(0);
-
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // The compositor's context uses these objects next; once, at creation,
+    // they have to be complete before it does.
     glFinish();
-
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
   }
 
   ~Shader() {
+    // Names from another context can't be deleted here; they go with it.
+    if (draw_context_ != EGL_NO_CONTEXT &&
+        eglGetCurrentContext() == draw_context_) {
+      glDeleteVertexArrays(1, &vertex_array_);
+      glDeleteFramebuffers(1, &framebuffer_);
+    }
+    for (auto& fence : pixel_buffer_fence_) {
+      if (fence) {
+        glDeleteSync(fence);
+      }
+    }
+    glDeleteBuffers(kPixelBufferCount, &pixel_buffer_[0]);
     glDeleteBuffers(1, &coord_buffer_);
     glDeleteBuffers(1, &vertex_buffer_);
-    glDeleteVertexArrays(1, &vertex_arr_id_);
     glDeleteProgram(program);
     glDeleteTextures(1, &textureId);
     glDeleteTextures(2, &innerTexture[0]);
-    glDeleteFramebuffers(1, &framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
   }
 
   /**
@@ -163,14 +241,19 @@ class Shader {
    * @param[in] y_buf Pointer to image data for luminance signal
    * @param[in] uv_buf Pointer to image data for color difference signal
    * @param[in] y_p_s No use
-   * @param[in] y_s Texture image width for luminance signal
+   * @param[in] y_s Row stride in bytes of the luminance plane
    * @param[in] uv_p_s No use
-   * @param[in] uv_s Texture image width for color difference signal
-   * @return void
+   * @param[in] uv_s Row stride in bytes of the color difference plane
+   * @return bool true if the planes were queued for upload, false if the
+   * frame was skipped
    * @relation
    * flutter
+   *
+   * Both planes are staged in one of kPixelBufferCount pixel buffers and
+   * copied into the existing texture storage by the GPU, so the call
+   * returns without waiting for the transfer.
    */
-  void load_pixels(gpointer y_buf,
+  bool load_pixels(gpointer y_buf,
                    gpointer uv_buf,
                    const GLsizei y_p_s,
                    const GLsizei y_s,
@@ -179,42 +262,73 @@ class Shader {
     (void)y_p_s;
     (void)uv_p_s;
     SPDLOG_TRACE("[VideoPlayer] load_pixels");
-    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    const auto y_size = static_cast<GLsizeiptr>(y_s) * height;
+    const auto uv_size = static_cast<GLsizeiptr>(uv_s) * uv_height();
+    const auto index = pixel_buffer_index_;
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT |
+                        GL_MAP_UNSYNCHRONIZED_BIT;
+
+    // The buffer was last used kPixelBufferCount frames ago and its fence
+    // has normally signaled long before. This runs on the raster thread, so
+    // the fence is only polled: if the GPU is still reading the buffer the
+    // frame is skipped and the next one tries the same buffer again, since
+    // overwriting it now would corrupt the frame being read.
+    if (auto& fence = pixel_buffer_fence_[index]) {
+      const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                             kPixelBufferTimeout);
+      if (result == GL_TIMEOUT_EXPIRED) {
+        SPDLOG_DEBUG("[VideoPlayer] Pixel buffer still in use, frame skipped");
+        return false;
+      }
+      glDeleteSync(fence);
+      fence = nullptr;
+      // Without a signaled fence the driver has to synchronize the map.
+      if (result == GL_WAIT_FAILED) {
+        spdlog::error("[VideoPlayer] Pixel buffer fence wait failed: 0x{:X}",
+                      glGetError());
+        access &= ~GL_MAP_UNSYNCHRONIZED_BIT;
+      }
+    }
+    pixel_buffer_index_ = (pixel_buffer_index_ + 1) % kPixelBufferCount;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer_[index]);
+    if (pixel_buffer_size_[index] != y_size + uv_size) {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, y_size + uv_size, nullptr,
+                   GL_STREAM_DRAW);
+      pixel_buffer_size_[index] = y_size + uv_size;
+    }
+    auto dst = static_cast<uint8_t*>(glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, y_size + uv_size, access));
+    if (dst == nullptr) {
+      spdlog::error("[VideoPlayer] Failed to map pixel buffer: 0x{:X}",
+                    glGetError());
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      return false;
+    }
+    memcpy(dst, y_buf, static_cast<size_t>(y_size));
+    memcpy(dst + y_size, uv_buf, static_cast<size_t>(uv_size));
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, innerTexture[0]);
-    glUniform1i(texY, 0);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, y_s, height, 0, GL_RED,
-                 GL_UNSIGNED_BYTE, y_buf);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, innerTexture[0]);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, y_s);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED,
+                    GL_UNSIGNED_BYTE, nullptr);
 
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, innerTexture[1]);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glUniform1i(texUV, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, uv_s / 2);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, uv_width(), uv_height(), GL_RG,
+                    GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(y_size));
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, uv_s / 2, height / 2, 0, GL_RG,
-                 GL_UNSIGNED_BYTE, uv_buf);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    auto fbo_status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if (fbo_status != GL_FRAMEBUFFER_COMPLETE)
-      spdlog::error("[VideoPlayer] Framebuffer is not complete: 0x{:X}",
-                    fbo_status);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    pixel_buffer_fence_[index] =
+        glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    return true;
   }
 
   GLuint load_shaders(const GLchar* vsource = kVertexSource,
@@ -262,46 +376,101 @@ class Shader {
     return shaderProgram;
   }
 
-  void draw_core() const {
+  /**
+   * @brief Converts the uploaded planes into textureId
+   * @return void
+   * @relation
+   * flutter
+   *
+   * Framebuffers and vertex arrays are not shared between contexts, so both
+   * are made on the first draw in the pulling context and kept for it.
+   */
+  void draw_core() {
     SPDLOG_TRACE("[VideoPlayer] draw_core");
+    if (const EGLContext context = eglGetCurrentContext();
+        context != draw_context_) {
+      draw_context_ = context;
+      framebuffer_ = 0;
+      vertex_array_ = 0;
+    }
+    if (vertex_array_ == 0) {
+      create_draw_objects();
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           textureId, 0);
+    glBindVertexArray(vertex_array_);
+
     glViewport(-width / 2, -height / 2, width * 2, height * 2);
     glClearColor(0, 0, 0, 0);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glUseProgram(program);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    glBindVertexArray(0);
+    // Attached only while drawing, so a framebuffer left behind in the
+    // compositor's context never keeps the texture alive.
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+
+ private:
+  static constexpr int kPixelBufferCount = 2;
+  static constexpr GLuint64 kPixelBufferTimeout = 0;
+
+  [[nodiscard]] GLsizei uv_width() const { return (width + 1) / 2; }
+  [[nodiscard]] GLsizei uv_height() const { return (height + 1) / 2; }
 
+  // Makes the framebuffer and the vertex array, with its attributes, in the
+  // current context.
+  void create_draw_objects() {
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           textureId, 0);
+    if (const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        status != GL_FRAMEBUFFER_COMPLETE) {
+      spdlog::error("[VideoPlayer] Framebuffer is not complete: 0x{:X}",
+                    status);
+    }
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           0, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &vertex_array_);
+    glBindVertexArray(vertex_array_);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-
     glEnableVertexAttribArray(1);
     glBindBuffer(GL_ARRAY_BUFFER, coord_buffer_);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-
-    glFinish();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
   }
 
-  void load_rgb_pixels(gpointer data) const {
-    SPDLOG_DEBUG("[VideoPlayer] load_rgb_pixels");
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureId);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  // Black until the first frame arrives, instead of undefined contents.
+  void clear_texture() const {
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           textureId, 0);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+  }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB,
-                 GL_UNSIGNED_BYTE, data);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  static void set_sampler_params() {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                    GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   }
 
- private:
   GLint texY{};
   GLint texUV{};
   GLuint innerTexture[2]{};
@@ -311,6 +480,17 @@ class Shader {
 
   GLuint vertex_buffer_{};
   GLuint coord_buffer_{};
+
+  // Belong to draw_context_, the context the frames are pulled in.
+  EGLContext draw_context_ = EGL_NO_CONTEXT;
+  GLuint framebuffer_{};
+  GLuint vertex_array_{};
+
+  GLuint pixel_buffer_[kPixelBufferCount]{};
+  GLsizeiptr pixel_buffer_size_[kPixelBufferCount]{};
+  // Signals when the GPU has finished reading the matching pixel buffer.
+  GLsync pixel_buffer_fence_[kPixelBufferCount]{};
+  int pixel_buffer_index_{};
 };
 
 }  // namespace video_player_linux::nv12
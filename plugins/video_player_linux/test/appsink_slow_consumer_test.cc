@@ -0,0 +1,120 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Feeds an appsink through VideoPlayer's FrameQueue from a 60 fps test
+ * source, and takes frames out of it ten times slower than they are made,
+ * the way a stalled compositor would. The pipeline has to keep to its clock
+ * anyway: the test fails if the position falls more than kMaxLag behind the
+ * time spent playing.
+ *
+ *   ./appsink_slow_consumer_test [seconds]
+ */
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "frame_queue.h"
+
+namespace {
+
+constexpr int kDefaultSeconds = 5;
+// Ten frame times of the 60 fps source.
+constexpr std::chrono::milliseconds kConsumerDelay(167);
+constexpr GstClockTime kMaxLag = 250 * GST_MSECOND;
+
+gint64 QueryPosition(GstElement* pipeline) {
+  gint64 position = 0;
+  gst_element_query_position(pipeline, GST_FORMAT_TIME, &position);
+  return position;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  gst_init(&argc, &argv);
+  const int seconds = argc > 1 ? std::atoi(argv[1]) : kDefaultSeconds;
+  if (seconds <= 0) {
+    return EXIT_FAILURE;
+  }
+
+  GError* error = nullptr;
+  GstElement* pipeline = gst_parse_launch(
+      "videotestsrc ! "
+      "video/x-raw,format=NV12,width=640,height=360,framerate=60/1 ! "
+      "appsink name=sink",
+      &error);
+  if (pipeline == nullptr) {
+    std::fprintf(stderr, "Unable to build the pipeline: %s\n",
+                 error->message);
+    g_clear_error(&error);
+    return EXIT_FAILURE;
+  }
+
+  // Polled by the consumer below rather than woken up.
+  video_player_linux::FrameQueue queue(nullptr);
+  GstElement* sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+  queue.Attach(sink);
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+  if (gst_element_get_state(pipeline, nullptr, nullptr, GST_CLOCK_TIME_NONE) ==
+      GST_STATE_CHANGE_FAILURE) {
+    std::fprintf(stderr, "Unable to start the pipeline\n");
+    return EXIT_FAILURE;
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<int> consumed{0};
+  std::thread consumer([&] {
+    while (!stop) {
+      std::this_thread::sleep_for(kConsumerDelay);
+      if (GstSample* sample = queue.TakeDue(pipeline)) {
+        gst_sample_unref(sample);
+        ++consumed;
+      }
+    }
+  });
+
+  const gint64 start_position = QueryPosition(pipeline);
+  const auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::seconds(seconds));
+  const gint64 played = QueryPosition(pipeline) - start_position;
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  stop = true;
+  consumer.join();
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  queue.Detach();
+  queue.Flush();
+  gst_object_unref(sink);
+  gst_object_unref(pipeline);
+
+  const bool kept_pace = played + static_cast<gint64>(kMaxLag) >= elapsed;
+  std::printf(
+      "%s: played %.2f s in %.2f s; %d frames consumed, %llu dropped from "
+      "the queue\n",
+      kept_pace ? "PASS" : "FAIL", static_cast<double>(played) / GST_SECOND,
+      static_cast<double>(elapsed) / GST_SECOND, consumed.load(),
+      static_cast<unsigned long long>(queue.dropped()));
+  return kept_pace ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2020-2024 Toyota Connected North America
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the NV12 upload and conversion in nv12.h on a headless GLES 3
+ * context, for instance with software GL:
+ *
+ *   EGL_PLATFORM=surfaceless LIBGL_ALWAYS_SOFTWARE=1 ./nv12_upload_benchmark
+ *
+ * For 1080p and 4K it reports the CPU time spent per frame in load_pixels
+ * and draw_core, and the frame rate sustained once the GPU work is counted.
+ * An optional argument sets the number of frames per size.
+ */
+
+#include <EGL/egl.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+#include "nv12.h"
+
+namespace {
+
+constexpr int kDefaultFrames = 120;
+constexpr int kWarmUpFrames = 10;
+
+struct Size {
+  GLsizei width;
+  GLsizei height;
+};
+
+constexpr Size kSizes[] = {{1920, 1080}, {3840, 2160}};
+
+bool MakeContextCurrent() {
+  EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+    spdlog::error("No EGL display");
+    return false;
+  }
+  eglBindAPI(EGL_OPENGL_ES_API);
+
+  // Any surface type; the default asks for window surfaces.
+  constexpr EGLint kConfigAttributes[] = {
+      EGL_SURFACE_TYPE, 0, EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT, EGL_NONE};
+  EGLConfig config;
+  EGLint count = 0;
+  if (!eglChooseConfig(display, kConfigAttributes, &config, 1, &count) ||
+      count == 0) {
+    spdlog::error("No GLES 3 EGL config");
+    return false;
+  }
+
+  constexpr EGLint kContextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3,
+                                           EGL_NONE};
+  EGLContext context =
+      eglCreateContext(display, config, EGL_NO_CONTEXT, kContextAttributes);
+  // The conversion renders into its own texture; no surface is needed.
+  if (context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    spdlog::error("Unable to make a surfaceless GLES 3 context current");
+    return false;
+  }
+  spdlog::info("GL renderer: {}",
+               reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+  return true;
+}
+
+void Run(const Size& size, const int frames) {
+  const GLsizei uv_stride = (size.width + 1) / 2 * 2;
+  const GLsizei uv_rows = (size.height + 1) / 2;
+  std::vector<uint8_t> y(static_cast<size_t>(size.width) * size.height, 128);
+  std::vector<uint8_t> uv(static_cast<size_t>(uv_stride) * uv_rows, 128);
+
+  video_player_linux::nv12::Shader shader(size.width, size.height);
+
+  int skipped = 0;
+  const auto upload = [&](const int frame) {
+    // Some content that changes from frame to frame.
+    y[static_cast<size_t>(frame) % y.size()] = static_cast<uint8_t>(frame);
+    video_player_linux::nv12::ScopedGlState state;
+    if (shader.load_pixels(y.data(), uv.data(), 1, size.width, 2,
+                           uv_stride)) {
+      shader.draw_core();
+    } else {
+      ++skipped;
+    }
+    glFlush();
+  };
+
+  for (int frame = 0; frame < kWarmUpFrames; frame++) {
+    upload(frame);
+  }
+  glFinish();
+  skipped = 0;
+
+  std::chrono::steady_clock::duration cpu{};
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < frames; frame++) {
+    const auto frame_start = std::chrono::steady_clock::now();
+    upload(frame);
+    cpu += std::chrono::steady_clock::now() - frame_start;
+  }
+  glFinish();
+  const std::chrono::duration<double> total =
+      std::chrono::steady_clock::now() - start;
+
+  spdlog::info(
+      "{}x{}: {:.2f} ms CPU per frame, {:.1f} fps sustained, {} of {} frames "
+      "skipped",
+      size.width, size.height,
+      std::chrono::duration<double, std::milli>(cpu).count() / frames,
+      (frames - skipped) / total.count(), skipped, frames);
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  const int frames = argc > 1 ? std::atoi(argv[1]) : kDefaultFrames;
+  if (frames <= 0 || !MakeContextCurrent()) {
+    return EXIT_FAILURE;
+  }
+  for (const auto& size : kSizes) {
+    Run(size, frames);
+  }
+  return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 
 #include <backend/backend.h>
 #include <plugins/common/common.h>
+#include <chrono>
 #include <utility>
 
 #define GSTREAMER_DEBUG 0
@@ -50,6 +51,10 @@ VideoPlayer::VideoPlayer(flutter::PluginRegistrarDesktop* registrar,
       height_(height),
       duration_(duration),
       decoder_factory_(decoder_factory),
+      frame_queue_([this] {
+        m_registrar->texture_registrar()->MarkTextureFrameAvailable(
+            m_texture_id);
+      }),
       media_state_(GST_STATE_VOID_PENDING),
       event_channel_(nullptr) {
   SPDLOG_DEBUG(
@@ -80,7 +85,7 @@ VideoPlayer::VideoPlayer(flutter::PluginRegistrarDesktop* registrar,
       kFlutterDesktopGpuSurfaceTypeGlTexture2D,
       [&](size_t /* width */,
           size_t /* height */) -> const FlutterDesktopGpuSurfaceDescriptor* {
-        return &m_descriptor;
+        return OnTexturePull();
       });
 
   flutter::TextureVariant texture = *gpu_surface_texture_;
@@ -115,13 +120,9 @@ VideoPlayer::VideoPlayer(flutter::PluginRegistrarDesktop* registrar,
   g_object_set(playbin_, "flags", flags, nullptr);
   g_object_set(playbin_, "connection-speed", 56, nullptr);
 
-  sink_ = gst_element_factory_make("fakesink", nullptr);
+  sink_ = gst_element_factory_make("appsink", nullptr);
   assert(sink_);
-  g_object_set(sink_, "sync", TRUE, nullptr);
-  g_object_set(sink_, "signal-handoffs", TRUE, nullptr);
-  g_object_set(sink_, "can-activate-pull", TRUE, nullptr);
-  handoff_handler_id_ = g_signal_connect(
-      sink_, "handoff", reinterpret_cast<GCallback>(handoff_handler), this);
+  frame_queue_.Attach(sink_);
 
   decoder_ = gst_element_factory_create(decoder_factory, "decoder");
   assert(decoder_);
@@ -167,7 +168,7 @@ VideoPlayer::VideoPlayer(flutter::PluginRegistrarDesktop* registrar,
 
   if (!gst_element_link_filtered(video_scale_, sink_, scale)) {
     SPDLOG_ERROR(
-        "[VideoPlayer] Failed to link videoscale with fakesink using filter");
+        "[VideoPlayer] Failed to link videoscale with appsink using filter");
   }
   gst_caps_unref(scale);
 
@@ -411,47 +412,57 @@ void VideoPlayer::OnTag(const GstTagList* list,
   }
 }
 
-void VideoPlayer::handoff_handler(GstElement* /* fakesink */,
-                                  GstBuffer* buffer,
-                                  GstPad* /* pad */,
-                                  void* user_data) {
-  const auto obj = static_cast<VideoPlayer*>(user_data);
-  if (!obj->is_initialized_ || obj->info_.finfo == nullptr) {
+void VideoPlayer::UploadSample(GstSample* sample) {
+  GstVideoInfo info;
+  if (!gst_video_info_from_caps(&info, gst_sample_get_caps(sample))) {
+    SPDLOG_ERROR("[VideoPlayer] Fail to get video info from the sample");
     return;
   }
 
-  std::lock_guard lock(obj->gst_mutex_);
   GstVideoFrame frame;
-  if (gst_video_frame_map(&frame, &obj->info_, buffer, GST_MAP_READ)) {
-    obj->m_registrar->texture_registrar()->TextureMakeCurrent();
-    glBindVertexArray(obj->shader_->vertex_arr_id_);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    if (const guint n_planes = GST_VIDEO_INFO_N_PLANES(&obj->info_);
-        n_planes == 2) {
-      // Assume NV12
-      obj->shader_->load_pixels(GST_VIDEO_FRAME_PLANE_DATA(&frame, 0),
-                                GST_VIDEO_FRAME_PLANE_DATA(&frame, 1),
-                                GST_VIDEO_FRAME_COMP_PSTRIDE(&frame, 0),
-                                GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0),
-                                GST_VIDEO_FRAME_COMP_PSTRIDE(&frame, 1),
-                                GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 1));
+  if (!gst_video_frame_map(&frame, &info, gst_sample_get_buffer(sample),
+                           GST_MAP_READ)) {
+    SPDLOG_ERROR("[VideoPlayer] Cannot read video frame out from buffer");
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  {
+    nv12::ScopedGlState state;
+    // The caps filter ahead of the sink pins the format to NV12.
+    if (shader_->load_pixels(GST_VIDEO_FRAME_PLANE_DATA(&frame, 0),
+                             GST_VIDEO_FRAME_PLANE_DATA(&frame, 1),
+                             GST_VIDEO_FRAME_COMP_PSTRIDE(&frame, 0),
+                             GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0),
+                             GST_VIDEO_FRAME_COMP_PSTRIDE(&frame, 1),
+                             GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 1))) {
+      shader_->draw_core();
     } else {
-      // Assume RGB
-      obj->shader_->load_rgb_pixels(GST_VIDEO_FRAME_PLANE_DATA(&frame, 0));
+      ++m_dropped_frames;
+      SPDLOG_TRACE("[VideoPlayer] pixel buffer busy, dropped: {}",
+                   m_dropped_frames.load());
     }
-    gst_video_frame_unmap(&frame);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, obj->shader_->framebuffer);
-    obj->shader_->draw_core();
+  }
+  gst_video_frame_unmap(&frame);
+  SPDLOG_TRACE("[VideoPlayer] frame: {} us",
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count());
+}
 
-    obj->m_registrar->texture_registrar()->TextureClearCurrent();
-    obj->m_registrar->texture_registrar()->MarkTextureFrameAvailable(
-        obj->m_texture_id);
-    SPDLOG_TRACE("[VideoPlayer] frame");
-  } else {
-    SPDLOG_ERROR("[VideoPlayer] Cannot read video frame out from buffer");
+const FlutterDesktopGpuSurfaceDescriptor* VideoPlayer::OnTexturePull() {
+  GstSample* sample = frame_queue_.TakeDue(playbin_);
+  if (sample == nullptr) {
+    return &m_descriptor;
+  }
+  // Dispose() holds the lock while it tears the shader down; the frame is
+  // not worth waiting for then.
+  if (std::unique_lock lock(buffer_mutex_, std::try_to_lock);
+      lock.owns_lock() && shader_) {
+    UploadSample(sample);
   }
+  gst_sample_unref(sample);
+  return &m_descriptor;
 }
 
 void VideoPlayer::Init(flutter::BinaryMessenger* messenger) {
@@ -558,7 +569,8 @@ void VideoPlayer::Dispose() {
   }
 
   g_signal_handler_disconnect(G_OBJECT(bus_), on_bus_msg_id_);
-  g_signal_handler_disconnect(G_OBJECT(sink_), handoff_handler_id_);
+  frame_queue_.Detach();
+  frame_queue_.Flush();
 
   m_registrar->texture_registrar()->TextureMakeCurrent();
   shader_.reset();
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <functional>
 #include <future>
 #include <map>
@@ -30,6 +31,7 @@
 #include <flutter/plugin_registrar_homescreen.h>
 #include <flutter/standard_method_codec.h>
 
+#include "frame_queue.h"
 #include "nv12.h"
 
 extern "C" {
@@ -85,6 +87,12 @@ class VideoPlayer {
   flutter::TextureRegistrar* m_texture_registry{};
   std::unique_ptr<flutter::GpuSurfaceTexture> gpu_surface_texture_;
 
+  // Decoded frames waiting for the compositor; uploads happen when Flutter
+  // pulls the texture.
+  FrameQueue frame_queue_;
+  // Frames whose upload was skipped because the pixel buffer was busy.
+  std::atomic<uint64_t> m_dropped_frames{};
+
   GMainContext* context_;
   GstState media_state_;
 
@@ -101,7 +109,6 @@ class VideoPlayer {
   gdouble rate_ = 0.0;
   GstBus* bus_{};
 
-  gulong handoff_handler_id_;
   gulong on_bus_msg_id_;
 
   GstState target_state_ = GST_STATE_PAUSED;
@@ -158,19 +165,21 @@ class VideoPlayer {
   bool EnsureTextureCreated(uint32_t width, uint32_t height);
 
   /**
-   * @brief Callback called when fakesink receives new frame data
-   * @param[in] fakesink No use
-   * @param[in] buffer Pointer to New frame data
-   * @param[in] pad No use
-   * @param[in,out] _data Pointer to User data
+   * @brief Uploads a frame and converts it into the Flutter texture
+   * @param[in] sample Frame to upload
    * @return void
    * @relation
    * flutter
    */
-  static void handoff_handler(GstElement* fakesink,
-                              GstBuffer* buffer,
-                              GstPad* pad,
-                              void* user_data);
+  void UploadSample(GstSample* sample);
+
+  /**
+   * @brief Texture callback, runs with the compositor's context current
+   * @return const FlutterDesktopGpuSurfaceDescriptor*
+   * @relation
+   * flutter
+   */
+  const FlutterDesktopGpuSurfaceDescriptor* OnTexturePull();
 
   static gboolean OnBusMessage(GstBus* bus, GstMessage* msg, void* user_data);
 